@@ -0,0 +1,202 @@
+// Plant.cpp
+#include "Plant.h"
+
+#include <Arduino.h>
+#include <HX711.h>
+#include <DHT.h>
+#include <NativeHal.h>
+#include <math.h>
+
+namespace {
+
+// Pines del firmware (ver los .h de cada dispositivo)
+const uint8_t PUMP_PIN = 18;
+const uint8_t WATER_IR_PIN = 9;
+const uint8_t WATER_LEVEL_PIN = A1;
+const uint8_t MQ2_PIN = A0;
+const uint8_t LITTER_ECHO_PIN = 11;
+const uint8_t LITTER_PULL_PIN = 17;
+const uint8_t PLATE_ECHO_PIN = 5;
+const uint8_t STORAGE_ECHO_PIN = 7;
+const uint8_t AUGER_PULL_PIN = 12;
+const uint8_t AUGER_DIR_PIN = 13;
+
+const float US_PER_CM = 58.2f;                 // ida y vuelta a ~22 °C
+const float MQ2_CURVE_A = 20.0f;               // misma curva NH3 que gen_mq2_lut.py
+const float MQ2_CURVE_B = -2.2f;
+const uint64_t AMBIENT_PERIOD_US = 60000000ULL;
+const float DAY_US = 86400e6f;
+
+} // namespace
+
+Plant::Plant(const PlantConfig& config)
+    : cfg(config), lastUs(0), lastAmbientUs(0), lastAugerEdges(0),
+      hoseFlow(0.0f), gasExcessPpm(0.0f), pumpRunning(false),
+      pumpStarts(0), pumpOffUs(0), litterStepUs(0), noiseState(12345) {
+    for (uint8_t s = 0; s < SIM_STATION_COUNT; ++s) {
+        present[s] = false;
+        arrivedUs[s] = 0;
+    }
+}
+
+void Plant::install() {
+    lastUs = hal::nowMicros();
+    lastAugerEdges = hal::risingEdges(AUGER_PULL_PIN);
+
+    hal::setDigitalProvider([this](uint8_t pin) {
+        if (pin == WATER_IR_PIN) return present[SIM_WATER] ? LOW : HIGH;
+        return HIGH;
+    });
+    hal::setAnalogProvider([this](uint8_t pin) { return analogValue(pin); });
+    hal::setPulseProvider([this](uint8_t pin, unsigned long timeoutUs) {
+        unsigned long us = echoUs(pin);
+        return us > timeoutUs ? 0UL : us;
+    });
+    hal::setOutputListener([this](uint8_t pin, int value) {
+        if (pin == PUMP_PIN) {
+            bool on = value == HIGH;
+            if (on == pumpRunning) return;
+            step();                        // integrar con el estado anterior de la bomba
+            pumpRunning = on;
+            if (on) pumpStarts++;
+            else pumpOffUs = hal::nowMicros();
+        } else if (pin == LITTER_PULL_PIN && value == HIGH) {
+            litterStepUs = hal::nowMicros();
+        }
+    });
+
+    updateAmbient(lastUs);
+    hal::setLoadGrams(loadGrams());
+}
+
+void Plant::scheduleVisit(uint8_t station, uint32_t startMs, uint32_t durationMs) {
+    CatVisit v = { station, startMs, durationMs };
+    visits.push_back(v);
+}
+
+void Plant::step() {
+    uint64_t now = hal::nowMicros();
+    if (now < lastUs) lastUs = now;
+    float dt = (now - lastUs) / 1e6f;
+    lastUs = now;
+
+    updatePresence(now);
+
+    // Bebedero: caudal de primer orden por la manguera, evaporación y el gato
+    if (dt > 0.0f) {
+        float target = pumpRunning ? 1.0f : 0.0f;
+        float k = 1.0f - expf(-dt * 1000.0f / cfg.hoseTauMs);
+        float before = hoseFlow;
+        hoseFlow += (target - hoseFlow) * k;
+        float delivered = (before + hoseFlow) * 0.5f * cfg.pumpMlPerS * dt;
+        float lost = cfg.evaporationMlPerH * dt / 3600.0f;
+        if (present[SIM_WATER]) lost += cfg.drinkMlPerS * dt;
+        cfg.bowlMl += delivered - lost;
+        if (cfg.bowlMl < 0.0f) cfg.bowlMl = 0.0f;
+        if (cfg.bowlMl > cfg.bowlCapacityMl) cfg.bowlMl = cfg.bowlCapacityMl;   // rebalsa
+    }
+
+    // Comedero: cada paso en el sentido de dispensado (DIR en LOW, ver
+    // DispenseController) saca comida de la tolva; llega al plato tarde
+    uint32_t edges = hal::risingEdges(AUGER_PULL_PIN);
+    if (edges != lastAugerEdges) {
+        float grams = (edges - lastAugerEdges) / cfg.augerStepsPerGram;
+        lastAugerEdges = edges;
+        if (hal::digitalOutput(AUGER_DIR_PIN) == LOW) {
+            if (grams > cfg.storageG) grams = cfg.storageG;
+            cfg.storageG -= grams;
+            Pellet p = { now + (uint64_t)(cfg.transitMs * 1000.0f), grams };
+            chute.push_back(p);
+        }
+    }
+    while (!chute.empty() && chute.front().arrivesUs <= now) {
+        cfg.plateG += chute.front().grams;
+        chute.pop_front();
+    }
+    if (present[SIM_FEEDER] && dt > 0.0f) {
+        cfg.plateG -= cfg.eatGPerS * dt;
+        if (cfg.plateG < 0.0f) cfg.plateG = 0.0f;
+    }
+
+    // Arenero: el olor decae exponencialmente
+    if (dt > 0.0f) gasExcessPpm *= expf(-dt / (cfg.gasDecayMin * 60.0f));
+
+    if (now - lastAmbientUs >= AMBIENT_PERIOD_US) updateAmbient(now);
+    hal::setLoadGrams(loadGrams());
+}
+
+float Plant::waterCounts() const {
+    return cfg.emptyCounts + cfg.bowlMl * cfg.countsPerMl;
+}
+
+float Plant::inFlightGrams() const {
+    float g = 0.0f;
+    for (size_t i = 0; i < chute.size(); ++i) g += chute[i].grams;
+    return g;
+}
+
+int Plant::noise(int amplitude) {
+    if (amplitude <= 0) return 0;
+    noiseState = noiseState * 1103515245u + 12345u;
+    return (int)((noiseState >> 16) % (uint32_t)(2 * amplitude + 1)) - amplitude;
+}
+
+void Plant::updatePresence(uint64_t nowUs) {
+    bool next[SIM_STATION_COUNT] = { false, false, false };
+    uint32_t nowMs = (uint32_t)(nowUs / 1000ULL);
+    for (size_t i = 0; i < visits.size(); ++i) {
+        const CatVisit& v = visits[i];
+        if (nowMs >= v.startMs && nowMs < v.startMs + v.durationMs) next[v.station] = true;
+    }
+    for (uint8_t s = 0; s < SIM_STATION_COUNT; ++s) {
+        if (next[s] && !present[s]) arrivedUs[s] = nowUs;
+        // Al salir del arenero queda el olor de la visita
+        if (!next[s] && present[s] && s == SIM_LITTERBOX) gasExcessPpm += cfg.gasPerVisitPpm;
+        present[s] = next[s];
+    }
+}
+
+void Plant::updateAmbient(uint64_t nowUs) {
+    lastAmbientUs = nowUs;
+    // Mínimo a las 6 h, máximo a las 18 h
+    float phase = sinf(2.0f * (float)M_PI * ((float)nowUs / DAY_US - 0.5f) - (float)M_PI / 2.0f);
+    hal::setAmbient(cfg.tempMeanC + cfg.tempSwingC * phase, cfg.humMean - cfg.humSwing * phase);
+}
+
+unsigned long Plant::echoUs(uint8_t pin) {
+    float cm;
+    if (pin == LITTER_ECHO_PIN) {
+        cm = present[SIM_LITTERBOX] ? cfg.litterCatCm : cfg.litterClearCm;
+    } else if (pin == PLATE_ECHO_PIN) {
+        cm = present[SIM_FEEDER] ? cfg.plateCatCm : cfg.plateClearCm;
+    } else if (pin == STORAGE_ECHO_PIN) {
+        float fill = cfg.storageG / cfg.storageCapacityG;
+        if (fill > 1.0f) fill = 1.0f;
+        cm = cfg.storageEmptyCm - fill * (cfg.storageEmptyCm - cfg.storageFullCm);
+    } else {
+        return 0;
+    }
+    return (unsigned long)(cm * US_PER_CM);
+}
+
+int Plant::analogValue(uint8_t pin) {
+    if (pin == WATER_LEVEL_PIN) {
+        // El gato bebiendo mueve la superficie: más ruido en la lectura
+        int amplitude = cfg.levelNoise * (present[SIM_WATER] ? 4 : 1);
+        int v = (int)(waterCounts() + 0.5f) + noise(amplitude);
+        return v < 0 ? 0 : (v > 1023 ? 1023 : v);
+    }
+    if (pin == MQ2_PIN) {
+        // ppm = A * (Rs/Ro)^B  ->  Rs = Ro * (ppm/A)^(1/B); divisor con RL a masa
+        float rs = cfg.mq2RoKohm * powf(gasPpm() / MQ2_CURVE_A, 1.0f / MQ2_CURVE_B);
+        int v = (int)(1023.0f * cfg.mq2LoadKohm / (cfg.mq2LoadKohm + rs) + 0.5f) + noise(1);
+        return v < 0 ? 0 : (v > 1023 ? 1023 : v);
+    }
+    return 0;
+}
+
+float Plant::loadGrams() {
+    float g = cfg.plateG;
+    if (present[SIM_FEEDER]) g += cfg.catPushG * noise(100) / 100.0f;
+    return g;
+}
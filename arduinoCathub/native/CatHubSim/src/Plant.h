@@ -0,0 +1,132 @@
+// Plant.h
+// Modelos físicos simples de la estación (bebedero, comedero, arenero y
+// gato) conectados al HAL nativo: leen las salidas que escribe el firmware
+// (bomba, pasos del sinfín) y generan las entradas que éste lee (ADC, ecos,
+// IR, HX711, DHT). Se integran sobre el reloj virtual.
+#ifndef CATHUB_SIM_PLANT_H
+#define CATHUB_SIM_PLANT_H
+
+#include <stdint.h>
+#include <deque>
+#include <vector>
+
+enum SimStation : uint8_t {
+    SIM_LITTERBOX,
+    SIM_FEEDER,
+    SIM_WATER,
+    SIM_STATION_COUNT
+};
+
+// Parámetros de la planta. Los valores por defecto están a propósito algo
+// corridos de la configuración de fábrica del firmware (pasos/g del sinfín,
+// caudal de la bomba) para que el lazo cerrado tenga algo que corregir.
+struct PlantConfig {
+    // Bebedero: sensor analógico lineal en el volumen
+    float bowlMl = 300.0f;
+    float bowlCapacityMl = 600.0f;
+    float emptyCounts = 60.0f;         // ADC con el bebedero vacío
+    float countsPerMl = 1.0f;
+    float pumpMlPerS = 30.0f;
+    float hoseTauMs = 300.0f;          // la manguera retrasa el caudal al arrancar y al cortar
+    float evaporationMlPerH = 1.5f;
+    float drinkMlPerS = 0.5f;
+    int   levelNoise = 2;              // ± cuentas de ruido del ADC
+
+    // Comedero
+    float storageG = 1500.0f;
+    float storageCapacityG = 2000.0f;
+    float storageFullCm = 3.0f;
+    float storageEmptyCm = 14.0f;      // tolva vacía (el firmware corta en 13 cm)
+    float augerStepsPerGram = 100.0f;  // real; el firmware arranca con 80
+    float transitMs = 800.0f;          // del sinfín al plato
+    float plateG = 0.0f;
+    float eatGPerS = 0.05f;
+    float plateClearCm = 25.0f;        // ultrasónico del plato sin gato
+    float plateCatCm = 5.0f;           // cabeza del gato sobre el plato
+    float catPushG = 15.0f;            // el gato apoya el hocico: ruido en la balanza
+
+    // Arenero
+    float litterClearCm = 34.0f;
+    float litterCatCm = 5.0f;
+    float gasBaselinePpm = 0.13f;      // Rs/Ro ≈ 9.83 (aire limpio en la curva NH3)
+    float gasPerVisitPpm = 25.0f;
+    float gasDecayMin = 20.0f;
+    float mq2RoKohm = 10.0f;
+    float mq2LoadKohm = 10.0f;
+
+    // Ambiente (ciclo diario)
+    float tempMeanC = 22.0f;
+    float tempSwingC = 2.0f;
+    float humMean = 45.0f;
+    float humSwing = 5.0f;
+};
+
+struct CatVisit {
+    uint8_t station;
+    uint32_t startMs;
+    uint32_t durationMs;
+};
+
+class Plant {
+public:
+    explicit Plant(const PlantConfig& config = PlantConfig());
+
+    // Conecta los proveedores del HAL (después de hal::reset())
+    void install();
+
+    // Integra la física desde la última llamada hasta el reloj virtual
+    void step();
+
+    void scheduleVisit(uint8_t station, uint32_t startMs, uint32_t durationMs);
+    bool catAt(uint8_t station) const { return present[station]; }
+    // Inicio de la visita en curso (µs del reloj virtual)
+    uint64_t catArrivedUs(uint8_t station) const { return arrivedUs[station]; }
+
+    // Estado verdadero (lo que el firmware intenta estimar)
+    float waterCounts() const;
+    float waterMl() const { return cfg.bowlMl; }
+    float plateGrams() const { return cfg.plateG; }
+    float inFlightGrams() const;
+    float storageGrams() const { return cfg.storageG; }
+    float gasPpm() const { return cfg.gasBaselinePpm + gasExcessPpm; }
+    bool pumpOn() const { return pumpRunning; }
+
+    // Salidas observadas con marca de tiempo (para medir latencias)
+    uint32_t getPumpStarts() const { return pumpStarts; }
+    uint64_t getPumpOffUs() const { return pumpOffUs; }
+    uint64_t getLitterStepUs() const { return litterStepUs; }   // último paso del tambor
+
+    const PlantConfig& config() const { return cfg; }
+    PlantConfig& config() { return cfg; }
+
+private:
+    struct Pellet {
+        uint64_t arrivesUs;
+        float grams;
+    };
+
+    PlantConfig cfg;
+    std::vector<CatVisit> visits;
+    std::deque<Pellet> chute;
+    bool present[SIM_STATION_COUNT];
+    uint64_t arrivedUs[SIM_STATION_COUNT];
+    uint64_t lastUs;
+    uint64_t lastAmbientUs;
+    uint32_t lastAugerEdges;
+    float hoseFlow;            // fracción del caudal nominal que llega al bebedero
+    float gasExcessPpm;
+    bool pumpRunning;
+    uint32_t pumpStarts;
+    uint64_t pumpOffUs;
+    uint64_t litterStepUs;
+    uint32_t noiseState;
+
+    int noise(int amplitude);
+    void updatePresence(uint64_t nowUs);
+    void updateAmbient(uint64_t nowUs);
+    unsigned long echoUs(uint8_t pin);
+    int analogValue(uint8_t pin);
+    float loadGrams();
+};
+
+#endif
@@ -0,0 +1,16 @@
+// Scenarios.h
+// Escenarios de la simulación. Cada uno arma la planta, programa visitas del
+// gato y comandos, corre el firmware y fija los límites de sus métricas.
+#ifndef CATHUB_SIM_SCENARIOS_H
+#define CATHUB_SIM_SCENARIOS_H
+
+struct SimScenario {
+    const char* name;
+    const char* description;
+    bool (*run)(bool verbose);   // true si pasaron todos los límites
+};
+
+extern const SimScenario SIM_SCENARIOS[];
+extern const unsigned SIM_SCENARIO_COUNT;
+
+#endif
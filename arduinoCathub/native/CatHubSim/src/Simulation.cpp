@@ -0,0 +1,220 @@
+// Simulation.cpp
+#include "Simulation.h"
+
+#include <Arduino.h>
+#include <NativeHal.h>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+
+void setup();
+void loop();
+
+namespace {
+
+uint64_t wallMicros() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+bool contains(const std::string& line, const char* text) {
+    return line.find(text) != std::string::npos;
+}
+
+float msBetween(uint64_t fromUs, uint64_t toUs) {
+    return toUs > fromUs ? (toUs - fromUs) / 1000.0f : 0.0f;
+}
+
+} // namespace
+
+Simulation::Simulation(const char* name, const PlantConfig& config)
+    : name(name), model(config), verbose(false),
+      seenPumpStarts(0), pumpWasOn(false), floodReachedUs(0), catWhilePumpUs(0),
+      overshootUntilUs(0), catWasAtWater(false), catWasAtLitter(false),
+      cleanStopCheckUs(0), cleanCatUs(0), dispenseTarget(-1.0f),
+      dispenseStorageBefore(0.0f), dispenseStartUs(0), wallStartUs(0) {}
+
+void Simulation::begin() {
+    wallStartUs = wallMicros();
+    hal::reset();
+    Serial.setEcho(false);
+    model.install();
+    setup();
+    readSerial();
+}
+
+void Simulation::at(uint32_t ms, const std::string& command) {
+    Scheduled s = { ms, command, -1.0f };
+    schedule.push_back(s);
+}
+
+void Simulation::dispenseAt(uint32_t ms, float grams) {
+    char command[32];
+    snprintf(command, sizeof(command), "FDR1:DISPENSE:%.1f", grams);
+    Scheduled s = { ms, command, grams };
+    schedule.push_back(s);
+}
+
+void Simulation::runUntil(uint32_t ms) {
+    while (millis() < ms) {
+        runScheduled(millis());
+        loop();
+        hal::advanceMicros(LOOP_CPU_US);
+        model.step();
+        stats.loops++;
+        readSerial();
+        observe();
+    }
+}
+
+void Simulation::runScheduled(uint32_t nowMs) {
+    for (size_t i = 0; i < schedule.size(); ) {
+        if (schedule[i].atMs > nowMs) { ++i; continue; }
+        if (schedule[i].dispenseGrams >= 0.0f) {
+            dispenseTarget = schedule[i].dispenseGrams;
+            dispenseStorageBefore = model.storageGrams();
+            dispenseStartUs = hal::nowMicros();
+        }
+        if (verbose) printf("%10.3f > %s\n", hal::nowMicros() / 1e6, schedule[i].command.c_str());
+        Serial.inject(schedule[i].command + "\n");
+        schedule.erase(schedule.begin() + i);
+    }
+}
+
+void Simulation::observe() {
+    uint64_t now = hal::nowMicros();
+    bool pumpOn = model.pumpOn();
+    float counts = model.waterCounts();
+
+    // Bebedero: arranques, corte por nivel, corte por gato y sobrepaso
+    if (model.getPumpStarts() != seenPumpStarts) {
+        seenPumpStarts = model.getPumpStarts();
+        stats.refills++;
+        floodReachedUs = 0;
+        catWhilePumpUs = 0;
+        if (model.catAt(SIM_WATER)) stats.pumpStartsWithCat++;
+    }
+    if (pumpOn && floodReachedUs == 0 && counts >= FLOOD_COUNTS) floodReachedUs = now;
+    bool catAtWater = model.catAt(SIM_WATER);
+    if (pumpOn && catAtWater && !catWasAtWater) catWhilePumpUs = model.catArrivedUs(SIM_WATER);
+    catWasAtWater = catAtWater;
+
+    if (pumpWasOn && !pumpOn) {
+        uint64_t offUs = model.getPumpOffUs();
+        if (floodReachedUs) {
+            float ms = msBetween(floodReachedUs, offUs);
+            if (ms > stats.levelStopMs) stats.levelStopMs = ms;
+        }
+        if (catWhilePumpUs) {
+            float ms = msBetween(catWhilePumpUs, offUs);
+            if (ms > stats.catStopMs) stats.catStopMs = ms;
+            stats.catStops++;
+        }
+        overshootUntilUs = offUs + OVERSHOOT_WINDOW_MS * 1000ULL;
+    }
+    pumpWasOn = pumpOn;
+    if (pumpOn || now < overshootUntilUs) {
+        float over = counts - FLOOD_COUNTS;
+        if (over > stats.maxOvershootCounts) stats.maxOvershootCounts = over;
+    }
+
+    // Arenero: cuánto siguió girando el tambor después de llegar el gato
+    bool catAtLitter = model.catAt(SIM_LITTERBOX);
+    if (catAtLitter && !catWasAtLitter) {
+        uint64_t arrived = model.catArrivedUs(SIM_LITTERBOX);
+        uint64_t lastStep = model.getLitterStepUs();
+        if (lastStep && arrived - lastStep < 50000ULL + LOOP_CPU_US) {
+            cleanCatUs = arrived;
+            cleanStopCheckUs = now + CLEAN_STOP_WINDOW_MS * 1000ULL;
+        }
+    }
+    catWasAtLitter = catAtLitter;
+    if (cleanStopCheckUs && now >= cleanStopCheckUs) {
+        float ms = msBetween(cleanCatUs, model.getLitterStepUs());
+        if (ms > stats.cleanStopMs) stats.cleanStopMs = ms;
+        cleanStopCheckUs = 0;
+    }
+
+    if (model.gasPpm() > stats.gasPeakPpm) stats.gasPeakPpm = model.gasPpm();
+}
+
+void Simulation::readSerial() {
+    std::string out = Serial.takeOutput();
+    for (size_t i = 0; i < out.size(); ++i) {
+        char c = out[i];
+        if (c == '\r') continue;
+        if (c != '\n') { serialLine += c; continue; }
+        if (!serialLine.empty()) onLine(serialLine);
+        serialLine.clear();
+    }
+}
+
+void Simulation::onLine(const std::string& line) {
+    if (verbose) printf("%10.3f < %s\n", hal::nowMicros() / 1e6, line.c_str());
+
+    if (contains(line, "\"CLEAN_DONE\"")) stats.cleanings++;
+    else if (contains(line, "\"CLEAN_PAUSED\"")) stats.cleanPauses++;
+    else if (contains(line, "\"CLEAN_ABORTED\"")) stats.cleanAborts++;
+    else if (dispenseTarget >= 0.0f &&
+             (contains(line, "\"DISPENSE_DONE\"") || contains(line, "\"DISPENSE_STALLED\"") ||
+              contains(line, "\"DISPENSE_NO_FOOD\"") || contains(line, "\"DISPENSE_ABORTED\"") ||
+              (contains(line, "\"DISPENSE\"") && contains(line, "\"success\":false")))) {
+        finishDispense();
+    }
+}
+
+void Simulation::finishDispense() {
+    // Lo que salió del sinfín: incluye lo que todavía cae hacia el plato
+    float delivered = dispenseStorageBefore - model.storageGrams();
+    float err = delivered - dispenseTarget;
+    stats.dispenses++;
+    stats.lastDispenseErrG = err;
+    stats.sumDispenseErrG += fabsf(err);
+    if (fabsf(err) > stats.maxDispenseErrG) stats.maxDispenseErrG = fabsf(err);
+    float seconds = (hal::nowMicros() - dispenseStartUs) / 1e6f;
+    if (seconds > stats.maxDispenseS) stats.maxDispenseS = seconds;
+    if (verbose) printf("%10.3f = dispense target %.1f g delivered %.2f g in %.1f s\n",
+                        hal::nowMicros() / 1e6, dispenseTarget, delivered, seconds);
+    dispenseTarget = -1.0f;
+}
+
+void Simulation::expectMax(const char* metric, float value, float limit) {
+    Check c = { metric, value, limit, true };
+    checks.push_back(c);
+}
+
+void Simulation::expectMin(const char* metric, float value, float limit) {
+    Check c = { metric, value, limit, false };
+    checks.push_back(c);
+}
+
+bool Simulation::report() {
+    bool pass = true;
+    float meanErr = stats.dispenses ? stats.sumDispenseErrG / stats.dispenses : 0.0f;
+
+    printf("{\"scenario\":\"%s\",\"sim_s\":%.1f,\"wall_ms\":%.0f,\"loops\":%u,",
+           name, hal::nowMicros() / 1e6, (wallMicros() - wallStartUs) / 1000.0, stats.loops);
+    printf("\"water\":{\"refills\":%u,\"starts_with_cat\":%u,\"overshoot_counts\":%.1f,"
+           "\"level_stop_ms\":%.1f,\"cat_stop_ms\":%.1f,\"cat_stops\":%u,\"level_counts\":%.0f},",
+           stats.refills, stats.pumpStartsWithCat, stats.maxOvershootCounts,
+           stats.levelStopMs, stats.catStopMs, stats.catStops, model.waterCounts());
+    printf("\"feeder\":{\"dispenses\":%u,\"max_err_g\":%.2f,\"mean_err_g\":%.2f,"
+           "\"max_s\":%.1f,\"plate_g\":%.1f,\"storage_g\":%.1f},",
+           stats.dispenses, stats.maxDispenseErrG, meanErr, stats.maxDispenseS,
+           model.plateGrams(), model.storageGrams());
+    printf("\"litterbox\":{\"cleanings\":%u,\"pauses\":%u,\"aborts\":%u,\"stop_ms\":%.1f,"
+           "\"gas_peak_ppm\":%.1f},",
+           stats.cleanings, stats.cleanPauses, stats.cleanAborts, stats.cleanStopMs, stats.gasPeakPpm);
+
+    printf("\"checks\":[");
+    for (size_t i = 0; i < checks.size(); ++i) {
+        const Check& c = checks[i];
+        bool ok = c.isMax ? c.value <= c.limit : c.value >= c.limit;
+        if (!ok) pass = false;
+        printf("%s{\"metric\":\"%s\",\"value\":%.2f,\"%s\":%.2f,\"ok\":%s}", i ? "," : "",
+               c.metric, c.value, c.isMax ? "max" : "min", c.limit, ok ? "true" : "false");
+    }
+    printf("],\"pass\":%s}\n", pass ? "true" : "false");
+    fflush(stdout);
+    return pass;
+}
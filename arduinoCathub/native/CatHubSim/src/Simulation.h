@@ -0,0 +1,115 @@
+// Simulation.h
+// Corre el firmware real (setup()/loop()) contra la planta sobre el reloj
+// virtual: inyecta comandos programados, observa las salidas y mide el
+// desempeño de los lazos de control. Al final compara cada métrica con su
+// límite y reporta una línea JSON por escenario.
+#ifndef CATHUB_SIM_SIMULATION_H
+#define CATHUB_SIM_SIMULATION_H
+
+#include "Plant.h"
+#include <string>
+#include <vector>
+
+struct SimMetrics {
+    uint32_t loops = 0;
+
+    // Bebedero
+    uint16_t refills = 0;
+    uint16_t pumpStartsWithCat = 0;   // la bomba arrancó con el gato bebiendo
+    float maxOvershootCounts = 0.0f;  // nivel real por encima de water_flood_level
+    float levelStopMs = 0.0f;         // peor: nivel de corte alcanzado -> bomba apagada
+    float catStopMs = 0.0f;           // peor: llega el gato -> bomba apagada
+    uint16_t catStops = 0;
+
+    // Comedero
+    uint16_t dispenses = 0;
+    float maxDispenseErrG = 0.0f;     // |entregado real - objetivo|
+    float sumDispenseErrG = 0.0f;
+    float lastDispenseErrG = 0.0f;
+    float maxDispenseS = 0.0f;        // peor: comando DISPENSE -> evento final
+
+    // Arenero
+    uint16_t cleanings = 0;
+    uint16_t cleanPauses = 0;
+    uint16_t cleanAborts = 0;         // volvió a la posición inicial tras una pausa vencida
+    float cleanStopMs = 0.0f;         // peor: llega el gato -> último paso del tambor
+    float gasPeakPpm = 0.0f;          // real (la planta)
+};
+
+class Simulation {
+public:
+    // Valores de fábrica del firmware contra los que se miden los lazos
+    static const int FLOOD_COUNTS = 450;
+
+    Simulation(const char* name, const PlantConfig& config = PlantConfig());
+
+    Plant& plant() { return model; }
+    const SimMetrics& metrics() const { return stats; }
+    void setVerbose(bool on) { verbose = on; }
+
+    // hal::reset(), planta conectada y setup() del firmware
+    void begin();
+
+    // Comandos serie programados (en ms del reloj virtual)
+    void at(uint32_t ms, const std::string& command);
+    // DISPENSE:<g> que además mide lo entregado al terminar
+    void dispenseAt(uint32_t ms, float grams);
+
+    void runUntil(uint32_t ms);
+
+    // Límites: la métrica debe quedar en [min, max]
+    void expectMax(const char* metric, float value, float limit);
+    void expectMin(const char* metric, float value, float limit);
+
+    // Imprime el resultado (JSON) y devuelve true si pasaron todos los límites
+    bool report();
+
+private:
+    struct Scheduled {
+        uint32_t atMs;
+        std::string command;
+        float dispenseGrams;   // < 0: comando común
+    };
+
+    struct Check {
+        const char* metric;
+        float value;
+        float limit;
+        bool isMax;
+    };
+
+    static const uint32_t LOOP_CPU_US = 200;          // trabajo de una vuelta en la placa
+    static const uint32_t OVERSHOOT_WINDOW_MS = 3000; // la manguera sigue goteando tras cortar
+    static const uint32_t CLEAN_STOP_WINDOW_MS = 1000;
+
+    const char* name;
+    Plant model;
+    SimMetrics stats;
+    std::vector<Scheduled> schedule;
+    std::vector<Check> checks;
+    std::string serialLine;
+    bool verbose;
+
+    // Seguimiento de eventos en curso
+    uint32_t seenPumpStarts;
+    bool pumpWasOn;
+    uint64_t floodReachedUs;     // 0 = no alcanzado en esta carga
+    uint64_t catWhilePumpUs;     // 0 = sin gato durante la carga
+    uint64_t overshootUntilUs;
+    bool catWasAtWater;
+    bool catWasAtLitter;
+    uint64_t cleanStopCheckUs;   // 0 = sin medición pendiente
+    uint64_t cleanCatUs;
+    float dispenseTarget;        // < 0: sin dispensado medido en curso
+    float dispenseStorageBefore;
+    uint64_t dispenseStartUs;
+    uint64_t wallStartUs;
+
+    void runScheduled(uint32_t nowMs);
+    void observe();
+    void readSerial();
+    void onLine(const std::string& line);
+    void finishDispense();
+};
+
+#endif
@@ -0,0 +1,43 @@
+// sim_main.cpp - corre los escenarios de la simulación física
+//
+// Uso:
+//   program              todos los escenarios (cada uno en su propio proceso)
+//   program <nombre>     uno solo
+//   program <nombre> -v  además imprime el Serial y los comandos con su tiempo
+//   program list
+// El código de salida es distinto de 0 si algún límite no se cumplió.
+#include "Scenarios.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+int main(int argc, char** argv) {
+    const char* wanted = argc > 1 ? argv[1] : nullptr;
+    bool verbose = argc > 2 && strcmp(argv[2], "-v") == 0;
+
+    if (wanted && strcmp(wanted, "list") == 0) {
+        for (unsigned i = 0; i < SIM_SCENARIO_COUNT; ++i) {
+            printf("%-12s %s\n", SIM_SCENARIOS[i].name, SIM_SCENARIOS[i].description);
+        }
+        return 0;
+    }
+
+    if (wanted) {
+        for (unsigned i = 0; i < SIM_SCENARIO_COUNT; ++i) {
+            if (strcmp(wanted, SIM_SCENARIOS[i].name) == 0) return SIM_SCENARIOS[i].run(verbose) ? 0 : 1;
+        }
+        fprintf(stderr, "escenario desconocido: %s (ver 'list')\n", wanted);
+        return 2;
+    }
+
+    // El firmware vive en globales (EEPROM, máquinas de estado): un proceso
+    // nuevo por escenario garantiza que arranquen desde cero
+    int failed = 0;
+    for (unsigned i = 0; i < SIM_SCENARIO_COUNT; ++i) {
+        std::string cmd = std::string("\"") + argv[0] + "\" " + SIM_SCENARIOS[i].name;
+        if (system(cmd.c_str()) != 0) failed++;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,27 @@
+// DHT.h (native)
+// DHT simulado: la temperatura/humedad las fija hal::setAmbient().
+#ifndef NATIVE_DHT_H
+#define NATIVE_DHT_H
+
+#include <stdint.h>
+
+#define DHT11 11
+#define DHT12 12
+#define DHT21 21
+#define DHT22 22
+#define AM2301 21
+
+namespace hal {
+void setAmbient(float temperatureC, float humidityPercent);
+void setDhtConnected(bool connected);
+}
+
+class DHT {
+public:
+    DHT(uint8_t pin, uint8_t type, uint8_t count = 6) { (void)pin; (void)type; (void)count; }
+    void begin(uint8_t usec = 55) { (void)usec; }
+    float readTemperature(bool fahrenheit = false, bool force = false);
+    float readHumidity(bool force = false);
+};
+
+#endif // NATIVE_DHT_H
@@ -0,0 +1,40 @@
+// EEPROM.h (native)
+// EEPROM simulada de 4 KB (como el Mega) en memoria, con contador de escrituras.
+#ifndef NATIVE_EEPROM_H
+#define NATIVE_EEPROM_H
+
+#include <stdint.h>
+#include <string.h>
+
+class EEPROMClass {
+private:
+    static const int SIZE = 4096;
+    uint8_t mem[SIZE];
+    uint32_t writes;
+
+public:
+    EEPROMClass() : writes(0) { memset(mem, 0xFF, sizeof(mem)); }
+    uint8_t read(int idx) const { return (idx >= 0 && idx < SIZE) ? mem[idx] : 0xFF; }
+    void write(int idx, uint8_t val) { if (idx >= 0 && idx < SIZE) { mem[idx] = val; writes++; } }
+    void update(int idx, uint8_t val) { if (read(idx) != val) write(idx, val); }
+    uint16_t length() const { return SIZE; }
+
+    template <typename T> T& get(int idx, T& t) const {
+        uint8_t* p = reinterpret_cast<uint8_t*>(&t);
+        for (unsigned i = 0; i < sizeof(T); ++i) p[i] = read(idx + (int)i);
+        return t;
+    }
+    template <typename T> const T& put(int idx, const T& t) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&t);
+        for (unsigned i = 0; i < sizeof(T); ++i) update(idx + (int)i, p[i]);
+        return t;
+    }
+
+    // Hooks nativos
+    uint32_t writeCount() const { return writes; }
+    void clear() { memset(mem, 0xFF, sizeof(mem)); writes = 0; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // NATIVE_EEPROM_H
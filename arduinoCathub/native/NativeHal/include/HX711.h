@@ -0,0 +1,39 @@
+// HX711.h (native)
+// Celda de carga simulada: el peso en gramos lo fija hal::setLoadGrams().
+#ifndef NATIVE_HX711_H
+#define NATIVE_HX711_H
+
+#include <stdint.h>
+
+namespace hal {
+void setLoadGrams(float grams);
+float loadGrams();
+void setHx711Connected(bool connected);
+// Cuentas crudas por gramo que entrega el conversor simulado
+void setHx711CountsPerGram(float counts);
+}
+
+class HX711 {
+private:
+    float scale;
+    long offset;
+
+public:
+    HX711() : scale(1.0f), offset(0) {}
+    void begin(uint8_t dout, uint8_t sck, uint8_t gain = 128) { (void)dout; (void)sck; (void)gain; }
+    bool is_ready();
+    void wait_ready(unsigned long delayMs = 0) { (void)delayMs; }
+    long read();
+    long read_average(uint8_t times = 10);
+    double get_value(uint8_t times = 1) { return read_average(times) - offset; }
+    float get_units(uint8_t times = 1) { return (float)(get_value(times) / scale); }
+    void tare(uint8_t times = 10) { set_offset(read_average(times)); }
+    void set_scale(float s = 1.0f) { scale = s; }
+    float get_scale() { return scale; }
+    void set_offset(long o = 0) { offset = o; }
+    long get_offset() { return offset; }
+    void power_down() {}
+    void power_up() {}
+};
+
+#endif // NATIVE_HX711_H
@@ -0,0 +1,38 @@
+// HardwareSerial.h (native)
+// Serial capturable: la entrada se inyecta con hal::serialInject() y la
+// salida se acumula en memoria para que las pruebas y el simulador la lean.
+#ifndef NATIVE_HARDWARE_SERIAL_H
+#define NATIVE_HARDWARE_SERIAL_H
+
+#include <string>
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+private:
+    std::string rx;
+    std::string tx;
+    bool echo;
+
+public:
+    HardwareSerial() : echo(false) {}
+    void begin(unsigned long) {}
+    void end() {}
+    operator bool() const { return true; }
+
+    int available() override { return (int)rx.size(); }
+    int read() override;
+    int peek() override { return rx.empty() ? -1 : (unsigned char)rx[0]; }
+    size_t write(uint8_t c) override;
+    using Print::write;
+    int availableForWrite() override { return 63; }
+
+    // Hooks del entorno nativo
+    void inject(const std::string& data) { rx += data; }
+    std::string takeOutput() { std::string out; out.swap(tx); return out; }
+    const std::string& output() const { return tx; }
+    void setEcho(bool on) { echo = on; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_HARDWARE_SERIAL_H
@@ -0,0 +1,44 @@
+// NativeHal.h
+// Hooks del HAL simulado: reloj virtual y entradas programables. Sólo existe
+// en el entorno nativo; el firmware no lo incluye.
+#ifndef NATIVE_HAL_H
+#define NATIVE_HAL_H
+
+#include <stdint.h>
+#include <functional>
+
+namespace hal {
+
+// Reloj virtual en microsegundos. delay()/delayMicroseconds()/pulseIn()
+// avanzan este reloj en lugar de dormir.
+uint64_t nowMicros();
+void advanceMicros(uint64_t us);
+void advanceMillis(uint32_t ms);
+void resetClock();
+
+// Entradas programables. Si hay un proveedor se usa; si no, el valor fijo.
+void setDigitalInput(uint8_t pin, int value);
+void setAnalogInput(uint8_t pin, int value);
+void setDigitalProvider(std::function<int(uint8_t pin)> provider);
+void setAnalogProvider(std::function<int(uint8_t pin)> provider);
+// pulseIn: devuelve la duración en µs (0 = timeout) para el pin de echo.
+void setPulseProvider(std::function<unsigned long(uint8_t pin, unsigned long timeoutUs)> provider);
+void setPulseWidth(uint8_t pin, unsigned long widthUs);
+
+// Se llama al final de cada delay(): el puente serie lo usa para dormir al
+// ritmo de la pared y meter lo que llegó por stdin mientras el firmware
+// espera, como haría la UART de la placa
+void setDelayHook(std::function<void()> hook);
+
+// Salidas observables
+int digitalOutput(uint8_t pin);
+int pinModeOf(uint8_t pin);
+uint32_t risingEdges(uint8_t pin);   // flancos de subida escritos (pasos de motor)
+void setOutputListener(std::function<void(uint8_t pin, int value)> listener);
+
+// Vuelve todo el HAL a su estado inicial (entre escenarios)
+void reset();
+
+} // namespace hal
+
+#endif // NATIVE_HAL_H
@@ -0,0 +1,22 @@
+// Stream.h (native)
+#ifndef NATIVE_STREAM_H
+#define NATIVE_STREAM_H
+
+#include "Print.h"
+
+class Stream : public Print {
+protected:
+    unsigned long _timeout;
+
+public:
+    Stream() : _timeout(1000) {}
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    String readStringUntil(char terminator);
+    String readString();
+    size_t readBytes(char* buffer, size_t length);
+};
+
+#endif // NATIVE_STREAM_H
@@ -0,0 +1,98 @@
+// WString.h (native)
+// Subconjunto de la clase String de Arduino suficiente para el firmware.
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class __FlashStringHelper;
+
+class String {
+private:
+    std::string buf;
+
+public:
+    String() {}
+    String(const char* s) : buf(s ? s : "") {}
+    String(const std::string& s) : buf(s) {}
+    String(const __FlashStringHelper* s) : buf(s ? reinterpret_cast<const char*>(s) : "") {}
+    explicit String(char c) : buf(1, c) {}
+    explicit String(unsigned char v, unsigned char base = 10);
+    explicit String(int v, unsigned char base = 10);
+    explicit String(unsigned int v, unsigned char base = 10);
+    explicit String(long v, unsigned char base = 10);
+    explicit String(unsigned long v, unsigned char base = 10);
+    explicit String(float v, unsigned char decimals = 2);
+    explicit String(double v, unsigned char decimals = 2);
+
+    unsigned int length() const { return (unsigned int)buf.size(); }
+    const char* c_str() const { return buf.c_str(); }
+    bool reserve(unsigned int size) { buf.reserve(size); return true; }
+
+    String& operator+=(const String& rhs) { buf += rhs.buf; return *this; }
+    String& operator+=(const char* rhs) { if (rhs) buf += rhs; return *this; }
+    String& operator+=(char c) { buf += c; return *this; }
+    String& operator+=(const __FlashStringHelper* rhs) { if (rhs) buf += reinterpret_cast<const char*>(rhs); return *this; }
+    String& operator+=(int v) { return *this += String(v); }
+    String& operator+=(unsigned int v) { return *this += String(v); }
+    String& operator+=(long v) { return *this += String(v); }
+    String& operator+=(unsigned long v) { return *this += String(v); }
+    String& operator+=(float v) { return *this += String(v); }
+    String& operator+=(double v) { return *this += String(v); }
+    bool concat(const String& rhs) { buf += rhs.buf; return true; }
+    bool concat(const char* rhs) { if (rhs) buf += rhs; return true; }
+    bool concat(char c) { buf += c; return true; }
+
+    bool operator==(const String& rhs) const { return buf == rhs.buf; }
+    bool operator==(const char* rhs) const { return buf == (rhs ? rhs : ""); }
+    bool operator!=(const String& rhs) const { return !(*this == rhs); }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    bool operator<(const String& rhs) const { return buf < rhs.buf; }
+    bool equals(const String& rhs) const { return buf == rhs.buf; }
+    bool equalsIgnoreCase(const String& rhs) const;
+
+    char charAt(unsigned int i) const { return i < buf.size() ? buf[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+    void setCharAt(unsigned int i, char c) { if (i < buf.size()) buf[i] = c; }
+
+    bool startsWith(const String& prefix) const { return buf.compare(0, prefix.buf.size(), prefix.buf) == 0; }
+    bool startsWith(const String& prefix, unsigned int offset) const {
+        return offset <= buf.size() && buf.compare(offset, prefix.buf.size(), prefix.buf) == 0;
+    }
+    bool endsWith(const String& suffix) const {
+        return buf.size() >= suffix.buf.size() &&
+               buf.compare(buf.size() - suffix.buf.size(), suffix.buf.size(), suffix.buf) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const String& s, unsigned int from = 0) const;
+    int lastIndexOf(char c) const;
+    String substring(unsigned int from) const { return substring(from, length()); }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toUpperCase();
+    void toLowerCase();
+    void replace(const String& find, const String& repl);
+    void remove(unsigned int index) { if (index < buf.size()) buf.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < buf.size()) buf.erase(index, count); }
+
+    long toInt() const { return atol(buf.c_str()); }
+    float toFloat() const { return (float)atof(buf.c_str()); }
+    double toDouble() const { return atof(buf.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, char b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, const __FlashStringHelper* b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, int b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, long b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, float b) { String r(a); r += b; return r; }
+    friend String operator+(const String& a, double b) { String r(a); r += b; return r; }
+};
+
+#endif // NATIVE_WSTRING_H
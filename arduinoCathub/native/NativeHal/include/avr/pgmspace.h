@@ -0,0 +1,31 @@
+// avr/pgmspace.h (native)
+// En host no hay espacio de programa separado: las rutinas _P son las normales.
+#ifndef NATIVE_PGMSPACE_H
+#define NATIVE_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)  (*(const uint8_t*)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t*)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t*)(addr))
+#define pgm_read_float(addr) (*(const float*)(addr))
+#define pgm_read_ptr(addr)   (*(const void* const*)(addr))
+
+#define memcpy_P      memcpy
+#define strcpy_P      strcpy
+#define strncpy_P     strncpy
+#define strlen_P      strlen
+#define strcmp_P      strcmp
+#define strncmp_P     strncmp
+#define strcasecmp_P  strcasecmp
+#define snprintf_P    snprintf
+#define sprintf_P     sprintf
+
+#endif // NATIVE_PGMSPACE_H
@@ -0,0 +1,184 @@
+// NativeHal.cpp
+// Implementación del HAL simulado (reloj virtual, GPIO, ADC, Serial, HX711, DHT).
+#include <Arduino.h>
+#include <HX711.h>
+#include <DHT.h>
+#include "NativeHal.h"
+
+#include <stdio.h>
+
+HardwareSerial Serial;
+
+namespace {
+
+uint64_t clockUs = 0;
+
+int digitalIn[NUM_DIGITAL_PINS];
+int analogIn[NUM_DIGITAL_PINS];
+int digitalOut[NUM_DIGITAL_PINS];
+int modes[NUM_DIGITAL_PINS];
+uint32_t edges[NUM_DIGITAL_PINS];
+unsigned long pulseWidth[NUM_DIGITAL_PINS];
+
+std::function<int(uint8_t)> digitalProvider;
+std::function<int(uint8_t)> analogProvider;
+std::function<unsigned long(uint8_t, unsigned long)> pulseProvider;
+std::function<void(uint8_t, int)> outputListener;
+std::function<void()> delayHook;
+
+float loadGrams = 0.0f;
+bool hx711Connected = true;
+float hx711CountsPerGram = 422.0f;
+float ambientTemp = 22.0f;
+float ambientHum = 45.0f;
+bool dhtConnected = true;
+
+bool validPin(uint8_t pin) { return pin < NUM_DIGITAL_PINS; }
+
+} // namespace
+
+namespace hal {
+
+uint64_t nowMicros() { return clockUs; }
+void advanceMicros(uint64_t us) { clockUs += us; }
+void advanceMillis(uint32_t ms) { clockUs += (uint64_t)ms * 1000ULL; }
+void resetClock() { clockUs = 0; }
+
+void setDigitalInput(uint8_t pin, int value) { if (validPin(pin)) digitalIn[pin] = value; }
+void setAnalogInput(uint8_t pin, int value) { if (validPin(pin)) analogIn[pin] = value; }
+void setDigitalProvider(std::function<int(uint8_t)> provider) { digitalProvider = provider; }
+void setAnalogProvider(std::function<int(uint8_t)> provider) { analogProvider = provider; }
+void setPulseProvider(std::function<unsigned long(uint8_t, unsigned long)> provider) { pulseProvider = provider; }
+void setPulseWidth(uint8_t pin, unsigned long widthUs) { if (validPin(pin)) pulseWidth[pin] = widthUs; }
+
+int digitalOutput(uint8_t pin) { return validPin(pin) ? digitalOut[pin] : LOW; }
+int pinModeOf(uint8_t pin) { return validPin(pin) ? modes[pin] : INPUT; }
+uint32_t risingEdges(uint8_t pin) { return validPin(pin) ? edges[pin] : 0; }
+void setOutputListener(std::function<void(uint8_t, int)> listener) { outputListener = listener; }
+void setDelayHook(std::function<void()> hook) { delayHook = hook; }
+
+void setLoadGrams(float grams) { ::loadGrams = grams; }
+float loadGrams() { return ::loadGrams; }
+void setHx711Connected(bool connected) { hx711Connected = connected; }
+void setHx711CountsPerGram(float counts) { hx711CountsPerGram = counts; }
+
+void setAmbient(float temperatureC, float humidityPercent) {
+    ambientTemp = temperatureC;
+    ambientHum = humidityPercent;
+}
+void setDhtConnected(bool connected) { dhtConnected = connected; }
+
+void reset() {
+    clockUs = 0;
+    for (int i = 0; i < NUM_DIGITAL_PINS; ++i) {
+        digitalIn[i] = HIGH;
+        analogIn[i] = 0;
+        digitalOut[i] = LOW;
+        modes[i] = INPUT;
+        edges[i] = 0;
+        pulseWidth[i] = 0;
+    }
+    digitalProvider = nullptr;
+    analogProvider = nullptr;
+    pulseProvider = nullptr;
+    outputListener = nullptr;
+    delayHook = nullptr;
+    ::loadGrams = 0.0f;
+    hx711Connected = true;
+    hx711CountsPerGram = 422.0f;
+    ambientTemp = 22.0f;
+    ambientHum = 45.0f;
+    dhtConnected = true;
+    Serial.takeOutput();
+    while (Serial.available()) Serial.read();
+}
+
+} // namespace hal
+
+// ===== Núcleo Arduino =====
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+unsigned long millis() { return (unsigned long)(clockUs / 1000ULL); }
+unsigned long micros() { return (unsigned long)clockUs; }
+void delay(unsigned long ms) {
+    clockUs += (uint64_t)ms * 1000ULL;
+    if (delayHook) delayHook();
+}
+void delayMicroseconds(unsigned int us) { clockUs += us; }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) { if (validPin(pin)) modes[pin] = mode; }
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+    if (!validPin(pin)) return;
+    int v = val ? HIGH : LOW;
+    if (v == HIGH && digitalOut[pin] == LOW) edges[pin]++;
+    digitalOut[pin] = v;
+    if (outputListener) outputListener(pin, v);
+}
+
+int digitalRead(uint8_t pin) {
+    if (!validPin(pin)) return LOW;
+    if (digitalProvider) return digitalProvider(pin);
+    return digitalIn[pin];
+}
+
+int analogRead(uint8_t pin) {
+    if (!validPin(pin)) return 0;
+    clockUs += 112; // conversión ADC ~112 µs a 125 kHz
+    if (analogProvider) return constrain(analogProvider(pin), 0, 1023);
+    return constrain(analogIn[pin], 0, 1023);
+}
+
+void analogWrite(uint8_t pin, int val) { digitalWrite(pin, val > 0 ? HIGH : LOW); }
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout) {
+    (void)state;
+    unsigned long width = pulseProvider ? pulseProvider(pin, timeout)
+                                        : (validPin(pin) ? pulseWidth[pin] : 0);
+    if (width == 0 || width > timeout) {
+        clockUs += timeout;
+        return 0;
+    }
+    clockUs += width;
+    return width;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+// ===== HX711 =====
+bool HX711::is_ready() { return hx711Connected; }
+
+long HX711::read() {
+    clockUs += 100; // lectura de 24 bits
+    if (!hx711Connected) return 0;
+    return (long)lroundf(loadGrams * hx711CountsPerGram);
+}
+
+long HX711::read_average(uint8_t times) {
+    if (times == 0) times = 1;
+    long long sum = 0;
+    for (uint8_t i = 0; i < times; ++i) sum += read();
+    return (long)(sum / times);
+}
+
+// ===== DHT =====
+float DHT::readTemperature(bool fahrenheit, bool force) {
+    (void)force;
+    clockUs += 5000;
+    if (!dhtConnected) return NAN;
+    return fahrenheit ? ambientTemp * 1.8f + 32.0f : ambientTemp;
+}
+
+float DHT::readHumidity(bool force) {
+    (void)force;
+    if (!dhtConnected) return NAN;
+    return ambientHum;
+}
+
+// ===== EEPROM =====
+#include <EEPROM.h>
+EEPROMClass EEPROM;
@@ -0,0 +1,67 @@
+// Print.cpp / Stream.cpp / HardwareSerial.cpp (native)
+#include <Arduino.h>
+#include <stdio.h>
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+}
+
+size_t Print::print(const __FlashStringHelper* s) {
+    return write(reinterpret_cast<const char*>(s));
+}
+
+size_t Print::print(long n, int base) {
+    if (base == 10 && n < 0) {
+        size_t t = write('-');
+        return t + printNumber((unsigned long)(-n), 10);
+    }
+    return printNumber((unsigned long)n, (uint8_t)base);
+}
+
+size_t Print::print(unsigned long n, int base) { return printNumber(n, (uint8_t)base); }
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+    String s(n, base);
+    return write(s.c_str(), s.length());
+}
+
+size_t Print::printFloat(double number, uint8_t digits) {
+    String s(number, digits);
+    return write(s.c_str(), s.length());
+}
+
+String Stream::readStringUntil(char terminator) {
+    String ret;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) ret += (char)c;
+    return ret;
+}
+
+String Stream::readString() {
+    String ret;
+    int c;
+    while ((c = read()) >= 0) ret += (char)c;
+    return ret;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t n = 0;
+    int c;
+    while (n < length && (c = read()) >= 0) buffer[n++] = (char)c;
+    return n;
+}
+
+int HardwareSerial::read() {
+    if (rx.empty()) return -1;
+    unsigned char c = (unsigned char)rx[0];
+    rx.erase(0, 1);
+    return c;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    tx += (char)c;
+    if (echo) fputc(c, stdout);
+    return 1;
+}
@@ -0,0 +1,86 @@
+// WString.cpp (native)
+#include "WString.h"
+
+#include <ctype.h>
+#include <cmath>
+#include <stdio.h>
+#include <strings.h>
+
+namespace {
+std::string toBase(unsigned long v, unsigned char base) {
+    if (base < 2) base = 10;
+    char tmp[66];
+    int i = 64;
+    tmp[65] = 0;
+    do {
+        unsigned d = (unsigned)(v % base);
+        tmp[i--] = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+        v /= base;
+    } while (v && i >= 0);
+    return std::string(&tmp[i + 1]);
+}
+
+std::string formatFloat(double v, unsigned char decimals) {
+    if (std::isnan(v)) return "nan";
+    if (std::isinf(v)) return "inf";
+    if (v > 4294967040.0 || v < -4294967040.0) return "ovf";
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "%.*f", (int)decimals, v);
+    return std::string(tmp);
+}
+} // namespace
+
+String::String(unsigned char v, unsigned char base) : buf(toBase(v, base)) {}
+String::String(int v, unsigned char base)
+    : buf(v < 0 && base == 10 ? "-" + toBase((unsigned long)(-(long)v), base) : toBase((unsigned int)v, base)) {}
+String::String(unsigned int v, unsigned char base) : buf(toBase(v, base)) {}
+String::String(long v, unsigned char base)
+    : buf(v < 0 && base == 10 ? "-" + toBase((unsigned long)(-v), base) : toBase((unsigned long)v, base)) {}
+String::String(unsigned long v, unsigned char base) : buf(toBase(v, base)) {}
+String::String(float v, unsigned char decimals) : buf(formatFloat(v, decimals)) {}
+String::String(double v, unsigned char decimals) : buf(formatFloat(v, decimals)) {}
+
+bool String::equalsIgnoreCase(const String& rhs) const {
+    return buf.size() == rhs.buf.size() && strcasecmp(buf.c_str(), rhs.buf.c_str()) == 0;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    size_t p = buf.find(c, from);
+    return p == std::string::npos ? -1 : (int)p;
+}
+
+int String::indexOf(const String& s, unsigned int from) const {
+    size_t p = buf.find(s.buf, from);
+    return p == std::string::npos ? -1 : (int)p;
+}
+
+int String::lastIndexOf(char c) const {
+    size_t p = buf.rfind(c);
+    return p == std::string::npos ? -1 : (int)p;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) { unsigned int t = from; from = to; to = t; }
+    if (from >= buf.size()) return String();
+    if (to > buf.size()) to = (unsigned int)buf.size();
+    return String(buf.substr(from, to - from));
+}
+
+void String::trim() {
+    size_t b = 0, e = buf.size();
+    while (b < e && isspace((unsigned char)buf[b])) ++b;
+    while (e > b && isspace((unsigned char)buf[e - 1])) --e;
+    buf = buf.substr(b, e - b);
+}
+
+void String::toUpperCase() { for (auto& c : buf) c = (char)toupper((unsigned char)c); }
+void String::toLowerCase() { for (auto& c : buf) c = (char)tolower((unsigned char)c); }
+
+void String::replace(const String& find, const String& repl) {
+    if (find.buf.empty()) return;
+    size_t p = 0;
+    while ((p = buf.find(find.buf, p)) != std::string::npos) {
+        buf.replace(p, find.buf.size(), repl.buf);
+        p += repl.buf.size();
+    }
+}
@@ -0,0 +1,90 @@
+// main_native.cpp - ejecuta setup()/loop() sobre el reloj virtual
+#include <Arduino.h>
+#include "NativeHal.h"
+#include <stdlib.h>
+#include <string.h>
+
+// En env:sim el main() lo pone CatHubSim (escenarios con planta) y en
+// `pio test` el de cada prueba
+#if !defined(CATHUB_SIM) && !defined(PIO_UNIT_TESTING)
+
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+void setup();
+void loop();
+
+// Modo puente (program --serial): el Serial queda conectado a stdin/stdout
+// y el reloj virtual se frena al ritmo del reloj de pared, así un host real
+// (ArduinoSerial sobre un pty) ve los mismos tiempos que con la placa.
+// Sólo se inyectan líneas completas: readStringUntil() nativo no espera.
+// También se lee stdin dentro de cada delay(): un nodo del bus que espera
+// con BusLink::idle() se despierta apenas llega el turno.
+static int runSerialBridge() {
+    typedef std::chrono::steady_clock Clock;
+
+    hal::reset();
+    Serial.setEcho(true);
+    setvbuf(stdout, nullptr, _IOFBF, 4096);
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+
+    Clock::time_point wallStart = Clock::now();
+    std::string pending;
+    bool hostClosed = false;
+
+    auto pump = [&]() {
+        char buf[256];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n == 0) hostClosed = true;              // el host cerró el puerto
+        if (n > 0) pending.append(buf, (size_t)n);
+        size_t nl = pending.rfind('\n');
+        if (nl != std::string::npos) {
+            Serial.inject(pending.substr(0, nl + 1));
+            pending.erase(0, nl + 1);
+        }
+    };
+
+    // Virtual adelantado: dormir la diferencia; atrasado: alcanzar la pared
+    auto pace = [&]() {
+        uint64_t wallUs = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - wallStart).count();
+        uint64_t virtUs = hal::nowMicros();
+        if (virtUs > wallUs) std::this_thread::sleep_for(std::chrono::microseconds(virtUs - wallUs));
+        else hal::advanceMicros(wallUs - virtUs);
+    };
+
+    hal::setDelayHook([&]() {
+        fflush(stdout);
+        pace();
+        pump();
+    });
+
+    bool setupDone = false;
+    while (!hostClosed) {
+        pump();
+        if (hostClosed) break;
+
+        if (!setupDone) { setup(); setupDone = true; }
+        else loop();
+        fflush(stdout);
+        pace();
+    }
+    hal::setDelayHook(nullptr);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--serial") == 0) return runSerialBridge();
+
+    unsigned long loops = argc > 1 ? strtoul(argv[1], nullptr, 10) : 200;
+    hal::reset();
+    Serial.setEcho(true);
+    setup();
+    if (getenv("CMDS")) Serial.inject(getenv("CMDS"));
+    for (unsigned long i = 0; i < loops; ++i) loop();
+    return 0;
+}
+
+#endif
@@ -0,0 +1,127 @@
+"""
+Generador de la tabla MQ2 (Rs/Ro -> PPM)
+
+Evalúa en la PC la curva de cada gas (ppm = A * (Rs/Ro)^B, aproximación
+log-log de la hoja de datos del MQ2) sobre puntos de Rs/Ro espaciados en
+escala logarítmica, y escribe MQ2CurveTable.h con los valores en flash.
+El firmware sólo busca el tramo e interpola linealmente con la pendiente
+precalculada de cada tramo: sin pow(), float ni divisiones en cada lectura.
+
+Uso:
+    - PlatformIO lo ejecuta antes de compilar (extra_scripts = pre:...)
+    - A mano: python scripts/gen_mq2_lut.py
+Para ajustar un gas basta con cambiar sus constantes en GASES.
+"""
+
+import math
+import os
+
+# ✅ CURVAS POR GAS: (nombre del enum, A, B)
+GASES = [
+    ("MQ2_GAS_NH3",   20.0,    -2.2),    # curva usada hasta ahora en el arenero (amoníaco aprox.)
+    ("MQ2_GAS_LPG",   574.25,  -2.222),
+    ("MQ2_GAS_CH4",   4303.4,  -2.38),
+    ("MQ2_GAS_SMOKE", 3616.1,  -2.675),
+]
+
+# ✅ RANGO Y RESOLUCIÓN DE LA TABLA
+RATIO_MIN = 0.1        # Rs/Ro más bajo (gas muy concentrado)
+RATIO_MAX = 16.0       # Rs/Ro más alto (aire limpio ~9.83)
+POINTS = 64
+PPM_MAX = 10000.0      # mismo tope que la conversión anterior
+
+Q16 = 65536
+PPM_Q8 = 256
+
+TABLE_PATH = os.path.join("src", "Devices", "litterbox", "sensors", "MQ2CurveTable.h")
+
+
+def ratio_points():
+    step = math.log(RATIO_MAX / RATIO_MIN) / (POINTS - 1)
+    return [RATIO_MIN * math.exp(i * step) for i in range(POINTS)]
+
+
+def ppm_at(a: float, b: float, ratio: float) -> float:
+    return min(max(a * math.pow(ratio, b), 0.0), PPM_MAX)
+
+
+def slope_q16(ppm_delta: int, ratio_delta: int) -> int:
+    slope = int(round(ppm_delta * Q16 / ratio_delta))
+    if not -2**31 <= slope < 2**31:
+        raise ValueError("pendiente fuera de Q16.16: subir RATIO_MIN o POINTS")
+    return slope
+
+
+def render() -> str:
+    ratios = ratio_points()
+    lines = [
+        "// MQ2CurveTable.h",
+        "// GENERADO por scripts/gen_mq2_lut.py - no editar a mano.",
+        "// Rs/Ro en Q16.16 (espaciado logarítmico) y PPM en Q8 (ppm * 256) por gas.",
+        "// Pendiente de cada tramo en Q16.16: PPM Q8 por unidad de Rs/Ro Q16.16.",
+        "#ifndef MQ2_CURVE_TABLE_H",
+        "#define MQ2_CURVE_TABLE_H",
+        "",
+        "#include <Arduino.h>",
+        "",
+        "enum MQ2Gas : uint8_t {",
+    ]
+    for name, a, b in GASES:
+        lines.append(f"    {name},{' ' * (16 - len(name))}// ppm = {a} * ratio^{b}")
+    lines += [
+        "    MQ2_GAS_COUNT",
+        "};",
+        "",
+        f"static const uint8_t MQ2_LUT_SIZE = {POINTS};",
+        "",
+        "static const uint32_t MQ2_RATIO_Q16[MQ2_LUT_SIZE] PROGMEM = {",
+    ]
+    for i in range(0, POINTS, 8):
+        chunk = ", ".join(str(int(round(r * Q16))) for r in ratios[i:i + 8])
+        lines.append(f"    {chunk},")
+    lines += ["};", "", "static const uint32_t MQ2_PPM_Q8[MQ2_GAS_COUNT][MQ2_LUT_SIZE] PROGMEM = {"]
+    ratio_q16 = [int(round(r * Q16)) for r in ratios]
+    ppm_q8 = {name: [int(round(ppm_at(a, b, r) * PPM_Q8)) for r in ratios] for name, a, b in GASES}
+    for name, _, _ in GASES:
+        lines.append(f"    {{ // {name}")
+        values = ppm_q8[name]
+        for i in range(0, POINTS, 8):
+            lines.append("        " + ", ".join(str(v) for v in values[i:i + 8]) + ",")
+        lines.append("    },")
+    # Sobre los valores ya redondeados, para que cada tramo termine en su punto
+    lines += ["};", "", "static const int32_t MQ2_SLOPE_Q16[MQ2_GAS_COUNT][MQ2_LUT_SIZE - 1] PROGMEM = {"]
+    for name, _, _ in GASES:
+        lines.append(f"    {{ // {name}")
+        values = ppm_q8[name]
+        slopes = [slope_q16(values[i + 1] - values[i], ratio_q16[i + 1] - ratio_q16[i])
+                  for i in range(POINTS - 1)]
+        for i in range(0, POINTS - 1, 8):
+            lines.append("        " + ", ".join(str(v) for v in slopes[i:i + 8]) + ",")
+        lines.append("    },")
+    lines += ["};", "", "#endif // MQ2_CURVE_TABLE_H", ""]
+    return "\n".join(lines)
+
+
+def generate(project_dir: str) -> bool:
+    """Escribe la tabla sólo si cambió (no fuerza recompilar)"""
+    output = os.path.join(project_dir, TABLE_PATH)
+    content = render()
+    try:
+        with open(output, "r", encoding="utf-8") as f:
+            if f.read() == content:
+                return False
+    except FileNotFoundError:
+        pass
+    with open(output, "w", encoding="utf-8") as f:
+        f.write(content)
+    print(f"✅ Tabla MQ2 generada: {TABLE_PATH}")
+    return True
+
+
+try:
+    # Ejecutado por PlatformIO como extra_script (pre:); ahí no existe __file__
+    Import("env")  # noqa: F821
+    generate(env.subst("$PROJECT_DIR"))  # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        generate(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
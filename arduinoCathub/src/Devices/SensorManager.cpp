@@ -7,6 +7,30 @@
 #include "litterbox/config/ActuatorIDs.h"
 #include "waterdispenser/config/SensorIDs.h"
 #include "waterdispenser/config/ActuatorIDs.h"
+#include "common/UltrasonicRanging.h"
+#include "../system/LoopProfiler.h"
+#include "../system/TraceBuffer.h"
+#include "../state/ConfigStore.h"
+
+// Periodos por canal (ms): reposo / ráfaga, y la estación cuya actividad
+// activa la ráfaga. Deben quedar por encima del READ_INTERVAL de cada sensor,
+// que sólo es el mínimo físico (pings, conversiones del HX711, DHT).
+struct SensorRate {
+    uint16_t idleMs;
+    uint16_t burstMs;
+    uint8_t  station;   // bit en ACTIVITY_* (0 arenero, 1 comedero, 2 bebedero)
+};
+
+static const SensorRate SENSOR_RATES[SENSOR_CH_COUNT] PROGMEM = {
+    { 5000, 2500, 0 },   // SENSOR_CH_LITTER_DHT
+    {  500,  100, 0 },   // SENSOR_CH_LITTER_RANGE
+    { 1000,  500, 0 },   // SENSOR_CH_LITTER_MQ2
+    { 1000,  500, 1 },   // SENSOR_CH_FEEDER_WEIGHT
+    {  500,  100, 1 },   // SENSOR_CH_FEEDER_CAT_RANGE
+    { 2000,  200, 1 },   // SENSOR_CH_FEEDER_FOOD_RANGE
+    { 2000,  250, 2 },   // SENSOR_CH_WATER_LEVEL
+    {  250,  100, 2 },   // SENSOR_CH_WATER_IR
+};
 
 SensorManager::SensorManager(LitterboxUltrasonicSensor* litterboxUltrasonic,
                              LitterboxDHTSensor* litterboxDHT,
@@ -18,9 +42,13 @@ SensorManager::SensorManager(LitterboxUltrasonicSensor* litterboxUltrasonic,
                              FeederStepperMotor* feederMotorPtr,
                              WaterDispenserSensor* waterSensorPtr,
                              WaterDispenserPump* waterPumpPtr,
-                             WaterDispenserIRSensor* waterIRSensorPtr)
+                             WaterDispenserIRSensor* waterIRSensorPtr,
+                             uint8_t unit)
     : initialized(false),
-      lastUpdateTime(0) {
+      unit(unit),
+      externalActivity(0),
+      burstMask(0),
+      cursor(0) {
     ultrasonicSensor = litterboxUltrasonic;
     dhtSensor = litterboxDHT;
     mq2Sensor = litterboxMQ2;
@@ -34,6 +62,14 @@ SensorManager::SensorManager(LitterboxUltrasonicSensor* litterboxUltrasonic,
     waterSensor = waterSensorPtr;
     waterPump = waterPumpPtr;
     waterIRSensor = waterIRSensorPtr;
+
+    for (uint8_t ch = 0; ch < SENSOR_CH_COUNT; ++ch) {
+        lastRun[ch] = 0;
+        currentInterval[ch] = 0;
+        failStreak[ch] = 0;
+        backoffShift[ch] = 0;
+    }
+    for (uint8_t s = 0; s < STATION_COUNT; ++s) lastActiveAt[s] = 0;
 }
 
 SensorManager::~SensorManager() {
@@ -90,22 +126,171 @@ float SensorManager::getFeederWeight() {
     return 0.0f;
 }
 
+bool SensorManager::pollFeederWeightEvent(WeightEvent& out) {
+    return weightSensor && weightSensor->pollEvent(out);
+}
+
+bool SensorManager::isCatEating() {
+    return weightSensor && weightSensor->isCatEating();
+}
+
+bool SensorManager::isFeederWeightDisturbed() {
+    return weightSensor && weightSensor->isDisturbed();
+}
+
+void SensorManager::setFeederDispensing(bool dispensing) {
+    if (weightSensor) weightSensor->holdEvents(dispensing);
+}
+
+// ===== CALIBRACIÓN =====
+bool SensorManager::tareFeederWeight() {
+    if (!weightSensor || !weightSensor->isReady()) return false;
+    weightSensor->tare();
+    return true;
+}
+
+bool SensorManager::calibrateFeederWeight(float knownGrams) {
+    if (!weightSensor || !weightSensor->isReady()) return false;
+    return weightSensor->calibrate(knownGrams);
+}
+
+bool SensorManager::calibrateLitterboxMQ2() {
+    if (!mq2Sensor || !mq2Sensor->isReady()) return false;
+    mq2Sensor->calibrateRo();
+    return mq2Sensor->getRo() > 0.0f;
+}
+
 WaterDispenserSensor* SensorManager::getWaterSensor() {
     return waterSensor;
 }
 
-void SensorManager::poll() {
+// Actividad propia de los actuadores: no depende de que el llamador la informe
+uint8_t SensorManager::actuatorActivity() {
+    uint8_t mask = 0;
+    if (feederMotor && feederMotor->isRunning()) mask |= ACTIVITY_FEEDER;
+    if (waterPump && waterPump->isPumpRunning()) mask |= ACTIVITY_WATER;
+    return mask;
+}
+
+void SensorManager::setActivity(uint8_t mask) {
+    externalActivity = mask;
+}
+
+void SensorManager::poll(uint32_t budgetUs) {
     unsigned long now = millis();
-    if (now - lastUpdateTime >= UPDATE_INTERVAL) {
-        if (ultrasonicSensor) ultrasonicSensor->update();
-        if (dhtSensor) dhtSensor->update();
-        if (mq2Sensor) mq2Sensor->update();
-        if (weightSensor) weightSensor->update();
-        if (feederUltrasonic1) feederUltrasonic1->update();
-        if (feederUltrasonic2) feederUltrasonic2->update();
-        if (waterSensor) waterSensor->update();
-        if (waterIRSensor) waterIRSensor->update();
-        lastUpdateTime = now;
+    unsigned long pollStartUs = micros();
+
+    // Una estación sigue en ráfaga BURST_HOLD_MS después de su última actividad
+    uint8_t active = externalActivity | actuatorActivity();
+    burstMask = 0;
+    for (uint8_t s = 0; s < STATION_COUNT; ++s) {
+        if (active & (1u << s)) lastActiveAt[s] = now;
+        if (now - lastActiveAt[s] < BURST_HOLD_MS) burstMask |= (uint8_t)(1u << s);
+    }
+
+    for (uint8_t i = 0; i < SENSOR_CH_COUNT; ++i) {
+        uint8_t ch = (uint8_t)((cursor + i) % SENSOR_CH_COUNT);
+        SensorRate rate;
+        memcpy_P(&rate, &SENSOR_RATES[ch], sizeof(SensorRate));
+        uint32_t interval = (burstMask & (1u << rate.station)) ? rate.burstMs : rate.idleMs;
+        interval <<= backoffShift[ch];
+        currentInterval[ch] = (interval > MAX_BACKOFF_MS) ? MAX_BACKOFF_MS : (uint16_t)interval;
+        if (now - lastRun[ch] < currentInterval[ch]) continue;
+        lastRun[ch] = now;
+        PROFILE_BEGIN(PROF_SENSOR_BASE + ch);
+        TRACE_EVENT(TRC_SENSOR_BEGIN, ch);
+        unsigned long startUs = micros();
+        SensorReadResult result = runChannel(ch, backoffShift[ch] > 0);
+        health[ch].record(result, micros() - startUs, now);
+        updateBreaker(ch, result);
+        TRACE_EVENT(TRC_SENSOR_END, ch);
+        PROFILE_END(PROF_SENSOR_BASE + ch);
+
+        if (budgetUs > 0 && micros() - pollStartUs >= budgetUs) {
+            cursor = (uint8_t)((ch + 1) % SENSOR_CH_COUNT);
+            return;
+        }
+    }
+}
+
+SensorReadResult SensorManager::runChannel(uint8_t channel, bool singleShot) {
+    SensorReadResult result = SENSOR_READ_SKIPPED;
+    switch (channel) {
+        case SENSOR_CH_LITTER_DHT:
+            // La temperatura del arenero ajusta la velocidad del sonido de los
+            // tres ultrasónicos (sólo recalcula si cambió) y compensa el MQ2
+            if (!dhtSensor) break;
+            result = dhtSensor->update(singleShot);
+            UltrasonicRanging::updateAmbient(dhtSensor->getTemperature(), dhtSensor->getHumidity());
+            if (mq2Sensor) mq2Sensor->setAmbient(dhtSensor->getTemperature(), dhtSensor->getHumidity());
+            break;
+        case SENSOR_CH_LITTER_RANGE:      if (ultrasonicSensor) result = ultrasonicSensor->update(); break;
+        case SENSOR_CH_LITTER_MQ2:        if (mq2Sensor) result = mq2Sensor->update(); break;
+        case SENSOR_CH_FEEDER_WEIGHT:     if (weightSensor) result = weightSensor->update(); break;
+        case SENSOR_CH_FEEDER_CAT_RANGE:  if (feederUltrasonic1) result = feederUltrasonic1->update(singleShot); break;
+        case SENSOR_CH_FEEDER_FOOD_RANGE: if (feederUltrasonic2) result = feederUltrasonic2->update(singleShot); break;
+        case SENSOR_CH_WATER_LEVEL:
+            if (!waterSensor) break;
+            result = waterSensor->update();
+            TRACE_EVENT(TRC_WATER_LEVEL, waterSensor->getAnalogValue());
+            break;
+        case SENSOR_CH_WATER_IR:          if (waterIRSensor) result = waterIRSensor->update(); break;
+        default: break;
+    }
+    return result;
+}
+
+void SensorManager::updateBreaker(uint8_t channel, SensorReadResult result) {
+    if (result == SENSOR_READ_SKIPPED) return;
+    if (result != SENSOR_READ_TIMEOUT) {
+        // Cualquier respuesta cierra el circuito: vuelve al periodo normal
+        failStreak[channel] = 0;
+        if (backoffShift[channel] > 0) {
+            backoffShift[channel] = 0;
+            TRACE_EVENT(TRC_SENSOR_RECOVERED, channel);
+        }
+        return;
+    }
+    if (failStreak[channel] < UINT8_MAX) failStreak[channel]++;
+    if (failStreak[channel] < BREAKER_THRESHOLD) return;
+    if (backoffShift[channel] == 0) TRACE_EVENT(TRC_SENSOR_DEGRADED, channel);
+    if (backoffShift[channel] < MAX_BACKOFF_SHIFT) backoffShift[channel]++;
+}
+
+void SensorManager::resetHealth() {
+    for (uint8_t ch = 0; ch < SENSOR_CH_COUNT; ++ch) health[ch].reset();
+}
+
+bool SensorManager::isChannelDegraded(uint8_t channel) const {
+    return channel < SENSOR_CH_COUNT && backoffShift[channel] > 0;
+}
+
+uint8_t SensorManager::getChannelBackoff(uint8_t channel) const {
+    return (channel < SENSOR_CH_COUNT) ? backoffShift[channel] : 0;
+}
+
+uint16_t SensorManager::getChannelInterval(uint8_t channel) const {
+    return (channel < SENSOR_CH_COUNT) ? currentInterval[channel] : 0;
+}
+
+bool SensorManager::isChannelBursting(uint8_t channel) const {
+    if (channel >= SENSOR_CH_COUNT) return false;
+    SensorRate rate;
+    memcpy_P(&rate, &SENSOR_RATES[channel], sizeof(SensorRate));
+    return (burstMask & (1u << rate.station)) != 0;
+}
+
+// El ID lo da el sensor (cada estación tiene los suyos); sin sensor, el de la primera
+const __FlashStringHelper* SensorManager::getChannelSensorId(uint8_t channel) const {
+    switch (channel) {
+        case SENSOR_CH_LITTER_DHT:        return dhtSensor ? dhtSensor->getSensorId() : FPSTR(SENSOR_ID_LITTER_DHT);
+        case SENSOR_CH_LITTER_RANGE:      return ultrasonicSensor ? ultrasonicSensor->getSensorId() : FPSTR(SENSOR_ID_LITTER_ULTRA);
+        case SENSOR_CH_LITTER_MQ2:        return mq2Sensor ? mq2Sensor->getSensorId() : FPSTR(SENSOR_ID_LITTER_MQ2);
+        case SENSOR_CH_FEEDER_WEIGHT:     return weightSensor ? weightSensor->getSensorId() : FPSTR(SENSOR_ID_FEEDER_WEIGHT);
+        case SENSOR_CH_FEEDER_CAT_RANGE:  return feederUltrasonic1 ? feederUltrasonic1->getSensorId() : FPSTR(SENSOR_ID_FEEDER_SONIC1);
+        case SENSOR_CH_FEEDER_FOOD_RANGE: return feederUltrasonic2 ? feederUltrasonic2->getSensorId() : FPSTR(SENSOR_ID_FEEDER_SONIC2);
+        case SENSOR_CH_WATER_LEVEL:       return waterSensor ? waterSensor->getSensorId() : FPSTR(SENSOR_ID_WATER_LEVEL);
+        default:                          return waterIRSensor ? waterIRSensor->getSensorId() : FPSTR(SENSOR_ID_WATER_IR);
     }
 }
 
@@ -126,10 +311,29 @@ float SensorManager::getLitterboxHumidity() {
 }
 
 float SensorManager::getLitterboxGasPPM() {
+    if (mq2Sensor && mq2Sensor->isReady()) return mq2Sensor->getPPM();
+    return -1.0f;
+}
+
+float SensorManager::getLitterboxGasAnalog() {
     if (mq2Sensor && mq2Sensor->isReady()) return mq2Sensor->getAnalog();
     return -1.0f;
 }
 
+float SensorManager::getLitterboxGasRo() {
+    if (mq2Sensor && mq2Sensor->isReady()) return mq2Sensor->getRo();
+    return 0.0f;
+}
+
+float SensorManager::getLitterboxGasBaselineRs() {
+    if (mq2Sensor && mq2Sensor->isReady()) return mq2Sensor->getBaselineRs();
+    return 0.0f;
+}
+
+void SensorManager::setLitterboxOccupied(bool occupied) {
+    if (mq2Sensor) mq2Sensor->setCatNearby(occupied);
+}
+
 LitterboxStepperMotor* SensorManager::getLitterboxMotor() {
     return litterboxMotor;
 }
@@ -148,26 +352,30 @@ float SensorManager::getFeederFoodDistance() {
 String SensorManager::getStorageFoodStatus() {
     if (feederUltrasonic2 && feederUltrasonic2->isReady()) {
         float d = feederUltrasonic2->getDistance();
-        if (d <= 0) return "UNKNOWN";
-        if (d <= 2.0f) return "FULL";
-        if (d >= 13.0f) return "EMPTY";
-        float pct = (13.0f - d) / (13.0f - 2.0f) * 100.0f;
+        float emptyCm = ConfigStore::getInstance().getUnit(unit).storageEmptyCm;
+        if (d <= 0) return F("UNKNOWN");
+        if (d <= STORAGE_FULL_CM) return F("FULL");
+        if (d >= emptyCm) return F("EMPTY");
+        float pct = (emptyCm - d) / (emptyCm - STORAGE_FULL_CM) * 100.0f;
         int ipct = (int) round(pct);
-        if (ipct >= 45 && ipct <= 55) return "HALF";
-        return "PARTIAL_" + String(ipct) + "%";
+        if (ipct >= 45 && ipct <= 55) return F("HALF");
+        String partial = F("PARTIAL_");
+        partial += ipct;
+        partial += '%';
+        return partial;
     }
-    return "NOT_READY";
+    return F("NOT_READY");
 }
 
 String SensorManager::getPlateFoodStatus() {
     if (feederUltrasonic1 && feederUltrasonic1->isReady()) {
         float d = feederUltrasonic1->getDistance();
-        if (d <= 0) return "UNKNOWN";
-        if (d <= 2.0f) return "FULL";
-        if (d >= 8.0f) return "EMPTY";
-        return "PARTIAL";
+        if (d <= 0) return F("UNKNOWN");
+        if (d <= ConfigStore::getInstance().getUnit(unit).plateFullCm) return F("FULL");
+        if (d >= PLATE_EMPTY_CM) return F("EMPTY");
+        return F("PARTIAL");
     }
-    return "NOT_READY";
+    return F("NOT_READY");
 }
 
 // ===== MÉTODOS DEL BEBEDERO =====
@@ -175,7 +383,12 @@ String SensorManager::getWaterLevel() {
     if (waterSensor && waterSensor->isReady()) {
         return waterSensor->getWaterLevel();
     }
-    return "NOT_READY";
+    return F("NOT_READY");
+}
+
+uint8_t SensorManager::getWaterLevelCode() {
+    if (waterSensor && waterSensor->isReady()) return waterSensor->getLevelCode();
+    return WATER_NOT_READY;
 }
 
 bool SensorManager::isWaterDetected() {
@@ -197,6 +410,7 @@ bool SensorManager::isLitterboxUltrasonicReady() { return ultrasonicSensor && ul
 bool SensorManager::isLitterboxDHTReady()       { return dhtSensor && dhtSensor->isReady(); }
 bool SensorManager::isLitterboxMQ2Ready()      { return mq2Sensor && mq2Sensor->isReady(); }
 bool SensorManager::isFeederWeightReady()      { return weightSensor && weightSensor->isReady(); }
+bool SensorManager::isFeederWeightSettled()    { return weightSensor && weightSensor->hasSettled(); }
 bool SensorManager::isFeederCatUltrasonicReady(){ return feederUltrasonic1 && feederUltrasonic1->isReady(); }
 bool SensorManager::isFeederFoodUltrasonicReady(){ return feederUltrasonic2 && feederUltrasonic2->isReady(); }
 bool SensorManager::isFeederMotorReady()       { return feederMotor && feederMotor->isReady(); }
@@ -210,66 +424,68 @@ bool SensorManager::areAllSensorsReady() {
 }
 
 String SensorManager::getSensorStatus() {
-    String status = "{\"sensors\":{";
-    status += "\"litterbox\":{";
-    status += "\"ultrasonic\":{\"ready\":" + String(isLitterboxUltrasonicReady()) + "},";
-    status += "\"dht\":{\"ready\":" + String(isLitterboxDHTReady()) + "},";
-    status += "\"mq2\":{\"ready\":" + String(isLitterboxMQ2Ready()) + "}";
-    status += "},";
-    status += "\"feeder\":{";
-    status += "\"weight\":{\"ready\":" + String(isFeederWeightReady()) + "},";
-    status += "\"ultrasonic_cat\":{\"ready\":" + String(isFeederCatUltrasonicReady()) + "},";
-    status += "\"ultrasonic_food\":{\"ready\":" + String(isFeederFoodUltrasonicReady()) + "},";
-    status += "\"motor\":{\"ready\":" + String(isFeederMotorReady()) + "}";
-    status += "},";
-    status += "\"waterdispenser\":{";
-    status += "\"water_sensor\":{\"ready\":" + String(isWaterLevelReady()) + "},";
-    status += "\"pump\":{\"ready\":" + String(waterPump && waterPump->isReady()) + "},";
-    status += "\"ir\":{\"ready\":" + String(isWaterIRReady()) + "}";
-    status += "}";
-    status += "}}";
+    String status = F("{\"sensors\":{");
+    status += F("\"litterbox\":{");
+    status += F("\"ultrasonic\":{\"ready\":"); status += String(isLitterboxUltrasonicReady()); status += F("},");
+    status += F("\"dht\":{\"ready\":"); status += String(isLitterboxDHTReady()); status += F("},");
+    status += F("\"mq2\":{\"ready\":"); status += String(isLitterboxMQ2Ready()); status += F("}");
+    status += F("},");
+    status += F("\"feeder\":{");
+    status += F("\"weight\":{\"ready\":"); status += String(isFeederWeightReady()); status += F("},");
+    status += F("\"ultrasonic_cat\":{\"ready\":"); status += String(isFeederCatUltrasonicReady()); status += F("},");
+    status += F("\"ultrasonic_food\":{\"ready\":"); status += String(isFeederFoodUltrasonicReady()); status += F("},");
+    status += F("\"motor\":{\"ready\":"); status += String(isFeederMotorReady()); status += F("}");
+    status += F("},");
+    status += F("\"waterdispenser\":{");
+    status += F("\"water_sensor\":{\"ready\":"); status += String(isWaterLevelReady()); status += F("},");
+    status += F("\"pump\":{\"ready\":"); status += String(waterPump && waterPump->isReady()); status += F("},");
+    status += F("\"ir\":{\"ready\":"); status += String(isWaterIRReady()); status += F("}");
+    status += F("}");
+    status += F("}}");
     return status;
 }
 
 String SensorManager::getAllReadings() {
-    auto fmt = [](float v, const char* fmtNum = "%.2f") -> String {
-        if (isnan(v)) return String("null");
-        // valores sentinel negativos que usabas -> convertir a null
-        if (v <= -900.0f) return String("null");
-        if (v == -1.0f) return String("null");
+    // Valores sentinel negativos / NAN -> null (literales en flash)
+    auto fmt = [](float v) -> String {
+        if (isnan(v)) return String(F("null"));
+        if (v <= -900.0f) return String(F("null"));
+        if (v == -1.0f) return String(F("null"));
         // formato con 2 decimales
         return String(v, 2);
     };
 
-    String readings = "{\"readings\":{";
-    readings += "\"litterbox\":{";
+    String readings = F("{\"readings\":{");
+    readings += F("\"litterbox\":{");
     // distance puede ser -1 si no listo
     float d = getLitterboxDistance();
-    readings += "\"distance\":" + (d <= 0.0f ? String("null") : String(d,2)) + ",";
+    readings += F("\"distance\":"); readings += (d <= 0.0f ? String(F("null")) : String(d,2)); readings += ',';
 
     float t = getLitterboxTemperature();
-    readings += "\"temperature\":" + fmt(t) + ",";
+    readings += F("\"temperature\":"); readings += fmt(t); readings += ',';
 
     float h = getLitterboxHumidity();
-    readings += "\"humidity\":" + fmt(h) + ",";
+    readings += F("\"humidity\":"); readings += fmt(h); readings += ',';
 
     float g = getLitterboxGasPPM();
-    readings += "\"gas_ppm\":" + (g < 0.0f ? String("null") : String(g,2));
+    readings += F("\"gas_ppm\":"); readings += (g < 0.0f ? String(F("null")) : String(g,2)); readings += ',';
+    float ga = getLitterboxGasAnalog();
+    readings += F("\"gas_analog\":"); readings += (ga < 0.0f ? String(F("null")) : String(ga,0));
 
-    readings += "},";
-    readings += "\"feeder\":{";
-    readings += "\"weight\":" + String(getFeederWeight(),2) + ",";
+    readings += F("},");
+    readings += F("\"feeder\":{");
+    readings += F("\"weight\":"); readings += String(getFeederWeight(),2); readings += ',';
     float cd = getFeederCatDistance();
-    readings += "\"cat_distance\":" + (cd < 0.0f ? String("null") : String(cd,2)) + ",";
+    readings += F("\"cat_distance\":"); readings += (cd < 0.0f ? String(F("null")) : String(cd,2)); readings += ',';
     float fd = getFeederFoodDistance();
-    readings += "\"food_distance\":" + (fd < 0.0f ? String("null") : String(fd,2));
-    readings += "},";
-    readings += "\"waterdispenser\":{";
-    readings += "\"water_level\":\"" + getWaterLevel() + "\",";
-    readings += "\"cat_drinking\":" + String(isCatDrinking() ? "true" : "false");
-    readings += "},";
-    readings += "\"timestamp\":" + String(millis());
-    readings += "}}";
+    readings += F("\"food_distance\":"); readings += (fd < 0.0f ? String(F("null")) : String(fd,2));
+    readings += F("},");
+    readings += F("\"waterdispenser\":{");
+    readings += F("\"water_level\":\""); readings += getWaterLevel(); readings += F("\",");
+    readings += F("\"cat_drinking\":"); readings += (isCatDrinking() ? F("true") : F("false"));
+    readings += F("},");
+    readings += F("\"timestamp\":"); readings += String(millis());
+    readings += F("}}");
     return readings;
 }
 
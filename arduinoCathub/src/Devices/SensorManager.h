@@ -13,6 +13,27 @@
 #include "waterdispenser/sensors/WaterDispenserSensor.h"
 #include "waterdispenser/actuators/WaterDispenserPump.h"
 #include "waterdispenser/sensors/WaterDispenserIRSensor.h"
+#include "common/SensorHealth.h"
+
+// Canales de muestreo: cada uno con su periodo en reposo y en ráfaga. Los de
+// presencia y movimiento pasan a ráfaga cuando su estación tiene actividad
+// (gato o actuador en marcha); los lentos (DHT, MQ2) casi no cambian.
+enum SensorChannel : uint8_t {
+    SENSOR_CH_LITTER_DHT,        // primero: compensa ultrasónicos y MQ2
+    SENSOR_CH_LITTER_RANGE,
+    SENSOR_CH_LITTER_MQ2,
+    SENSOR_CH_FEEDER_WEIGHT,
+    SENSOR_CH_FEEDER_CAT_RANGE,
+    SENSOR_CH_FEEDER_FOOD_RANGE,
+    SENSOR_CH_WATER_LEVEL,
+    SENSOR_CH_WATER_IR,
+    SENSOR_CH_COUNT
+};
+
+// Bits de actividad por estación (setActivity)
+static const uint8_t ACTIVITY_LITTERBOX = 0x01;
+static const uint8_t ACTIVITY_FEEDER    = 0x02;
+static const uint8_t ACTIVITY_WATER     = 0x04;
 
 class SensorManager {
 private:
@@ -32,8 +53,41 @@ private:
     WaterDispenserIRSensor*     waterIRSensor;
 
     bool initialized;
-    unsigned long lastUpdateTime;
-    static const unsigned long UPDATE_INTERVAL = 500; // ms
+    uint8_t unit;                  // estación: umbrales de comida en ConfigStore
+
+    // Planificador adaptativo
+    static const unsigned long BURST_HOLD_MS = 5000;   // ráfaga tras la última actividad
+    static const uint8_t STATION_COUNT = 3;
+    unsigned long lastRun[SENSOR_CH_COUNT];
+    uint16_t currentInterval[SENSOR_CH_COUNT];
+    unsigned long lastActiveAt[STATION_COUNT];
+    uint8_t externalActivity;      // presencia/automatismos (setActivity)
+    uint8_t burstMask;             // estaciones en ráfaga en el último poll
+    uint8_t cursor;                // primer canal a revisar en el próximo poll (con presupuesto)
+
+    // Diagnóstico por canal (DIAG): intentos, fallas y duración de update()
+    SensorHealth health[SENSOR_CH_COUNT];
+
+    // Cortacircuitos por canal: tras BREAKER_THRESHOLD timeouts seguidos el
+    // canal queda degradado, su periodo se duplica en cada sonda fallida
+    // (hasta MAX_BACKOFF_MS) y se lee en modo de un solo intento hasta que
+    // responda. Sólo cuentan los timeouts: son las lecturas que bloquean. El
+    // ultrasónico del gato del comedero no abre el circuito cuando no hay eco
+    // (SENSOR_READ_NO_TARGET): con su alcance corto eso es "no hay nadie".
+    static const uint8_t BREAKER_THRESHOLD = 3;
+    static const uint8_t MAX_BACKOFF_SHIFT = 10;
+    static const uint16_t MAX_BACKOFF_MS = 60000;
+    uint8_t failStreak[SENSOR_CH_COUNT];
+    uint8_t backoffShift[SENSOR_CH_COUNT];      // 0 = canal sano
+
+    // Extremos de los estados de comida sin parámetro propio; el otro extremo
+    // de cada uno es storageEmptyCm / plateFullCm de ConfigStore.
+    static constexpr float STORAGE_FULL_CM = 2.0f;
+    static constexpr float PLATE_EMPTY_CM  = 8.0f;
+
+    uint8_t actuatorActivity();
+    SensorReadResult runChannel(uint8_t channel, bool singleShot);
+    void updateBreaker(uint8_t channel, SensorReadResult result);
 
 public:
     SensorManager(LitterboxUltrasonicSensor* litterboxUltrasonic,
@@ -46,18 +100,40 @@ public:
                   FeederStepperMotor* feederMotorPtr,
                   WaterDispenserSensor* waterSensorPtr,
                   WaterDispenserPump* waterPumpPtr,
-                  WaterDispenserIRSensor* waterIRSensorPtr);
+                  WaterDispenserIRSensor* waterIRSensorPtr,
+                  uint8_t unit = 0);
 
     ~SensorManager();
 
     bool begin();
-    void poll();
+    // Lee los canales que vencieron. Con budgetUs > 0 corta al agotarlo (al
+    // menos un canal por llamada) y el próximo poll sigue desde ahí: con
+    // varias estaciones en la placa ninguna acapara la vuelta del loop.
+    // 0 = sin límite, siempre desde el primer canal.
+    void poll(uint32_t budgetUs = 0);
+
+    // Muestreo adaptativo
+    void setActivity(uint8_t mask);                 // ACTIVITY_* vistos por el llamador
+    uint8_t getBurstMask() const { return burstMask; }
+    uint16_t getChannelInterval(uint8_t channel) const;   // periodo vigente (ms)
+    bool isChannelBursting(uint8_t channel) const;
+    const __FlashStringHelper* getChannelSensorId(uint8_t channel) const;
+
+    // Salud de los sensores
+    const SensorHealth& getChannelHealth(uint8_t channel) const { return health[channel]; }
+    void resetHealth();
+    bool isChannelDegraded(uint8_t channel) const;
+    uint8_t getChannelBackoff(uint8_t channel) const;   // veces que se duplicó el periodo
 
     // Litterbox
     float getLitterboxDistance();
     float getLitterboxTemperature();
     float getLitterboxHumidity();
-    float getLitterboxGasPPM();
+    float getLitterboxGasPPM();      // -1 si el MQ2 no está calibrado (sin Ro)
+    float getLitterboxGasAnalog();   // cuentas ADC filtradas (0..1023)
+    float getLitterboxGasRo();       // Ro vigente (sigue la línea base), 0 = sin calibrar
+    float getLitterboxGasBaselineRs();   // envolvente de aire limpio (kΩ)
+    void setLitterboxOccupied(bool occupied);   // pausa el seguimiento de la línea base
     LitterboxStepperMotor* getLitterboxMotor();
 
     // Feeder
@@ -65,11 +141,16 @@ public:
     float getFeederCatDistance();
     float getFeederFoodDistance();
     FeederStepperMotor* getFeederMotor();
+    bool pollFeederWeightEvent(WeightEvent& out);   // eventos de comida/escalón
+    bool isCatEating();
+    bool isFeederWeightDisturbed();
+    void setFeederDispensing(bool dispensing);      // suspende sesiones de comida
     String getStorageFoodStatus();
     String getPlateFoodStatus();
 
     // Water
     String getWaterLevel();
+    uint8_t getWaterLevelCode();     // WaterLevelCode; WATER_NOT_READY sin sensor
     bool isWaterDetected();
     bool isCatDrinking();
     WaterDispenserPump* getWaterPump();
@@ -80,6 +161,7 @@ public:
     bool isLitterboxDHTReady();
     bool isLitterboxMQ2Ready();
     bool isFeederWeightReady();
+    bool isFeederWeightSettled();    // ya hay una media completa de muestras
     bool isFeederCatUltrasonicReady();
     bool isFeederFoodUltrasonicReady();
     bool isFeederMotorReady();
@@ -89,6 +171,11 @@ public:
     String getSensorStatus();
     String getAllReadings();
     void printAllSensorReadings();
+
+    // Calibración (se persiste en ConfigStore)
+    bool tareFeederWeight();
+    bool calibrateFeederWeight(float knownGrams);
+    bool calibrateLitterboxMQ2();
     
 };
 
@@ -0,0 +1,41 @@
+// SensorHealth.cpp
+#include "SensorHealth.h"
+
+void SensorHealth::reset() {
+    attempts = 0;
+    ok = 0;
+    timeouts = 0;
+    outOfRange = 0;
+    lastOkMs = 0;
+    avgUs = 0;
+    maxUs = 0;
+}
+
+void SensorHealth::record(SensorReadResult result, uint32_t elapsedUs, unsigned long nowMs) {
+    if (result == SENSOR_READ_SKIPPED) return;
+
+    attempts++;
+    switch (result) {
+        case SENSOR_READ_OK:
+        case SENSOR_READ_NO_TARGET:     // "libre" también es una lectura válida
+            ok++;
+            lastOkMs = nowMs;
+            break;
+        case SENSOR_READ_TIMEOUT:
+            if (timeouts < UINT16_MAX) timeouts++;
+            break;
+        default:
+            if (outOfRange < UINT16_MAX) outOfRange++;
+            break;
+    }
+
+    // La primera medición arranca la media; después se acerca 1/8 por lectura
+    if (attempts == 1) {
+        avgUs = elapsedUs;
+    } else if (elapsedUs >= avgUs) {
+        avgUs += (elapsedUs - avgUs) >> 3;
+    } else {
+        avgUs -= (avgUs - elapsedUs) >> 3;
+    }
+    if (elapsedUs > maxUs) maxUs = elapsedUs;
+}
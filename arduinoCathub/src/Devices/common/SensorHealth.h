@@ -0,0 +1,48 @@
+// SensorHealth.h
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <Arduino.h>
+
+// Resultado de una llamada a update() de un sensor. SKIPPED no cuenta como
+// intento: todavía no tocaba (intervalo mínimo del sensor), el sensor no se
+// inicializó o el canal lo tiene otro (enclavamiento).
+enum SensorReadResult : uint8_t {
+    SENSOR_READ_SKIPPED,
+    SENSOR_READ_OK,
+    SENSOR_READ_TIMEOUT,        // no respondió: sin eco, HX711 sin conversión, DHT sin datos
+    SENSOR_READ_OUT_OF_RANGE,   // respondió con un valor físicamente imposible
+    SENSOR_READ_NO_TARGET       // ultrasónico de presencia sin eco en su alcance corto: nada enfrente
+};
+
+// Contadores de salud de un canal de muestreo (comando DIAG). Un sensor que
+// se degrada se ve antes en timeouts/out_of_range y en el tiempo de lectura
+// que en las lecturas mismas, porque los sensores conservan el último valor
+// válido.
+class SensorHealth {
+private:
+    uint32_t attempts;
+    uint32_t ok;
+    uint16_t timeouts;          // saturan en 65535
+    uint16_t outOfRange;
+    unsigned long lastOkMs;
+    uint32_t avgUs;             // media exponencial (1/8) de la duración
+    uint32_t maxUs;
+
+public:
+    SensorHealth() { reset(); }
+
+    void reset();
+    void record(SensorReadResult result, uint32_t elapsedUs, unsigned long nowMs);
+
+    uint32_t getAttempts() const { return attempts; }
+    uint32_t getOk() const { return ok; }
+    uint16_t getTimeouts() const { return timeouts; }
+    uint16_t getOutOfRange() const { return outOfRange; }
+    bool hasOk() const { return ok > 0; }
+    unsigned long getAgeMs(unsigned long nowMs) const { return nowMs - lastOkMs; }   // sólo con hasOk()
+    uint32_t getAvgUs() const { return avgUs; }
+    uint32_t getMaxUs() const { return maxUs; }
+};
+
+#endif
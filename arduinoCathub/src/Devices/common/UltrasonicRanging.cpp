@@ -0,0 +1,53 @@
+// UltrasonicRanging.cpp
+#include "UltrasonicRanging.h"
+
+q16_t UltrasonicRanging::cmPerUsQ16 = 0;
+int16_t UltrasonicRanging::cachedTempDeciC = INT16_MIN;
+
+// c [m/s] = 331.3 + 0.606*T + 0.0124*HR (aprox. lineal, suficiente de 0 a 50 °C).
+// Ida y vuelta: cm/µs = c * 100 / 1e6 / 2 = c / 20000
+q16_t UltrasonicRanging::computeScale(float tempC, float humidity) {
+    float c = 331.3f + 0.606f * tempC;
+    if (!isnan(humidity) && humidity >= 0.0f && humidity <= 100.0f) {
+        c += 0.0124f * humidity;
+    }
+    return q16FromFloat(c / 20000.0f);
+}
+
+void UltrasonicRanging::updateAmbient(float tempC, float humidity) {
+    if (isnan(tempC)) return;
+
+    int16_t deci = (int16_t)(tempC * 10.0f + (tempC >= 0.0f ? 0.5f : -0.5f));
+    if (deci < MIN_TEMP_DECI_C) deci = MIN_TEMP_DECI_C;
+    if (deci > MAX_TEMP_DECI_C) deci = MAX_TEMP_DECI_C;
+    if (deci == cachedTempDeciC) return;   // misma temperatura: factor vigente
+
+    cachedTempDeciC = deci;
+    cmPerUsQ16 = computeScale(deci / 10.0f, humidity);
+}
+
+float UltrasonicRanging::echoToCm(long durationUs) {
+    if (durationUs <= 0) return -1.0f;
+    if (cmPerUsQ16 == 0) updateAmbient(DEFAULT_TEMP_DECI_C / 10.0f, NAN);
+    // durationUs < TIMEOUT (≤ 30000 µs) y factor ~1130: el producto entra en 32 bits
+    return q16ToFloat(q16MulInt(durationUs, cmPerUsQ16));
+}
+
+long UltrasonicRanging::measureEcho(int trigPin, int echoPin, unsigned long timeoutUs) {
+    digitalWrite(trigPin, LOW);
+    delayMicroseconds(2);
+    digitalWrite(trigPin, HIGH);
+    delayMicroseconds(10);
+    digitalWrite(trigPin, LOW);
+    return pulseIn(echoPin, HIGH, timeoutUs);
+}
+
+SensorReadResult UltrasonicRanging::classifyCm(float cm) {
+    if (cm < 0.0f) return SENSOR_READ_TIMEOUT;
+    if (cm < MIN_RANGE_CM || cm > MAX_RANGE_CM) return SENSOR_READ_OUT_OF_RANGE;
+    return SENSOR_READ_OK;
+}
+
+SensorReadResult UltrasonicRanging::classifyPresenceCm(float cm) {
+    return (cm < 0.0f) ? SENSOR_READ_NO_TARGET : classifyCm(cm);
+}
@@ -0,0 +1,42 @@
+// UltrasonicRanging.h
+#ifndef ULTRASONIC_RANGING_H
+#define ULTRASONIC_RANGING_H
+
+#include <Arduino.h>
+#include "../../filters/FixedPoint.h"
+#include "SensorHealth.h"
+
+// Conversión eco -> cm compartida por los tres ultrasónicos. La velocidad del
+// sonido depende de la temperatura (~0.6 m/s por °C): el factor cm/µs se
+// guarda en Q16.16 y sólo se recalcula cuando cambia la lectura del DHT, así
+// cada muestra cuesta una multiplicación entera.
+class UltrasonicRanging {
+private:
+    static const int16_t DEFAULT_TEMP_DECI_C = 200;   // 20.0 °C hasta tener DHT
+    static const int16_t MIN_TEMP_DECI_C = -200;
+    static const int16_t MAX_TEMP_DECI_C = 600;
+
+    static q16_t cmPerUsQ16;
+    static int16_t cachedTempDeciC;     // décimas de °C del factor vigente
+
+    static q16_t computeScale(float tempC, float humidity);
+
+public:
+    // Alcance útil del HC-SR04: por debajo queda la zona ciega
+    static constexpr float MIN_RANGE_CM = 2.0f;
+    static constexpr float MAX_RANGE_CM = 400.0f;
+
+    // Llamar con la lectura del DHT (NAN = sin lectura, se mantiene el factor)
+    static void updateAmbient(float tempC, float humidity);
+
+    static q16_t getScaleQ16() { return cmPerUsQ16; }
+    static float getTemperature() { return cachedTempDeciC / 10.0f; }
+
+    static float echoToCm(long durationUs);   // -1 si no hubo eco
+    static long measureEcho(int trigPin, int echoPin, unsigned long timeoutUs);  // 0 = timeout
+    static SensorReadResult classifyCm(float cm);   // -1 = TIMEOUT, fuera del alcance = OUT_OF_RANGE
+    // Para los que buscan al gato con un timeout corto: -1 = NO_TARGET
+    static SensorReadResult classifyPresenceCm(float cm);
+};
+
+#endif
@@ -1,8 +1,25 @@
 #ifndef DEVICE_IDS_H
 #define DEVICE_IDS_H
 
-#define DEVICE_ID_LITTERBOX "LTR1"
-#define DEVICE_ID_FEEDER    "FDR1"  
-#define DEVICE_ID_WATER     "WTR1"
+#include <Arduino.h>
 
-#endif
\ No newline at end of file
+// Los IDs viven en flash (PROGMEM); se manejan como __FlashStringHelper*
+// para poder imprimirlos directamente con Serial.print().
+#ifndef FPSTR
+#define FPSTR(p) (reinterpret_cast<const __FlashStringHelper*>(p))
+#endif
+
+static const char DEVICE_ID_LITTERBOX[] PROGMEM = "LTR1";
+static const char DEVICE_ID_FEEDER[]    PROGMEM = "FDR1";
+static const char DEVICE_ID_WATER[]     PROGMEM = "WTR1";
+
+// Estaciones adicionales de la misma placa (CATHUB_UNITS, ver StationLayout.h).
+// Todos los IDs de dispositivo miden 4 caracteres: el ruteo corta ahí el prefijo.
+static const char DEVICE_ID_LITTERBOX_2[] PROGMEM = "LTR2";
+static const char DEVICE_ID_FEEDER_2[]    PROGMEM = "FDR2";
+static const char DEVICE_ID_WATER_2[]     PROGMEM = "WTR2";
+static const char DEVICE_ID_LITTERBOX_3[] PROGMEM = "LTR3";
+static const char DEVICE_ID_FEEDER_3[]    PROGMEM = "FDR3";
+static const char DEVICE_ID_WATER_3[]     PROGMEM = "WTR3";
+
+#endif
@@ -1,19 +1,21 @@
 #include "FeederStepperMotor.h"
+#include "../../../state/ConfigStore.h"
 
-FeederStepperMotor::FeederStepperMotor(const char* id, const char* devId) : 
-    actuatorId(id), deviceId(devId), motorEnabled(false), motorReady(false), 
+FeederStepperMotor::FeederStepperMotor(const __FlashStringHelper* id, const __FlashStringHelper* devId,
+                                       uint8_t dirPin, uint8_t enPin, uint8_t pullPin, uint8_t unit) :
+    dirPin(dirPin), enPin(enPin), pullPin(pullPin), unit(unit), actuatorId(id), deviceId(devId), motorEnabled(false), motorReady(false), 
     motorRunning(false), currentSpeed(50), currentPosition(0), direction(true),
     lastStepTime(0) {}
 
 bool FeederStepperMotor::initialize() {
-    pinMode(DIR_PIN, OUTPUT);
-    pinMode(EN_PIN, OUTPUT);
-    pinMode(PULL_PIN, OUTPUT);
+    pinMode(dirPin, OUTPUT);
+    pinMode(enPin, OUTPUT);
+    pinMode(pullPin, OUTPUT);
     
     // Inicializar en estado seguro
-    digitalWrite(EN_PIN, HIGH);   // Deshabilitado (activo LOW)
-    digitalWrite(DIR_PIN, HIGH);  // Dirección por defecto
-    digitalWrite(PULL_PIN, LOW);  // Pulso en bajo
+    digitalWrite(enPin, HIGH);   // Deshabilitado (activo LOW)
+    digitalWrite(dirPin, HIGH);  // Dirección por defecto
+    digitalWrite(pullPin, LOW);  // Pulso en bajo
     
     motorReady = true;
     return true;
@@ -21,7 +23,7 @@ bool FeederStepperMotor::initialize() {
 
 void FeederStepperMotor::enable() {
     if (motorReady) {
-        digitalWrite(EN_PIN, LOW); // Activo LOW
+        digitalWrite(enPin, LOW); // Activo LOW
         motorEnabled = true;
         delay(10); // Tiempo para estabilizar
     }
@@ -29,13 +31,13 @@ void FeederStepperMotor::enable() {
 
 void FeederStepperMotor::disable() {
     motorRunning = false;
-    digitalWrite(EN_PIN, HIGH); // Desactivar
+    digitalWrite(enPin, HIGH); // Desactivar
     motorEnabled = false;
 }
 
 void FeederStepperMotor::setDirection(bool clockwise) {
     direction = clockwise;
-    digitalWrite(DIR_PIN, clockwise ? HIGH : LOW);
+    digitalWrite(dirPin, clockwise ? HIGH : LOW);
     delayMicroseconds(5); // Tiempo de setup para TB6600
 }
 
@@ -47,9 +49,9 @@ void FeederStepperMotor::step(int steps) {
     if (!motorEnabled || !motorReady) return;
     
     for (int i = 0; i < abs(steps); i++) {
-        digitalWrite(PULL_PIN, HIGH);
+        digitalWrite(pullPin, HIGH);
         delayMicroseconds(STEP_DELAY_US / 2);
-        digitalWrite(PULL_PIN, LOW);
+        digitalWrite(pullPin, LOW);
         delayMicroseconds(STEP_DELAY_US / 2);
         
         // Actualizar posición
@@ -78,11 +80,13 @@ void FeederStepperMotor::feedPortion(int portions) {
 
 void FeederStepperMotor::startContinuous() {
     if (!motorEnabled || !motorReady) return;
+    if (!motorRunning) TRACE_EVENT(TRC_FEEDER_START, currentSpeed);
     motorRunning = true;
     lastStepTime = micros();
 }
 
-void FeederStepperMotor::stopContinuous() {
+void FeederStepperMotor::stopContinuous(uint8_t reason) {
+    if (motorRunning) TRACE_EVENT(TRC_FEEDER_STOP, reason);
     motorRunning = false;
 }
 
@@ -95,9 +99,9 @@ void FeederStepperMotor::update() {
     
     unsigned long now = micros();
     if (now - lastStepTime >= stepDelay) {
-        digitalWrite(PULL_PIN, HIGH);
+        digitalWrite(pullPin, HIGH);
         delayMicroseconds(50);
-        digitalWrite(PULL_PIN, LOW);
+        digitalWrite(pullPin, LOW);
         // Actualizar posición
         currentPosition += (direction ? 1 : -1);
         lastStepTime = now;
@@ -113,21 +117,21 @@ bool FeederStepperMotor::isReady() {
 }
 
 String FeederStepperMotor::getStatus() {
-    if (!motorReady) return "NOT_INITIALIZED";
-    if (motorRunning) return "RUNNING";
-    if (motorEnabled) return "ENABLED";
-    return "DISABLED";
+    if (!motorReady) return F("NOT_INITIALIZED");
+    if (motorRunning) return F("RUNNING");
+    if (motorEnabled) return F("ENABLED");
+    return F("DISABLED");
 }
 
 int FeederStepperMotor::getCurrentPosition() {
     return currentPosition;
 }
 
-const char* FeederStepperMotor::getActuatorId() {
+const __FlashStringHelper* FeederStepperMotor::getActuatorId() {
     return actuatorId;
 }
 
-const char* FeederStepperMotor::getDeviceId() {
+const __FlashStringHelper* FeederStepperMotor::getDeviceId() {
     return deviceId;
 }
 
@@ -141,20 +145,21 @@ void FeederStepperMotor::controlFromSerial(int command) {
         // enable(); setDirection(false); setSpeed(120); startContinuous();
     } 
     else if (command == 0) {
-        stopContinuous();
+        stopContinuous(TRC_REASON_COMMAND);
         disable();
-        // Serial.println("{\"feeder_motor\":\"STOPPED_BY_SERIAL\"}");
     }
 }
 
 // canStart: revisar distancias con tolerancia y manejar lecturas desconocidas (-1)
 bool FeederStepperMotor::canStart(float foodStorageDistance, float plateFoodDistance) {
-    // Si no hay lectura del depósito o lectura indica vacío (>= 13.0 cm) -> no arrancar
+    const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+
+    // Si no hay lectura del depósito o lectura indica vacío (>= storage_empty_cm) -> no arrancar
     if (foodStorageDistance <= 0) return false;
-    if (foodStorageDistance >= 13.0) return false;
+    if (foodStorageDistance >= cfg.storageEmptyCm) return false;
 
-    // Si hay lectura del plato y este está muy cerca (<= 2.0 cm) -> plato lleno -> no arrancar
-    if (plateFoodDistance > 0 && plateFoodDistance <= 2.0) return false;
+    // Si hay lectura del plato y este está muy cerca (<= plate_full_cm) -> plato lleno -> no arrancar
+    if (plateFoodDistance > 0 && plateFoodDistance <= cfg.plateFullCm) return false;
 
     // En los demás casos, permitir arranque
     return true;
@@ -165,11 +170,11 @@ bool FeederStepperMotor::canStart(float foodStorageDistance, float plateFoodDist
 // Devuelve true si el motor efectivamente arrancó.
 bool FeederStepperMotor::tryStart(float foodStorageDistance, float plateFoodDistance) {
     if (!motorReady) {
-        // Serial.println("{\"feeder_motor\":\"START_BLOCKED\",\"reason\":\"MOTOR_NOT_READY\"}");
+        TRACE_EVENT(TRC_FEEDER_BLOCKED, TRC_REASON_NOT_READY);
         return false;
     }
     if (!canStart(foodStorageDistance, plateFoodDistance)) {
-        // Serial.println("{\"feeder_motor\":\"START_BLOCKED\",\"reason\":\"SENSOR_CHECK_FAILED\",\"storage\":" + String(foodStorageDistance) + ",\"plate\":" + String(plateFoodDistance) + "}");
+        TRACE_EVENT(TRC_FEEDER_BLOCKED, TRC_REASON_SENSORS);
         return false;
     }
     // Inicio seguro
@@ -186,16 +191,14 @@ bool FeederStepperMotor::tryStart(float foodStorageDistance, float plateFoodDist
 bool FeederStepperMotor::monitorAndStop(float foodStorageDistance, float plateFoodDistance) {
     if (!motorRunning) return false;
     if (!canStart(foodStorageDistance, plateFoodDistance)) {
-        stopContinuous();
+        stopContinuous(TRC_REASON_SENSORS);
         disable();
-        // Serial.println("{\"feeder_motor\":\"AUTO_STOP\",\"reason\":\"SENSOR_STATE_CHANGED\",\"storage\":" + String(foodStorageDistance) + ",\"plate\":" + String(plateFoodDistance) + "}");
         return true;
     }
     return false;
 }
 
 void FeederStepperMotor::emergencyStop() {
-    stopContinuous();
+    stopContinuous(TRC_REASON_EMERGENCY);
     disable();
-    // Serial.println("{\"feeder_motor\":\"EMERGENCY_STOP\"}");
 }
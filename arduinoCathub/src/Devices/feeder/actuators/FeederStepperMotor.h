@@ -4,18 +4,19 @@
 #include <Arduino.h>
 #include "../config/ActuatorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../../system/TraceBuffer.h"
 
 class FeederStepperMotor {
 private:
-    static const int DIR_PIN = 13;   // Dirección
-    static const int EN_PIN = 14;    // Enable (activo LOW)
-    static const int PULL_PIN = 12;  // Pulsos (Step)
-
     static const unsigned long STEP_DELAY_US = 1000; // 10ms entre pulsos (valor base)
     static const int STEPS_PER_REVOLUTION = 200;     // Pasos por vuelta completa
 
-    const char* actuatorId;
-    const char* deviceId;
+    const uint8_t dirPin;           // Dirección
+    const uint8_t enPin;            // Enable (activo LOW)
+    const uint8_t pullPin;          // Pulsos (Step)
+    const uint8_t unit;             // estación: sus umbrales de depósito y plato
+    const __FlashStringHelper* actuatorId;
+    const __FlashStringHelper* deviceId;
     bool motorEnabled;
     bool motorReady;
     bool motorRunning;              // Indica si el motor está en movimiento continuo
@@ -25,7 +26,8 @@ private:
     unsigned long lastStepTime;     // Para control continuo
     
 public:
-    FeederStepperMotor(const char* id = ACTUATOR_FEEDER_MOTOR_ID_1, const char* devId = DEVICE_ID_FEEDER);
+    FeederStepperMotor(const __FlashStringHelper* id = FPSTR(ACTUATOR_FEEDER_MOTOR_ID_1), const __FlashStringHelper* devId = FPSTR(DEVICE_ID_FEEDER),
+                       uint8_t dirPin = 13, uint8_t enPin = 14, uint8_t pullPin = 12, uint8_t unit = 0);
     bool initialize();
     void enable();
     void disable();
@@ -36,15 +38,15 @@ public:
     void rotate(float degrees);
     void feedPortion(int portions = 1); // Alimentar porciones
     void startContinuous();         // Inicia movimiento continuo (interno)
-    void stopContinuous();          // Detiene movimiento continuo (interno)
+    void stopContinuous(uint8_t reason = TRC_REASON_DONE); // Detiene movimiento continuo (interno); reason: TraceReason
     void update();                  // Actualizar motor en modo continuo (llamar desde loop/poll)
     bool isEnabled();
     bool isReady();
     bool isRunning() { return motorRunning; }
     
     // IDs y estado
-    const char* getActuatorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getActuatorId();
+    const __FlashStringHelper* getDeviceId();
     String getStatus();
     int getCurrentPosition();
 
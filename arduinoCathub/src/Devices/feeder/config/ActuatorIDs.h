@@ -1 +1,10 @@
-#define ACTUATOR_FEEDER_MOTOR_ID_1   "FRMTR_001"
+#ifndef FEEDER_ACTUATOR_IDS_H
+#define FEEDER_ACTUATOR_IDS_H
+
+#include <Arduino.h>
+
+static const char ACTUATOR_FEEDER_MOTOR_ID_1[] PROGMEM = "FRMTR_001";
+static const char ACTUATOR_FEEDER_MOTOR_ID_2[] PROGMEM = "FRMTR_002";
+static const char ACTUATOR_FEEDER_MOTOR_ID_3[] PROGMEM = "FRMTR_003";
+
+#endif
@@ -1,3 +1,18 @@
-#define SENSOR_ID_FEEDER_WEIGHT   "WIT_001"
-#define SENSOR_ID_FEEDER_SONIC1   "UTS_001"
-#define SENSOR_ID_FEEDER_SONIC2   "UTS_002"
\ No newline at end of file
+#ifndef FEEDER_SENSOR_IDS_H
+#define FEEDER_SENSOR_IDS_H
+
+#include <Arduino.h>
+
+static const char SENSOR_ID_FEEDER_WEIGHT[] PROGMEM = "WIT_001";
+static const char SENSOR_ID_FEEDER_SONIC1[] PROGMEM = "UTS_001";
+static const char SENSOR_ID_FEEDER_SONIC2[] PROGMEM = "UTS_002";
+
+// Estaciones 2 y 3: los ultrasónicos siguen la numeración (dos por comedero)
+static const char SENSOR_ID_FEEDER_WEIGHT_2[] PROGMEM = "WIT_002";
+static const char SENSOR_ID_FEEDER_SONIC1_2[] PROGMEM = "UTS_003";
+static const char SENSOR_ID_FEEDER_SONIC2_2[] PROGMEM = "UTS_004";
+static const char SENSOR_ID_FEEDER_WEIGHT_3[] PROGMEM = "WIT_003";
+static const char SENSOR_ID_FEEDER_SONIC1_3[] PROGMEM = "UTS_005";
+static const char SENSOR_ID_FEEDER_SONIC2_3[] PROGMEM = "UTS_006";
+
+#endif
@@ -4,64 +4,67 @@
 #include <Arduino.h>
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../common/SensorHealth.h"
 
 // Sensor para detectar presencia del gato / nivel de comida
 class FeederUltrasonicSensor1 {
 private:
-    static const int TRIG_PIN = 4;   // Pin trigger para sensor 1
-    static const int ECHO_PIN = 5;   // Pin echo para sensor 1
-    static const unsigned long READ_INTERVAL = 100; // ms
+    static const unsigned long READ_INTERVAL = 60;  // ms mínimos entre pings (eco residual)
     static const unsigned long TIMEOUT_US = 6000;   // µs, ~1 m roundtrip suficiente para comederos
     
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t trigPin;
+    const uint8_t echoPin;
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
     
     float lastDistance;       // -1.0 = sin lectura válida
     unsigned long lastReadTime;
     bool sensorReady;
 
 public:
-    FeederUltrasonicSensor1(const char* id = SENSOR_ID_FEEDER_SONIC1, const char* deviceId = DEVICE_ID_FEEDER);
+    FeederUltrasonicSensor1(const __FlashStringHelper* id = FPSTR(SENSOR_ID_FEEDER_SONIC1), const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_FEEDER),
+                            uint8_t trigPin = 4, uint8_t echoPin = 5);
     bool initialize();
     // NOTA: ajustar rangos según montaje físico; aquí valores recomendados
     bool hasFood() { return (lastDistance > 0 && lastDistance <= 4.0); }  // Depósito lleno (<=4cm)
     bool isEmpty() { return (lastDistance > 0 && lastDistance >= 6.0); }   // Depósito vacío (>=6cm)
     String getFoodStatus();
-    void update();
+    SensorReadResult update(bool singleShot = false);   // singleShot: un ping en vez de la mediana de 3
     float getDistance();
     bool isReady();
     String getStatus();
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 // Sensor para medir nivel de comida en platito (si lo usas)
 class FeederUltrasonicSensor2 {
 private:
-    static const int TRIG_PIN = 6;
-    static const int ECHO_PIN = 7;
-    static const unsigned long READ_INTERVAL = 120; // desfasado respecto al otro
+    static const unsigned long READ_INTERVAL = 60;  // ms mínimos entre pings (eco residual)
     static const unsigned long TIMEOUT_US = 6000;
     
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t trigPin;
+    const uint8_t echoPin;
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
     
     float lastDistance;
     unsigned long lastReadTime;
     bool sensorReady;
 
 public:
-    FeederUltrasonicSensor2(const char* id = SENSOR_ID_FEEDER_SONIC2, const char* deviceId = DEVICE_ID_FEEDER);
+    FeederUltrasonicSensor2(const __FlashStringHelper* id = FPSTR(SENSOR_ID_FEEDER_SONIC2), const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_FEEDER),
+                            uint8_t trigPin = 6, uint8_t echoPin = 7);
     bool initialize();
     bool isFull() { return (lastDistance > 0 && lastDistance <= 4.0); }   // Platito lleno
     bool isEmpty() { return (lastDistance > 0 && lastDistance >= 12.0); }  // Platito vacío
     String getPlateStatus();
-    void update();
+    SensorReadResult update(bool singleShot = false);
     float getDistance();
     bool isReady();
     String getStatus();
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif
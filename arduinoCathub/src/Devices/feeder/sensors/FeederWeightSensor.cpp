@@ -1,18 +1,25 @@
 // FeederWeightSensor.cpp
 #include "FeederWeightSensor.h"
+#include "../../../state/ConfigStore.h"
 
-const float FeederWeightSensor::CALIBRATION_FACTOR = 422.0;
-
-FeederWeightSensor::FeederWeightSensor(const char* id, const char* devId) 
-    : sensorId(id), deviceId(devId), currentWeight(0), lastReadTime(0), sensorReady(false) {
+FeederWeightSensor::FeederWeightSensor(const __FlashStringHelper* id, const __FlashStringHelper* devId,
+                                       uint8_t doutPin, uint8_t sckPin, uint8_t unit)
+    : doutPin(doutPin), sckPin(sckPin), unit(unit), sensorId(id), deviceId(devId), events(unit), currentWeight(0), lastReadTime(0), sensorReady(false) {
 }
 
 bool FeederWeightSensor::initialize() {
-    scale.begin(DOUT_PIN, SCK_PIN);
+    scale.begin(doutPin, sckPin);
     
     if (scale.is_ready()) {
-        scale.set_scale(CALIBRATION_FACTOR);
-        scale.tare(); // Reset the scale to 0
+        ConfigStore& config = ConfigStore::getInstance();
+        scale.set_scale(config.getCalibrationFactor(unit));
+        if (config.hasFlag(ConfigStore::CONFIG_FLAG_HX711_TARE, unit)) {
+            scale.set_offset(config.getHx711Offset(unit)); // Tara guardada: no se repite al arrancar
+        } else {
+            scale.tare(); // Reset the scale to 0
+            config.setHx711Offset(scale.get_offset(), unit);
+            config.save();
+        }
         sensorReady = true;
         return true;
     }
@@ -21,21 +28,29 @@ bool FeederWeightSensor::initialize() {
     return false;
 }
 
-void FeederWeightSensor::update() {
-    if (!sensorReady) return;
+SensorReadResult FeederWeightSensor::update() {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
     
     unsigned long now = millis();
-    if (now - lastReadTime >= READ_INTERVAL && scale.is_ready()) {
-        currentWeight = scale.get_units(10); // Promedio de 10 lecturas
-        lastReadTime = now;
+    if (now - lastReadTime < READ_INTERVAL) return SENSOR_READ_SKIPPED;
+    if (!scale.is_ready()) {
+        // Sin conversión todavía; pasado CONVERSION_TIMEOUT_MS ya no es espera
+        return (now - lastReadTime >= CONVERSION_TIMEOUT_MS) ? SENSOR_READ_TIMEOUT : SENSOR_READ_SKIPPED;
     }
+
+    // Una conversión por ciclo (~100 ms a 10 SPS) en vez de 10 bloqueantes;
+    // la media móvil entera suaviza y sólo se pasa a gramos al final.
+    int32_t raw = (int32_t)scale.read();
+    int32_t avg = rawAverage.update(raw);
+    currentWeight = (float)(avg - scale.get_offset()) / scale.get_scale();
+    events.update(currentWeight, now);
+    lastReadTime = now;
+    // ADC de 24 bits saturado: celda desconectada o sobrecargada
+    return (raw >= RAW_MAX || raw <= -RAW_MAX) ? SENSOR_READ_OUT_OF_RANGE : SENSOR_READ_OK;
 }
 
 float FeederWeightSensor::getCurrentWeight() {
-    if (scale.is_ready()) {
-        return scale.get_units(5); // Lectura inmediata con 5 muestras
-    }
-    return currentWeight; // Devolver último valor conocido
+    return currentWeight; // Último valor filtrado (no bloquea)
 }
 
 bool FeederWeightSensor::isReady() {
@@ -46,27 +61,39 @@ void FeederWeightSensor::tare() {
     if (scale.is_ready()) {
         scale.tare();
         currentWeight = 0.0;
+        rawAverage.reset();
+        events.reset();   // la meseta anterior ya no vale
+        ConfigStore& config = ConfigStore::getInstance();
+        config.setHx711Offset(scale.get_offset(), unit);
+        config.save();
     }
 }
 
-void FeederWeightSensor::calibrate(float knownWeight) {
-    if (scale.is_ready() && knownWeight > 0) {
-        float reading = scale.get_units(10);
-        float newFactor = reading / knownWeight;
-        scale.set_scale(newFactor);
-    }
+bool FeederWeightSensor::calibrate(float knownWeight) {
+    if (!scale.is_ready() || knownWeight <= 0) return false;
+
+    // get_value() ya descuenta la tara: cuentas netas / gramos = factor
+    float reading = (float)scale.get_value(10);
+    float newFactor = reading / knownWeight;
+    if (fabs(newFactor) < 0.001f) return false;
+
+    scale.set_scale(newFactor);
+    events.reset();
+    ConfigStore& config = ConfigStore::getInstance();
+    config.setCalibrationFactor(newFactor, unit);
+    return config.save();
 }
 
 String FeederWeightSensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    if (!scale.is_ready()) return "NOT_READY";
-    return "READY";
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    if (!scale.is_ready()) return F("NOT_READY");
+    return F("READY");
 }
 
-const char* FeederWeightSensor::getSensorId() {
+const __FlashStringHelper* FeederWeightSensor::getSensorId() {
     return sensorId;
 }
 
-const char* FeederWeightSensor::getDeviceId() {
+const __FlashStringHelper* FeederWeightSensor::getDeviceId() {
     return deviceId;
 }
\ No newline at end of file
@@ -4,34 +4,48 @@
 
 #include <Arduino.h>
 #include "HX711.h"
+#include "../../../filters/SignalFilters.h"
+#include "WeightEventDetector.h"
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../common/SensorHealth.h"
 
 class FeederWeightSensor {
 private:
-    static const int DOUT_PIN = 3;
-    static const int SCK_PIN = 2;
-    static const float CALIBRATION_FACTOR;
-    static const unsigned long READ_INTERVAL = 500;
-    const char* sensorId;
-    const char* deviceId;
+    static const unsigned long READ_INTERVAL = 100; // una conversión a 10 SPS
+    static const unsigned long CONVERSION_TIMEOUT_MS = 1000;   // 10 conversiones perdidas
+    static const int32_t RAW_MAX = 0x7FFFFF;   // fondo de escala del HX711
+    static const uint8_t AVERAGE_SAMPLES = 4;   // media móvil de cuentas crudas
+    const uint8_t doutPin;
+    const uint8_t sckPin;
+    const uint8_t unit;         // estación: índice de la calibración en ConfigStore
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
     
     HX711 scale;
+    MovingAverage<AVERAGE_SAMPLES> rawAverage;
+    WeightEventDetector events;
     float currentWeight;
     unsigned long lastReadTime;
     bool sensorReady;
     
 public:
     // Modificado para usar IDs hardcodeados por defecto
-    FeederWeightSensor(const char* id = SENSOR_ID_FEEDER_WEIGHT, const char* deviceId = DEVICE_ID_FEEDER);
+    FeederWeightSensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_FEEDER_WEIGHT), const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_FEEDER),
+                       uint8_t doutPin = 3, uint8_t sckPin = 2, uint8_t unit = 0);
     bool initialize();
-    void update();
+    SensorReadResult update();
     float getCurrentWeight();
     bool isReady();
-    void tare();
-    void calibrate(float knownWeight);
-    const char* getSensorId();
-    const char* getDeviceId();
+    bool hasSettled() const { return rawAverage.isFull(); }   // ventana de media completa
+    void tare();                         // persiste la tara en ConfigStore
+    bool calibrate(float knownWeight);   // persiste el factor en ConfigStore
+    bool pollEvent(WeightEvent& out) { return events.poll(out); }
+    bool isCatEating() const { return events.isEating(); }
+    bool isDisturbed() const { return events.isDisturbed(); }
+    void holdEvents(bool hold) { events.setHold(hold); }
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
     String getStatus();
 };
 
@@ -0,0 +1,127 @@
+// WeightEventDetector.cpp
+#include "WeightEventDetector.h"
+#include "../../../state/ConfigStore.h"
+
+WeightEventDetector::WeightEventDetector(uint8_t unit) : held(false), unit(unit), queueHead(0), queueCount(0) {
+    reset();
+}
+
+void WeightEventDetector::reset() {
+    head = 0;
+    count = 0;
+    state = STATE_IDLE;
+    hasPlateau = false;
+    plateauDg = 0;
+    sessionStartDg = 0;
+    stableSince = 0;
+    disturbedSince = 0;
+    sessionStart = 0;
+    lastActivity = 0;
+}
+
+void WeightEventDetector::push(WeightEventType type, int32_t gramsDg, int32_t levelDg, uint32_t durationMs) {
+    if (queueCount == QUEUE_SIZE) {
+        // Cola llena: se pierde el más viejo (el host no está leyendo)
+        queueHead = (uint8_t)((queueHead + 1) % QUEUE_SIZE);
+        queueCount--;
+    }
+    WeightEvent& ev = queue[(queueHead + queueCount) % QUEUE_SIZE];
+    ev.type = type;
+    ev.gramsDg = gramsDg;
+    ev.levelDg = levelDg;
+    ev.durationMs = durationMs;
+    queueCount++;
+}
+
+bool WeightEventDetector::poll(WeightEvent& out) {
+    if (queueCount == 0) return false;
+    out = queue[queueHead];
+    queueHead = (uint8_t)((queueHead + 1) % QUEUE_SIZE);
+    queueCount--;
+    return true;
+}
+
+int32_t WeightEventDetector::windowMean() const {
+    if (count == 0) return 0;
+    int32_t sum = 0;
+    for (uint8_t i = 0; i < count; ++i) sum += window[i];
+    return sum / count;
+}
+
+int32_t WeightEventDetector::windowSpread() const {
+    if (count == 0) return 0;
+    int32_t lo = window[0], hi = window[0];
+    for (uint8_t i = 1; i < count; ++i) {
+        if (window[i] < lo) lo = window[i];
+        if (window[i] > hi) hi = window[i];
+    }
+    return hi - lo;
+}
+
+void WeightEventDetector::update(float grams, unsigned long now) {
+    const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+    const int32_t stepDg = (int32_t)cfg.weightStepG * 10;
+    const int32_t bandDg = (stepDg / 2 > 10) ? stepDg / 2 : 10;   // ruido tolerado en meseta (>= 1 g)
+
+    int32_t sampleDg = (int32_t)(grams * 10.0f + (grams >= 0.0f ? 0.5f : -0.5f));
+    window[head] = sampleDg;
+    head = (uint8_t)((head + 1) % WINDOW);
+    if (count < WINDOW) count++;
+
+    bool stable = (count == WINDOW) && windowSpread() <= bandDg;
+    if (!stable) stableSince = now;
+    bool settled = stable && (now - stableSince >= cfg.weightSettleMs);
+
+    if (!hasPlateau) {
+        // Primera meseta tras el arranque o una tara: sólo referencia, sin evento
+        if (settled) {
+            plateauDg = windowMean();
+            hasPlateau = true;
+            state = STATE_IDLE;
+        }
+        return;
+    }
+
+    switch (state) {
+        case STATE_IDLE:
+            if (!stable || held) {
+                state = STATE_DISTURBED;
+                disturbedSince = now;
+            }
+            break;
+
+        case STATE_DISTURBED:
+            if (settled && !held) {
+                // Perturbación corta: relleno, plato retirado/puesto o nada
+                int32_t level = windowMean();
+                int32_t delta = level - plateauDg;
+                if (delta >= stepDg || delta <= -stepDg) {
+                    push(WEIGHT_EVENT_STEP, delta, level, 0);
+                }
+                plateauDg = level;
+                state = STATE_IDLE;
+            } else if (!held && !stable && now - disturbedSince >= EAT_MIN_MS) {
+                // Sigue ruidoso (no es un escalón asentándose): gato comiendo
+                state = STATE_EATING;
+                sessionStart = disturbedSince;
+                sessionStartDg = plateauDg;
+                lastActivity = now;
+                push(WEIGHT_EVENT_EAT_START, 0, plateauDg, 0);
+            }
+            break;
+
+        case STATE_EATING:
+            if (!stable) {
+                lastActivity = now;
+            } else if (now - lastActivity >= cfg.weightSessionGapMs) {
+                // Sin actividad durante el hueco configurado: fin de la sesión
+                int32_t level = windowMean();
+                int32_t eaten = sessionStartDg - level;
+                if (eaten < 0) eaten = 0;   // se rellenó durante la sesión
+                push(WEIGHT_EVENT_EAT_END, eaten, level, lastActivity - sessionStart);
+                plateauDg = level;
+                state = STATE_IDLE;
+            }
+            break;
+    }
+}
@@ -0,0 +1,75 @@
+// WeightEventDetector.h
+#ifndef WEIGHT_EVENT_DETECTOR_H
+#define WEIGHT_EVENT_DETECTOR_H
+
+#include <Arduino.h>
+
+// Detector de eventos sobre el flujo de peso del HX711 (comedero). En vez de
+// mandar el peso crudo, reconoce mesetas estables, escalones (relleno o plato
+// retirado) y los periodos ruidosos del gato comiendo, y genera pocos eventos
+// por comida: inicio de sesión, fin (gramos comidos y duración) y escalón.
+// Todo en décimas de gramo enteras; los umbrales vienen de ConfigStore.
+enum WeightEventType : uint8_t {
+    WEIGHT_EVENT_EAT_START,
+    WEIGHT_EVENT_EAT_END,
+    WEIGHT_EVENT_STEP
+};
+
+struct WeightEvent {
+    WeightEventType type;
+    int32_t  gramsDg;       // EAT_END: comido, STEP: cambio (con signo), en décimas de g
+    int32_t  levelDg;       // peso de la meseta al generar el evento
+    uint32_t durationMs;    // EAT_END: duración de la sesión
+};
+
+class WeightEventDetector {
+private:
+    static const uint8_t WINDOW = 6;           // muestras para medir el ruido (~3 s a 500 ms)
+    static const uint8_t QUEUE_SIZE = 4;
+    static const unsigned long EAT_MIN_MS = 5000;   // perturbación más larga = gato comiendo
+
+    enum State : uint8_t {
+        STATE_IDLE,        // meseta conocida y estable
+        STATE_DISTURBED,   // algo movió el plato, todavía no se sabe qué
+        STATE_EATING       // sesión de comida abierta
+    };
+
+    int32_t window[WINDOW];
+    uint8_t head;
+    uint8_t count;
+
+    State state;
+    bool hasPlateau;
+    bool held;                     // dispensando: el ruido no es un gato comiendo
+    int32_t plateauDg;
+    int32_t sessionStartDg;
+    unsigned long stableSince;     // inicio de la racha estable actual
+    unsigned long disturbedSince;
+    unsigned long sessionStart;
+    unsigned long lastActivity;    // última muestra ruidosa de la sesión
+
+    uint8_t unit;                  // estación: sus weight_step_g / settle / gap
+
+    WeightEvent queue[QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueCount;
+
+    void push(WeightEventType type, int32_t gramsDg, int32_t levelDg, uint32_t durationMs);
+    int32_t windowMean() const;
+    int32_t windowSpread() const;
+
+public:
+    explicit WeightEventDetector(uint8_t unit = 0);
+
+    void reset();                                 // tras tara/calibración
+    void update(float grams, unsigned long now);  // una muestra filtrada
+    bool poll(WeightEvent& out);                  // saca el evento más viejo
+    bool isEating() const { return state == STATE_EATING; }
+    // Peso moviéndose fuera de un dispensado (posible gato en el plato)
+    bool isDisturbed() const { return hasPlateau && !held && state != STATE_IDLE; }
+    // Mientras se dispensa no se abren sesiones; al soltar, el llenado queda
+    // como un escalón en cuanto el peso se asienta.
+    void setHold(bool hold) { held = hold; }
+};
+
+#endif
@@ -1,22 +1,33 @@
 #include "LitterboxStepperMotor.h"
-
-LitterboxStepperMotor::LitterboxStepperMotor(const char* id, const char* devId) :
+#include "../../../system/SafetyInterlock.h"
+#include "../../../system/TraceBuffer.h"
+
+LitterboxStepperMotor::LitterboxStepperMotor(const __FlashStringHelper* id, const __FlashStringHelper* devId,
+                                             uint8_t dirPin, uint8_t enPin, uint8_t pullPin, uint8_t unit) :
+    dirPin(dirPin),
+    enPin(enPin),
+    pullPin(pullPin),
+    safetyChannel(safetyChannelFor(SAFETY_LITTERBOX, unit)),
     actuatorId(id),
     deviceId(devId),
     motorEnabled(false),
     motorReady(false),
     currentPosition(0),
-    currentState(INACTIVE) {}
+    currentState(INACTIVE),
+    moving(false),
+    moveTarget(0),
+    lastStepUs(0) {}
 
 bool LitterboxStepperMotor::initialize() {
-    pinMode(DIR_PIN, OUTPUT);
-    pinMode(EN_PIN, OUTPUT);
-    pinMode(PULL_PIN, OUTPUT);
+    pinMode(dirPin, OUTPUT);
+    pinMode(enPin, OUTPUT);
+    pinMode(pullPin, OUTPUT);
 
     // EN = HIGH -> disabled (driver típico TB6600 activo en LOW)
-    digitalWrite(EN_PIN, HIGH);
-    digitalWrite(DIR_PIN, HIGH);
-    digitalWrite(PULL_PIN, LOW);
+    digitalWrite(enPin, HIGH);
+    digitalWrite(dirPin, HIGH);
+    digitalWrite(pullPin, LOW);
+    SafetyInterlock::attachOutput(safetyChannel, enPin, true);   // HIGH = driver deshabilitado
 
     motorReady = true;
     motorEnabled = false;
@@ -28,8 +39,8 @@ bool LitterboxStepperMotor::initialize() {
 }
 
 bool LitterboxStepperMotor::enableTorque() {
-    if (!motorReady) return false;
-    digitalWrite(EN_PIN, LOW); // LOW = enabled
+    if (!motorReady || SafetyInterlock::isLatched(safetyChannel)) return false;
+    digitalWrite(enPin, LOW); // LOW = enabled
     motorEnabled = true;
     delay(5);
     // Serial.println("{\"device\":\"LITTERBOX\",\"torque\":\"ENABLED\"}");
@@ -37,7 +48,7 @@ bool LitterboxStepperMotor::enableTorque() {
 }
 
 bool LitterboxStepperMotor::disableTorque() {
-    digitalWrite(EN_PIN, HIGH); // HIGH = disabled
+    digitalWrite(enPin, HIGH); // HIGH = disabled
     motorEnabled = false;
     delay(5);
     // Serial.println("{\"device\":\"LITTERBOX\",\"torque\":\"DISABLED\"}");
@@ -46,37 +57,47 @@ bool LitterboxStepperMotor::disableTorque() {
 
 void LitterboxStepperMotor::setDirection(bool clockwise) {
     // clockwise=true -> RIGHT, clockwise=false -> LEFT
-    digitalWrite(DIR_PIN, clockwise ? HIGH : LOW);
+    digitalWrite(dirPin, clockwise ? HIGH : LOW);
     delayMicroseconds(2);
 }
 
-void LitterboxStepperMotor::stepSigned(int signedSteps) {
+bool LitterboxStepperMotor::stepSigned(int signedSteps) {
     if (!motorReady) {
         // Serial.println("{\"device\":\"LITTERBOX\",\"error\":\"MOTOR_NOT_READY\"}");
-        return;
+        return false;
     }
-    if (signedSteps == 0) return;
+    if (signedSteps == 0) return true;
 
     // Requerimos torque activo para mover. Si no está activo, fallo (caller debe activar).
     if (!motorEnabled) {
         // Serial.println("{\"device\":\"LITTERBOX\",\"error\":\"TORQUE_DISABLED_CANNOT_MOVE\"}");
-        return;
+        return false;
     }
 
+    // Mientras se mueve, el enclavamiento vigila el ultrasónico por interrupción
+    if (!SafetyInterlock::arm(safetyChannel)) return false;
+
     bool dirRight = (signedSteps > 0);
     int steps = abs(signedSteps);
 
     setDirection(dirRight);
     // Inicio movimiento
     for (int i = 0; i < steps; ++i) {
-        digitalWrite(PULL_PIN, HIGH);
+        if (SafetyInterlock::isLatched(safetyChannel)) break;   // EN ya cortado por el ISR
+        digitalWrite(pullPin, HIGH);
         delayMicroseconds(STEP_DELAY_US / 2);
-        digitalWrite(PULL_PIN, LOW);
+        digitalWrite(pullPin, LOW);
         delayMicroseconds(STEP_DELAY_US / 2);
         currentPosition += (dirRight ? 1 : -1);
         // NO imprimir dentro del bucle para no afectar timing
     }
+    SafetyInterlock::disarm(safetyChannel);
+    if (SafetyInterlock::isLatched(safetyChannel)) {
+        emergencyStop();
+        return false;
+    }
     // Serial.println("{\"device\":\"LITTERBOX\",\"action\":\"STEP_DONE\",\"dir\":" + String(dirRight ? "RIGHT":"LEFT") + ",\"steps\":" + String(steps) + ",\"pos\":" + String(currentPosition) + "}");
+    return true;
 }
 
 bool LitterboxStepperMotor::setReady() {
@@ -93,7 +114,7 @@ bool LitterboxStepperMotor::setReady() {
     delay(20);
 
     // 2) mover READY_STEPS hacia la izquierda (negativo)
-    stepSigned(-READY_STEPS);
+    if (!stepSigned(-READY_STEPS)) return false;   // enclavamiento: motor ya detenido
 
     // 3) actualizar estado
     currentState = ACTIVE;
@@ -101,41 +122,55 @@ bool LitterboxStepperMotor::setReady() {
     return true;
 }
 
-bool LitterboxStepperMotor::executeNormalCleaning() {
-    if (currentState != ACTIVE) {
-        // Serial.println("{\"device\":\"LITTERBOX\",\"error\":\"NOT_ACTIVE_CANNOT_CLEAN\"}");
-        return false;
-    }
-
-    // MOVIMIENTO: RIGHT NORMAL_CLEAN_STEPS y luego regresar la misma cantidad (LEFT)
-    stepSigned(NORMAL_CLEAN_STEPS);
-    delay(150);
-    stepSigned(-NORMAL_CLEAN_STEPS);
-
-    // Serial.println("{\"device\":\"LITTERBOX\",\"action\":\"NORMAL_CLEAN_COMPLETE\",\"position\":" + String(currentPosition) + "}");
+bool LitterboxStepperMotor::beginMoveTo(long position) {
+    if (!motorReady) return false;
+    if (!motorEnabled && !enableTorque()) return false;   // enclavado: no se reactiva
+    if (!SafetyInterlock::arm(safetyChannel)) return false;
+
+    moveTarget = position;
+    setDirection(moveTarget > currentPosition);
+    lastStepUs = micros();
+    moving = (moveTarget != currentPosition);
+    if (!moving) SafetyInterlock::disarm(safetyChannel);
+    else TRACE_EVENT(TRC_LITTER_MOVE, labs(moveTarget - currentPosition));   // pasos a dar
     return true;
 }
 
-bool LitterboxStepperMotor::executeDeepCleaning() {
-    if (currentState != ACTIVE) {
-        // Serial.println("{\"device\":\"LITTERBOX\",\"error\":\"NOT_ACTIVE_CANNOT_DEEP_CLEAN\"}");
+bool LitterboxStepperMotor::serviceMove() {
+    if (!moving) return false;
+
+    if (SafetyInterlock::isLatched(safetyChannel)) {
+        // El ISR ya cortó EN: sólo se sincroniza el estado local
+        TRACE_EVENT(TRC_LITTER_STOP, TRC_REASON_INTERLOCK);
+        moving = false;
+        motorEnabled = false;
         return false;
     }
 
-    // 1) LEFT DEEP_CLEAN_STEPS (vaciar)
-    stepSigned(-DEEP_CLEAN_STEPS);
-    delay(150);
+    unsigned long now = micros();
+    unsigned long elapsed = now - lastStepUs;
+    if (elapsed < STEP_DELAY_US) return true;
+    // Un loop lento no se recupera con una ráfaga de pasos: se pierde el tiempo, no los pasos
+    lastStepUs = (elapsed >= 2 * STEP_DELAY_US) ? now : lastStepUs + STEP_DELAY_US;
 
-    // 2) RIGHT DEEP_CLEAN_STEPS (volver al punto anterior)
-    stepSigned(DEEP_CLEAN_STEPS);
-    delay(150);
+    digitalWrite(pullPin, HIGH);
+    delayMicroseconds(STEP_PULSE_US);
+    digitalWrite(pullPin, LOW);
+    currentPosition += (moveTarget > currentPosition) ? 1 : -1;
 
-    // 3) Desactivar torque y pasar a INACTIVE (estado 1)
-    disableTorque();
-    currentState = INACTIVE;
+    if (currentPosition == moveTarget) stopMove();
+    return moving;
+}
 
-    // Serial.println("{\"device\":\"LITTERBOX\",\"action\":\"DEEP_CLEAN_COMPLETE\",\"state\":1,\"position\":" + String(currentPosition) + "}");
-    return true;
+void LitterboxStepperMotor::stopMove() {
+    if (moving) TRACE_EVENT(TRC_LITTER_STOP, currentPosition == moveTarget ? TRC_REASON_DONE : TRC_REASON_COMMAND);
+    moving = false;
+    SafetyInterlock::disarm(safetyChannel);
+}
+
+void LitterboxStepperMotor::releaseTorque() {
+    stopMove();
+    disableTorque();
 }
 
 int LitterboxStepperMotor::getState() const {
@@ -155,16 +190,16 @@ long LitterboxStepperMotor::getCurrentPosition() const {
 }
 
 String LitterboxStepperMotor::getStateString() const {
-    return (currentState == ACTIVE) ? "ACTIVE" : "INACTIVE";
+    return (currentState == ACTIVE) ? F("ACTIVE") : F("INACTIVE");
 }
 
 String LitterboxStepperMotor::getStatus() const {
-    String s = "{";
-    s += "\"device\":\"LITTERBOX\",";
-    s += "\"state\":\"" + getStateString() + "\",";
-    s += "\"torque\":" + String(isTorqueActive() ? "true" : "false") + ",";
-    s += "\"position\":" + String(getCurrentPosition());
-    s += "}";
+    String s = F("{");
+    s += F("\"device\":\"LITTERBOX\",");
+    s += F("\"state\":\""); s += getStateString(); s += F("\",");
+    s += F("\"torque\":"); s += (isTorqueActive() ? F("true") : F("false")); s += ',';
+    s += F("\"position\":"); s += String(getCurrentPosition());
+    s += F("}");
     return s;
 }
 
@@ -13,40 +13,56 @@ public:
     };
 
 private:
-    const char* actuatorId;
-    const char* deviceId;
+    const uint8_t dirPin;
+    const uint8_t enPin;
+    const uint8_t pullPin;
+    const uint8_t safetyChannel;    // SafetyChannel de su estación
+
+    const __FlashStringHelper* actuatorId;
+    const __FlashStringHelper* deviceId;
     bool motorEnabled;     // true = EN low (holding)
     bool motorReady;
     long currentPosition;  // contador de pasos (puede ser negativo)
     LitterboxState currentState;
 
-    static const int DIR_PIN = 15;
-    static const int EN_PIN  = 16;
-    static const int PULL_PIN = 17;
+    // Recorrido sin bloqueo (secuencia de limpieza)
+    bool moving;
+    long moveTarget;
+    unsigned long lastStepUs;
 
     static const unsigned long STEP_DELAY_US = 4000UL; // 1ms = velocidad moderada
+    static const unsigned long STEP_PULSE_US = 5;      // ancho mínimo del pulso PUL del TB6600 (2.2 µs) con margen
     static const int STEPS_PER_REVOLUTION = 1600;      // 200 * 8 = 1600 pasos/vuelta (con microstepping 1/8)
 
     // PARÁMETROS CALIBRADOS PARA NEMA 21 + TB6600
     static const int READY_STEPS = 480; // 40° izquierda (40° ÷ 0.225° = 178 pasos)
-    static const int NORMAL_CLEAN_STEPS = 1200; // 270° derecha (270° ÷ 0.225° = 1200 pasos)
-    static const int DEEP_CLEAN_STEPS = 450; // pasos para limpieza completa (izquierda)
-    // -------------------------------------
 
     bool enableTorque();
     bool disableTorque();
     void setDirection(bool clockwise);
-    void stepSigned(int signedSteps); // acepta + (RIGHT) o - (LEFT)
+    bool stepSigned(int signedSteps); // acepta + (RIGHT) o - (LEFT); false si no completó
 
 public:
-    LitterboxStepperMotor(const char* id = ACTUATOR_LITTERBOX_MOTOR_ID_1,
-                         const char* devId = DEVICE_ID_LITTERBOX);
+    static const int NORMAL_CLEAN_STEPS = 1200; // 270° derecha (270° ÷ 0.225° = 1200 pasos)
+    static const int DEEP_CLEAN_STEPS = 450; // pasos para limpieza completa (izquierda)
+    // -------------------------------------
+
+    LitterboxStepperMotor(const __FlashStringHelper* id = FPSTR(ACTUATOR_LITTERBOX_MOTOR_ID_1),
+                         const __FlashStringHelper* devId = FPSTR(DEVICE_ID_LITTERBOX),
+                         uint8_t dirPin = 15, uint8_t enPin = 16, uint8_t pullPin = 17, uint8_t unit = 0);
     bool initialize();
 
     // Operaciones (basadas en estados)
-    bool setReady();               // LTR1:2
-    bool executeNormalCleaning();  // LTR1:2.1
-    bool executeDeepCleaning();    // LTR1:2.2
+    bool setReady();               // LTR1:2 (LTR1:2.1 / 2.2 las secuencia LitterboxCleaningSequence)
+
+    // Recorrido sin bloqueo hasta una posición absoluta. beginMoveTo() activa
+    // el torque y arma el enclavamiento; serviceMove() se llama en cada loop y
+    // da a lo sumo un paso por llamada; stopMove() deja el motor frenado con torque.
+    bool beginMoveTo(long position);
+    bool serviceMove();            // true mientras falte recorrido
+    void stopMove();
+    bool isMoving() const { return moving; }
+    void releaseTorque();          // suelta el torque sin cambiar el estado lógico
 
     // Getters
     int getState() const;
@@ -55,6 +71,8 @@ public:
     long getCurrentPosition() const;
     String getStateString() const;
     String getStatus() const;
+    const __FlashStringHelper* getDeviceId() const { return deviceId; }
+    uint8_t getSafetyChannel() const { return safetyChannel; }
 
     // Emergencia / control externo
     void emergencyStop();          // desactiva torque y pone INACTIVE
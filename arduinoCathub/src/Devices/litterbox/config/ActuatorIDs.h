@@ -1 +1,10 @@
-#define ACTUATOR_LITTERBOX_MOTOR_ID_1   "LTMTR_001"
+#ifndef LITTERBOX_ACTUATOR_IDS_H
+#define LITTERBOX_ACTUATOR_IDS_H
+
+#include <Arduino.h>
+
+static const char ACTUATOR_LITTERBOX_MOTOR_ID_1[] PROGMEM = "LTMTR_001";
+static const char ACTUATOR_LITTERBOX_MOTOR_ID_2[] PROGMEM = "LTMTR_002";
+static const char ACTUATOR_LITTERBOX_MOTOR_ID_3[] PROGMEM = "LTMTR_003";
+
+#endif
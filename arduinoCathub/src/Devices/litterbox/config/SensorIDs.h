@@ -1,3 +1,17 @@
-#define SENSOR_ID_LITTER_ULTRA    "LUT_001"
-#define SENSOR_ID_LITTER_DHT      "DHT_001"
-#define SENSOR_ID_LITTER_MQ2      "MQ2_001"
\ No newline at end of file
+#ifndef LITTERBOX_SENSOR_IDS_H
+#define LITTERBOX_SENSOR_IDS_H
+
+#include <Arduino.h>
+
+static const char SENSOR_ID_LITTER_ULTRA[] PROGMEM = "LUT_001";
+static const char SENSOR_ID_LITTER_DHT[]   PROGMEM = "DHT_001";
+static const char SENSOR_ID_LITTER_MQ2[]   PROGMEM = "MQ2_001";
+
+static const char SENSOR_ID_LITTER_ULTRA_2[] PROGMEM = "LUT_002";
+static const char SENSOR_ID_LITTER_DHT_2[]   PROGMEM = "DHT_002";
+static const char SENSOR_ID_LITTER_MQ2_2[]   PROGMEM = "MQ2_002";
+static const char SENSOR_ID_LITTER_ULTRA_3[] PROGMEM = "LUT_003";
+static const char SENSOR_ID_LITTER_DHT_3[]   PROGMEM = "DHT_003";
+static const char SENSOR_ID_LITTER_MQ2_3[]   PROGMEM = "MQ2_003";
+
+#endif
@@ -1,10 +1,12 @@
 #include "LitterboxDHTSensor.h"
 #include <math.h>
 
-LitterboxDHTSensor::LitterboxDHTSensor(const char* id, const char* deviceId)
-    : sensorId(id),
+LitterboxDHTSensor::LitterboxDHTSensor(const __FlashStringHelper* id, const __FlashStringHelper* deviceId,
+                                       uint8_t dataPin)
+    : dataPin(dataPin),
+      sensorId(id),
       deviceId(deviceId),
-      dht(DATA_PIN, DHT_TYPE),
+      dht(dataPin, DHT_TYPE),
       lastTemperature(NAN),
       lastHumidity(NAN),
       lastReadTime(0),
@@ -39,20 +41,20 @@ bool LitterboxDHTSensor::initialize() {
     return false;
 }
 
-void LitterboxDHTSensor::update() {
-    if (!sensorReady) return;
+SensorReadResult LitterboxDHTSensor::update(bool singleShot) {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
 
     unsigned long now = millis();
-    if (now - lastReadTime < READ_INTERVAL) return;
+    if (now - lastReadTime < READ_INTERVAL) return SENSOR_READ_SKIPPED;
 
     // Intentar hasta N lecturas rápidas para evitar NAN transitorio
-    const int RETRIES = 3;
+    const int RETRIES = singleShot ? 1 : 3;
     float t = NAN, h = NAN;
     for (int i = 0; i < RETRIES; ++i) {
         t = dht.readTemperature();
         h = dht.readHumidity();
         if (!isnan(t) && !isnan(h)) break;
-        delay(200); // pequeño retardo entre reintentos
+        if (i + 1 < RETRIES) delay(200); // pequeño retardo entre reintentos
     }
 
     if (!isnan(t) && !isnan(h)) {
@@ -68,6 +70,10 @@ void LitterboxDHTSensor::update() {
     }
 
     lastReadTime = now;
+    if (!lastReadValid) return SENSOR_READ_TIMEOUT;
+    // Fuera de la hoja de datos (DHT22: -40..80 °C) suele ser un bit corrido en el bus
+    if (t < -40.0f || t > 80.0f || h < 0.0f || h > 100.0f) return SENSOR_READ_OUT_OF_RANGE;
+    return SENSOR_READ_OK;
 }
 
 float LitterboxDHTSensor::getTemperature() {
@@ -83,15 +89,15 @@ bool LitterboxDHTSensor::isReady() {
 }
 
 String LitterboxDHTSensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    if (!lastReadValid) return "READ_ERROR";
-    return "READY";
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    if (!lastReadValid) return F("READ_ERROR");
+    return F("READY");
 }
 
-const char* LitterboxDHTSensor::getSensorId() {
-    return sensorId ? sensorId : "UNCONFIGURED";
+const __FlashStringHelper* LitterboxDHTSensor::getSensorId() {
+    return sensorId ? sensorId : F("UNCONFIGURED");
 }
 
-const char* LitterboxDHTSensor::getDeviceId() {
-    return deviceId ? deviceId : "UNCONFIGURED";
+const __FlashStringHelper* LitterboxDHTSensor::getDeviceId() {
+    return deviceId ? deviceId : F("UNCONFIGURED");
 }
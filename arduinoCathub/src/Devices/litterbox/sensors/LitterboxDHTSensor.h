@@ -5,15 +5,16 @@
 #include <DHT.h>
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../common/SensorHealth.h"
 
 class LitterboxDHTSensor {
 private:
-    static const int DATA_PIN = 21;        // Pin digital para el sensor DHT
     static const int DHT_TYPE = DHT11;     // Cambia a DHT22 si usas ese
     static const unsigned long READ_INTERVAL = 2000; // 2s entre lecturas
 
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t dataPin;
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
 
     DHT dht;
     float lastTemperature;
@@ -23,16 +24,17 @@ private:
     bool lastReadValid;
 
 public:
-    LitterboxDHTSensor(const char* id = SENSOR_ID_LITTER_DHT,
-                       const char* deviceId = DEVICE_ID_LITTERBOX);
+    LitterboxDHTSensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_LITTER_DHT),
+                       const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_LITTERBOX),
+                       uint8_t dataPin = 21);
     bool initialize();
-    void update();
+    SensorReadResult update(bool singleShot = false);   // singleShot: sin reintentos (sonda de un canal degradado)
     float getTemperature();   // puede devolver NAN si no hay lectura válida
     float getHumidity();      // puede devolver NAN si no hay lectura válida
     bool isReady();           // si se pudo inicializar (sensor detectado)
     String getStatus();       // READY | NOT_INITIALIZED | READ_ERROR
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif
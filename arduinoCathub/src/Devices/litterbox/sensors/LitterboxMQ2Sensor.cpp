@@ -1,38 +1,58 @@
 #include "LitterboxMQ2Sensor.h"
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
-#include <math.h>
+#include "../../../state/ConfigStore.h"
+#include "MQ2CurveTable.h"
 
-LitterboxMQ2Sensor::LitterboxMQ2Sensor(const char* id, const char* deviceId,
+LitterboxMQ2Sensor::LitterboxMQ2Sensor(const __FlashStringHelper* id, const __FlashStringHelper* deviceId,
+                                       uint8_t analogPin_, uint8_t unit_,
                                        float vcc_, float rLoad_, float emaAlpha_) :
+    analogPin(analogPin_),
+    unit(unit_),
     sensorId(id),
     deviceId(deviceId),
     lastValue(0.0f),
     lastPPM(-1.0f),
     lastRs(0.0f),
     Ro(0.0f),
+    roQ16(0),
+    lastRsQ16(0),
     lastReadTime(0),
     sensorReady(false),
     vcc(vcc_),
     rLoad(rLoad_),
-    emaAlpha(emaAlpha_) {
+    rLoadQ16(q16FromFloat(rLoad_)),
+    emaAlpha(emaAlpha_),
+    adcEma(q16FromFloat(emaAlpha_)),
+    lastRoPersist(0) {
+}
+
+q16_t LitterboxMQ2Sensor::rsFromAdcQ16(q16_t adcQ16) const {
+    // Equivale a voltage > 0.001 V con Vcc = 5 V
+    static const q16_t MIN_ADC_Q16 = q16FromFloat(0.2046f);
+    if (adcQ16 <= MIN_ADC_Q16) return rLoadQ16;
+    return q16Div(q16Mul(rLoadQ16, q16FromInt(1023) - adcQ16), adcQ16);
 }
 
 bool LitterboxMQ2Sensor::initialize(bool autoCalibrate, int calSamples, unsigned long calDelayMs) {
-    int v = analogRead(ANALOG_PIN);
+    int v = analogRead(analogPin);
+    adcEma.prime(v);
     lastValue = (float)v;
-    float voltage = lastValue * (vcc / 1023.0f);
-
-    if (voltage > 0.001f) {
-        lastRs = (rLoad * (vcc - voltage) / voltage);
-    } else {
-        lastRs = rLoad;
-    }
+    lastRsQ16 = rsFromAdcQ16(adcEma.valueQ16());
+    lastRs = q16ToFloat(lastRsQ16);
 
     lastReadTime = millis();
     sensorReady = true;
     lastPPM = -1.0f; // no calibrado aún
 
+    // Ro guardado en EEPROM: evita la calibración bloqueante en cada arranque
+    ConfigStore& config = ConfigStore::getInstance();
+    if (config.hasFlag(ConfigStore::CONFIG_FLAG_MQ2_RO, unit)) {
+        setRo(config.getMq2Ro(unit));
+        baseline.seed(roQ16, CLEAN_AIR_FACTOR_Q16);
+        autoCalibrate = false;
+    }
+
     // Serial.println("{\"mq2\":\"INITIALIZED\",\"analog\":" + String((int)lastValue) + ",\"rs\":" + String(lastRs,3) + "}");
 
     if (autoCalibrate) {
@@ -42,38 +62,44 @@ bool LitterboxMQ2Sensor::initialize(bool autoCalibrate, int calSamples, unsigned
     return sensorReady;
 }
 
-void LitterboxMQ2Sensor::update() {
-    if (!sensorReady) return;
+SensorReadResult LitterboxMQ2Sensor::update() {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
     unsigned long now = millis();
-    if (now - lastReadTime < READ_INTERVAL) return;
+    if (now - lastReadTime < READ_INTERVAL) return SENSOR_READ_SKIPPED;
 
     const int SAMPLES = 5;
-    long sum = 0;
+    int32_t sum = 0;
     for (int i = 0; i < SAMPLES; ++i) {
-        sum += analogRead(ANALOG_PIN);
+        sum += analogRead(analogPin);
         delay(2);
     }
-    float avg = (float)sum / (float)SAMPLES;
-
-    // EMA smoothing
-    lastValue = (emaAlpha * avg) + ((1.0f - emaAlpha) * lastValue);
-
-    float voltage = lastValue * (vcc / 1023.0f);
-    if (voltage > 0.001f) {
-        lastRs = (rLoad * (vcc - voltage) / voltage);
-    } else {
-        lastRs = rLoad;
+    int32_t adc = (sum + SAMPLES / 2) / SAMPLES;
+
+    // EMA smoothing (entero; el estado Q16.16 conserva la fracción)
+    q16_t adcQ16 = adcEma.update(adc);
+    lastValue = q16ToFloat(adcQ16);
+    lastRsQ16 = rsFromAdcQ16(adcQ16);
+    lastRs = q16ToFloat(lastRsQ16);
+
+    // Rs normalizada a la condición de referencia: la envolvente y el PPM
+    // comparan contra el mismo Ro sin importar temperatura y humedad
+    const ConfigData& cfg = ConfigStore::getInstance().get();
+    q16_t rsCompQ16 = baseline.compensate(lastRsQ16);
+    if (cfg.mq2AutoCal != MQ2_AUTOCAL_OFF && baseline.update(rsCompQ16, CLEAN_AIR_FACTOR_Q16, now)) {
+        setRo(q16ToFloat(baseline.getRoQ16()));
+        if (cfg.mq2AutoCal == MQ2_AUTOCAL_PERSIST) persistTrackedRo(now);
     }
 
-    if (Ro > 0.0f) {
-        float ratio = lastRs / Ro;
-        lastPPM = analogToPPM_internal(ratio);
+    if (roQ16 > 0) {
+        lastPPM = ratioToPPM(q16Div(rsCompQ16, roQ16), (uint8_t)cfg.mq2Gas);
     } else {
         lastPPM = -1.0f; // no calibrado
     }
 
     // Serial.println("{\"mq2\":\"READ\",\"analog\":" + String((int)round(lastValue)) + ",\"rs\":" + String(lastRs,3) + ",\"ppm\":" + String(lastPPM,2) + "}");
     lastReadTime = now;
+    // Pegado a un riel: resistencia de carga abierta o sensor en corto
+    return (adc <= 0 || adc >= 1023) ? SENSOR_READ_OUT_OF_RANGE : SENSOR_READ_OK;
 }
 
 float LitterboxMQ2Sensor::getAnalog() {
@@ -89,45 +115,109 @@ bool LitterboxMQ2Sensor::isReady() {
 }
 
 String LitterboxMQ2Sensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    String s = "READY";
-    if (Ro <= 0.0f) s += "_UNCALIBRATED";
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    String s = F("READY");
+    if (Ro <= 0.0f) s += F("_UNCALIBRATED");
     return s;
 }
 
-const char* LitterboxMQ2Sensor::getSensorId() { return sensorId; }
-const char* LitterboxMQ2Sensor::getDeviceId() { return deviceId; }
+const __FlashStringHelper* LitterboxMQ2Sensor::getSensorId() { return sensorId; }
+const __FlashStringHelper* LitterboxMQ2Sensor::getDeviceId() { return deviceId; }
 
 void LitterboxMQ2Sensor::calibrateRo(int samples, unsigned long delayMs) {
-    double sumRs = 0.0;
+    if (samples <= 0) return;
+    // Parte entera y fracción en acumuladores de 32 bits separados (Rs >= 0):
+    // no desbordan con cualquier cantidad de muestras que entre en un int
+    uint32_t sumWhole = 0;
+    uint32_t sumFrac = 0;
     for (int i = 0; i < samples; ++i) {
-        int v = analogRead(ANALOG_PIN);
-        float voltage = v * (vcc / 1023.0f);
-        float rsTmp = (voltage > 0.001f) ? (rLoad * (vcc - voltage) / voltage) : rLoad;
-        sumRs += rsTmp;
+        int v = analogRead(analogPin);
+        q16_t rs = baseline.compensate(rsFromAdcQ16(q16FromInt(v)));
+        if (rs < 0) rs = 0;
+        sumWhole += (uint32_t)rs >> Q16_SHIFT;
+        sumFrac += (uint32_t)rs & 0xFFFFu;
         delay(delayMs);
     }
-    float avgRs = (float)(sumRs / samples);
-    Ro = avgRs / CLEAN_AIR_FACTOR;
+    uint32_t n = (uint32_t)samples;
+    uint32_t avgRsQ16 = ((sumWhole / n) << Q16_SHIFT) + ((sumWhole % n) << Q16_SHIFT) / n + sumFrac / n;
+    float avgRs = q16ToFloat((q16_t)avgRsQ16);
+    setRo(avgRs / CLEAN_AIR_FACTOR);
+    baseline.seed(roQ16, CLEAN_AIR_FACTOR_Q16);
+
+    ConfigStore& config = ConfigStore::getInstance();
+    config.setMq2Ro(Ro, unit);
+    config.save();
+    lastRoPersist = millis();
     // Serial.println("{\"mq2\":\"Ro_calibrated\",\"avgRs\":" + String(avgRs,3) + ",\"Ro\":" + String(Ro,3) + "}");
 }
 
+void LitterboxMQ2Sensor::setRo(float ro) {
+    Ro = ro;
+    roQ16 = (ro > 0.0f) ? q16FromFloat(ro) : 0;
+}
+
+// El Ro seguido se guarda sólo si se apartó más de un 2 % del guardado, y
+// como mucho cada RO_PERSIST_MS, para no gastar la EEPROM.
+void LitterboxMQ2Sensor::persistTrackedRo(unsigned long now) {
+    ConfigStore& config = ConfigStore::getInstance();
+    float stored = config.getMq2Ro(unit);
+    bool hasStored = config.hasFlag(ConfigStore::CONFIG_FLAG_MQ2_RO, unit) && stored > 0.0f;
+    if (hasStored && now - lastRoPersist < RO_PERSIST_MS) return;
+    if (hasStored && fabs(Ro - stored) < stored * 0.02f) return;
+
+    config.setMq2Ro(Ro, unit);
+    config.save();
+    lastRoPersist = now;
+}
+
+void LitterboxMQ2Sensor::setAmbient(float tempC, float humidity) {
+    baseline.setAmbient(tempC, humidity, millis());
+}
+
+void LitterboxMQ2Sensor::setCatNearby(bool nearby) {
+    baseline.setCatNearby(nearby, millis());
+}
+
+float LitterboxMQ2Sensor::getBaselineRs() const {
+    return q16ToFloat(baseline.getEnvelopeQ16());
+}
+
 float LitterboxMQ2Sensor::getRo() const { return Ro; }
 float LitterboxMQ2Sensor::getRs() const { return lastRs; }
 float LitterboxMQ2Sensor::getRatioRSRo() const {
     if (Ro <= 0.0f) return -1.0f;
-    return lastRs / Ro;
+    return q16ToFloat(baseline.compensate(lastRsQ16)) / Ro;
 }
 bool LitterboxMQ2Sensor::isGasHigh(float ppmThreshold) {
     if (lastPPM < 0) return false;
     return lastPPM >= ppmThreshold;
 }
-float LitterboxMQ2Sensor::analogToPPM_internal(float ratio_rs_ro) {
-    if (ratio_rs_ro <= 0.0f) return -1.0f;
-    const float C = 20.0f;
-    const float EXP = -2.2f;
-    float ppm = C * pow(ratio_rs_ro, EXP);
-    if (ppm < 0.0f) ppm = 0.0f;
-    if (ppm > 10000.0f) ppm = 10000.0f;
-    return ppm;
+// Búsqueda binaria del tramo [r_i, r_i+1) en la tabla de Rs/Ro (log-espaciada)
+// e interpolación lineal del PPM. Fuera de rango se satura a los extremos.
+float LitterboxMQ2Sensor::ratioToPPM(q16_t ratioQ16, uint8_t gas) {
+    if (ratioQ16 <= 0) return -1.0f;
+    if (gas >= MQ2_GAS_COUNT) gas = MQ2_GAS_NH3;
+
+    const uint32_t ratio = (uint32_t)ratioQ16;
+    if (ratio <= pgm_read_dword(&MQ2_RATIO_Q16[0])) {
+        return (float)pgm_read_dword(&MQ2_PPM_Q8[gas][0]) / 256.0f;
+    }
+    if (ratio >= pgm_read_dword(&MQ2_RATIO_Q16[MQ2_LUT_SIZE - 1])) {
+        return (float)pgm_read_dword(&MQ2_PPM_Q8[gas][MQ2_LUT_SIZE - 1]) / 256.0f;
+    }
+
+    uint8_t lo = 0, hi = MQ2_LUT_SIZE - 1;
+    while (hi - lo > 1) {
+        uint8_t mid = (uint8_t)((lo + hi) / 2);
+        if (pgm_read_dword(&MQ2_RATIO_Q16[mid]) <= ratio) lo = mid;
+        else hi = mid;
+    }
+
+    // Pendiente del tramo precalculada en la tabla: un q16Mul en vez de la
+    // división de 64 bits (una llamada a libgcc en el AVR)
+    int32_t r0 = (int32_t)pgm_read_dword(&MQ2_RATIO_Q16[lo]);
+    int32_t p0 = (int32_t)pgm_read_dword(&MQ2_PPM_Q8[gas][lo]);
+    q16_t slope = (q16_t)pgm_read_dword(&MQ2_SLOPE_Q16[gas][lo]);
+    int32_t ppmQ8 = p0 + q16Mul(slope, (int32_t)ratio - r0);
+    return (float)ppmQ8 / 256.0f;
 }
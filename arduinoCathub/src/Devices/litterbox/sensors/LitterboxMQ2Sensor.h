@@ -4,47 +4,68 @@
 #include <Arduino.h>
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../../filters/SignalFilters.h"
+#include "MQ2BaselineTracker.h"
+#include "../../common/SensorHealth.h"
 
 class LitterboxMQ2Sensor {
 private:
-    static const int ANALOG_PIN = A0;
-    static const unsigned long READ_INTERVAL = 500; // ms
+    static const unsigned long READ_INTERVAL = 250; // ms mínimos; el ritmo real lo da SensorManager
+    static const unsigned long RO_PERSIST_MS = 21600000UL; // Ro aprendido a EEPROM cada 6 h como mucho
 
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t analogPin;
+    const uint8_t unit;     // estación: índice del Ro en ConfigStore
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
 
     float lastValue;        // Promedio crudo (0..1023)
     float lastPPM;          // Valor convertido a PPM (aprox)
     float lastRs;           // Resistencia calculada (kΩ)
     float Ro;               // Resistencia en aire limpio (kΩ) -> calibrar!
+    q16_t roQ16;
+    q16_t lastRsQ16;
     unsigned long lastReadTime;
     bool sensorReady;
 
     // Parámetros hardware
     float vcc;              // Voltaje de referencia (5.0 o 3.3)
     float rLoad;            // resistencia de carga en kOhm (ej: 10k -> 10.0)
+    q16_t rLoadQ16;
 
-    // Suavizado (EMA)
+    // Suavizado (EMA en punto fijo sobre cuentas ADC)
     float emaAlpha;
+    EmaFilter adcEma;
+
+    // Línea base de aire limpio en segundo plano (deriva de Ro)
+    MQ2BaselineTracker baseline;
+    unsigned long lastRoPersist;
+
+    // Rs (kΩ) a partir de cuentas ADC en Q16.16: Rs = RL * (1023 - adc) / adc
+    // (vcc se cancela, así que no hace falta pasar por voltios)
+    q16_t rsFromAdcQ16(q16_t adcQ16) const;
 
     // Factor de aire limpio (Rs/Ro en aire limpio) — valor orientativo
     static constexpr float CLEAN_AIR_FACTOR = 9.83f;
+    static const q16_t CLEAN_AIR_FACTOR_Q16 = q16FromFloat(CLEAN_AIR_FACTOR);
 
-    // Conversión analógica -> PPM (aproximada). Ver .cpp para notas.
-    float analogToPPM_internal(float ratio_rs_ro);
+    // Conversión Rs/Ro -> PPM por tabla (MQ2CurveTable.h, generada en build)
+    static float ratioToPPM(q16_t ratioQ16, uint8_t gas);
+    void setRo(float ro);
+    void persistTrackedRo(unsigned long now);
 
 public:
-    LitterboxMQ2Sensor(const char* id = SENSOR_ID_LITTER_MQ2,
-                       const char* deviceId = DEVICE_ID_LITTERBOX,
+    LitterboxMQ2Sensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_LITTER_MQ2),
+                       const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_LITTERBOX),
+                       uint8_t analogPin = A0, uint8_t unit = 0,
                        float vcc = 5.0, float rLoad = 10.0, float emaAlpha = 0.2f);
     bool initialize(bool autoCalibrate = false, int calSamples = 50, unsigned long calDelayMs = 50);
-    void update();
+    SensorReadResult update();
     float getAnalog();       // 0..1023 (promediado)
     float getPPM();          // PPM aproximado
     bool isReady();
     String getStatus();
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 
     // Métodos utilitarios:
     void calibrateRo(int samples = 50, unsigned long delayMs = 50); // calibrar Ro en aire limpio
@@ -52,6 +73,11 @@ public:
     float getRs() const;     // Rs actual (kΩ)
     float getRatioRSRo() const; // Rs / Ro
     bool isGasHigh(float ppmThreshold); // helper
+
+    // Contexto para el seguimiento de la línea base
+    void setAmbient(float tempC, float humidity);   // DHT del arenero
+    void setCatNearby(bool nearby);                 // presencia en el arenero
+    float getBaselineRs() const;                    // envolvente de aire limpio (kΩ)
 };
 
 #endif
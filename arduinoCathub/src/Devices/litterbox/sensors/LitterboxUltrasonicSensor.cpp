@@ -1,9 +1,15 @@
 #include "LitterboxUltrasonicSensor.h"
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
-
-LitterboxUltrasonicSensor::LitterboxUltrasonicSensor(const char* id, const char* deviceId)
-    : sensorId(id),
+#include "../../common/UltrasonicRanging.h"
+#include "../../../system/SafetyInterlock.h"
+
+LitterboxUltrasonicSensor::LitterboxUltrasonicSensor(const __FlashStringHelper* id, const __FlashStringHelper* deviceId,
+                                                     uint8_t trigPin, uint8_t echoPin, uint8_t unit)
+    : trigPin(trigPin),
+      echoPin(echoPin),
+      safetyChannel(safetyChannelFor(SAFETY_LITTERBOX, unit)),
+      sensorId(id),
       deviceId(deviceId),
       lastDistance(-1.0f),   // -1 indica "sin lectura válida aún"
       lastReadTime(0),
@@ -11,20 +17,15 @@ LitterboxUltrasonicSensor::LitterboxUltrasonicSensor(const char* id, const char*
 }
 
 bool LitterboxUltrasonicSensor::initialize() {
-    pinMode(TRIG_PIN, OUTPUT);
-    pinMode(ECHO_PIN, INPUT);
+    pinMode(trigPin, OUTPUT);
+    pinMode(echoPin, INPUT);
+    SafetyInterlock::attachRanger(safetyChannel, trigPin, echoPin);
 
     // Test de pulso
-    digitalWrite(TRIG_PIN, LOW);
-    delayMicroseconds(2);
-    digitalWrite(TRIG_PIN, HIGH);
-    delayMicroseconds(10);
-    digitalWrite(TRIG_PIN, LOW);
-
-    long duration = pulseIn(ECHO_PIN, HIGH, TIMEOUT_US);
+    long duration = UltrasonicRanging::measureEcho(trigPin, echoPin, TIMEOUT_US);
     if (duration > 0) {
         sensorReady = true;
-        lastDistance = (duration * 0.034) / 2.0;
+        lastDistance = UltrasonicRanging::echoToCm(duration);
         lastReadTime = millis();
         // Serial.println("{\"ultrasonic\":\"INITIALIZED\",\"distance_cm\":" + String(lastDistance) + "}");
         return true;
@@ -35,28 +36,25 @@ bool LitterboxUltrasonicSensor::initialize() {
     return false;
 }
 
-void LitterboxUltrasonicSensor::update() {
-    if (!sensorReady) return;
+SensorReadResult LitterboxUltrasonicSensor::update() {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
+    // Con el motor en marcha el enclavamiento dispara sus propios pings
+    if (SafetyInterlock::ownsRanger(safetyChannel)) return SENSOR_READ_SKIPPED;
 
     unsigned long now = millis();
-    if (now - lastReadTime >= READ_INTERVAL) {
-        // Trigger pulse
-        digitalWrite(TRIG_PIN, LOW);
-        delayMicroseconds(2);
-        digitalWrite(TRIG_PIN, HIGH);
-        delayMicroseconds(10);
-        digitalWrite(TRIG_PIN, LOW);
-
-        long duration = pulseIn(ECHO_PIN, HIGH, TIMEOUT_US);
-        if (duration > 0) {
-            lastDistance = (duration * 0.034) / 2.0;
-        } else {
-            // No eco: mantenemos la última lectura válida (puedes elegir setear -1.0 si prefieres)
-            // lastDistance = -1.0f;
-        }
+    if (now - lastReadTime < READ_INTERVAL) return SENSOR_READ_SKIPPED;
 
-        lastReadTime = now;
+    long duration = UltrasonicRanging::measureEcho(trigPin, echoPin, TIMEOUT_US);
+    float cm = UltrasonicRanging::echoToCm(duration);
+    if (duration > 0) {
+        lastDistance = cm;
+    } else {
+        // No eco: mantenemos la última lectura válida (puedes elegir setear -1.0 si prefieres)
+        // lastDistance = -1.0f;
     }
+
+    lastReadTime = now;
+    return UltrasonicRanging::classifyCm(cm);
 }
 
 float LitterboxUltrasonicSensor::getDistance() {
@@ -68,22 +66,14 @@ bool LitterboxUltrasonicSensor::isReady() {
 }
 
 String LitterboxUltrasonicSensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    return "READY";
-}
-
-bool LitterboxUltrasonicSensor::isObjectDetected() {
-    return sensorReady && lastDistance > 0.0f && lastDistance <= DETECTION_THRESHOLD_CM;
-}
-
-bool LitterboxUltrasonicSensor::isCatBlocking() {
-    return sensorReady && lastDistance > 0.0f && lastDistance <= BLOCK_THRESHOLD_CM;
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    return F("READY");
 }
 
-const char* LitterboxUltrasonicSensor::getSensorId() {
-    return sensorId ? sensorId : "UNCONFIGURED";
+const __FlashStringHelper* LitterboxUltrasonicSensor::getSensorId() {
+    return sensorId ? sensorId : F("UNCONFIGURED");
 }
 
-const char* LitterboxUltrasonicSensor::getDeviceId() {
-    return deviceId ? deviceId : "UNCONFIGURED";
+const __FlashStringHelper* LitterboxUltrasonicSensor::getDeviceId() {
+    return deviceId ? deviceId : F("UNCONFIGURED");
 }
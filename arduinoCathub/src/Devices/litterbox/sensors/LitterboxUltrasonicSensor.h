@@ -4,40 +4,36 @@
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
 #include <Arduino.h>
+#include "../../common/SensorHealth.h"
 
 class LitterboxUltrasonicSensor {
 private:
-    static const int TRIG_PIN = 10;
-    static const int ECHO_PIN = 11;
-    static const unsigned long READ_INTERVAL = 100; // ms entre lecturas
+    static const unsigned long READ_INTERVAL = 60;  // ms mínimos entre pings (eco residual)
     static const long TIMEOUT_US = 30000;           // timeout para pulseIn en microsegundos
 
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t trigPin;
+    const uint8_t echoPin;       // con PCINT0 para el enclavamiento
+    const uint8_t safetyChannel; // SafetyChannel del motor de su estación
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
 
     float lastDistance;
     unsigned long lastReadTime;
     bool sensorReady;
 
-    // Umbrales
-    static constexpr float DETECTION_THRESHOLD_CM = 10.0f; // presencia general
-    static constexpr float BLOCK_THRESHOLD_CM     = 3.0f; // bloqueo (gato dentro)
-
 public:
-    LitterboxUltrasonicSensor(const char* id = SENSOR_ID_LITTER_ULTRA,
-                              const char* deviceId = DEVICE_ID_LITTERBOX);
+    LitterboxUltrasonicSensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_LITTER_ULTRA),
+                              const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_LITTERBOX),
+                              uint8_t trigPin = 10, uint8_t echoPin = 11, uint8_t unit = 0);
     bool initialize();
-    void update();
+    SensorReadResult update();
     float getDistance();
     bool isReady();
     String getStatus();
+    // La presencia del gato se decide en PresenceEngine (umbral en ConfigStore)
 
-    // Métodos útiles
-    bool isObjectDetected();   // <= DETECTION_THRESHOLD_CM
-    bool isCatBlocking();      // <= BLOCK_THRESHOLD_CM
-
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif // LITTERBOX_ULTRASONIC_SENSOR_H
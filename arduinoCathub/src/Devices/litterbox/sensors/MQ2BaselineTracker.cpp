@@ -0,0 +1,82 @@
+// MQ2BaselineTracker.cpp
+#include "MQ2BaselineTracker.h"
+
+// Pendientes de Rs/Rs(20 °C, 33 %RH) leídas de la hoja de datos del MQ2
+static const float COMP_PER_DEG_C = -0.0133f;
+static const float COMP_PER_RH = -0.0020f;
+static const float COMP_REF_TEMP = 20.0f;
+static const float COMP_REF_RH = 33.0f;
+
+MQ2BaselineTracker::MQ2BaselineTracker()
+    : envelopeQ16(0), roQ16(0), compQ16(Q16_ONE), compTemp(NAN), compHum(NAN),
+      rhRef(NAN), rhRefTime(0), quietAfter(WARMUP_MS), quietSince(0),
+      catNearby(false), quiet(false) {}
+
+void MQ2BaselineTracker::seed(q16_t ro, q16_t cleanAirFactorQ16) {
+    roQ16 = ro;
+    envelopeQ16 = (ro > 0) ? q16Mul(ro, cleanAirFactorQ16) : 0;
+    quietSince = millis();
+}
+
+// Extiende la espera (nunca la acorta)
+void MQ2BaselineTracker::holdUntil(unsigned long t) {
+    if ((long)(t - quietAfter) > 0) quietAfter = t;
+}
+
+void MQ2BaselineTracker::setAmbient(float tempC, float humidity, unsigned long now) {
+    if (isnan(tempC) || isnan(humidity)) return;
+
+    // Salto de humedad dentro de la ventana: el MQ2 reacciona al vapor de agua
+    if (isnan(rhRef)) {
+        rhRef = humidity;
+        rhRefTime = now;
+    } else if (now - rhRefTime >= RH_WINDOW_MS) {
+        if (fabs(humidity - rhRef) >= RH_JUMP) holdUntil(now + RH_HOLD_MS);
+        rhRef = humidity;
+        rhRefTime = now;
+    }
+
+    // Recalcular el factor sólo si el ambiente cambió de verdad
+    if (!isnan(compTemp) && fabs(tempC - compTemp) < 0.5f && fabs(humidity - compHum) < 1.0f) return;
+    compTemp = tempC;
+    compHum = humidity;
+    float k = 1.0f + COMP_PER_DEG_C * (tempC - COMP_REF_TEMP) + COMP_PER_RH * (humidity - COMP_REF_RH);
+    k = constrain(k, 0.5f, 2.0f);
+    compQ16 = q16FromFloat(1.0f / k);
+}
+
+void MQ2BaselineTracker::setCatNearby(bool nearby, unsigned long now) {
+    catNearby = nearby;
+    if (nearby) holdUntil(now + AFTER_CAT_MS);
+}
+
+bool MQ2BaselineTracker::update(q16_t rsCompQ16, q16_t cleanAirFactorQ16, unsigned long now) {
+    bool wasQuiet = quiet;
+    quiet = !catNearby && (long)(now - quietAfter) >= 0;
+    if (!quiet || rsCompQ16 <= 0) return false;
+    if (!wasQuiet) quietSince = now;
+
+    // Envolvente superior: ataque rápido, decaimiento muy lento
+    if (envelopeQ16 <= 0) {
+        envelopeQ16 = rsCompQ16;
+    } else if (rsCompQ16 > envelopeQ16) {
+        envelopeQ16 += (rsCompQ16 - envelopeQ16) >> ATTACK_SHIFT;
+    } else {
+        envelopeQ16 -= envelopeQ16 >> DECAY_SHIFT;
+    }
+
+    if (now - quietSince < ROLL_MS) return false;
+    quietSince = now;
+
+    q16_t target = q16Div(envelopeQ16, cleanAirFactorQ16);
+    if (roQ16 <= 0) {
+        roQ16 = target;   // sensor sin calibrar: primera estimación tras ROLL_MS de calma
+        return true;
+    }
+    q16_t step = (target - roQ16) / (1 << RO_STEP_SHIFT);
+    q16_t maxStep = roQ16 >> RO_MAX_STEP_SHIFT;
+    step = constrain(step, -maxStep, maxStep);
+    if (step == 0) return false;
+    roQ16 += step;
+    return true;
+}
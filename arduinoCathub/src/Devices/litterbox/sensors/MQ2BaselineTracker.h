@@ -0,0 +1,73 @@
+// MQ2BaselineTracker.h
+#ifndef MQ2_BASELINE_TRACKER_H
+#define MQ2_BASELINE_TRACKER_H
+
+#include <Arduino.h>
+#include "../../../filters/FixedPoint.h"
+
+enum MQ2AutoCalMode : uint8_t {
+    MQ2_AUTOCAL_OFF,       // Ro fijo (EEPROM o CAL_MQ2)
+    MQ2_AUTOCAL_TRACK,     // Ro sigue la línea base sólo en RAM
+    MQ2_AUTOCAL_PERSIST    // además se guarda en EEPROM de vez en cuando
+};
+
+// Seguimiento en segundo plano de la línea base del MQ2. El gas BAJA la Rs,
+// así que el aire limpio es la envolvente superior de Rs: sube rápido hacia
+// lecturas más altas y decae muy despacio (~18 h) para seguir la deriva por
+// envejecimiento. Sólo se alimenta en periodos "tranquilos": sin gato en el
+// arenero (ni olor reciente) y sin saltos de humedad. Cada ROLL_MS de calma
+// acerca Ro a envolvente / CLEAN_AIR_FACTOR con pasos acotados.
+// Rs se normaliza a 20 °C / 33 %RH (referencia de la hoja de datos, curva
+// aproximada lineal) antes de entrar; la misma corrección se aplica a la
+// relación Rs/Ro con la que se calcula el PPM.
+class MQ2BaselineTracker {
+private:
+    static const unsigned long WARMUP_MS = 600000UL;      // precalentado del calefactor (10 min)
+    static const unsigned long AFTER_CAT_MS = 900000UL;   // olor residual tras una visita (15 min)
+    static const unsigned long RH_WINDOW_MS = 60000UL;    // ventana para medir cambios de humedad
+    static const unsigned long RH_HOLD_MS = 300000UL;     // calma exigida tras un salto de humedad
+    static const unsigned long ROLL_MS = 600000UL;        // cada cuánto se corrige Ro (10 min)
+    static constexpr float RH_JUMP = 3.0f;                // %RH por ventana que cuenta como salto
+    // En calma el MQ2 se muestrea cada 1 s (ritmo de reposo de SensorManager)
+    static const uint8_t ATTACK_SHIFT = 5;                // subida: 1/32 por muestra (~30 s)
+    static const uint8_t DECAY_SHIFT = 16;                // bajada: 1/65536 por muestra (~18 h)
+    static const uint8_t RO_STEP_SHIFT = 3;               // Ro avanza 1/8 hacia el objetivo...
+    static const uint8_t RO_MAX_STEP_SHIFT = 6;           // ...y nunca más de ~1.5 % por corrección
+
+    q16_t envelopeQ16;         // Rs de aire limpio compensada (kΩ), 0 = sin semilla
+    q16_t roQ16;
+    q16_t compQ16;             // 1 / k(T, RH), multiplica a Rs
+    float compTemp;
+    float compHum;
+
+    float rhRef;               // humedad al inicio de la ventana actual
+    unsigned long rhRefTime;
+    unsigned long quietAfter;        // no hay calma antes de este instante
+    unsigned long quietSince;        // inicio del tramo de calma que cuenta para ROLL_MS
+    bool catNearby;
+    bool quiet;
+
+    void holdUntil(unsigned long t);
+
+public:
+    MQ2BaselineTracker();
+
+    // Ro conocido (EEPROM o calibración manual): siembra la envolvente
+    void seed(q16_t roQ16, q16_t cleanAirFactorQ16);
+
+    // Temperatura/humedad del DHT (NAN = sin dato, no compensa)
+    void setAmbient(float tempC, float humidity, unsigned long now);
+    void setCatNearby(bool nearby, unsigned long now);
+
+    // Rs sin compensar -> Rs normalizada a 20 °C / 33 %RH
+    q16_t compensate(q16_t rsQ16) const { return q16Mul(rsQ16, compQ16); }
+
+    // Una muestra de Rs compensada; true si Ro cambió
+    bool update(q16_t rsCompQ16, q16_t cleanAirFactorQ16, unsigned long now);
+
+    q16_t getRoQ16() const { return roQ16; }
+    q16_t getEnvelopeQ16() const { return envelopeQ16; }
+    bool isQuiet() const { return quiet; }
+};
+
+#endif
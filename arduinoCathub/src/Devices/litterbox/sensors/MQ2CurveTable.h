@@ -0,0 +1,117 @@
+// MQ2CurveTable.h
+// GENERADO por scripts/gen_mq2_lut.py - no editar a mano.
+// Rs/Ro en Q16.16 (espaciado logarítmico) y PPM en Q8 (ppm * 256) por gas.
+// Pendiente de cada tramo en Q16.16: PPM Q8 por unidad de Rs/Ro Q16.16.
+#ifndef MQ2_CURVE_TABLE_H
+#define MQ2_CURVE_TABLE_H
+
+#include <Arduino.h>
+
+enum MQ2Gas : uint8_t {
+    MQ2_GAS_NH3,     // ppm = 20.0 * ratio^-2.2
+    MQ2_GAS_LPG,     // ppm = 574.25 * ratio^-2.222
+    MQ2_GAS_CH4,     // ppm = 4303.4 * ratio^-2.38
+    MQ2_GAS_SMOKE,   // ppm = 3616.1 * ratio^-2.675
+    MQ2_GAS_COUNT
+};
+
+static const uint8_t MQ2_LUT_SIZE = 64;
+
+static const uint32_t MQ2_RATIO_Q16[MQ2_LUT_SIZE] PROGMEM = {
+    6554, 7103, 7699, 8345, 9045, 9804, 10627, 11518,
+    12484, 13532, 14667, 15897, 17231, 18677, 20243, 21942,
+    23782, 25778, 27940, 30284, 32825, 35578, 38563, 41798,
+    45305, 49106, 53225, 57690, 62530, 67776, 73462, 79625,
+    86304, 93545, 101392, 109898, 119118, 129111, 139942, 151682,
+    164407, 178200, 193149, 209353, 226916, 245953, 266586, 288950,
+    313191, 339465, 367944, 398811, 432268, 468532, 507839, 550442,
+    596620, 646672, 700922, 759724, 823459, 892540, 967417, 1048576,
+};
+
+static const uint32_t MQ2_PPM_Q8[MQ2_GAS_COUNT][MQ2_LUT_SIZE] PROGMEM = {
+    { // MQ2_GAS_NH3
+        811465, 679674, 569287, 476828, 399386, 334521, 280191, 234685,
+        196569, 164644, 137904, 115507, 96747, 81034, 67873, 56850,
+        47617, 39883, 33406, 27980, 23436, 19630, 16442, 13771,
+        11535, 9661, 8092, 6778, 5677, 4755, 3983, 3336,
+        2794, 2340, 1960, 1642, 1375, 1152, 965, 808,
+        677, 567, 475, 398, 333, 279, 234, 196,
+        164, 137, 115, 96, 81, 68, 57, 47,
+        40, 33, 28, 23, 20, 16, 14, 11,
+    },
+    { // MQ2_GAS_LPG
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2560000, 2560000, 2560000, 2560000, 2391853, 1999841, 1672078,
+        1398034, 1168903, 977326, 817148, 683222, 571245, 477621, 399342,
+        333892, 279169, 233415, 195159, 163174, 136430, 114070, 95375,
+        79743, 66674, 55746, 46610, 38971, 32584, 27243, 22778,
+        19045, 15924, 13314, 11132, 9307, 7782, 6507, 5440,
+        4549, 3803, 3180, 2659, 2223, 1859, 1554, 1299,
+        1086, 908, 759, 635, 531, 444, 371, 310,
+    },
+    { // MQ2_GAS_CH4
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2189691, 1807657, 1492276, 1231920, 1016988, 839555, 693078,
+        572157, 472334, 389926, 321896, 265735, 219372, 181099, 149502,
+        123419, 101886, 84110, 69435, 57321, 47320, 39064, 32249,
+        26622, 21978, 18143, 14978, 12365, 10207, 8426, 6956,
+        5743, 4741, 3914, 3231, 2667, 2202, 1818, 1501,
+    },
+    { // MQ2_GAS_SMOKE
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000, 2560000,
+        2485291, 2003501, 1615109, 1302010, 1049607, 846134, 682105, 549875,
+        443278, 357346, 288072, 232227, 187209, 150917, 121661, 98076,
+        79063, 63736, 51381, 41420, 33391, 26918, 21699, 17493,
+        14102, 11368, 9164, 7388, 5956, 4801, 3870, 3120,
+        2515, 2028, 1635, 1318, 1062, 856, 690, 556,
+    },
+};
+
+static const int32_t MQ2_SLOPE_Q16[MQ2_GAS_COUNT][MQ2_LUT_SIZE - 1] PROGMEM = {
+    { // MQ2_GAS_NH3
+        -15732341, -12138125, -9379865, -7250341, -5600781, -4326332, -3347117, -2585890,
+        -1996409, -1543994, -1193341, -921631, -712149, -550779, -425193, -328855,
+        -253936, -196335, -151706, -117196, -90603, -69993, -54110, -41785,
+        -32311, -24964, -19287, -14908, -11518, -8898, -6880, -5318,
+        -4109, -3174, -2450, -1898, -1462, -1131, -876, -675,
+        -523, -403, -311, -243, -186, -143, -111, -87,
+        -67, -51, -40, -29, -23, -18, -15, -10,
+        -9, -6, -6, -3, -4, -2, -2,
+    },
+    { // MQ2_GAS_LPG
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, -7620803, -16405427, -12642893, -9760732,
+        -7523211, -5807211, -4478424, -3454142, -2665646, -2055525, -1585809, -1223077,
+        -943522, -727976, -561511, -433093, -334101, -257718, -198799, -153385,
+        -118283, -91268, -70390, -54298, -41887, -32317, -24925, -19226,
+        -14829, -11442, -8825, -6810, -5250, -4050, -3127, -2409,
+        -1861, -1434, -1106, -854, -658, -509, -392, -302,
+        -233, -180, -138, -107, -83, -64, -49,
+    },
+    { // MQ2_GAS_CH4
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        -6384786, -6078412, -4629073, -3525349, -2685052, -2045067, -1557605, -1186507,
+        -903466, -688249, -524149, -399194, -304057, -231582, -176383, -134332,
+        -102312, -77929, -59352, -45203, -34429, -26223, -19971, -15213,
+        -11584, -8825, -6720, -5118, -3900, -2969, -2261, -1721,
+        -1312, -999, -761, -580, -441, -336, -256,
+    },
+    { // MQ2_GAS_SMOKE
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, -1396102,
+        -8306916, -6179572, -4595578, -3417662, -2541900, -1890574, -1406105, -1045956,
+        -777743, -578558, -430268, -319989, -238010, -177022, -131658, -97920,
+        -72825, -54164, -40287, -29960, -22284, -16577, -12325, -9168,
+        -6819, -5072, -3771, -2805, -2087, -1552, -1154, -859,
+        -638, -475, -353, -263, -195, -145, -108,
+    },
+};
+
+#endif // MQ2_CURVE_TABLE_H
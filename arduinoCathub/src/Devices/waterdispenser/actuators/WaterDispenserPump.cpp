@@ -1,16 +1,21 @@
 // WaterDispenserPump.cpp
 #include "WaterDispenserPump.h"
+#include "../../../state/ConfigStore.h"
+#include "../../../system/SafetyInterlock.h"
+#include "../../../system/TraceBuffer.h"
 
-WaterDispenserPump::WaterDispenserPump(const char* id, const char* devId) : 
-    actuatorId(id), deviceId(devId), pumpEnabled(true), pumpRunning(false), pumpReady(false),
+WaterDispenserPump::WaterDispenserPump(const __FlashStringHelper* id, const __FlashStringHelper* devId,
+                                       uint8_t pumpPin, uint8_t unit) :
+    pumpPin(pumpPin), unit(unit), safetyChannel(safetyChannelFor(SAFETY_WATER, unit)), actuatorId(id), deviceId(devId), pumpEnabled(true), pumpRunning(false), pumpReady(false),
     pumpStartTime(0), pumpDuration(0), currentPower(PUMP_POWER) {}
 
 bool WaterDispenserPump::initialize() {
-    pinMode(PUMP_PIN, OUTPUT);
-    digitalWrite(PUMP_PIN, LOW);  // 🔥 Cambiar analogWrite por digitalWrite
+    pinMode(pumpPin, OUTPUT);
+    digitalWrite(pumpPin, LOW);  // 🔥 Cambiar analogWrite por digitalWrite
+    SafetyInterlock::attachOutput(safetyChannel, pumpPin, false);   // LOW = apagada
     pumpReady = true;
     pumpRunning = false;
-    // Serial.print("{\"pump_init\":\"SUCCESS\",\"pin\":" + String(PUMP_PIN) + ",\"mode\":\"DIGITAL\"}");
+    // Serial.print("{\"pump_init\":\"SUCCESS\",\"pin\":" + String(pumpPin) + ",\"mode\":\"DIGITAL\"}");
     return true;
 }
 
@@ -20,33 +25,47 @@ void WaterDispenserPump::turnOn(unsigned long duration) {
         return;
     }
     
-    if (duration > MAX_PUMP_TIME) {
-        duration = MAX_PUMP_TIME;
+    unsigned long maxPumpTime = ConfigStore::getInstance().getUnit(unit).pumpMaxMs;
+    if (duration > maxPumpTime) {
+        duration = maxPumpTime;
     }
     
+    // Enclavada por el IR: no arranca hasta que se libere
+    if (!SafetyInterlock::arm(safetyChannel)) return;
+
     pumpDuration = duration;
     pumpStartTime = millis();
     pumpRunning = true;
-    digitalWrite(PUMP_PIN, HIGH);  // 🔥 Cambiar analogWrite por digitalWrite HIGH
-    
-    // Serial.print("{\"pump_action\":\"TURNED_ON\",\"pin\":" + String(PUMP_PIN) + 
-                   // ",\"duration_ms\":" + String(duration) + ",\"digital_state\":\"HIGH\"}");
+    digitalWrite(pumpPin, HIGH);  // 🔥 Cambiar analogWrite por digitalWrite HIGH
+    TRACE_EVENT(TRC_PUMP_ON, duration > 0xFFFFUL ? 0xFFFFUL : duration);
+    if (SafetyInterlock::isLatched(safetyChannel)) {
+        turnOff();   // el ISR disparó entre el armado y el encendido
+        return;
+    }
 }
 
 void WaterDispenserPump::turnOff() {
-    digitalWrite(PUMP_PIN, LOW);  // 🔥 Cambiar analogWrite por digitalWrite LOW
+    digitalWrite(pumpPin, LOW);  // 🔥 Cambiar analogWrite por digitalWrite LOW
+#if defined(CATHUB_TRACE)
+    if (pumpRunning) {
+        // Quién la apagó: el enclavamiento, el fin de la duración o un comando
+        uint8_t reason = TRC_REASON_COMMAND;
+        if (SafetyInterlock::isLatched(safetyChannel)) reason = TRC_REASON_INTERLOCK;
+        else if (pumpDuration > 0 && millis() - pumpStartTime >= pumpDuration) reason = TRC_REASON_DONE;
+        TRACE_EVENT(TRC_PUMP_OFF, reason);
+    }
+#endif
+    SafetyInterlock::disarm(safetyChannel);
     pumpRunning = false;
     pumpStartTime = 0;
     pumpDuration = 0;
-    
-    // Serial.print("{\"pump_action\":\"TURNED_OFF\",\"pin\":" + String(PUMP_PIN) + ",\"digital_state\":\"LOW\"}");
 }
 
 void WaterDispenserPump::setPower(int power) {
     // 🔥 Como ahora es digital, solo importa si power > 0
     currentPower = constrain(power, 0, 255);
-    if (pumpRunning) {
-        digitalWrite(PUMP_PIN, currentPower > 0 ? HIGH : LOW);  // 🔥 Digital: HIGH si power > 0
+    if (pumpRunning && !SafetyInterlock::isLatched(safetyChannel)) {
+        digitalWrite(pumpPin, currentPower > 0 ? HIGH : LOW);  // 🔥 Digital: HIGH si power > 0
     }
 }
 
@@ -72,33 +91,31 @@ void WaterDispenserPump::update() {
     if (pumpDuration > 0) {
         unsigned long elapsed = millis() - pumpStartTime;
         if (elapsed >= pumpDuration) {
-            // Serial.print("{\"pump_auto\":\"TIMEOUT_REACHED\",\"elapsed_ms\":" + String(elapsed) + "}");
             turnOff();
         }
     }
 }
 
 String WaterDispenserPump::getStatus() {
-    if (!pumpReady) return "NOT_INITIALIZED";
-    if (!pumpEnabled) return "DISABLED";
-    if (pumpRunning) return "RUNNING";
-    return "READY";
+    if (!pumpReady) return F("NOT_INITIALIZED");
+    if (!pumpEnabled) return F("DISABLED");
+    if (pumpRunning) return F("RUNNING");
+    return F("READY");
 }
 
 void WaterDispenserPump::emergencyStop() {
-    digitalWrite(PUMP_PIN, LOW);  // 🔥 Cambiar analogWrite por digitalWrite LOW
+    digitalWrite(pumpPin, LOW);  // 🔥 Cambiar analogWrite por digitalWrite LOW
+    if (pumpRunning) TRACE_EVENT(TRC_PUMP_OFF, TRC_REASON_EMERGENCY);
     pumpRunning = false;
     pumpEnabled = false;
     pumpStartTime = 0;
     pumpDuration = 0;
-    
-    // Serial.print("{\"pump_action\":\"EMERGENCY_STOP\",\"pin\":" + String(PUMP_PIN) + "}");
 }
 
-const char* WaterDispenserPump::getActuatorId() {
+const __FlashStringHelper* WaterDispenserPump::getActuatorId() {
     return actuatorId;
 }
 
-const char* WaterDispenserPump::getDeviceId() {
+const __FlashStringHelper* WaterDispenserPump::getDeviceId() {
     return deviceId;
 }
\ No newline at end of file
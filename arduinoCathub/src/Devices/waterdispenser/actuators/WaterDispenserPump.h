@@ -8,12 +8,14 @@
 
 class WaterDispenserPump {
 private:
-    static const int PUMP_PIN = 18;  // Pin digital (NO PWM)
     static const int PUMP_POWER = 1;  // 🔥 Cambiar a 1 (solo HIGH/LOW)
-    static const unsigned long MAX_PUMP_TIME = 10000;
+    // Tope por encendido: ConfigStore (pump_max_ms)
     
-    const char* actuatorId;
-    const char* deviceId;
+    const uint8_t pumpPin;          // Pin digital (NO PWM)
+    const uint8_t unit;             // estación: su pump_max_ms en ConfigStore
+    const uint8_t safetyChannel;    // SafetyChannel de su estación
+    const __FlashStringHelper* actuatorId;
+    const __FlashStringHelper* deviceId;
     bool pumpEnabled;
     bool pumpRunning;
     bool pumpReady;
@@ -22,7 +24,8 @@ private:
     int currentPower;  // Solo para compatibilidad (0 = LOW, >0 = HIGH)
     
 public:
-    WaterDispenserPump(const char* id = ACTUATOR_WATERDISPENSER_PUMP_ID_1, const char* devId = DEVICE_ID_WATER);
+    WaterDispenserPump(const __FlashStringHelper* id = FPSTR(ACTUATOR_WATERDISPENSER_PUMP_ID_1), const __FlashStringHelper* devId = FPSTR(DEVICE_ID_WATER),
+                       uint8_t pumpPin = 18, uint8_t unit = 0);
     bool initialize();
     void turnOn(unsigned long duration = 3000);
     void turnOff();
@@ -33,8 +36,8 @@ public:
     void update();
     String getStatus();
     void emergencyStop();
-    const char* getActuatorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getActuatorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif
\ No newline at end of file
@@ -1,2 +1,10 @@
-#define ACTUATOR_WATERDISPENSER_PUMP_ID_1   "pump_1"
+#ifndef WATERDISPENSER_ACTUATOR_IDS_H
+#define WATERDISPENSER_ACTUATOR_IDS_H
 
+#include <Arduino.h>
+
+static const char ACTUATOR_WATERDISPENSER_PUMP_ID_1[] PROGMEM = "pump_1";
+static const char ACTUATOR_WATERDISPENSER_PUMP_ID_2[] PROGMEM = "pump_2";
+static const char ACTUATOR_WATERDISPENSER_PUMP_ID_3[] PROGMEM = "pump_3";
+
+#endif
@@ -1,2 +1,14 @@
-#define SENSOR_ID_WATER_LEVEL     "WLV_001"
-#define SENSOR_ID_WATER_IR        "WIR_001"
\ No newline at end of file
+#ifndef WATERDISPENSER_SENSOR_IDS_H
+#define WATERDISPENSER_SENSOR_IDS_H
+
+#include <Arduino.h>
+
+static const char SENSOR_ID_WATER_LEVEL[] PROGMEM = "WLV_001";
+static const char SENSOR_ID_WATER_IR[]    PROGMEM = "WIR_001";
+
+static const char SENSOR_ID_WATER_LEVEL_2[] PROGMEM = "WLV_002";
+static const char SENSOR_ID_WATER_IR_2[]    PROGMEM = "WIR_002";
+static const char SENSOR_ID_WATER_LEVEL_3[] PROGMEM = "WLV_003";
+static const char SENSOR_ID_WATER_IR_3[]    PROGMEM = "WIR_003";
+
+#endif
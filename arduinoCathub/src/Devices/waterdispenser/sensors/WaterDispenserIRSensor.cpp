@@ -2,17 +2,20 @@
 #include "WaterDispenserIRSensor.h"
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../../system/SafetyInterlock.h"
 
-WaterDispenserIRSensor::WaterDispenserIRSensor(const char* id, const char* deviceId) : 
-    sensorId(id), deviceId(deviceId), objectDetected(false), lastState(false), lastReadTime(0), 
+WaterDispenserIRSensor::WaterDispenserIRSensor(const __FlashStringHelper* id, const __FlashStringHelper* deviceId,
+                                               uint8_t irPin, uint8_t unit) :
+    irPin(irPin), safetyChannel(safetyChannelFor(SAFETY_WATER, unit)), sensorId(id), deviceId(deviceId), objectDetected(false), lastState(false), lastReadTime(0), 
     detectionStartTime(0), sensorReady(false) {}
 
 bool WaterDispenserIRSensor::initialize() {
-    pinMode(IR_PIN, INPUT);
+    pinMode(irPin, INPUT);
+    SafetyInterlock::attachInput(safetyChannel, irPin, true);   // LOW = detectado
     
     // Leer estado inicial
     delay(100);
-    bool initialReading = digitalRead(IR_PIN);
+    bool initialReading = digitalRead(irPin);
     
     // El sensor MH-B generalmente es LOW cuando detecta objeto
     lastState = initialReading;
@@ -22,18 +25,18 @@ bool WaterDispenserIRSensor::initialize() {
     return true;
 }
 
-void WaterDispenserIRSensor::update() {
-    if (!sensorReady) return;
+SensorReadResult WaterDispenserIRSensor::update() {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
     
     unsigned long now = millis();
     if (now - lastReadTime >= READ_INTERVAL) {
-        bool currentReading = digitalRead(IR_PIN);
+        bool currentReading = digitalRead(irPin);
         bool currentDetection = !currentReading; // Invertir: LOW = detectado
         
         // Debug cada 5 segundos o cuando cambie el estado
         static unsigned long lastDebugTime = 0;
         if ((now - lastDebugTime > 5000) || (currentDetection != objectDetected)) {
-            // Serial.println("{\"debug\":\"IR_SENSOR\",\"pin\":" + String(IR_PIN) + 
+            // Serial.println("{\"debug\":\"IR_SENSOR\",\"pin\":" + String(irPin) + 
                         //    ",\"raw_value\":" + String(currentReading) + 
                         //    ",\"detected\":" + String(currentDetection) + "}");
             lastDebugTime = now;
@@ -53,7 +56,9 @@ void WaterDispenserIRSensor::update() {
         }
         
         lastReadTime = now;
+        return SENSOR_READ_OK;
     }
+    return SENSOR_READ_SKIPPED;
 }
 
 bool WaterDispenserIRSensor::isObjectDetected() {
@@ -76,15 +81,15 @@ bool WaterDispenserIRSensor::isReady() {
 }
 
 String WaterDispenserIRSensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    if (objectDetected) return "OBJECT_DETECTED";
-    return "CLEAR";
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    if (objectDetected) return F("OBJECT_DETECTED");
+    return F("CLEAR");
 }
 
-const char* WaterDispenserIRSensor::getSensorId() {
+const __FlashStringHelper* WaterDispenserIRSensor::getSensorId() {
     return sensorId;
 }
 
-const char* WaterDispenserIRSensor::getDeviceId() {
+const __FlashStringHelper* WaterDispenserIRSensor::getDeviceId() {
     return deviceId;
 }
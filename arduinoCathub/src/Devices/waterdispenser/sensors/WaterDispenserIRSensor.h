@@ -5,14 +5,16 @@
 #include <Arduino.h>
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../common/SensorHealth.h"
 
 class WaterDispenserIRSensor {
 private:
-    static const int IR_PIN = 9;  // Pin digital para el sensor infrarrojo
-    static const unsigned long READ_INTERVAL = 100; // Lectura rápida para detección
+    static const unsigned long READ_INTERVAL = 50; // ms mínimos (el ritmo lo da SensorManager)
 
-    const char* sensorId;
-    const char* deviceId;
+    const uint8_t irPin;
+    const uint8_t safetyChannel;    // SafetyChannel de la bomba de su estación
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
 
     bool objectDetected;
     bool lastState;
@@ -25,16 +27,17 @@ private:
     static const unsigned long DEBOUNCE_TIME = 50;
     
 public:
-    WaterDispenserIRSensor(const char* id = SENSOR_ID_WATER_IR, const char* deviceId = DEVICE_ID_WATER);
+    WaterDispenserIRSensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_WATER_IR), const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_WATER),
+                           uint8_t irPin = 9, uint8_t unit = 0);
     bool initialize();
-    void update();
+    SensorReadResult update();
     bool isObjectDetected();
     bool hasStateChanged();
     unsigned long getDetectionDuration();
     bool isReady();
     String getStatus();
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif
\ No newline at end of file
@@ -2,15 +2,17 @@
 #include "WaterDispenserSensor.h"
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../../state/ConfigStore.h"
 
-WaterDispenserSensor::WaterDispenserSensor(const char* id, const char* deviceId) : sensorId(id), deviceId(deviceId), lastAnalogValue(0), lastReadTime(0), sensorReady(false) {}
+WaterDispenserSensor::WaterDispenserSensor(const __FlashStringHelper* id, const __FlashStringHelper* deviceId, uint8_t analogPin, uint8_t unit) :
+    analogPin(analogPin), unit(unit), sensorId(id), deviceId(deviceId), lastAnalogValue(0), lastReadTime(0), sensorReady(false) {}
 
 bool WaterDispenserSensor::initialize() {
-    pinMode(ANALOG_PIN, INPUT);
+    pinMode(analogPin, INPUT);
     
     // Hacer una lectura inicial para verificar que el sensor está conectado
     delay(100);
-    float testReading = analogRead(ANALOG_PIN);
+    float testReading = analogRead(analogPin);
     
     // El sensor debería dar alguna lectura válida (0-1023)
     if (testReading >= 0 && testReading <= 1023) {
@@ -23,14 +25,15 @@ bool WaterDispenserSensor::initialize() {
     return false;
 }
 
-void WaterDispenserSensor::update() {
-    if (!sensorReady) return;
+// Seco (0) y sumergido (1023) son lecturas legítimas: no hay fuera de rango
+SensorReadResult WaterDispenserSensor::update() {
+    if (!sensorReady) return SENSOR_READ_SKIPPED;
     
     unsigned long now = millis();
-    if (now - lastReadTime >= READ_INTERVAL) {
-        lastAnalogValue = analogRead(ANALOG_PIN);
-        lastReadTime = now;
-    }
+    if (now - lastReadTime < READ_INTERVAL) return SENSOR_READ_SKIPPED;
+    lastAnalogValue = analogRead(analogPin);
+    lastReadTime = now;
+    return SENSOR_READ_OK;
 }
 
 float WaterDispenserSensor::getAnalogValue() {
@@ -38,20 +41,23 @@ float WaterDispenserSensor::getAnalogValue() {
 }
 
 bool WaterDispenserSensor::isWaterDetected() {
-    return lastAnalogValue > DRY_THRESHOLD;
+    return lastAnalogValue > ConfigStore::getInstance().getUnit(unit).waterDryLevel;
+}
+
+uint8_t WaterDispenserSensor::getLevelCode() {
+    const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+    if (lastAnalogValue < cfg.waterDryLevel) return WATER_DRY;       // Sin agua - BOMBA ON
+    if (lastAnalogValue < cfg.waterWetLevel) return WATER_LOW;       // Poco agua - BOMBA ON
+    if (lastAnalogValue < cfg.waterFloodLevel) return WATER_WET;     // Agua suficiente - BOMBA ON aún
+    return WATER_FLOOD;                                              // Lleno al máximo - BOMBA OFF
 }
 
 String WaterDispenserSensor::getWaterLevel() {
-    // Serial.print("Water Level: ");
-    // Serial.println(lastAnalogValue);
-    if (lastAnalogValue < DRY_THRESHOLD) {
-        return "DRY";           // Sin agua - BOMBA ON
-    } else if (lastAnalogValue < WET_THRESHOLD) {
-        return "LOW";           // Poco agua - BOMBA ON
-    } else if (lastAnalogValue < FLOOD_THRESHOLD) {
-        return "WET";           // Agua suficiente - BOMBA ON aún
-    } else {
-        return "FLOOD";         // Lleno al máximo - BOMBA OFF
+    switch (getLevelCode()) {
+        case WATER_DRY: return F("DRY");
+        case WATER_LOW: return F("LOW");
+        case WATER_WET: return F("WET");
+        default:        return F("FLOOD");
     }
 }
 
@@ -60,14 +66,14 @@ bool WaterDispenserSensor::isReady() {
 }
 
 String WaterDispenserSensor::getStatus() {
-    if (!sensorReady) return "NOT_INITIALIZED";
-    return "READY";
+    if (!sensorReady) return F("NOT_INITIALIZED");
+    return F("READY");
 }
 
-const char* WaterDispenserSensor::getSensorId() {
+const __FlashStringHelper* WaterDispenserSensor::getSensorId() {
     return sensorId;
 }
 
-const char* WaterDispenserSensor::getDeviceId() {
+const __FlashStringHelper* WaterDispenserSensor::getDeviceId() {
     return deviceId;
 }
@@ -2,36 +2,46 @@
 #ifndef WATER_DISPENSER_SENSOR_H
 #define WATER_DISPENSER_SENSOR_H
 
-// 🔥 UMBRALES CORREGIDOS PARA FUNCIONAMIENTO AUTOMÁTICO
-#define DRY_THRESHOLD 100     // Sin agua (bomba se ACTIVA)
-#define WET_THRESHOLD 250     // Medio lleno (bomba se ACTIVA aún)  
-#define FLOOD_THRESHOLD 450   // Lleno al máximo (bomba se DETIENE)
+// Umbrales DRY/LOW/WET/FLOOD: ConfigStore (water_dry, water_wet, water_flood)
 
 #include <Arduino.h>
 #include "../config/SensorIDs.h"
 #include "../../config/DeviceIDs.h"
+#include "../../common/SensorHealth.h"
+
+// Nivel del bebedero como código (getWaterLevel() da el mismo nivel en texto)
+enum WaterLevelCode : uint8_t {
+    WATER_DRY,
+    WATER_LOW,
+    WATER_WET,
+    WATER_FLOOD,
+    WATER_NOT_READY = 0xFF
+};
 
 class WaterDispenserSensor {
 private:
-    static const int ANALOG_PIN = A1;
-    static const unsigned long READ_INTERVAL = 300;
-    const char* sensorId;
-    const char* deviceId;
+    static const unsigned long READ_INTERVAL = 100; // ms mínimos
+    const uint8_t analogPin;
+    const uint8_t unit;             // estación: sus umbrales en ConfigStore
+    const __FlashStringHelper* sensorId;
+    const __FlashStringHelper* deviceId;
     
     float lastAnalogValue;
     unsigned long lastReadTime;
     bool sensorReady;
 public:
-    WaterDispenserSensor(const char* id = SENSOR_ID_WATER_LEVEL, const char* deviceId = DEVICE_ID_WATER);
+    WaterDispenserSensor(const __FlashStringHelper* id = FPSTR(SENSOR_ID_WATER_LEVEL), const __FlashStringHelper* deviceId = FPSTR(DEVICE_ID_WATER),
+                         uint8_t analogPin = A1, uint8_t unit = 0);
     bool initialize();
-    void update();
+    SensorReadResult update();
     float getAnalogValue();
     bool isWaterDetected();
     String getWaterLevel();
+    uint8_t getLevelCode();         // WaterLevelCode
     bool isReady();
     String getStatus();
-    const char* getSensorId();
-    const char* getDeviceId();
+    const __FlashStringHelper* getSensorId();
+    const __FlashStringHelper* getDeviceId();
 };
 
 #endif
\ No newline at end of file
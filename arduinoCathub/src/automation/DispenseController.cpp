@@ -0,0 +1,163 @@
+// DispenseController.cpp
+#include "DispenseController.h"
+#include "../state/ConfigStore.h"
+
+DispenseController::DispenseController(SensorManager* sensors, FeederStepperMotor* motor, uint8_t unit)
+    : sensors(sensors), motor(motor), unit(unit), state(STATE_IDLE), targetG(0), startWeightG(0),
+      dispensedG(0), lastGainWeightG(0), stepsPerGram(0), steps(0), lastGainSteps(0),
+      burstEndSteps(0), lastPosition(0), lastSample(0), phaseStart(0) {}
+
+bool DispenseController::start(float grams, ProtoStr& reason) {
+    if (grams <= 0.0f)  { reason = VAL_INVALID_VALUE; return false; }
+    if (state != STATE_IDLE) { reason = VAL_BUSY; return false; }
+    if (!sensors || !motor || !motor->isReady()) { reason = VAL_MISSING_DEPENDENCY; return false; }
+    if (!sensors->isFeederWeightReady() || !sensors->isFeederWeightSettled()) {
+        reason = VAL_SENSOR_NOT_READY;
+        return false;
+    }
+    if (motor->isRunning()) { reason = VAL_BUSY; return false; }
+
+    const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+    float storage = sensors->getFeederFoodDistance();
+    if (storage <= 0 || storage >= cfg.storageEmptyCm) { reason = VAL_NO_FOOD_IN_STORAGE; return false; }
+
+    targetG = grams;
+    startWeightG = sensors->getFeederWeight();
+    lastGainWeightG = startWeightG;
+    dispensedG = 0;
+    stepsPerGram = cfg.dispenseStepsPerGramX100 / 100.0f;
+    steps = 0;
+    lastGainSteps = 0;
+    lastPosition = motor->getCurrentPosition();
+    lastSample = millis();
+    phaseStart = lastSample;
+
+    // El detector de eventos no debe tomar el llenado por un gato comiendo
+    sensors->setFeederDispensing(true);
+    runMotor(FAST_SPEED);
+    state = STATE_FAST;
+    return true;
+}
+
+bool DispenseController::abort() {
+    if (state == STATE_IDLE) return false;
+    finish(DISPENSE_ABORTED);
+    return true;
+}
+
+void DispenseController::accumulateSteps() {
+    // Diferencias pequeñas por ciclo: no importa el desborde de currentPosition
+    int pos = motor->getCurrentPosition();
+    int delta = pos - lastPosition;
+    steps += (delta >= 0) ? delta : -delta;
+    lastPosition = pos;
+}
+
+void DispenseController::runMotor(int speed) {
+    motor->setDirection(false);   // dirección de dispensado (igual que tryStart)
+    motor->setSpeed(speed);
+    motor->enable();
+    motor->startContinuous();
+}
+
+void DispenseController::stopMotor(uint8_t reason) {
+    motor->stopContinuous(reason);
+}
+
+DispenseOutcome DispenseController::update(unsigned long now) {
+    if (state == STATE_IDLE) return DISPENSE_NONE;
+    accumulateSteps();
+
+    // Fin de ráfaga: se cuenta en pasos, no hace falta esperar a la balanza
+    if (state == STATE_BURST && steps >= burstEndSteps) {
+        stopMotor(TRC_REASON_DONE);
+        state = STATE_SETTLE;
+        phaseStart = now;
+    }
+
+    if (now - lastSample < SAMPLE_MS) return DISPENSE_NONE;
+    lastSample = now;
+
+    float weight = sensors->getFeederWeight();
+    dispensedG = weight - startWeightG;
+    if (weight >= lastGainWeightG + MIN_GAIN_G) {
+        lastGainWeightG = weight;
+        lastGainSteps = steps;
+    }
+
+    // Atasco o tolva vacía: el tornillo avanza y el peso no sube
+    if (steps - lastGainSteps > (long)(stepsPerGram * STALL_GRAMS)) {
+        const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+        float storage = sensors->getFeederFoodDistance();
+        bool empty = storage <= 0 || storage >= cfg.storageEmptyCm;
+        return finish(empty ? DISPENSE_NO_FOOD : DISPENSE_STALLED);
+    }
+
+    float remaining = targetG - dispensedG;
+    float slowZone = targetG * SLOW_ZONE_FRACTION;
+    if (slowZone < SLOW_ZONE_G) slowZone = SLOW_ZONE_G;
+
+    switch (state) {
+        case STATE_FAST:
+            if (remaining <= TOLERANCE_G) return finish(DISPENSE_DONE);
+            if (remaining <= slowZone) {
+                // Cerca del objetivo: parar y dejar que caiga lo que está en vuelo
+                stopMotor(TRC_REASON_DONE);
+                state = STATE_SETTLE;
+                phaseStart = now;
+            }
+            break;
+
+        case STATE_SETTLE:
+            if (now - phaseStart < SETTLE_MS) break;
+            if (remaining <= TOLERANCE_G) return finish(DISPENSE_DONE);
+            {
+                // Ráfaga de la mitad de lo que falta (mínimo un cuarto de gramo)
+                long burst = (long)(remaining * stepsPerGram * 0.5f);
+                long minBurst = (long)(stepsPerGram * 0.25f);
+                if (burst < minBurst) burst = minBurst;
+                if (burst < 1) burst = 1;
+                burstEndSteps = steps + burst;
+                runMotor(SLOW_SPEED);
+                state = STATE_BURST;
+            }
+            break;
+
+        default:
+            break;
+    }
+    return DISPENSE_PROGRESS;
+}
+
+DispenseOutcome DispenseController::finish(DispenseOutcome outcome) {
+    switch (outcome) {
+        case DISPENSE_ABORTED: stopMotor(TRC_REASON_COMMAND); break;
+        case DISPENSE_STALLED: stopMotor(TRC_REASON_STALLED); break;
+        case DISPENSE_NO_FOOD: stopMotor(TRC_REASON_SENSORS); break;   // depósito vacío
+        default:               stopMotor(TRC_REASON_DONE); break;
+    }
+    motor->disable();
+    accumulateSteps();
+    if (outcome == DISPENSE_DONE) learn();
+    sensors->setFeederDispensing(false);
+    state = STATE_IDLE;
+    return outcome;
+}
+
+void DispenseController::learn() {
+    // Pocos gramos o pocos pasos (comida que ya venía cayendo): no es una medida
+    if (dispensedG < LEARN_MIN_G || steps < (long)(stepsPerGram * LEARN_MIN_G)) return;
+
+    // Media exponencial (1/4) acotada: una lectura rara no descalibra el tornillo
+    float measured = steps / dispensedG;
+    if (measured < stepsPerGram * 0.25f) measured = stepsPerGram * 0.25f;
+    if (measured > stepsPerGram * 4.0f)  measured = stepsPerGram * 4.0f;
+    stepsPerGram += (measured - stepsPerGram) * 0.25f;
+
+    ConfigStore& store = ConfigStore::getInstance();
+    uint16_t x100 = (uint16_t)constrain(stepsPerGram * 100.0f + 0.5f, 1.0f, 65535.0f);
+    if (x100 != store.getUnit(unit).dispenseStepsPerGramX100) {
+        store.setStepsPerGramX100(x100, unit);
+        store.save();
+    }
+}
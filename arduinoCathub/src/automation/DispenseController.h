@@ -0,0 +1,81 @@
+// DispenseController.h
+#ifndef DISPENSE_CONTROLLER_H
+#define DISPENSE_CONTROLLER_H
+
+#include <Arduino.h>
+#include "../Devices/SensorManager.h"
+#include "../Devices/feeder/actuators/FeederStepperMotor.h"
+#include "../protocol/ProtocolStrings.h"
+
+// Dispensado por gramos con realimentación del HX711 (FDR1:DISPENSE:<g>).
+// El tornillo gira en continuo hasta acercarse al objetivo; ahí pasa a ráfagas
+// cortas con pausa para que la balanza se asiente, y se detiene al llegar o si
+// el peso deja de subir (atasco o depósito vacío). Al terminar ajusta los
+// pasos por gramo aprendidos para el siguiente dispensado.
+enum DispenseOutcome : uint8_t {
+    DISPENSE_NONE,       // nada nuevo
+    DISPENSE_PROGRESS,   // nueva muestra de peso durante el dispensado
+    DISPENSE_DONE,
+    DISPENSE_STALLED,
+    DISPENSE_NO_FOOD,
+    DISPENSE_ABORTED
+};
+
+class DispenseController {
+private:
+    static const int FAST_SPEED = 200;
+    static const int SLOW_SPEED = 80;
+    static const unsigned long SAMPLE_MS = 500;     // periodo del HX711
+    static const unsigned long SETTLE_MS = 2000;    // media móvil de 4 muestras
+    static constexpr float SLOW_ZONE_G = 3.0f;      // a partir de aquí, ráfagas
+    static constexpr float SLOW_ZONE_FRACTION = 0.15f;
+    static constexpr float TOLERANCE_G = 0.5f;
+    static constexpr float STALL_GRAMS = 5.0f;      // pasos de 5 g sin subir peso = atasco
+    static constexpr float MIN_GAIN_G = 0.5f;
+    static constexpr float LEARN_MIN_G = 2.0f;      // menos que esto no se aprende
+
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_FAST,        // giro continuo
+        STATE_SETTLE,      // motor parado esperando a la balanza
+        STATE_BURST        // ráfaga corta de aproximación
+    };
+
+    SensorManager* sensors;
+    FeederStepperMotor* motor;
+    uint8_t unit;              // estación: sus umbrales y sus pasos por gramo
+
+    State state;
+    float targetG;
+    float startWeightG;
+    float dispensedG;
+    float lastGainWeightG;
+    float stepsPerGram;
+    long  steps;               // pasos acumulados en este dispensado
+    long  lastGainSteps;       // pasos al último aumento de peso
+    long  burstEndSteps;
+    int   lastPosition;
+    unsigned long lastSample;
+    unsigned long phaseStart;
+
+    void accumulateSteps();
+    void runMotor(int speed);
+    void stopMotor(uint8_t reason);   // reason: TraceReason
+    DispenseOutcome finish(DispenseOutcome outcome);
+    void learn();
+
+public:
+    DispenseController(SensorManager* sensors, FeederStepperMotor* motor, uint8_t unit = 0);
+
+    bool start(float grams, ProtoStr& reason);
+    DispenseOutcome update(unsigned long now);
+    bool abort();
+
+    bool isActive() const { return state != STATE_IDLE; }
+    float getTarget() const { return targetG; }
+    float getDispensed() const { return dispensedG; }
+    long getSteps() const { return steps; }
+    float getStepsPerGram() const { return stepsPerGram; }
+};
+
+#endif
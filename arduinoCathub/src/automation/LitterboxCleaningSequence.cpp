@@ -0,0 +1,117 @@
+// LitterboxCleaningSequence.cpp
+#include "LitterboxCleaningSequence.h"
+#include "../config/MotorConfigs.h"
+#include "../system/SafetyInterlock.h"
+
+LitterboxCleaningSequence::LitterboxCleaningSequence(LitterboxStepperMotor* motor)
+    : motor(motor), state(STATE_IDLE), mode(CLEANING_NORMAL), rollingBack(false),
+      targets{0, 0}, legCount(0), legIndex(0), startPosition(0), lastReported(0),
+      phaseStart(0) {}
+
+bool LitterboxCleaningSequence::start(CleaningMode cleaningMode, unsigned long now) {
+    if (state != STATE_IDLE || !motor || !motor->isReady()) return false;
+
+    mode = cleaningMode;
+    rollingBack = false;
+    startPosition = motor->getCurrentPosition();
+    lastReported = startPosition;
+    legIndex = 0;
+    legCount = 2;
+    if (mode == CLEANING_NORMAL) {
+        // RIGHT NORMAL_CLEAN_STEPS y regreso
+        targets[0] = startPosition + LitterboxStepperMotor::NORMAL_CLEAN_STEPS;
+    } else {
+        // LEFT DEEP_CLEAN_STEPS (vaciar) y regreso
+        targets[0] = startPosition - LitterboxStepperMotor::DEEP_CLEAN_STEPS;
+    }
+    targets[1] = startPosition;
+
+    return beginLeg(now);
+}
+
+long LitterboxCleaningSequence::getTarget() const {
+    if (legCount == 0) return startPosition;
+    return targets[legIndex < legCount ? legIndex : legCount - 1];
+}
+
+bool LitterboxCleaningSequence::beginLeg(unsigned long now) {
+    if (!motor->beginMoveTo(targets[legIndex])) return false;
+    state = STATE_MOVING;
+    phaseStart = now;
+    return true;
+}
+
+CleaningOutcome LitterboxCleaningSequence::pause(unsigned long now) {
+    motor->stopMove();
+    state = STATE_PAUSED;
+    phaseStart = now;
+    return CLEANING_PAUSED;
+}
+
+CleaningOutcome LitterboxCleaningSequence::finishLeg(unsigned long now) {
+    lastReported = motor->getCurrentPosition();
+    ++legIndex;
+    if (legIndex < legCount) {
+        state = STATE_DWELL;
+        phaseStart = now;
+        return CLEANING_PROGRESS;
+    }
+
+    state = STATE_IDLE;
+    if (rollingBack) return CLEANING_ABORTED;
+    // La limpieza profunda termina sin torque (estado 1)
+    if (mode == CLEANING_DEEP) motor->forceDisableTorque();
+    return CLEANING_DONE;
+}
+
+CleaningOutcome LitterboxCleaningSequence::update(unsigned long now, bool catPresent) {
+    if (state == STATE_IDLE) return CLEANING_NONE;
+
+    // El ISR puede haber cortado el motor antes de que la presencia lo confirme
+    bool blocked = catPresent || SafetyInterlock::isLatched(motor->getSafetyChannel());
+
+    switch (state) {
+        case STATE_MOVING:
+            if (blocked) return pause(now);
+            if (motor->serviceMove()) {
+                long pos = motor->getCurrentPosition();
+                if (labs(pos - lastReported) >= PROGRESS_STEPS) {
+                    lastReported = pos;
+                    return CLEANING_PROGRESS;
+                }
+                return CLEANING_NONE;
+            }
+            if (motor->getCurrentPosition() != targets[legIndex]) return pause(now);   // cortado por el ISR
+            return finishLeg(now);
+
+        case STATE_DWELL:
+            if (blocked) return pause(now);
+            if (now - phaseStart < DWELL_MS) return CLEANING_NONE;
+            if (!beginLeg(now)) return pause(now);
+            return CLEANING_NONE;
+
+        case STATE_PAUSED:
+            if (blocked) {
+                if (now - phaseStart < (unsigned long)LitterboxMotorConfig::EMERGENCY_TIMEOUT_MS) return CLEANING_NONE;
+                motor->releaseTorque();
+                state = STATE_SAFE;
+                return CLEANING_TIMEOUT;
+            }
+            // Se retoma el tramo en curso desde donde quedó
+            if (!beginLeg(now)) return CLEANING_NONE;
+            return CLEANING_RESUMED;
+
+        case STATE_SAFE:
+            if (blocked) return CLEANING_NONE;
+            // Estación libre: volver al punto de partida del ciclo
+            rollingBack = true;
+            targets[0] = startPosition;
+            legCount = 1;
+            legIndex = 0;
+            if (!beginLeg(now)) return CLEANING_NONE;
+            return CLEANING_ROLLBACK;
+
+        default:
+            return CLEANING_NONE;
+    }
+}
@@ -0,0 +1,77 @@
+// LitterboxCleaningSequence.h
+#ifndef LITTERBOX_CLEANING_SEQUENCE_H
+#define LITTERBOX_CLEANING_SEQUENCE_H
+
+#include <Arduino.h>
+#include "../Devices/litterbox/actuators/LitterboxStepperMotor.h"
+
+// Limpieza del arenero (LTR1:2.1 / LTR1:2.2) como máquina de estados sin
+// bloqueo. El ciclo es una lista de tramos hasta posiciones absolutas; el
+// final de cada tramo es un punto de control. Si aparece el gato (presencia
+// o enclavamiento por ISR) el motor se frena con torque y el ciclo queda en
+// pausa: al irse el gato se retoma el tramo desde la posición actual. Si la
+// pausa supera EMERGENCY_TIMEOUT_MS se suelta el torque (estado seguro) y,
+// cuando la estación queda libre, el tambor vuelve a la posición inicial del
+// ciclo y éste termina como abortado.
+enum CleaningMode : uint8_t {
+    CLEANING_NORMAL,
+    CLEANING_DEEP
+};
+
+enum CleaningOutcome : uint8_t {
+    CLEANING_NONE,         // nada nuevo
+    CLEANING_PROGRESS,     // punto de control o avance de PROGRESS_STEPS
+    CLEANING_PAUSED,
+    CLEANING_RESUMED,
+    CLEANING_TIMEOUT,      // pausa demasiado larga: torque suelto
+    CLEANING_ROLLBACK,     // volviendo a la posición inicial
+    CLEANING_DONE,
+    CLEANING_ABORTED       // terminó de volver a la posición inicial
+};
+
+class LitterboxCleaningSequence {
+private:
+    static const uint8_t MAX_LEGS = 2;
+    static const unsigned long DWELL_MS = 150;   // pausa entre tramos (igual que el ciclo bloqueante)
+    static const long PROGRESS_STEPS = 200;      // evento de avance cada ~0.8 s de giro
+
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_MOVING,
+        STATE_DWELL,       // entre tramos
+        STATE_PAUSED,      // gato presente, motor frenado con torque
+        STATE_SAFE         // pausa vencida, torque suelto
+    };
+
+    LitterboxStepperMotor* motor;
+
+    State state;
+    CleaningMode mode;
+    bool rollingBack;
+    long targets[MAX_LEGS];
+    uint8_t legCount;
+    uint8_t legIndex;
+    long startPosition;
+    long lastReported;
+    unsigned long phaseStart;
+
+    bool beginLeg(unsigned long now);
+    CleaningOutcome pause(unsigned long now);
+    CleaningOutcome finishLeg(unsigned long now);
+
+public:
+    explicit LitterboxCleaningSequence(LitterboxStepperMotor* motor);
+
+    bool start(CleaningMode mode, unsigned long now);
+    CleaningOutcome update(unsigned long now, bool catPresent);
+
+    bool isActive() const { return state != STATE_IDLE; }
+    bool isRollingBack() const { return rollingBack; }
+    CleaningMode getMode() const { return mode; }
+    uint8_t getCheckpoint() const { return legIndex; }   // tramos completados
+    uint8_t getLegCount() const { return legCount; }
+    long getTarget() const;
+    long getPosition() const { return motor ? motor->getCurrentPosition() : 0; }
+};
+
+#endif
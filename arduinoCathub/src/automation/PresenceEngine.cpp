@@ -0,0 +1,116 @@
+// PresenceEngine.cpp
+#include "PresenceEngine.h"
+#include "../state/ConfigStore.h"
+
+// Tiempo mínimo sobre el umbral para entrar / bajo el umbral para salir (ms)
+struct PresenceDwell {
+    uint16_t enterMs;
+    uint16_t exitMs;
+};
+
+static const PresenceDwell DWELL[PRESENCE_STATION_COUNT] = {
+    { 1000, 5000 },    // arenero: el gato se queda quieto un rato
+    { 1000, 10000 },   // comedero: pausas entre bocados
+    { 500,  3000 },    // bebedero
+};
+
+PresenceEngine::PresenceEngine(SensorManager* sensors, uint8_t unit)
+    : sensors(sensors), unit(unit), lastTick(0), queueHead(0), queueCount(0) {
+    for (uint8_t i = 0; i < PRESENCE_STATION_COUNT; ++i) {
+        stations[i].confidence = 0;
+        stations[i].present = false;
+        stations[i].pending = false;
+        stations[i].pendingSince = 0;
+        stations[i].enteredAt = 0;
+    }
+}
+
+uint8_t PresenceEngine::evidenceFor(PresenceStation station, bool present) {
+    // Con el gato ya presente el umbral de distancia se alarga (histéresis)
+    float hysteresis = present ? EXIT_HYSTERESIS_CM : 0.0f;
+
+    switch (station) {
+        case PRESENCE_LITTERBOX: {
+            float d = sensors->getLitterboxDistance();
+            float limit = ConfigStore::getInstance().getUnit(unit).catPresentCm + hysteresis;
+            return (d > 0.0f && d <= limit) ? EVIDENCE_FULL : 0;
+        }
+        case PRESENCE_FEEDER: {
+            uint16_t evidence = 0;
+            float d = sensors->getFeederCatDistance();
+            if (d > 0.0f && d < FEEDER_CAT_CM + hysteresis) evidence += EVIDENCE_PLATE_RANGE;
+            if (sensors->isCatEating()) evidence += EVIDENCE_EATING;
+            else if (sensors->isFeederWeightDisturbed()) evidence += EVIDENCE_WEIGHT_MOVING;
+            return (evidence > EVIDENCE_FULL) ? EVIDENCE_FULL : (uint8_t)evidence;
+        }
+        case PRESENCE_WATER:
+            return sensors->isCatDrinking() ? EVIDENCE_FULL : 0;
+        default:
+            return 0;
+    }
+}
+
+void PresenceEngine::update(unsigned long now) {
+    if (!sensors || now - lastTick < TICK_MS) return;
+    lastTick = now;
+    for (uint8_t i = 0; i < PRESENCE_STATION_COUNT; ++i) {
+        PresenceStation station = (PresenceStation)i;
+        step(station, evidenceFor(station, stations[i].present), now);
+    }
+}
+
+void PresenceEngine::step(PresenceStation station, uint8_t evidence, unsigned long now) {
+    Station& s = stations[station];
+
+    // Confianza: media exponencial 1/2 (una sola muestra suelta no llega a ENTER)
+    int16_t c = s.confidence;
+    c += ((int16_t)evidence - c) / 2;
+    if (evidence > s.confidence && c == s.confidence) c++;   // redondeo hacia la evidencia
+    s.confidence = (uint8_t)c;
+
+    bool crossing = s.present ? (s.confidence <= EXIT_CONFIDENCE)
+                              : (s.confidence >= ENTER_CONFIDENCE);
+    if (!crossing) {
+        s.pending = false;
+        return;
+    }
+    if (!s.pending) {
+        s.pending = true;
+        s.pendingSince = now;
+    }
+
+    const PresenceDwell& dwell = DWELL[station];
+    unsigned long needed = s.present ? dwell.exitMs : dwell.enterMs;
+    if (now - s.pendingSince < needed) return;
+
+    s.pending = false;
+    if (!s.present) {
+        s.present = true;
+        s.enteredAt = s.pendingSince;
+        push(station, true, s.confidence, 0);
+    } else {
+        s.present = false;
+        push(station, false, s.confidence, s.pendingSince - s.enteredAt);
+    }
+}
+
+void PresenceEngine::push(PresenceStation station, bool present, uint8_t confidence, uint32_t durationMs) {
+    if (queueCount == QUEUE_SIZE) {
+        queueHead = (uint8_t)((queueHead + 1) % QUEUE_SIZE);
+        queueCount--;
+    }
+    PresenceEvent& ev = queue[(queueHead + queueCount) % QUEUE_SIZE];
+    ev.station = station;
+    ev.present = present;
+    ev.confidence = confidence;
+    ev.durationMs = durationMs;
+    queueCount++;
+}
+
+bool PresenceEngine::poll(PresenceEvent& out) {
+    if (queueCount == 0) return false;
+    out = queue[queueHead];
+    queueHead = (uint8_t)((queueHead + 1) % QUEUE_SIZE);
+    queueCount--;
+    return true;
+}
@@ -0,0 +1,77 @@
+// PresenceEngine.h
+#ifndef PRESENCE_ENGINE_H
+#define PRESENCE_ENGINE_H
+
+#include <Arduino.h>
+#include "../Devices/SensorManager.h"
+
+// Fusión de presencia del gato por estación. Cada tick suma la evidencia de
+// los sensores de la estación (0..100), la suaviza en una confianza y aplica
+// histéresis (umbral de entrada > umbral de salida) más un tiempo mínimo en
+// cada lado antes de cambiar de estado. Los cambios quedan como eventos.
+enum PresenceStation : uint8_t {
+    PRESENCE_LITTERBOX,   // ultrasónico del arenero
+    PRESENCE_FEEDER,      // ultrasónico del plato + transitorios de peso
+    PRESENCE_WATER,       // IR del bebedero
+    PRESENCE_STATION_COUNT
+};
+
+struct PresenceEvent {
+    PresenceStation station;
+    bool     present;       // true = entró, false = salió
+    uint8_t  confidence;
+    uint32_t durationMs;    // salida: tiempo que estuvo presente
+};
+
+class PresenceEngine {
+private:
+    static const unsigned long TICK_MS = 500;      // mismo ritmo que SensorManager::poll
+    static const uint8_t ENTER_CONFIDENCE = 60;
+    static const uint8_t EXIT_CONFIDENCE = 30;
+    static const uint8_t QUEUE_SIZE = 4;
+
+    // Evidencia por fuente (se suman y se recortan a 100)
+    static const uint8_t EVIDENCE_FULL = 100;
+    static const uint8_t EVIDENCE_PLATE_RANGE = 40;    // algo cerca del plato (puede ser comida)
+    static const uint8_t EVIDENCE_WEIGHT_MOVING = 40;  // el peso no está quieto
+    static const uint8_t EVIDENCE_EATING = 80;         // sesión de comida abierta
+
+    static constexpr float EXIT_HYSTERESIS_CM = 2.0f;
+    static constexpr float FEEDER_CAT_CM = 10.0f;
+
+    struct Station {
+        uint8_t confidence;
+        bool present;
+        bool pending;                 // umbral cruzado, esperando el tiempo mínimo
+        unsigned long pendingSince;
+        unsigned long enteredAt;
+    };
+
+    SensorManager* sensors;
+    uint8_t unit;                     // estación: su cat_present_cm
+    Station stations[PRESENCE_STATION_COUNT];
+    unsigned long lastTick;
+
+    PresenceEvent queue[QUEUE_SIZE];
+    uint8_t queueHead;
+    uint8_t queueCount;
+
+    uint8_t evidenceFor(PresenceStation station, bool present);
+    void step(PresenceStation station, uint8_t evidence, unsigned long now);
+    void push(PresenceStation station, bool present, uint8_t confidence, uint32_t durationMs);
+
+public:
+    explicit PresenceEngine(SensorManager* sensors, uint8_t unit = 0);
+
+    void update(unsigned long now);
+    bool poll(PresenceEvent& out);
+
+    bool isPresent(PresenceStation station) const { return stations[station].present; }
+    // Para seguridad: también cuenta una entrada que aún no cumplió el tiempo mínimo
+    bool isOccupied(PresenceStation station) const {
+        return stations[station].present || stations[station].confidence >= ENTER_CONFIDENCE;
+    }
+    uint8_t getConfidence(PresenceStation station) const { return stations[station].confidence; }
+};
+
+#endif
@@ -0,0 +1,97 @@
+// WaterRefillController.cpp
+#include "WaterRefillController.h"
+#include "../state/ConfigStore.h"
+
+WaterRefillController::WaterRefillController(WaterDispenserSensor* sensor, WaterDispenserPump* pump, uint8_t unit)
+    : sensor(sensor), pump(pump), unit(unit), state(STATE_IDLE), hasRun(false), startLevel(0),
+      minSeen(0), maxSeen(0), startTime(0), stopTime(0), plannedMs(0), lastRate(0) {}
+
+float WaterRefillController::getLearnedRate() const {
+    return ConfigStore::getInstance().getUnit(unit).waterFillRateX100 / 100.0f;
+}
+
+WaterRefillOutcome WaterRefillController::update(unsigned long now, bool catNearby) {
+    if (!sensor || !pump || !sensor->isReady() || !pump->isReady()) return REFILL_NONE;
+
+    const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+    int16_t level = (int16_t)sensor->getAnalogValue();
+
+    switch (state) {
+        case STATE_IDLE: {
+            if (catNearby || level >= (int16_t)cfg.waterWetLevel) return REFILL_NONE;
+            if (hasRun && now - stopTime < MIN_OFF_MS) return REFILL_NONE;
+
+            // Tiempo previsto = déficit / caudal aprendido (sin modelo: pump_refill_ms)
+            float rate = getLearnedRate();
+            unsigned long planned = cfg.pumpRefillMs;
+            if (rate > 0.0f) {
+                float deficit = (float)cfg.waterFloodLevel - level;
+                planned = (unsigned long)(deficit / rate * 1000.0f * PREDICT_MARGIN);
+            }
+            if (planned < MIN_RUN_MS) planned = MIN_RUN_MS;
+            if (planned > cfg.pumpMaxMs) planned = cfg.pumpMaxMs;
+
+            plannedMs = planned;
+            startLevel = level;
+            minSeen = level;
+            maxSeen = level;
+            startTime = now;
+            pump->turnOn(planned);
+            state = STATE_FILLING;
+            hasRun = true;
+            return REFILL_STARTED;
+        }
+
+        case STATE_FILLING: {
+            if (level < minSeen) minSeen = level;
+            if (level > maxSeen) maxSeen = level;
+
+            if (catNearby) return stop(REFILL_STOPPED_CAT, now, level);
+            if (level >= (int16_t)cfg.waterFloodLevel) return stop(REFILL_STOPPED_FULL, now, level);
+
+            // El nivel tiene que moverse en los primeros segundos de bomba
+            if (now - startTime >= NO_RISE_MS && maxSeen - startLevel < MIN_RISE_COUNTS) {
+                return stop(maxSeen == minSeen ? REFILL_FAULT_STUCK : REFILL_FAULT_DRY_RUN, now, level);
+            }
+
+            // La bomba se apaga sola al cumplir el tiempo previsto (o pump_max_ms)
+            if (!pump->isPumpRunning()) return stop(REFILL_STOPPED_TIMEOUT, now, level);
+            return REFILL_NONE;
+        }
+
+        case STATE_FAULT:
+            if (now - stopTime >= FAULT_RETRY_MS) state = STATE_IDLE;
+            return REFILL_NONE;
+    }
+    return REFILL_NONE;
+}
+
+WaterRefillOutcome WaterRefillController::stop(WaterRefillOutcome outcome, unsigned long now, int16_t level) {
+    if (pump->isPumpRunning()) pump->turnOff();
+    stopTime = now;
+    lastRate = 0;
+
+    bool fault = (outcome == REFILL_FAULT_DRY_RUN || outcome == REFILL_FAULT_STUCK);
+    if (!fault) learn(level, now);
+    state = fault ? STATE_FAULT : STATE_IDLE;
+    return outcome;
+}
+
+void WaterRefillController::learn(int16_t level, unsigned long now) {
+    unsigned long elapsed = now - startTime;
+    int16_t rise = level - startLevel;
+    if (rise < MIN_LEARN_COUNTS || elapsed < MIN_RUN_MS) return;
+
+    lastRate = rise * 1000.0f / elapsed;
+
+    // Media exponencial (1/4); el primer encendido medido fija el modelo
+    float rate = getLearnedRate();
+    rate = (rate > 0.0f) ? rate + (lastRate - rate) * 0.25f : lastRate;
+
+    ConfigStore& store = ConfigStore::getInstance();
+    uint16_t x100 = (uint16_t)constrain(rate * 100.0f + 0.5f, 1.0f, 65535.0f);
+    if (x100 != store.getUnit(unit).waterFillRateX100) {
+        store.setWaterFillRateX100(x100, unit);
+        store.save();
+    }
+}
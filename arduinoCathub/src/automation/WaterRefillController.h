@@ -0,0 +1,69 @@
+// WaterRefillController.h
+#ifndef WATER_REFILL_CONTROLLER_H
+#define WATER_REFILL_CONTROLLER_H
+
+#include <Arduino.h>
+#include "../Devices/waterdispenser/sensors/WaterDispenserSensor.h"
+#include "../Devices/waterdispenser/actuators/WaterDispenserPump.h"
+
+// Rellenado del bebedero con modelo de caudal aprendido. Arranca cuando el
+// nivel baja de water_wet, calcula cuánto debe correr la bomba con la tasa
+// aprendida (cuentas ADC por segundo) y corta antes si el nivel llega a
+// water_flood. Si el nivel no sube, para por bomba en seco o sensor trabado.
+// Entre encendidos respeta un tiempo mínimo apagada.
+enum WaterRefillOutcome : uint8_t {
+    REFILL_NONE,
+    REFILL_STARTED,
+    REFILL_STOPPED_FULL,      // llegó a water_flood
+    REFILL_STOPPED_TIMEOUT,   // terminó el tiempo previsto
+    REFILL_STOPPED_CAT,       // gato bebiendo
+    REFILL_FAULT_DRY_RUN,     // la bomba corre y el nivel no sube
+    REFILL_FAULT_STUCK        // lectura idéntica todo el encendido
+};
+
+class WaterRefillController {
+private:
+    static const unsigned long MIN_OFF_MS = 60000UL;       // descanso mínimo entre encendidos
+    static const unsigned long MIN_RUN_MS = 1000UL;
+    static const unsigned long NO_RISE_MS = 5000UL;        // ventana para exigir subida
+    static const unsigned long FAULT_RETRY_MS = 600000UL;  // reintento tras una falla (10 min)
+    static const int16_t MIN_RISE_COUNTS = 10;
+    static const int16_t MIN_LEARN_COUNTS = 30;
+    static constexpr float PREDICT_MARGIN = 0.9f;          // apuntar un poco por debajo
+
+    enum State : uint8_t {
+        STATE_IDLE,
+        STATE_FILLING,
+        STATE_FAULT
+    };
+
+    WaterDispenserSensor* sensor;
+    WaterDispenserPump* pump;
+    uint8_t unit;              // estación: sus niveles, tiempos y caudal aprendido
+
+    State state;
+    bool hasRun;               // sin encendidos previos no hay descanso que respetar
+    int16_t startLevel;
+    int16_t minSeen;
+    int16_t maxSeen;
+    unsigned long startTime;
+    unsigned long stopTime;
+    unsigned long plannedMs;
+    float lastRate;            // cuentas/s del último encendido (0 = sin medida)
+
+    WaterRefillOutcome stop(WaterRefillOutcome outcome, unsigned long now, int16_t level);
+    void learn(int16_t level, unsigned long now);
+
+public:
+    WaterRefillController(WaterDispenserSensor* sensor, WaterDispenserPump* pump, uint8_t unit = 0);
+
+    WaterRefillOutcome update(unsigned long now, bool catNearby);
+
+    bool isFilling() const { return state == STATE_FILLING; }
+    bool isFaulted() const { return state == STATE_FAULT; }
+    unsigned long getPlannedMs() const { return plannedMs; }
+    float getLastRate() const { return lastRate; }
+    float getLearnedRate() const;    // cuentas/s (0 = aún sin aprender)
+};
+
+#endif
@@ -0,0 +1,104 @@
+// StationLayout.h
+#ifndef STATION_LAYOUT_H
+#define STATION_LAYOUT_H
+
+#include <Arduino.h>
+#include "../Devices/config/DeviceIDs.h"
+#include "../Devices/litterbox/config/SensorIDs.h"
+#include "../Devices/litterbox/config/ActuatorIDs.h"
+#include "../Devices/feeder/config/SensorIDs.h"
+#include "../Devices/feeder/config/ActuatorIDs.h"
+#include "../Devices/waterdispenser/config/SensorIDs.h"
+#include "../Devices/waterdispenser/config/ActuatorIDs.h"
+
+// Estaciones (arenero + comedero + bebedero) atendidas por la misma placa.
+// Se elige al compilar (env megaatmega2560_units2/_units3 o -DCATHUB_UNITS=N): cada
+// estación extra suma once sensores a la ronda de SensorManager y su juego
+// de objetos en SRAM.
+#ifndef CATHUB_UNITS
+#define CATHUB_UNITS 1
+#endif
+
+#define CATHUB_MAX_UNITS 3
+
+#if CATHUB_UNITS < 1 || CATHUB_UNITS > CATHUB_MAX_UNITS
+#error "CATHUB_UNITS debe estar entre 1 y CATHUB_MAX_UNITS"
+#endif
+
+// IDs (en flash) y pines de una estación
+struct StationLayout {
+    const char* litterboxId;
+    const char* feederId;
+    const char* waterId;
+
+    const char* litterUltraId;
+    const char* litterDhtId;
+    const char* litterMq2Id;
+    const char* litterMotorId;
+    const char* feederWeightId;
+    const char* feederCatId;
+    const char* feederFoodId;
+    const char* feederMotorId;
+    const char* waterLevelId;
+    const char* waterIrId;
+    const char* pumpId;
+
+    // Arenero: el eco del ultrasónico tiene que caer en PCINT0 (D10-D13,
+    // D50-D53) para que el enclavamiento corte el motor desde el ISR
+    uint8_t litterTrigPin, litterEchoPin;
+    uint8_t dhtPin;
+    uint8_t mq2Pin;
+    uint8_t litterDirPin, litterEnPin, litterPullPin;
+    // Comedero
+    uint8_t hxDoutPin, hxSckPin;
+    uint8_t catTrigPin, catEchoPin;
+    uint8_t foodTrigPin, foodEchoPin;
+    uint8_t feederDirPin, feederEnPin, feederPullPin;
+    // Bebedero
+    uint8_t waterLevelPin;
+    uint8_t irPin;
+    uint8_t pumpPin;
+};
+
+// La primera estación conserva los pines de siempre; las demás usan el
+// cabezal doble del Mega (D22-D53) y las analógicas libres
+static const StationLayout STATION_LAYOUTS[CATHUB_UNITS] = {
+    {
+        DEVICE_ID_LITTERBOX, DEVICE_ID_FEEDER, DEVICE_ID_WATER,
+        SENSOR_ID_LITTER_ULTRA, SENSOR_ID_LITTER_DHT, SENSOR_ID_LITTER_MQ2, ACTUATOR_LITTERBOX_MOTOR_ID_1,
+        SENSOR_ID_FEEDER_WEIGHT, SENSOR_ID_FEEDER_SONIC1, SENSOR_ID_FEEDER_SONIC2, ACTUATOR_FEEDER_MOTOR_ID_1,
+        SENSOR_ID_WATER_LEVEL, SENSOR_ID_WATER_IR, ACTUATOR_WATERDISPENSER_PUMP_ID_1,
+        10, 11, 21, A0, 15, 16, 17,
+        3, 2, 4, 5, 6, 7, 13, 14, 12,
+        A1, 9, 18
+    },
+#if CATHUB_UNITS >= 2
+    {
+        DEVICE_ID_LITTERBOX_2, DEVICE_ID_FEEDER_2, DEVICE_ID_WATER_2,
+        SENSOR_ID_LITTER_ULTRA_2, SENSOR_ID_LITTER_DHT_2, SENSOR_ID_LITTER_MQ2_2, ACTUATOR_LITTERBOX_MOTOR_ID_2,
+        SENSOR_ID_FEEDER_WEIGHT_2, SENSOR_ID_FEEDER_SONIC1_2, SENSOR_ID_FEEDER_SONIC2_2, ACTUATOR_FEEDER_MOTOR_ID_2,
+        SENSOR_ID_WATER_LEVEL_2, SENSOR_ID_WATER_IR_2, ACTUATOR_WATERDISPENSER_PUMP_ID_2,
+        22, 50, 23, A2, 24, 25, 26,
+        27, 28, 29, 30, 31, 32, 33, 34, 35,
+        A3, 36, 37
+    },
+#endif
+#if CATHUB_UNITS >= 3
+    {
+        DEVICE_ID_LITTERBOX_3, DEVICE_ID_FEEDER_3, DEVICE_ID_WATER_3,
+        SENSOR_ID_LITTER_ULTRA_3, SENSOR_ID_LITTER_DHT_3, SENSOR_ID_LITTER_MQ2_3, ACTUATOR_LITTERBOX_MOTOR_ID_3,
+        SENSOR_ID_FEEDER_WEIGHT_3, SENSOR_ID_FEEDER_SONIC1_3, SENSOR_ID_FEEDER_SONIC2_3, ACTUATOR_FEEDER_MOTOR_ID_3,
+        SENSOR_ID_WATER_LEVEL_3, SENSOR_ID_WATER_IR_3, ACTUATOR_WATERDISPENSER_PUMP_ID_3,
+        38, 51, 39, A4, 40, 41, 42,
+        43, 44, 45, 46, 47, 48, A8, A9, A10,
+        A5, A11, A12
+    },
+#endif
+};
+
+// Pin ocupado por alguna estación compilada (para no darle otro uso, ver
+// bus_de_pin). Definida en main.cpp, la única unidad que usa STATION_LAYOUTS:
+// en AVR cada copia de la tabla ocupa SRAM
+bool stationUsesPin(uint8_t pin);
+
+#endif
@@ -0,0 +1,94 @@
+// FixedPoint.h
+// Aritmética de punto fijo para el AVR (sin FPU): Q16.16 en int32_t y Q8.8
+// en int16_t. Las conversiones desde float son constexpr para que las
+// constantes se resuelvan en compilación y no cuesten nada en runtime.
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+typedef int32_t q16_t;   // Q16.16: rango ±32767, resolución 1/65536
+typedef int16_t q8_t;    // Q8.8:   rango ±127,   resolución 1/256
+
+static const uint8_t Q16_SHIFT = 16;
+static const q16_t   Q16_ONE   = (q16_t)1 << Q16_SHIFT;
+static const uint8_t Q8_SHIFT  = 8;
+static const q8_t    Q8_ONE    = (q8_t)(1 << Q8_SHIFT);
+
+// ---- Q16.16 ----
+constexpr q16_t q16FromFloat(float v) {
+    return (q16_t)(v * 65536.0f + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+inline q16_t q16FromInt(int32_t v) {
+    return (q16_t)((uint32_t)v << Q16_SHIFT);
+}
+
+inline float q16ToFloat(q16_t v) {
+    return (float)v / 65536.0f;
+}
+
+// Redondeo al entero más cercano
+inline int32_t q16ToInt(q16_t v) {
+    return (v + (Q16_ONE >> 1)) >> Q16_SHIFT;
+}
+
+// Producto con sólo multiplicaciones de 16x16 -> 32 bits (el AVR las hace
+// en hardware; las de 64 bits son llamadas a libgcc más caras que el float):
+// a*b/2^16 = ah*bh*2^16 + ah*bl + al*bh + al*bl/2^16, con ah/bh la parte
+// alta con signo y al/bl la baja sin signo. Da exactamente lo mismo que el
+// producto de 64 bits corrido (piso), también con negativos.
+inline q16_t q16Mul(q16_t a, q16_t b) {
+    int16_t ah = (int16_t)(a >> Q16_SHIFT);
+    int16_t bh = (int16_t)(b >> Q16_SHIFT);
+    uint16_t al = (uint16_t)a;
+    uint16_t bl = (uint16_t)b;
+    uint32_t r = ((uint32_t)((int32_t)ah * (int32_t)bh) << Q16_SHIFT)
+               + (uint32_t)((int32_t)ah * (int32_t)bl)
+               + (uint32_t)((int32_t)al * (int32_t)bh)
+               + (((uint32_t)al * bl) >> Q16_SHIFT);
+    return (q16_t)r;
+}
+
+// Satura en vez de desbordar (divisores muy chicos). Divisiones de 32 bits:
+// parte entera y resto por separado; para la fracción, si el divisor no
+// entra en 16 bits se corren divisor y resto juntos (a lo sumo 2 LSB de
+// diferencia con la división de 64 bits). Trunca hacia cero, como en C.
+inline q16_t q16Div(q16_t a, q16_t b) {
+    if (b == 0) return (a >= 0) ? INT32_MAX : INT32_MIN;
+    bool negative = (a < 0) != (b < 0);
+    uint32_t ua = (a < 0) ? 0u - (uint32_t)a : (uint32_t)a;
+    uint32_t ub = (b < 0) ? 0u - (uint32_t)b : (uint32_t)b;
+
+    uint32_t whole = ua / ub;
+    if (whole > 0x7FFFu) return negative ? INT32_MIN : INT32_MAX;
+    uint32_t rem = ua - whole * ub;
+    while (ub > 0xFFFFu) {
+        ub >>= 1;
+        rem >>= 1;
+    }
+    uint32_t r = (whole << Q16_SHIFT) + (rem << Q16_SHIFT) / ub;
+    if (r > (uint32_t)INT32_MAX) return negative ? INT32_MIN : INT32_MAX;
+    return negative ? -(q16_t)r : (q16_t)r;
+}
+
+// Entero (p.ej. cuentas ADC o µs) por un coeficiente Q16.16 -> Q16.16.
+// Multiplicación de 32 bits: el llamador garantiza |a * coeff| < 2^31.
+inline q16_t q16MulInt(int32_t a, q16_t coeff) {
+    return (q16_t)(a * coeff);
+}
+
+// ---- Q8.8 ----
+constexpr q8_t q8FromFloat(float v) {
+    return (q8_t)(v * 256.0f + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+inline float q8ToFloat(q8_t v) {
+    return (float)v / 256.0f;
+}
+
+inline q8_t q8Mul(q8_t a, q8_t b) {
+    return (q8_t)(((int32_t)a * b) >> Q8_SHIFT);
+}
+
+#endif // FIXED_POINT_H
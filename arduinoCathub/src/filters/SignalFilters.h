@@ -0,0 +1,176 @@
+// SignalFilters.h
+// Filtros enteros para las lecturas de sensores. Todas las muestras son
+// int32_t (cuentas ADC, µs de eco, cuentas HX711); los estados internos que
+// necesitan fracción van en Q16.16 (ver FixedPoint.h).
+#ifndef SIGNAL_FILTERS_H
+#define SIGNAL_FILTERS_H
+
+#include <stdint.h>
+#include "FixedPoint.h"
+
+// ===== MEDIANA =====
+inline int32_t median3(int32_t a, int32_t b, int32_t c) {
+    if (a > b) { int32_t t = a; a = b; b = t; }
+    if (b > c) { b = c; }
+    return (a > b) ? a : b;
+}
+
+// Mediana de las últimas N muestras (N impar y pequeño: inserción ordenada)
+template <uint8_t N>
+class MedianFilter {
+private:
+    int32_t window[N];    // orden de llegada
+    int32_t sorted[N];
+    uint8_t head;
+    uint8_t count;
+
+public:
+    MedianFilter() : head(0), count(0) {}
+
+    void reset() { head = 0; count = 0; }
+    bool isFull() const { return count == N; }
+
+    int32_t update(int32_t sample) {
+        if (count == N) {
+            // Quitar la muestra más vieja de la copia ordenada
+            int32_t old = window[head];
+            uint8_t i = 0;
+            while (i < count && sorted[i] != old) i++;
+            for (; i + 1 < count; ++i) sorted[i] = sorted[i + 1];
+            count--;
+        }
+        window[head] = sample;
+        head = (uint8_t)((head + 1) % N);
+
+        uint8_t j = count;
+        while (j > 0 && sorted[j - 1] > sample) { sorted[j] = sorted[j - 1]; j--; }
+        sorted[j] = sample;
+        count++;
+        return sorted[count / 2];
+    }
+
+    int32_t value() const { return count ? sorted[count / 2] : 0; }
+};
+
+// ===== MEDIA MÓVIL =====
+template <uint8_t N>
+class MovingAverage {
+private:
+    int32_t samples[N];
+    int32_t sum;          // cuidado con N * |muestra| < 2^31
+    uint8_t head;
+    uint8_t count;
+
+public:
+    MovingAverage() : sum(0), head(0), count(0) {}
+
+    void reset() { sum = 0; head = 0; count = 0; }
+    bool isFull() const { return count == N; }
+
+    int32_t update(int32_t sample) {
+        if (count == N) sum -= samples[head];
+        else count++;
+        samples[head] = sample;
+        sum += sample;
+        head = (uint8_t)((head + 1) % N);
+        return value();
+    }
+
+    int32_t value() const {
+        if (count == 0) return 0;
+        return (sum >= 0) ? (sum + count / 2) / count : (sum - count / 2) / count;
+    }
+};
+
+// ===== EMA =====
+// y += alpha * (x - y), alpha en Q16.16 (0 < alpha <= 1). Estado en Q16.16,
+// así el redondeo no se "pega" a un valor cuando alpha es chico.
+class EmaFilter {
+private:
+    q16_t alpha;
+    q16_t state;
+    bool primed;
+
+public:
+    explicit EmaFilter(q16_t alphaQ16 = q16FromFloat(0.2f))
+        : alpha(alphaQ16), state(0), primed(false) {}
+
+    void reset() { primed = false; state = 0; }
+    void prime(int32_t sample) { state = q16FromInt(sample); primed = true; }
+    void setAlpha(q16_t alphaQ16) { alpha = alphaQ16; }
+
+    q16_t update(int32_t sample) {
+        if (!primed) { prime(sample); return state; }
+        q16_t x = q16FromInt(sample);
+        state += q16Mul(alpha, x - state);
+        return state;
+    }
+
+    q16_t valueQ16() const { return state; }
+    int32_t value() const { return q16ToInt(state); }
+};
+
+// ===== ALFA-BETA (Kalman de estado estacionario) =====
+// Sigue valor y velocidad; dt fijo implícito en las ganancias.
+class AlphaBetaFilter {
+private:
+    q16_t alpha;
+    q16_t beta;
+    q16_t x;      // estimación
+    q16_t v;      // velocidad (unidades por muestra)
+    bool primed;
+
+public:
+    AlphaBetaFilter(q16_t alphaQ16 = q16FromFloat(0.5f), q16_t betaQ16 = q16FromFloat(0.1f))
+        : alpha(alphaQ16), beta(betaQ16), x(0), v(0), primed(false) {}
+
+    void reset() { primed = false; x = 0; v = 0; }
+
+    q16_t update(int32_t sample) {
+        q16_t z = q16FromInt(sample);
+        if (!primed) { x = z; v = 0; primed = true; return x; }
+        q16_t predicted = x + v;
+        q16_t residual = z - predicted;
+        x = predicted + q16Mul(alpha, residual);
+        v = v + q16Mul(beta, residual);
+        return x;
+    }
+
+    q16_t valueQ16() const { return x; }
+    q16_t velocityQ16() const { return v; }
+    int32_t value() const { return q16ToInt(x); }
+};
+
+// ===== COMPARADOR CON HISTÉRESIS =====
+// Se activa al cruzar onThreshold y se desactiva al volver de offThreshold.
+// risingActive = true: activo si valor >= on (p.ej. nivel de gas);
+// false: activo si valor <= on (p.ej. distancia corta = presencia).
+class HysteresisComparator {
+private:
+    int32_t onThreshold;
+    int32_t offThreshold;
+    bool risingActive;
+    bool active;
+
+public:
+    HysteresisComparator(int32_t on, int32_t off, bool rising = true)
+        : onThreshold(on), offThreshold(off), risingActive(rising), active(false) {}
+
+    void setThresholds(int32_t on, int32_t off) { onThreshold = on; offThreshold = off; }
+    void reset(bool state = false) { active = state; }
+
+    bool update(int32_t value) {
+        if (risingActive) {
+            if (!active && value >= onThreshold) active = true;
+            else if (active && value < offThreshold) active = false;
+        } else {
+            if (!active && value <= onThreshold) active = true;
+            else if (active && value > offThreshold) active = false;
+        }
+        return active;
+    }
+
+    bool isActive() const { return active; }
+};
+
+#endif // SIGNAL_FILTERS_H
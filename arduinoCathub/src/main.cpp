@@ -2,69 +2,226 @@
 #include <Arduino.h>
 #include "Devices/SensorManager.h"
 #include "protocol/CommandProcessor.h"
+#include "protocol/DeviceRouter.h"
+#include "protocol/BusLink.h"
+#include "config/StationLayout.h"
 #include "Devices/litterbox/actuators/LitterboxStepperMotor.h"
 #include "Devices/feeder/actuators/FeederStepperMotor.h"
 #include "Devices/waterdispenser/actuators/WaterDispenserPump.h"
+#include "state/ConfigStore.h"
+#include "state/ParamTable.h"
+#include "system/SafetyInterlock.h"
+#include "system/Watchdog.h"
+#include "system/LoopProfiler.h"
 
 // 🔥 CREAR TODAS LAS INSTANCIAS UNA SOLA VEZ EN MAIN
-// LITTERBOX
-LitterboxUltrasonicSensor litterboxUltrasonic;
-LitterboxDHTSensor litterboxDHT;
-LitterboxMQ2Sensor litterboxMQ2;
-LitterboxStepperMotor litterboxMotor;
-
-// FEEDER  
-FeederWeightSensor feederWeight;
-FeederUltrasonicSensor1 feederUltrasonicCat;
-FeederUltrasonicSensor2 feederUltrasonicFood;
-FeederStepperMotor feederMotor;
-
-// WATER DISPENSER
-WaterDispenserSensor waterSensor;
-WaterDispenserIRSensor waterIRSensor;
-WaterDispenserPump waterPump;
-
-// 🔥 SENSORMANAGER RECIBE TODAS LAS INSTANCIAS COMO PUNTEROS
-SensorManager sensorManager(&litterboxUltrasonic, &litterboxDHT, &litterboxMQ2, &litterboxMotor,
-                            &feederWeight, &feederUltrasonicCat, &feederUltrasonicFood, &feederMotor,
-                            &waterSensor, &waterPump, &waterIRSensor);
-
-// 🔥 COMMANDPROCESSOR RECIBE LAS MISMAS INSTANCIAS
-CommandProcessor commandProcessor(&sensorManager, &litterboxMotor, &feederMotor, &waterPump);
+// Una estación = arenero + comedero + bebedero, con sus pines e IDs de
+// config/StationLayout.h. La placa atiende CATHUB_UNITS estaciones.
+struct Station {
+    // LITTERBOX
+    LitterboxUltrasonicSensor litterboxUltrasonic;
+    LitterboxDHTSensor litterboxDHT;
+    LitterboxMQ2Sensor litterboxMQ2;
+    LitterboxStepperMotor litterboxMotor;
+
+    // FEEDER
+    FeederWeightSensor feederWeight;
+    FeederUltrasonicSensor1 feederUltrasonicCat;
+    FeederUltrasonicSensor2 feederUltrasonicFood;
+    FeederStepperMotor feederMotor;
+
+    // WATER DISPENSER
+    WaterDispenserSensor waterSensor;
+    WaterDispenserIRSensor waterIRSensor;
+    WaterDispenserPump waterPump;
+
+    // 🔥 SENSORMANAGER Y COMMANDPROCESSOR RECIBEN LAS INSTANCIAS COMO PUNTEROS
+    SensorManager sensorManager;
+    CommandProcessor commandProcessor;
+
+    explicit Station(uint8_t unit)
+        : Station(STATION_LAYOUTS[unit], unit) {}
+
+    Station(const StationLayout& l, uint8_t unit)
+        : litterboxUltrasonic(FPSTR(l.litterUltraId), FPSTR(l.litterboxId), l.litterTrigPin, l.litterEchoPin, unit),
+          litterboxDHT(FPSTR(l.litterDhtId), FPSTR(l.litterboxId), l.dhtPin),
+          litterboxMQ2(FPSTR(l.litterMq2Id), FPSTR(l.litterboxId), l.mq2Pin, unit),
+          litterboxMotor(FPSTR(l.litterMotorId), FPSTR(l.litterboxId), l.litterDirPin, l.litterEnPin, l.litterPullPin, unit),
+          feederWeight(FPSTR(l.feederWeightId), FPSTR(l.feederId), l.hxDoutPin, l.hxSckPin, unit),
+          feederUltrasonicCat(FPSTR(l.feederCatId), FPSTR(l.feederId), l.catTrigPin, l.catEchoPin),
+          feederUltrasonicFood(FPSTR(l.feederFoodId), FPSTR(l.feederId), l.foodTrigPin, l.foodEchoPin),
+          feederMotor(FPSTR(l.feederMotorId), FPSTR(l.feederId), l.feederDirPin, l.feederEnPin, l.feederPullPin, unit),
+          waterSensor(FPSTR(l.waterLevelId), FPSTR(l.waterId), l.waterLevelPin, unit),
+          waterIRSensor(FPSTR(l.waterIrId), FPSTR(l.waterId), l.irPin, unit),
+          waterPump(FPSTR(l.pumpId), FPSTR(l.waterId), l.pumpPin, unit),
+          sensorManager(&litterboxUltrasonic, &litterboxDHT, &litterboxMQ2, &litterboxMotor,
+                        &feederWeight, &feederUltrasonicCat, &feederUltrasonicFood, &feederMotor,
+                        &waterSensor, &waterPump, &waterIRSensor, unit),
+          commandProcessor(&sensorManager, &litterboxMotor, &feederMotor, &waterPump, unit) {}
+};
+
+// SRAM del Mega: 8 KB para todo. Las estaciones tienen tope para que queden
+// ~4 KB a BusLink (txBuf), Serial, ConfigStore, el anillo de TRACE y la pila.
+// En el AVR una estación ronda 0.93 KB; en la PC (punteros y long de 8 bytes)
+// pasa de 1.7 KB, por eso sólo se verifica al compilar para la placa.
+// La configuración va aparte: ConfigStore y los SET pendientes de ParamTable
+// guardan cada uno una ConfigData con el bloque de las 3 estaciones (~160 B),
+// tenga la placa las que tenga.
+#ifndef CATHUB_STATION_SRAM_BYTES
+#define CATHUB_STATION_SRAM_BYTES 4096
+#endif
+#ifndef CATHUB_CONFIG_SRAM_BYTES
+#define CATHUB_CONFIG_SRAM_BYTES 384
+#endif
+#if defined(__AVR__)
+static_assert(sizeof(Station) * CATHUB_UNITS <= CATHUB_STATION_SRAM_BYTES,
+              "Las estaciones no entran en la SRAM del Mega: bajar CATHUB_UNITS");
+static_assert(sizeof(ConfigStore) + sizeof(ParamTable) <= CATHUB_CONFIG_SRAM_BYTES,
+              "ConfigData creció: revisar el reparto de SRAM antes de subir el tope");
+#endif
+
+Station station1(0);
+#if CATHUB_UNITS >= 2
+Station station2(1);
+#endif
+#if CATHUB_UNITS >= 3
+Station station3(2);
+#endif
+
+Station* const stations[CATHUB_UNITS] = {
+    &station1,
+#if CATHUB_UNITS >= 2
+    &station2,
+#endif
+#if CATHUB_UNITS >= 3
+    &station3,
+#endif
+};
+
+bool stationUsesPin(uint8_t pin) {
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        const StationLayout& l = STATION_LAYOUTS[u];
+        const uint8_t pins[] = {
+            l.litterTrigPin, l.litterEchoPin, l.dhtPin, l.mq2Pin, l.litterDirPin, l.litterEnPin, l.litterPullPin,
+            l.hxDoutPin, l.hxSckPin, l.catTrigPin, l.catEchoPin, l.foodTrigPin, l.foodEchoPin,
+            l.feederDirPin, l.feederEnPin, l.feederPullPin, l.waterLevelPin, l.irPin, l.pumpPin
+        };
+        for (uint8_t i = 0; i < sizeof(pins); ++i) {
+            if (pins[i] == pin) return true;
+        }
+    }
+    return false;
+}
+
+// 🔥 LOS COMANDOS SE REPARTEN POR ID DE DISPOSITIVO
+DeviceRouter router;
+
+// Tope de tiempo de lectura por vuelta, repartido entre las estaciones. Con
+// una sola no hay tope (la ronda de siempre). La estación que arranca la ronda
+// rota en cada vuelta: ninguna queda siempre última cuando se acaba el tiempo.
+static const uint32_t SENSOR_BUDGET_US = 40000;
+static uint8_t firstUnit = 0;
+
+static const uint8_t BUS_LINES_PER_LOOP = 16;
 
 void setup() {
+    Watchdog::captureResetCause();
     Serial.begin(115200);
     while(!Serial) { delay(10); }
     
     // Serial.println(F("{\"event\":\"CATHUB_STARTING\"}"));
     
+    // Configuración persistente (calibraciones, umbrales) antes de los sensores
+    ConfigStore::getInstance().initialize();
+    BusLink::getInstance().begin();
+
     // 🔥 INICIALIZAR SISTEMAS (CADA OBJETO EXISTE UNA SOLA VEZ)
-    sensorManager.begin();
-    commandProcessor.initialize();
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        stations[u]->sensorManager.begin();
+        stations[u]->commandProcessor.initialize();
+        router.addUnit(&stations[u]->commandProcessor);
+    }
+
+    // Los dispositivos ya registraron sus pines: habilitar el tick y la PCINT
+    SafetyInterlock::begin();
     
     // Serial.println(F("{\"event\":\"CATHUB_READY\",\"message\":\"Esperando comandos de la Ras\"}"));
     
     delay(2000);
+
+    station1.commandProcessor.sendBootReport();
+    Watchdog::enable();
 }
 
 void loop() {
+    Watchdog::beginLoop();
+    PROFILE_BEGIN(PROF_LOOP);
+
+    // Sin AVR (HAL nativo) el enclavamiento se muestrea acá; en la placa corre por ISR
+    SafetyInterlock::service();
+
+    // Aplicar parámetros recibidos por SET (todos juntos, al borde del ciclo)
+    ParamTable::getInstance().applyPending();
+
     // Leer comandos del Serial
-    if (Serial.available()) {
-        String command = Serial.readStringUntil('\n');
-        commandProcessor.processCommand(command);
+    Watchdog::beginTask(WDT_TASK_COMMANDS);
+    PROFILE_BEGIN(PROF_COMMANDS);
+    // Punto a punto: un comando por vuelta. En el bus se atiende todo lo que
+    // llegó para esta placa, con un tope para que un host que no para de
+    // hablar no deje al resto sin vuelta
+    BusLink& bus = BusLink::getInstance();
+    String command;
+    for (uint8_t lines = 0; lines < BUS_LINES_PER_LOOP; ++lines) {
+        BusFrame frame = bus.receive(command);
+        if (frame == BUS_FRAME_COMMAND) router.processCommand(command);
+        else if (frame == BUS_FRAME_POLL) bus.sendTurn();
+        else break;
+        if (!bus.isNode()) break;
     }
-    
+    PROFILE_END(PROF_COMMANDS);
+    Watchdog::endTask(WDT_TASK_COMMANDS);
+
     // Actualizar sensores
-    sensorManager.poll();
-    
+    Watchdog::beginTask(WDT_TASK_SENSORS);
+    PROFILE_BEGIN(PROF_SENSORS);
+    uint32_t budgetUs = (CATHUB_UNITS > 1) ? SENSOR_BUDGET_US / CATHUB_UNITS : 0;
+    for (uint8_t i = 0; i < CATHUB_UNITS; ++i) {
+        stations[(firstUnit + i) % CATHUB_UNITS]->sensorManager.poll(budgetUs);
+    }
+    firstUnit = (firstUnit + 1) % CATHUB_UNITS;
+    PROFILE_END(PROF_SENSORS);
+    Watchdog::endTask(WDT_TASK_SENSORS);
+
     // Actualizar sistema automático
-    commandProcessor.update();
+    Watchdog::beginTask(WDT_TASK_AUTOMATION);
+    PROFILE_BEGIN(PROF_AUTOMATION);
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) stations[u]->commandProcessor.update();
+    PROFILE_END(PROF_AUTOMATION);
+    Watchdog::endTask(WDT_TASK_AUTOMATION);
 
     // Actualizar motor del comedero (genera los pasos cuando está en modo continuous)
-    feederMotor.update();
-    
+    Watchdog::beginTask(WDT_TASK_ACTUATORS);
+    PROFILE_BEGIN(PROF_FEEDER_MOTOR);
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) stations[u]->feederMotor.update();
+    PROFILE_END(PROF_FEEDER_MOTOR);
+
     // Actualizar bomba de agua directamente
-    waterPump.update();
-    
-    delay(50);
-}
\ No newline at end of file
+    PROFILE_BEGIN(PROF_WATER_PUMP);
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) stations[u]->waterPump.update();
+    PROFILE_END(PROF_WATER_PUMP);
+    Watchdog::endTask(WDT_TASK_ACTUATORS);
+
+    // Sólo se alimenta al perro si todas las tareas completaron su vuelta
+    Watchdog::endLoop();
+
+    // La pausa final no cuenta: se mide el trabajo de la vuelta
+    PROFILE_END(PROF_LOOP);
+
+    // Con algún tambor de arenero o sinfín del comedero girando no hay pausa:
+    // cada vuelta da (a lo sumo) un paso, y 50 ms por paso los deja casi quietos
+    bool motorMoving = false;
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        if (stations[u]->litterboxMotor.isMoving() || stations[u]->feederMotor.isRunning()) motorMoving = true;
+    }
+    if (!motorMoving) bus.idle(50);
+}
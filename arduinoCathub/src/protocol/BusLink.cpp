@@ -0,0 +1,193 @@
+// BusLink.cpp
+#include "BusLink.h"
+#include "JsonWriter.h"
+#include "../state/ConfigStore.h"
+
+BusLink::BusLink()
+    : txStart(0),
+      txUsed(0),
+      txPartial(0),
+      dropLine(false),
+      discarded(0),
+      rxOverflow(false),
+      rxFrame(BUS_FRAME_NONE),
+      rxQuietAt(0),
+      drivePin(0) {
+}
+
+void BusLink::begin() {
+    setDriver(false);
+}
+
+// DE/RE del transceptor: alto transmite, bajo escucha. Si cambia bus_de_pin
+// se configura el pin nuevo la próxima vez (el anterior queda en recepción)
+void BusLink::setDriver(bool transmit) {
+    uint8_t pin = (uint8_t)ConfigStore::getInstance().get().busDePin;
+    if (pin == 0) return;
+    if (pin != drivePin) {
+        if (drivePin != 0) digitalWrite(drivePin, LOW);
+        pinMode(pin, OUTPUT);
+        drivePin = pin;
+    }
+    digitalWrite(pin, transmit ? HIGH : LOW);
+}
+
+Print& BusLink::out() {
+    BusLink& link = getInstance();
+    if (link.isNode()) return link;
+    return Serial;
+}
+
+uint8_t BusLink::getAddress() const {
+    return (uint8_t)ConfigStore::getInstance().get().nodeAddress;
+}
+
+static bool isAddressDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+BusFrame BusLink::accept(String& line) {
+    uint8_t address = getAddress();
+
+    // "@NN:..." dirigido a este nodo o a todos; las respuestas de los otros
+    // nodos ("#NN:...") también se escuchan en el bus y se ignoran
+    line.trim();
+    if (line.length() < 5 || line.charAt(0) != '@' || line.charAt(3) != ':' ||
+        !isAddressDigit(line.charAt(1)) || !isAddressDigit(line.charAt(2))) {
+        return BUS_FRAME_NONE;
+    }
+    uint8_t to = (uint8_t)((line.charAt(1) - '0') * 10 + (line.charAt(2) - '0'));
+    if (to != address && to != 0) return BUS_FRAME_NONE;
+
+    line.remove(0, 4);
+    if (line.length() == 1 && line.charAt(0) == '?') {
+        return (to == address) ? BUS_FRAME_POLL : BUS_FRAME_NONE;
+    }
+    return BUS_FRAME_COMMAND;
+}
+
+BusFrame BusLink::collect() {
+    // Lo que está en la UART llegó después de rxQuietAt: es la cota de su edad
+    if (!Serial.available()) rxQuietAt = millis();
+    while (Serial.available()) {
+        char c = (char)Serial.read();
+        if (c != '\n') {
+            if (rxLine.length() < BUS_MAX_LINE) rxLine += c;
+            else rxOverflow = true;
+            continue;
+        }
+        BusFrame frame = rxOverflow ? BUS_FRAME_NONE : accept(rxLine);
+        rxOverflow = false;
+        if (frame != BUS_FRAME_NONE) return frame;
+        rxLine = "";
+    }
+    rxQuietAt = millis();
+    return BUS_FRAME_NONE;
+}
+
+bool BusLink::isStalePoll() const {
+    return Serial.available() > 0 || millis() - rxQuietAt > BUS_POLL_MAX_AGE_MS;
+}
+
+BusFrame BusLink::receive(String& command) {
+    if (!isNode()) {
+        if (!Serial.available()) return BUS_FRAME_NONE;
+        command = Serial.readStringUntil('\n');
+        return BUS_FRAME_COMMAND;
+    }
+
+    // Un bus_de_pin recién cambiado (SET) queda en recepción antes del primer turno
+    if (drivePin != (uint8_t)ConfigStore::getInstance().get().busDePin) setDriver(false);
+
+    // idle() puede haber dejado una trama aceptada
+    if (rxFrame == BUS_FRAME_NONE) rxFrame = collect();
+    BusFrame frame = rxFrame;
+    // Un turno que el host ya dio por perdido: contestarlo pisaría a otro nodo
+    if (frame == BUS_FRAME_POLL && isStalePoll()) {
+        rxLine = "";
+        rxFrame = BUS_FRAME_NONE;
+        return BUS_FRAME_NONE;
+    }
+    if (frame != BUS_FRAME_NONE) {
+        command = rxLine;
+        rxLine = "";
+        rxFrame = BUS_FRAME_NONE;
+    }
+    return frame;
+}
+
+void BusLink::writePrefix() {
+    uint8_t address = getAddress();
+    Serial.write('#');
+    Serial.write((uint8_t)('0' + address / 10));
+    Serial.write((uint8_t)('0' + address % 10));
+    Serial.write(':');
+}
+
+void BusLink::sendQueued() {
+    bool lineStart = true;
+    while (txUsed > 0) {
+        char c = txBuf[txStart];
+        txStart = (uint16_t)((txStart + 1) % CATHUB_BUS_TX_BYTES);
+        txUsed--;
+        if (lineStart) writePrefix();
+        if (c == '\n') Serial.write('\r');
+        Serial.write((uint8_t)c);
+        lineStart = (c == '\n');
+    }
+}
+
+void BusLink::sendTurn() {
+    setDriver(true);
+    sendQueued();
+    if (discarded > 0) {
+        // La cola quedó vacía: el aviso entra seguro
+        JsonWriter(*this).begin()
+            .beginObject(KEY_BUS).field(KEY_DISCARDED, (unsigned long)discarded).endObject()
+            .end();
+        discarded = 0;
+        sendQueued();
+    }
+    writePrefix();
+    Serial.write('.');
+    Serial.write('\r');
+    Serial.write('\n');
+    // flush() espera al último bit en el cable: soltar DE antes lo cortaría
+    Serial.flush();
+    setDriver(false);
+}
+
+void BusLink::idle(unsigned long ms) {
+    if (!isNode()) {
+        delay(ms);
+        return;
+    }
+    unsigned long start = millis();
+    while (millis() - start < ms) {
+        if (rxFrame == BUS_FRAME_NONE) rxFrame = collect();
+        if (rxFrame != BUS_FRAME_NONE) return;
+        delay(1);
+    }
+}
+
+size_t BusLink::write(uint8_t c) {
+    if (c == '\r') return 1;                      // se agrega al mandar
+    if (dropLine) {
+        if (c == '\n') dropLine = false;
+        return 1;
+    }
+    if ((uint16_t)(txUsed + txPartial) >= CATHUB_BUS_TX_BYTES) {
+        // Sin lugar: se pierde la línea entera, nunca un pedazo
+        txPartial = 0;
+        discarded++;
+        dropLine = (c != '\n');
+        return 1;
+    }
+    txBuf[(txStart + txUsed + txPartial) % CATHUB_BUS_TX_BYTES] = (char)c;
+    txPartial++;
+    if (c == '\n') {
+        txUsed = (uint16_t)(txUsed + txPartial);
+        txPartial = 0;
+    }
+    return 1;
+}
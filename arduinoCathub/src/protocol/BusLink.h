@@ -0,0 +1,100 @@
+// BusLink.h
+#ifndef BUS_LINK_H
+#define BUS_LINK_H
+
+#include <Arduino.h>
+
+// Cola de salida de un nodo del bus: lo que escribe mientras no tiene el turno
+#ifndef CATHUB_BUS_TX_BYTES
+#define CATHUB_BUS_TX_BYTES 512
+#endif
+
+static const uint8_t BUS_MAX_ADDRESS = 99;    // dos dígitos; 00 = a todos
+// Línea más larga que se junta en el bus: las respuestas de los otros nodos
+// (un DIAG entero) también pasan por el receptor y no deben crecer el heap
+static const uint8_t BUS_MAX_LINE = 128;
+// Un turno más viejo que esto ya no se contesta: el host lo dio por perdido
+// (turn_timeout de BusMultiplexer, 250 ms) y puede estar escuchando a otro nodo
+static const uint16_t BUS_POLL_MAX_AGE_MS = 150;
+
+// Qué trajo receive()
+enum BusFrame : uint8_t {
+    BUS_FRAME_NONE,       // nada completo para esta placa todavía
+    BUS_FRAME_COMMAND,    // comando para esta placa (sin el prefijo)
+    BUS_FRAME_POLL        // el host le pasa el turno
+};
+
+// Enlace con el host. Con node_addr = 0 (de fábrica, ver CATHUB_NODE_ADDR)
+// es el puerto serie punto a punto de siempre: out() es Serial y cada línea
+// recibida es un comando. Con node_addr = 1..99 la placa es un nodo de un
+// bus half-duplex compartido (RS-485) en el que sólo habla quien tiene el
+// turno:
+//   host -> nodo  "@NN:<comando>"  se ejecuta; lo que responde queda en cola
+//                 "@00:<comando>"  lo ejecutan todos los nodos
+//                 "@NN:?"          turno: el nodo vacía su cola
+//   nodo -> host  "#NN:<línea>"    cada línea de la cola (respuestas y eventos)
+//                 "#NN:."          fin del turno, el bus queda libre
+// Un comando no da el turno: el host manda los de cada nodo en la misma
+// escritura que su "@NN:?", y como se atienden en orden la respuesta ya está
+// en la cola cuando llega el turno.
+// El filtro de dirección está en la recepción (como el modo multiprocesador
+// de la USART): las tramas de los otros nodos se descartan byte a byte sin
+// despertar al loop, así un nodo no gasta una vuelta entera de sensores por
+// cada turno ajeno y está libre cuando le llega el suyo.
+// Si la cola se llena se descartan líneas enteras; el turno siguiente lo
+// avisa con {"bus":{"discarded":N}}.
+// Un nodo que estuvo bloqueado (CAL_MQ2, una vuelta de sensores larga)
+// encuentra su "@NN:?" en el buffer de la UART cuando el host ya siguió con
+// otro: ese turno se descarta si detrás llegó cualquier otra cosa o si pudo
+// haber llegado hace más de BUS_POLL_MAX_AGE_MS. El host vuelve a pedirlo.
+// Con un transceptor RS-485 (MAX485) el pin bus_de_pin maneja DE y /RE:
+// en alto sólo durante el turno, hasta que sale el último bit de "#NN:.".
+class BusLink : public Print {
+private:
+    char txBuf[CATHUB_BUS_TX_BYTES];
+    uint16_t txStart;         // primer byte de la línea más vieja
+    uint16_t txUsed;          // bytes de líneas completas
+    uint16_t txPartial;       // bytes de la línea que se está escribiendo
+    bool dropLine;            // la línea en curso no entró: se descarta hasta '\n'
+    uint16_t discarded;       // líneas descartadas desde el último turno
+
+    String rxLine;            // línea que se está juntando (o la ya aceptada)
+    bool rxOverflow;          // pasó de BUS_MAX_LINE: se descarta hasta '\n'
+    BusFrame rxFrame;         // trama aceptada que espera a receive()
+    unsigned long rxQuietAt;  // millis() de la última vez que la UART estaba vacía
+    uint8_t drivePin;         // pin DE/RE ya configurado como salida (0 = ninguno)
+
+    BusLink();
+    BusFrame accept(String& line);
+    BusFrame collect();
+    bool isStalePoll() const;
+    void sendQueued();
+    void writePrefix();
+    void setDriver(bool transmit);
+
+public:
+    static BusLink& getInstance() {
+        static BusLink instance;
+        return instance;
+    }
+
+    // Destino de todas las respuestas y eventos: Serial o la cola del nodo
+    static Print& out();
+
+    uint8_t getAddress() const;               // node_addr de ConfigStore
+    bool isNode() const { return getAddress() != 0; }
+    void begin();                             // transceptor en recepción (después de ConfigStore)
+
+    // Próxima línea para esta placa. Punto a punto es el readStringUntil()
+    // de siempre; en el bus se junta byte a byte, sin esperar el resto
+    BusFrame receive(String& command);
+    void sendTurn();                          // respuesta a "@NN:?"
+    // delay() que en el bus se corta en cuanto llega una trama para esta
+    // placa: el turno no espera la pausa del loop
+    void idle(unsigned long ms);
+
+    size_t write(uint8_t c) override;
+    using Print::write;
+};
+
+#endif
@@ -1,16 +1,65 @@
 // CommandProcessor.cpp
 #include "CommandProcessor.h"
 #include <ArduinoJson.h>
+#include "JsonWriter.h"
+#include "ProtocolStrings.h"
+#include "../Devices/config/DeviceIDs.h"
+#include "../Devices/litterbox/config/SensorIDs.h"
+#include "../Devices/feeder/config/SensorIDs.h"
+#include "../Devices/waterdispenser/config/SensorIDs.h"
+#include "../state/ConfigStore.h"
+#include "../state/ParamTable.h"
+#include "../system/LoopProfiler.h"
+#include "../system/TraceBuffer.h"
+#include "../system/TelemetryBench.h"
+#include "TelemetryEncoder.h"
+
+// Entero o decimal con signo opcional; toFloat() devuelve 0 ante basura
+static bool isNumeric(const String& text) {
+    if (text.length() == 0) return false;
+    bool digits = false, dot = false;
+    for (unsigned int i = 0; i < text.length(); ++i) {
+        char c = text.charAt(i);
+        if (c >= '0' && c <= '9') digits = true;
+        else if (c == '.' && !dot) dot = true;
+        else if (!(i == 0 && (c == '-' || c == '+'))) return false;
+    }
+    return digits;
+}
+
+// Selector de estación "@N" (N = 1..CATHUB_UNITS) al final de un comando o de
+// un nombre de parámetro: lo quita de `text`. 0 = sin selector, -1 = N no existe
+static int8_t takeStation(String& text) {
+    int at = text.lastIndexOf('@');
+    if (at < 0) return 0;
+    String digits = text.substring(at + 1);
+    text.remove(at);
+    if (digits.length() == 0 || digits.length() > 2) return -1;
+    for (unsigned int i = 0; i < digits.length(); ++i) {
+        if (digits.charAt(i) < '0' || digits.charAt(i) > '9') return -1;
+    }
+    long n = digits.toInt();
+    return (n >= 1 && n <= CATHUB_UNITS) ? (int8_t)n : -1;
+}
 
 CommandProcessor::CommandProcessor(SensorManager* sensors, LitterboxStepperMotor* litter,
-    FeederStepperMotor* feeder, WaterDispenserPump* water)
+    FeederStepperMotor* feeder, WaterDispenserPump* water, uint8_t unit)
     : sensorManager(sensors),
       litterboxMotor(litter),
       feederMotor(feeder),
       waterPump(water),
       initialized(false),
+      unit(unit),
+      litterboxId(litter ? litter->getDeviceId() : FPSTR(DEVICE_ID_LITTERBOX)),
+      feederId(feeder ? feeder->getDeviceId() : FPSTR(DEVICE_ID_FEEDER)),
+      waterId(water ? water->getDeviceId() : FPSTR(DEVICE_ID_WATER)),
+      lastUpdate(0),
       manualFeederControl(false),
-      litterboxState(1) {
+      litterboxState(1),
+      dispenser(sensors, feeder, unit),
+      presence(sensors, unit),
+      waterRefill(sensors ? sensors->getWaterSensor() : nullptr, water, unit),
+      cleaning(litter) {
 }
 
 bool CommandProcessor::initialize() {
@@ -28,183 +77,326 @@ void CommandProcessor::processCommand(String command) {
     command.trim();
     if (command.length() == 0) return;
 
-    if (command == "PING") { Serial.println("{\"response\":\"PONG\"}"); return; }
-    if (command == "ALL")    { sendAllDevicesStatus(); return; }
-    if (command == "C")    { sendPlainTextSensors(); return; }
+    if (protoEquals(command, CMD_PING))          { JsonWriter(BusLink::out()).begin().field(KEY_RESPONSE, VAL_PONG).end(); return; }
+    if (protoEquals(command, CMD_ALL))           { sendAllDevicesStatus(); return; }
+    if (protoEquals(command, CMD_PLAIN_SENSORS)) { sendPlainTextSensors(); return; }
+    if (protoEquals(command, CMD_CFG))           { sendConfig(0); return; }
+    if (protoEquals(command, CMD_CFG_RESET))     { resetConfig(); return; }
+    if (protoEquals(command, CMD_LIST))          { sendParamList(0); return; }
+    if (protoEquals(command, CMD_RATES))         { sendSensorRates(); return; }
+    if (protoEquals(command, CMD_DIAG))          { sendSensorHealth(); return; }
+    if (protoEquals(command, CMD_DIAG_RESET))    { resetSensorHealth(); sendSensorHealth(); return; }
+    if (protoEquals(command, CMD_WDT))           { sendWatchdogStats(); return; }
+    if (protoEquals(command, CMD_WDT_RESET))     { Watchdog::resetStats(); sendWatchdogStats(); return; }
+    if (protoEquals(command, CMD_PROF))          { sendProfile(); return; }
+    if (protoEquals(command, CMD_PROF_RESET))    { resetProfile(); return; }
+    if (protoEquals(command, CMD_TRACE))         { sendTrace(); return; }
+    if (protoEquals(command, CMD_TRACE_RESET))   { resetTrace(); return; }
+    if (protoEquals(command, CMD_BENCH))         { sendBench(); return; }
+    if (protoStartsWith(command, CMD_GET_PREFIX)) { sendParam(command.substring(4)); return; }
+    if (protoStartsWith(command, CMD_SET_PREFIX)) { setParam(command.substring(4)); return; }
+
+    // CFG@N / LIST@N
+    if (command.indexOf('@') > 0) {
+        String base = command;
+        int8_t station = takeStation(base);
+        bool cfg = protoEquals(base, CMD_CFG);
+        if (cfg || protoEquals(base, CMD_LIST)) {
+            if (station < 0) {
+                JsonWriter(BusLink::out()).begin().field(KEY_ERROR, VAL_UNKNOWN_STATION).field(KEY_RECEIVED, command).end();
+            } else if (cfg) {
+                sendConfig((uint8_t)(station - 1));
+            } else {
+                sendParamList((uint8_t)(station - 1));
+            }
+            return;
+        }
+    }
 
-    if (command == "FDR1:1" || command == "FDR1:0") {
+    // FDR1:1 / FDR1:0
+    if (command.length() == 6 && command.charAt(4) == ':' &&
+        protoEquals(command.substring(0, 4), feederId) &&
+        (command.charAt(5) == '1' || command.charAt(5) == '0')) {
         bool active = (command.charAt(5) == '1');
         controlFeederMotor(active);
         return;
     }
 
-    if (command.startsWith("LTR1:")) {
+    // FDR1:TARE / FDR1:CAL:<gramos>
+    if (command.length() > 5 && command.charAt(4) == ':' &&
+        protoEquals(command.substring(0, 4), feederId)) {
+        processFeederCommand(command.substring(5));
+        return;
+    }
+
+    if (command.length() >= 5 && command.charAt(4) == ':' &&
+        protoEquals(command.substring(0, 4), litterboxId)) {
         processDeviceIDCommand(command);
         return;
     }
 
-    Serial.println("{\"error\":\"UNKNOWN_COMMAND\",\"received\":\"" + command + "\"}");
+    JsonWriter(BusLink::out()).begin().field(KEY_ERROR, VAL_UNKNOWN_COMMAND).field(KEY_RECEIVED, command).end();
 }
 
 void CommandProcessor::processDeviceIDCommand(String command) {
     String deviceId = command.substring(0, 4);
     String action = command.substring(5);
 
-    if (deviceId != "LTR1") {
-        Serial.println("{\"device_id\":\"" + deviceId + "\",\"error\":\"UNKNOWN_DEVICE\"}");
+    if (!protoEquals(deviceId, litterboxId)) {
+        JsonWriter(BusLink::out()).begin().field(KEY_DEVICE_ID, deviceId).field(KEY_ERROR, VAL_UNKNOWN_DEVICE).end();
         return;
     }
 
-    if (action == "STATUS") {
+    if (protoEquals(action, CMD_STATUS)) {
         sendLitterboxStatus();
-    } else if (action == "READY" || action == "2") {
+    } else if (protoEquals(action, CMD_READY) || protoEquals(action, CMD_STATE_READY)) {
         setLitterboxReady();
-    } else if (action == "CLEAN_NORMAL" || action == "2.1") {
+    } else if (protoEquals(action, VAL_CLEAN_NORMAL) || protoEquals(action, CMD_STATE_NORMAL)) {
         startNormalCleaning();
-    } else if (action == "CLEAN_DEEP" || action == "2.2") {
+    } else if (protoEquals(action, VAL_CLEAN_DEEP) || protoEquals(action, CMD_STATE_DEEP)) {
         startDeepCleaning();
+    } else if (protoEquals(action, CMD_CAL_MQ2)) {
+        calibrateLitterboxMQ2();
     } else {
-        Serial.println("{\"device_id\":\"" + deviceId + "\",\"error\":\"UNKNOWN_ACTION\",\"action\":\"" + action + "\"}");
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, deviceId)
+            .field(KEY_ERROR, VAL_UNKNOWN_ACTION)
+            .field(KEY_ACTION, action)
+            .end();
     }
 }
 
+// Respuesta estándar de acción del arenero: {"device_id":"LTR1","action":...,"success":false,"reason":...}
+void CommandProcessor::sendLitterboxActionFailure(ProtoStr action, ProtoStr reason) {
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_DEVICE_ID, litterboxId)
+        .field(KEY_ACTION, action)
+        .field(KEY_SUCCESS, false)
+        .field(KEY_REASON, reason)
+        .end();
+}
+
 // ===== IMPLEMENTACIÓN ARENERO (LTR1) =====
 void CommandProcessor::sendLitterboxStatus() {
     int motorState = (litterboxMotor ? litterboxMotor->getState() : 0);
-    String stateStr = (motorState == 2) ? "ACTIVE" : (motorState == 1 ? "INACTIVE" : "UNKNOWN");
+    ProtoStr stateStr = (motorState == 2) ? VAL_ACTIVE : (motorState == 1 ? VAL_INACTIVE : VAL_UNKNOWN);
+
+    // Se evalúa antes de emitir para que el log de safety_check no quede dentro del JSON
+    bool safe = isLitterboxSafeToOperate();
 
-    String response = "{\"device_id\":\"LTR1\",\"status\":\"" + stateStr + "\",";
-    response += "\"state\":" + String(litterboxState) + ",";
-    response += "\"distance_cm\":" + String(sensorManager ? sensorManager->getLitterboxDistance() : -1.0) + ",";
-    response += "\"temperature_c\":" + String(sensorManager ? sensorManager->getLitterboxTemperature() : -999.0) + ",";
-    response += "\"humidity_percent\":" + String(sensorManager ? sensorManager->getLitterboxHumidity() : -1.0) + ",";
-    response += "\"gas_ppm\":" + String(sensorManager ? sensorManager->getLitterboxGasPPM() : -1.0) + ",";
-    response += "\"motor_ready\":" + String(litterboxMotor ? (litterboxMotor->isReady() ? "true" : "false") : "false") + ",";
-    response += "\"safe_to_operate\":" + String(isLitterboxSafeToOperate() ? "true" : "false");
-    response += "}";
-    Serial.println(response);
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_DEVICE_ID, litterboxId)
+        .field(KEY_STATUS, stateStr)
+        .field(KEY_STATE, litterboxState)
+        .field(KEY_DISTANCE_CM, sensorManager ? sensorManager->getLitterboxDistance() : -1.0)
+        .field(KEY_TEMPERATURE_C, sensorManager ? sensorManager->getLitterboxTemperature() : -999.0)
+        .field(KEY_HUMIDITY_PERCENT, sensorManager ? sensorManager->getLitterboxHumidity() : -1.0)
+        .field(KEY_GAS_PPM, sensorManager ? sensorManager->getLitterboxGasPPM() : -1.0)
+        .field(KEY_GAS_ANALOG, sensorManager ? sensorManager->getLitterboxGasAnalog() : -1.0, 0)
+        .field(KEY_MQ2_RO, sensorManager ? sensorManager->getLitterboxGasRo() : 0.0, 3)
+        .field(KEY_MQ2_BASELINE, sensorManager ? sensorManager->getLitterboxGasBaselineRs() : 0.0)
+        .field(KEY_MOTOR_READY, litterboxMotor ? litterboxMotor->isReady() : false)
+        .field(KEY_SAFE_TO_OPERATE, safe)
+        .end();
 }
 
-void CommandProcessor::sendPlainTextSensors() {
+// Línea "ID:valor" del modo texto plano; el ID se lee de flash
+static void printPlainLine(Print& out, const __FlashStringHelper* sensorId, const String& value) {
+    out.print(sensorId);
+    out.print(':');
+    out.println(value);
+}
+
+void CommandProcessor::sendPlainTextSensors(Print& out) {
     if (!sensorManager) {
-        Serial.println("ERROR:NO_SENSOR_MANAGER");
+        out.println(protoStr(VAL_ERROR_NO_SENSOR_MANAGER));
         return;
     }
     
     // Ultrasónico arenero - solo 1 o 0 según presencia del gato
-    float litterDist = sensorManager->getLitterboxDistance();
-    bool catDetected = (litterDist > 0.0f && litterDist <= 8.0f);
-    Serial.println("LUT_001:" + String(catDetected ? "1" : "0"));
+    bool catDetected = presence.isOccupied(PRESENCE_LITTERBOX);
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_LITTER_RANGE), String(catDetected ? '1' : '0'));
     
     // DHT (Temperatura)
     float temp = sensorManager->getLitterboxTemperature();
-    Serial.println("DHT_001:" + String(temp));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_LITTER_DHT), String(temp));
     
     // DHT (Humedad)
     float hum = sensorManager->getLitterboxHumidity();
-    Serial.println("DHT_001:" + String(hum));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_LITTER_DHT), String(hum));
     
-    // MQ2 (Gas) - CORREGIR: usar el método público del SensorManager
-    float gas = sensorManager->getLitterboxGasPPM();  // ✅ CAMBIAR
-    Serial.println("MQ2_001:" + String(gas));
+    // MQ2 (Gas)
+    float gas = sensorManager->getLitterboxGasPPM();
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_LITTER_MQ2), String(gas));
     
     // Ultrasónico comedero (distancia al gato)
     float feederCatDist = sensorManager->getFeederCatDistance();
-    Serial.println("UTS_001:" + String(feederCatDist));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_FEEDER_CAT_RANGE), String(feederCatDist));
     
     // Ultrasónico comedero (distancia a la comida)
     float feederFoodDist = sensorManager->getFeederFoodDistance();
-    Serial.println("UTS_002:" + String(feederFoodDist));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_FEEDER_FOOD_RANGE), String(feederFoodDist));
     
     // Peso comedero
     float feederWeight = sensorManager->getFeederWeight();
-    Serial.println("WIT_001:" + String(feederWeight));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_FEEDER_WEIGHT), String(feederWeight));
     
     // Estado agua
     String waterLevel = sensorManager->getWaterLevel();
-    Serial.println("WLV_001:" + String(waterLevel == "FLOOD" ? "1" : "0"));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_WATER_LEVEL), String(protoEquals(waterLevel, VAL_FLOOD) ? '1' : '0'));
 
     // IR agua (detección de gato)
     bool catDrinking = sensorManager->isCatDrinking();
-    Serial.println("WIR_001:" + String(catDrinking ? "1" : "0"));
+    printPlainLine(out, sensorManager->getChannelSensorId(SENSOR_CH_WATER_IR), String(catDrinking ? '1' : '0'));
 }
 
 void CommandProcessor::setLitterboxReady() {
     if (!sensorManager) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"SET_READY\",\"success\":false,\"reason\":\"NO_SENSOR_MANAGER\"}");
+        sendLitterboxActionFailure(VAL_SET_READY, VAL_NO_SENSOR_MANAGER);
         return;
     }
     if (!isLitterboxSafeToOperate()) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"SET_READY\",\"success\":false,\"reason\":\"NOT_SAFE\"}");
+        sendLitterboxActionFailure(VAL_SET_READY, VAL_NOT_SAFE);
         return;
     }
     if (!litterboxMotor) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"SET_READY\",\"success\":false,\"reason\":\"NO_MOTOR\"}");
+        sendLitterboxActionFailure(VAL_SET_READY, VAL_NO_MOTOR);
+        return;
+    }
+    if (cleaning.isActive()) {
+        sendLitterboxActionFailure(VAL_SET_READY, VAL_BUSY);
         return;
     }
 
     if (litterboxMotor->setReady()) {
         litterboxState = 2;
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"SET_READY\",\"success\":true,\"state\":2}");
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, litterboxId)
+            .field(KEY_ACTION, VAL_SET_READY)
+            .field(KEY_SUCCESS, true)
+            .field(KEY_STATE, 2)
+            .end();
     } else {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"SET_READY\",\"success\":false,\"reason\":\"MOTOR_FAILED\"}");
+        sendLitterboxActionFailure(VAL_SET_READY, VAL_MOTOR_FAILED);
     }
 }
 void CommandProcessor::startNormalCleaning() {
+    startCleaning(CLEANING_NORMAL);
+}
+
+void CommandProcessor::startDeepCleaning() {
+    startCleaning(CLEANING_DEEP);
+}
+
+// La respuesta sólo confirma el arranque; el avance y el final llegan como
+// eventos CLEAN_* desde updateCleaning()
+void CommandProcessor::startCleaning(CleaningMode mode) {
+    ProtoStr action = (mode == CLEANING_NORMAL) ? VAL_CLEAN_NORMAL : VAL_CLEAN_DEEP;
     if (!litterboxMotor) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_NORMAL\",\"success\":false,\"reason\":\"NO_MOTOR\"}");
+        sendLitterboxActionFailure(action, VAL_NO_MOTOR);
+        return;
+    }
+    if (cleaning.isActive()) {
+        sendLitterboxActionFailure(action, VAL_BUSY);
         return;
     }
     if (!isLitterboxSafeToClean()) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_NORMAL\",\"success\":false,\"reason\":\"NOT_SAFE\"}");
+        sendLitterboxActionFailure(action, VAL_NOT_SAFE);
+        return;
+    }
+    if (!cleaning.start(mode, millis())) {
+        sendLitterboxActionFailure(action, litterboxMotor->isReady() ? VAL_MOTOR_FAILED : VAL_NOT_READY);
         return;
     }
 
-    // temporal
-    litterboxState = 21;
-    bool ok = litterboxMotor->executeNormalCleaning();
-    litterboxState = litterboxMotor->getState(); // normalmente 2
-    Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_NORMAL\",\"success\":" + String(ok ? "true" : "false") + ",\"state\":" + String(litterboxState) + "}");
+    litterboxState = (mode == CLEANING_NORMAL) ? 21 : 22;
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_DEVICE_ID, litterboxId)
+        .field(KEY_ACTION, action)
+        .field(KEY_SUCCESS, true)
+        .field(KEY_STATE, litterboxState)
+        .field(KEY_POSITION, cleaning.getPosition())
+        .field(KEY_TARGET, cleaning.getTarget())
+        .end();
 }
 
-void CommandProcessor::startDeepCleaning() {
-    if (!litterboxMotor) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_DEEP\",\"success\":false,\"reason\":\"NO_MOTOR\"}");
-        return;
-    }
-    if (!isLitterboxSafeToClean()) {
-        Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_DEEP\",\"success\":false,\"reason\":\"NOT_SAFE\"}");
-        return;
+// Un paso del ciclo por llamada; reacciona a la presencia en el mismo loop
+// en que cambia (y al ISR del enclavamiento en la misma pasada). La presencia
+// fusionada va a TICK_MS, así que también frena la última distancia medida:
+// sin el ISR (HAL nativo) el tambor para dentro de un periodo de medición.
+void CommandProcessor::updateCleaning(unsigned long now) {
+    if (!cleaning.isActive()) return;
+
+    bool catPresent = presence.isOccupied(PRESENCE_LITTERBOX) || isLitterboxRangeBlocked();
+    CleaningOutcome outcome = cleaning.update(now, catPresent);
+    if (outcome == CLEANING_NONE) return;
+
+    ProtoStr event = VAL_CLEAN_PROGRESS;
+    switch (outcome) {
+        case CLEANING_PAUSED:   event = VAL_CLEAN_PAUSED; break;
+        case CLEANING_RESUMED:  event = VAL_CLEAN_RESUMED; break;
+        case CLEANING_TIMEOUT:  event = VAL_CLEAN_TIMEOUT; break;
+        case CLEANING_ROLLBACK: event = VAL_CLEAN_ROLLBACK; break;
+        case CLEANING_DONE:     event = VAL_CLEAN_DONE; break;
+        case CLEANING_ABORTED:  event = VAL_CLEAN_ABORTED; break;
+        default: break;
     }
+    if (!cleaning.isActive()) litterboxState = litterboxMotor->getState();
 
-    litterboxState = 22;
-    bool ok = litterboxMotor->executeDeepCleaning();
-    litterboxState = litterboxMotor->getState(); // debe quedar 1 (INACTIVE)
-    Serial.println("{\"device_id\":\"LTR1\",\"action\":\"CLEAN_DEEP\",\"success\":" + String(ok ? "true" : "false") + ",\"final_state\":" + String(litterboxState) + "}");
+    JsonWriter json(BusLink::out());
+    json.begin()
+        .field(KEY_DEVICE_ID, litterboxId)
+        .field(KEY_EVENT, event)
+        .field(KEY_ACTION, cleaning.getMode() == CLEANING_NORMAL ? VAL_CLEAN_NORMAL : VAL_CLEAN_DEEP)
+        .field(KEY_CHECKPOINT, (int)cleaning.getCheckpoint())
+        .field(KEY_POSITION, cleaning.getPosition())
+        .field(KEY_TARGET, cleaning.getTarget());
+    if (outcome == CLEANING_PAUSED || outcome == CLEANING_TIMEOUT) json.field(KEY_REASON, VAL_CAT_DETECTED);
+    if (!cleaning.isActive()) json.field(KEY_FINAL_STATE, litterboxState);
+    json.end();
 }
 
 // ===== IMPLEMENTACIÓN COMEDERO (FDR1) =====
 void CommandProcessor::sendFeederStatus() {
-    String response = "{\"device_id\":\"FDR1\",\"status\":\"ACTIVE\",";
-    response += "\"manual_control\":" + String(manualFeederControl ? "true" : "false") + ",";
-    response += "\"motor_running\":" + String((feederMotor ? feederMotor->isRunning() : false) ? "true" : "false") + ",";
-    response += "\"weight_grams\":" + String(sensorManager ? sensorManager->getFeederWeight() : 0.0) + ",";
-    response += "\"cat_distance_cm\":" + String(sensorManager ? sensorManager->getFeederCatDistance() : -1.0) + ",";
-    response += "\"food_distance_cm\":" + String(sensorManager ? sensorManager->getFeederFoodDistance() : -1.0) + ",";
-    response += "\"storage_status\":\"" + String(sensorManager ? sensorManager->getStorageFoodStatus() : "NOT_READY") + "\",";
-    response += "\"plate_status\":\"" + String(sensorManager ? sensorManager->getPlateFoodStatus() : "NOT_READY") + "\",";
-    response += "\"motor_ready\":" + String((feederMotor ? feederMotor->isReady() : false) ? "true" : "false") + ",";
-    response += "\"safe_to_operate\":" + String(isFeederSafeToOperate() ? "true" : "false");
-    response += "}";
+    bool safe = isFeederSafeToOperate();
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_DEVICE_ID, feederId)
+        .field(KEY_STATUS, VAL_ACTIVE)
+        .field(KEY_MANUAL_CONTROL, manualFeederControl)
+        .field(KEY_MOTOR_RUNNING, feederMotor ? feederMotor->isRunning() : false)
+        .field(KEY_WEIGHT_GRAMS, sensorManager ? sensorManager->getFeederWeight() : 0.0)
+        .field(KEY_CAT_DISTANCE_CM, sensorManager ? sensorManager->getFeederCatDistance() : -1.0)
+        .field(KEY_FOOD_DISTANCE_CM, sensorManager ? sensorManager->getFeederFoodDistance() : -1.0)
+        .field(KEY_STORAGE_STATUS, sensorManager ? sensorManager->getStorageFoodStatus() : String(protoStr(VAL_NOT_READY)))
+        .field(KEY_PLATE_STATUS, sensorManager ? sensorManager->getPlateFoodStatus() : String(protoStr(VAL_NOT_READY)))
+        .field(KEY_MOTOR_READY, feederMotor ? feederMotor->isReady() : false)
+        .field(KEY_SAFE_TO_OPERATE, safe)
+        .end();
 }
 
 void CommandProcessor::controlFeederMotor(bool on) {
     // El front envía FDR1:1 para presionar (persistent), FDR1:0 para soltar.
     manualFeederControl = on;
 
+    if (on && dispenser.isActive()) {
+        manualFeederControl = false;
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, feederId)
+            .field(KEY_ACTION, KEY_MANUAL_CONTROL)
+            .field(KEY_SUCCESS, false)
+            .field(KEY_REASON, VAL_BUSY)
+            .end();
+        return;
+    }
+
     if (on) {
         if (!sensorManager || !feederMotor) {
-            Serial.println("{\"device_id\":\"FDR1\",\"action\":\"manual_control\",\"success\":false,\"reason\":\"MISSING_DEPENDENCY\"}");
+            JsonWriter(BusLink::out()).begin()
+                .field(KEY_DEVICE_ID, feederId)
+                .field(KEY_ACTION, KEY_MANUAL_CONTROL)
+                .field(KEY_SUCCESS, false)
+                .field(KEY_REASON, VAL_MISSING_DEPENDENCY)
+                .end();
             manualFeederControl = false;
             return;
         }
@@ -218,48 +410,259 @@ void CommandProcessor::controlFeederMotor(bool on) {
             // Si no pudo arrancar, no dejamos persistencia.
             manualFeederControl = false;
 
-            String reason = "SENSOR_CHECK_FAILED";
-            if (storageDistance <= 0 || storageDistance >= 8.0) {
-                reason = "NO_FOOD_IN_STORAGE";
-            } else if (plateDistance > 0 && plateDistance <= 1.0) {
-                reason = "PLATE_ALREADY_FULL";
+            const UnitSettings& cfg = ConfigStore::getInstance().getUnit(unit);
+            ProtoStr reason = VAL_SENSOR_CHECK_FAILED;
+            if (storageDistance <= 0 || storageDistance >= cfg.storageEmptyCm) {
+                reason = VAL_NO_FOOD_IN_STORAGE;
+            } else if (plateDistance > 0 && plateDistance <= cfg.plateFullCm) {
+                reason = VAL_PLATE_ALREADY_FULL;
             }
 
-            Serial.println("{\"device_id\":\"FDR1\",\"action\":\"manual_control\",\"success\":false,\"reason\":\"" + reason + "\",\"storage_distance\":" + String(storageDistance) + ",\"plate_distance\":" + String(plateDistance) + "}");
+            JsonWriter(BusLink::out()).begin()
+                .field(KEY_DEVICE_ID, feederId)
+                .field(KEY_ACTION, KEY_MANUAL_CONTROL)
+                .field(KEY_SUCCESS, false)
+                .field(KEY_REASON, reason)
+                .field(KEY_STORAGE_DISTANCE, storageDistance)
+                .field(KEY_PLATE_DISTANCE, plateDistance)
+                .end();
             return;
         }
 
         // Si arranca, dejamos manualFeederControl = true (persistente hasta que se suelte o validación lo detenga)
-        Serial.println("{\"device_id\":\"FDR1\",\"action\":\"manual_control\",\"success\":true,\"motor\":\"ON\",\"direction\":\"LEFT\",\"speed\":120}");
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, feederId)
+            .field(KEY_ACTION, KEY_MANUAL_CONTROL)
+            .field(KEY_SUCCESS, true)
+            .field(KEY_MOTOR, VAL_ON)
+            .field(KEY_DIRECTION, VAL_LEFT)
+            .field(KEY_SPEED, 120)
+            .end();
     } else {
-        // Cuando sueltan el botón, parar inmediatamente.
+        // Cuando sueltan el botón, parar inmediatamente (también un DISPENSE en curso).
+        if (dispenser.abort()) sendDispenseEvent(VAL_DISPENSE_ABORTED);
         if (feederMotor) feederMotor->emergencyStop();
         manualFeederControl = false;
-        Serial.println("{\"device_id\":\"FDR1\",\"action\":\"manual_control\",\"success\":true,\"motor\":\"OFF\"}");
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, feederId)
+            .field(KEY_ACTION, KEY_MANUAL_CONTROL)
+            .field(KEY_SUCCESS, true)
+            .field(KEY_MOTOR, VAL_OFF)
+            .end();
+    }
+}
+
+void CommandProcessor::processFeederCommand(const String& action) {
+    if (protoEquals(action, CMD_TARE)) {
+        bool ok = sensorManager && sensorManager->tareFeederWeight();
+        JsonWriter json(BusLink::out());
+        json.begin()
+            .field(KEY_DEVICE_ID, feederId)
+            .field(KEY_ACTION, VAL_TARE)
+            .field(KEY_SUCCESS, ok);
+        if (ok) json.field(KEY_HX711_OFFSET, ConfigStore::getInstance().getHx711Offset(unit));
+        else json.field(KEY_REASON, VAL_SENSOR_NOT_READY);
+        json.end();
+        return;
+    }
+
+    if (protoStartsWith(action, CMD_CAL_PREFIX)) {
+        // Peso conocido en gramos sobre el plato (tarado previamente)
+        float grams = action.substring(4).toFloat();
+        ProtoStr reason = VAL_SENSOR_NOT_READY;
+        bool ok = false;
+        if (grams <= 0.0f) {
+            reason = VAL_INVALID_VALUE;
+        } else if (sensorManager && sensorManager->isFeederWeightReady()) {
+            ok = sensorManager->calibrateFeederWeight(grams);
+            reason = VAL_CALIBRATION_FAILED;
+        }
+
+        JsonWriter json(BusLink::out());
+        json.begin()
+            .field(KEY_DEVICE_ID, feederId)
+            .field(KEY_ACTION, VAL_CALIBRATE)
+            .field(KEY_SUCCESS, ok);
+        if (ok) json.field(KEY_HX711_FACTOR, ConfigStore::getInstance().getCalibrationFactor(unit), 3);
+        else json.field(KEY_REASON, reason);
+        json.end();
+        return;
+    }
+
+    if (protoStartsWith(action, CMD_DISPENSE_PREFIX)) {
+        startDispense(action.substring(9));
+        return;
+    }
+
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_DEVICE_ID, feederId)
+        .field(KEY_ERROR, VAL_UNKNOWN_ACTION)
+        .field(KEY_ACTION, action)
+        .end();
+}
+
+// ===== CONFIGURACIÓN PERSISTENTE =====
+void CommandProcessor::calibrateLitterboxMQ2() {
+    // Bloqueante (~2.5 s): sólo se ejecuta a pedido, con el arenero en aire limpio
+    bool ok = sensorManager && sensorManager->calibrateLitterboxMQ2();
+    JsonWriter json(BusLink::out());
+    json.begin()
+        .field(KEY_DEVICE_ID, litterboxId)
+        .field(KEY_ACTION, VAL_CAL_MQ2)
+        .field(KEY_SUCCESS, ok);
+    if (ok) json.field(KEY_MQ2_RO, ConfigStore::getInstance().getMq2Ro(unit), 3);
+    else json.field(KEY_REASON, VAL_SENSOR_NOT_READY);
+    json.end();
+}
+
+void CommandProcessor::sendConfig(uint8_t station) {
+    ConfigStore& store = ConfigStore::getInstance();
+    const UnitSettings& cfg = store.getUnit(station);
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_CONFIG)
+        .field(KEY_STATION, (int)station + 1)
+        .field(KEY_HX711_FACTOR, cfg.hx711Factor, 3)
+        .field(KEY_HX711_OFFSET, (long)cfg.hx711Offset)
+        .field(KEY_MQ2_RO, cfg.mq2Ro, 3)
+        .field(KEY_CAT_PRESENT_CM, cfg.catPresentCm)
+        .field(KEY_STORAGE_EMPTY_CM, cfg.storageEmptyCm)
+        .field(KEY_PLATE_FULL_CM, cfg.plateFullCm)
+        .field(KEY_PUMP_REFILL_MS, (unsigned long)cfg.pumpRefillMs)
+        .field(KEY_PUMP_MAX_MS, (unsigned long)cfg.pumpMaxMs)
+        .field(KEY_STEPS_PER_GRAM, cfg.dispenseStepsPerGramX100 / 100.0)
+        .field(KEY_FILL_RATE, cfg.waterFillRateX100 / 100.0)
+        .field(KEY_FLAGS, (int)cfg.flags)
+        .field(KEY_SEQUENCE, (unsigned long)store.getSequence())
+        .field(KEY_SLOT, (int)store.getCurrentSlot())
+        .endObject().end();
+}
+
+void CommandProcessor::resetConfig() {
+    // Los sensores siguen con la calibración actual hasta el próximo arranque
+    ConfigStore& store = ConfigStore::getInstance();
+    store.resetToDefaults();
+    bool ok = store.save();
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_CONFIG, VAL_RESET)
+        .field(KEY_SUCCESS, ok)
+        .end();
+}
+
+// ===== PARÁMETROS AJUSTABLES =====
+static void writeParamValue(JsonWriter& json, ProtoStr key, uint8_t index, float value) {
+    if (ParamTable::getInstance().isInteger(index)) json.field(key, (unsigned long)value);
+    else json.field(key, value);
+}
+
+// Resuelve "<nombre>[@N]". Sin selector, los de estación van a la primera.
+// Responde el error y devuelve -1 si el nombre o la estación no sirven.
+static int8_t resolveParam(const String& text, uint8_t& station) {
+    String name = text;
+    int8_t selected = takeStation(name);
+    ParamTable& params = ParamTable::getInstance();
+    int8_t index = params.find(name);
+
+    ProtoStr reason = VAL_UNKNOWN_PARAM;
+    if (index >= 0) {
+        if (selected < 0) reason = VAL_UNKNOWN_STATION;
+        else if (selected > 0 && !params.isPerStation(index)) reason = VAL_BOARD_PARAM;
+        else {
+            station = (selected > 0) ? (uint8_t)(selected - 1) : 0;
+            return index;
+        }
     }
+    JsonWriter(BusLink::out()).begin().field(KEY_PARAM, text).field(KEY_ERROR, reason).end();
+    return -1;
+}
+
+// "param" y, si es de estación, "station" (1..N) para que el host empareje la respuesta
+static void writeParamName(JsonWriter& json, uint8_t index, uint8_t station) {
+    ParamTable& params = ParamTable::getInstance();
+    json.field(KEY_PARAM, protoStr(params.nameOf(index)));
+    if (params.isPerStation(index)) json.field(KEY_STATION, (int)station + 1);
+}
+
+void CommandProcessor::sendParamList(uint8_t station) {
+    ParamTable& params = ParamTable::getInstance();
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_PARAMS);
+    for (uint8_t i = 0; i < params.count(); ++i) {
+        writeParamValue(json, params.nameOf(i), i, params.get(i, station));
+    }
+    json.endObject()
+        .field(KEY_STATION, (int)station + 1)
+        .field(KEY_PENDING, params.hasPending()).end();
+}
+
+void CommandProcessor::sendParam(const String& name) {
+    uint8_t station;
+    int8_t index = resolveParam(name, station);
+    if (index < 0) return;
+
+    ParamTable& params = ParamTable::getInstance();
+    JsonWriter json(BusLink::out());
+    json.begin();
+    writeParamName(json, index, station);
+    writeParamValue(json, KEY_VALUE, index, params.get(index, station));
+    writeParamValue(json, KEY_MIN, index, params.minOf(index));
+    writeParamValue(json, KEY_MAX, index, params.maxOf(index));
+    json.end();
+}
+
+void CommandProcessor::setParam(const String& assignment) {
+    // SET:<nombre>[@N]=<valor>; se aplica al inicio del siguiente loop()
+    int eq = assignment.indexOf('=');
+    String name = (eq < 0) ? assignment : assignment.substring(0, eq);
+    String valueText = (eq < 0) ? String() : assignment.substring(eq + 1);
+
+    uint8_t station;
+    int8_t index = resolveParam(name, station);
+    if (index < 0) return;
+
+    ParamTable& params = ParamTable::getInstance();
+    if (!isNumeric(valueText)) {
+        JsonWriter json(BusLink::out());
+        json.begin();
+        writeParamName(json, index, station);
+        json.field(KEY_SUCCESS, false).field(KEY_REASON, VAL_INVALID_VALUE).end();
+        return;
+    }
+
+    float value = valueText.toFloat();
+    JsonWriter json(BusLink::out());
+    json.begin();
+    writeParamName(json, index, station);
+    ParamResult result = params.set(index, value, station);
+    if (result == PARAM_OK) {
+        writeParamValue(json, KEY_VALUE, index, value);
+        json.field(KEY_SUCCESS, true).field(KEY_PENDING, true);
+    } else if (result == PARAM_PIN_IN_USE) {
+        json.field(KEY_SUCCESS, false).field(KEY_REASON, VAL_PIN_IN_USE);
+    } else {
+        json.field(KEY_SUCCESS, false).field(KEY_REASON, VAL_OUT_OF_RANGE);
+        writeParamValue(json, KEY_MIN, index, params.minOf(index));
+        writeParamValue(json, KEY_MAX, index, params.maxOf(index));
+    }
+    json.end();
 }
 
 // ===== VALIDACIONES DE SEGURIDAD =====
 bool CommandProcessor::isCatPresent() {
     if (!sensorManager) return false;
-    float feederDist = sensorManager->getFeederCatDistance();
-    float litterDist = sensorManager->getLitterboxDistance();
-    Serial.print(litterDist);
-    Serial.print("----------------------distancia");
-    bool feederDetect = (feederDist > 0.0f && feederDist < 10.0f);
-    bool litterDetect = (litterDist > 0.0f && litterDist <= 8.0f);  // ✅ CORREGIDO
-    Serial.print(litterDetect);
-    return litterDetect;
+    return presence.isOccupied(PRESENCE_LITTERBOX);
+}
+
+// Lectura cruda del ultrasónico del arenero contra cat_present_cm, sin fusión
+bool CommandProcessor::isLitterboxRangeBlocked() {
+    if (!sensorManager) return false;
+    float d = sensorManager->getLitterboxDistance();
+    return d > 0.0f && d <= ConfigStore::getInstance().getUnit(unit).catPresentCm;
 }
 
 bool CommandProcessor::isLitterboxSafeToClean() {
     if (!sensorManager) return false;
     // float ppm = sensorManager->getLitterboxGasPPM();
     // bool gasOk = (ppm >= 0.0f && ppm < 100.0f); // ajusta umbral
-    // Serial.println(ppm);
-    // Serial.println("----------------------ppm");
-    // Serial.println(gasOk);
-    // Serial.println("----------------------gas");
     return !isCatPresent(); //&& gasOk;
 }
 
@@ -267,7 +670,8 @@ bool CommandProcessor::isLitterboxSafeToOperate() {
     if (!sensorManager) return false;
     // float ppm = sensorManager->getLitterboxGasPPM();
     // bool gasOk = (ppm >= 0.0f && ppm < 150.0f); // ajusta umbral
-    Serial.println(isCatPresent() ? "{\"safety_check\":\"CAT_DETECTED\"}" : "{\"safety_check\":\"NO_CAT_DETECTED\"}");
+    ProtoStr check = isCatPresent() ? VAL_CAT_DETECTED : VAL_NO_CAT_DETECTED;
+    JsonWriter(BusLink::out()).begin().field(KEY_SAFETY_CHECK, check).end();
     return !isCatPresent(); //&& gasOk;
 }
 
@@ -283,24 +687,490 @@ bool CommandProcessor::isFeederSafeToOperate() {
 bool CommandProcessor::hasSufficientFood() {
     if (!sensorManager) return false;
     float foodDistance = sensorManager->getFeederFoodDistance();
-    return (foodDistance > 0 && foodDistance < 13.0);
+    return (foodDistance > 0 && foodDistance < ConfigStore::getInstance().getUnit(unit).storageEmptyCm);
 }
 
 // ===== COMANDO ALL =====
 void CommandProcessor::sendAllDevicesStatus() {
-    String response = "{\"command\":\"ALL\",\"devices\":{";
-    response += "\"LTR1\":{\"state\":" + String(litterboxState) + ",\"safe\":" + String(isLitterboxSafeToOperate() ? "true":"false") + "},";
-    response += "\"FDR1\":{},\"WTR1\":{}";
-    response += "}}";
-    Serial.println(response);
+    bool safe = isLitterboxSafeToOperate();
+    JsonWriter json(BusLink::out());
+    json.begin().field(KEY_COMMAND, CMD_ALL).beginObject(KEY_DEVICES);
+    writeDeviceStatus(json, safe);
+    json.endObject().end();
+}
+
+void CommandProcessor::writeDeviceStatus(JsonWriter& json, bool litterboxSafe) {
+    json.beginObject(litterboxId).field(KEY_STATE, litterboxState).field(KEY_SAFE, litterboxSafe).endObject();
+    json.beginObject(feederId).endObject();
+    json.beginObject(waterId).endObject();
+}
+
+bool CommandProcessor::ownsDevice(const String& deviceId) const {
+    return protoEquals(deviceId, litterboxId) || protoEquals(deviceId, feederId) ||
+           protoEquals(deviceId, waterId);
+}
+
+// Los avisos automáticos llevan device_id sólo si la placa tiene varias
+// estaciones: con una sola el formato queda como siempre
+void CommandProcessor::tagDevice(JsonWriter& json, const __FlashStringHelper* deviceId) {
+#if CATHUB_UNITS > 1
+    json.field(KEY_DEVICE_ID, deviceId);
+#else
+    (void)json;
+    (void)deviceId;
+#endif
 }
 
 // ===== CONTROL AUTOMÁTICO =====
+// ===== DISPENSADO POR GRAMOS (FDR1:DISPENSE:<g>) =====
+void CommandProcessor::startDispense(const String& gramsText) {
+    ProtoStr reason = VAL_INVALID_VALUE;
+    float grams = gramsText.toFloat();
+    bool ok = false;
+    if (manualFeederControl) {
+        reason = VAL_BUSY;
+    } else if (isNumeric(gramsText)) {
+        ok = dispenser.start(grams, reason);
+    }
+
+    JsonWriter json(BusLink::out());
+    json.begin()
+        .field(KEY_DEVICE_ID, feederId)
+        .field(KEY_ACTION, VAL_DISPENSE)
+        .field(KEY_SUCCESS, ok)
+        .field(KEY_TARGET_GRAMS, grams, 1);
+    if (ok) {
+        json.field(KEY_WEIGHT_GRAMS, sensorManager->getFeederWeight(), 1)
+            .field(KEY_STEPS_PER_GRAM, dispenser.getStepsPerGram());
+    } else {
+        json.field(KEY_REASON, reason);
+    }
+    json.end();
+}
+
+void CommandProcessor::sendDispenseEvent(ProtoStr event) {
+    JsonWriter json(BusLink::out());
+    json.begin()
+        .field(KEY_DEVICE_ID, feederId)
+        .field(KEY_EVENT, event)
+        .field(KEY_GRAMS, dispenser.getDispensed(), 1)
+        .field(KEY_TARGET_GRAMS, dispenser.getTarget(), 1);
+    if (event != VAL_DISPENSE_PROGRESS) {
+        json.field(KEY_STEPS, dispenser.getSteps())
+            .field(KEY_STEPS_PER_GRAM, dispenser.getStepsPerGram());
+    }
+    json.end();
+}
+
+void CommandProcessor::updateDispense(unsigned long now) {
+    switch (dispenser.update(now)) {
+        case DISPENSE_PROGRESS: sendDispenseEvent(VAL_DISPENSE_PROGRESS); break;
+        case DISPENSE_DONE:     sendDispenseEvent(VAL_DISPENSE_DONE); break;
+        case DISPENSE_STALLED:  sendDispenseEvent(VAL_DISPENSE_STALLED); break;
+        case DISPENSE_NO_FOOD:  sendDispenseEvent(VAL_DISPENSE_NO_FOOD); break;
+        default: break;
+    }
+}
+
+// ===== EVENTOS DE PRESENCIA =====
+void CommandProcessor::sendPresenceEvents() {
+    PresenceEvent ev;
+    while (presence.poll(ev)) {
+        const __FlashStringHelper* deviceId = litterboxId;
+        if (ev.station == PRESENCE_FEEDER) deviceId = feederId;
+        else if (ev.station == PRESENCE_WATER) deviceId = waterId;
+
+        JsonWriter json(BusLink::out());
+        json.begin()
+            .field(KEY_DEVICE_ID, deviceId)
+            .field(KEY_EVENT, ev.present ? VAL_CAT_ENTER : VAL_CAT_EXIT)
+            .field(KEY_CONFIDENCE, (int)ev.confidence);
+        if (!ev.present) json.field(KEY_DURATION_MS, (unsigned long)ev.durationMs);
+        json.end();
+    }
+}
+
+// ===== ENCLAVAMIENTO DE SEGURIDAD =====
+// El ISR ya apagó la salida; acá sólo se informa y se libera el enclavamiento
+// cuando la presencia confirma que la estación quedó libre. La bomba se
+// resincroniza en updateWaterRefill (corte por gato) y el motor del arenero
+// en stepSigned() / serviceMove().
+void CommandProcessor::updateSafetyInterlock() {
+    SafetyInterlock::setLitterboxBlockCm(ConfigStore::getInstance().getUnit(unit).catPresentCm, unit);
+
+    uint8_t waterChannel = safetyChannelFor(SAFETY_WATER, unit);
+    uint8_t litterChannel = safetyChannelFor(SAFETY_LITTERBOX, unit);
+
+    SafetyTrip trip;
+    while (SafetyInterlock::pollTrip(trip, waterChannel | litterChannel)) {
+        bool water = (trip.channel == waterChannel);
+        JsonWriter(BusLink::out()).begin()
+            .field(KEY_DEVICE_ID, water ? waterId : litterboxId)
+            .field(KEY_EVENT, VAL_SAFETY_INTERLOCK)
+            .field(KEY_REASON, VAL_CAT_DETECTED)
+            .field(KEY_LATENCY_US, (unsigned long)trip.latencyUs)
+            .field(KEY_WORST_CASE_US, (unsigned long)trip.worstCaseUs)
+            .end();
+    }
+
+    if (SafetyInterlock::isLatched(waterChannel) && !presence.isOccupied(PRESENCE_WATER)) {
+        SafetyInterlock::release(waterChannel);
+    }
+    if (SafetyInterlock::isLatched(litterChannel) && !presence.isOccupied(PRESENCE_LITTERBOX)) {
+        SafetyInterlock::release(litterChannel);
+    }
+}
+
+// ===== MUESTREO ADAPTATIVO =====
+// Gato (aunque aún no cumpla el tiempo mínimo) o automatismo en curso: la
+// estación pasa a ráfaga. Los motores y la bomba los detecta SensorManager.
+void CommandProcessor::updateSensorActivity() {
+    if (!sensorManager) return;
+    bool litterboxOccupied = presence.isOccupied(PRESENCE_LITTERBOX);
+    uint8_t activity = 0;
+    if (litterboxOccupied || cleaning.isActive()) activity |= ACTIVITY_LITTERBOX;
+    if (presence.isOccupied(PRESENCE_FEEDER) || dispenser.isActive()) activity |= ACTIVITY_FEEDER;
+    if (presence.isOccupied(PRESENCE_WATER) || waterRefill.isFilling()) activity |= ACTIVITY_WATER;
+    sensorManager->setActivity(activity);
+    sensorManager->setLitterboxOccupied(litterboxOccupied);
+}
+
+void CommandProcessor::sendSensorRates() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_RATES);
+    writeSensorRates(json);
+    json.endObject().end();
+}
+
+void CommandProcessor::writeSensorRates(JsonWriter& json) {
+    if (!sensorManager) return;
+    for (uint8_t ch = 0; ch < SENSOR_CH_COUNT; ++ch) {
+        json.beginObject(sensorManager->getChannelSensorId(ch))
+            .field(KEY_INTERVAL_MS, (unsigned long)sensorManager->getChannelInterval(ch))
+            .field(KEY_BURST, sensorManager->isChannelBursting(ch))
+            .endObject();
+    }
+}
+
+// Salud por sensor en arreglos posicionales para que la respuesta quepa en
+// una línea corta: [attempts, ok, timeouts, out_of_range, age_ms, avg_us,
+// max_us, backoff]. age_ms = null si nunca hubo lectura válida; backoff > 0
+// = canal degradado (su periodo se duplicó esas veces). El orden de los
+// campos lo replica DIAG_FIELDS en DeviceManager.py (raspberryCathub).
+void CommandProcessor::sendSensorHealth() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_DIAG);
+    writeSensorHealth(json);
+    json.endObject().end();
+}
+
+void CommandProcessor::writeSensorHealth(JsonWriter& json) {
+    if (!sensorManager) return;
+    unsigned long now = millis();
+    for (uint8_t ch = 0; ch < SENSOR_CH_COUNT; ++ch) {
+        const SensorHealth& h = sensorManager->getChannelHealth(ch);
+        json.beginArray(sensorManager->getChannelSensorId(ch))
+            .item((unsigned long)h.getAttempts())
+            .item((unsigned long)h.getOk())
+            .item((unsigned long)h.getTimeouts())
+            .item((unsigned long)h.getOutOfRange());
+        if (h.hasOk()) json.item(h.getAgeMs(now));
+        else json.itemNull();
+        json.item((unsigned long)h.getAvgUs())
+            .item((unsigned long)h.getMaxUs())
+            .item((unsigned long)sensorManager->getChannelBackoff(ch))
+            .endArray();
+    }
+}
+
+void CommandProcessor::resetSensorHealth() {
+    if (sensorManager) sensorManager->resetHealth();
+}
+
+// ===== WATCHDOG =====
+static ProtoStr resetCauseName(uint8_t cause) {
+    switch (cause) {
+        case RESET_POWER_ON:  return VAL_POWER_ON;
+        case RESET_EXTERNAL:  return VAL_EXTERNAL;
+        case RESET_BROWN_OUT: return VAL_BROWN_OUT;
+        case RESET_WATCHDOG:  return VAL_WATCHDOG;
+        case RESET_JTAG:      return VAL_JTAG;
+        default:              return VAL_UNKNOWN;
+    }
+}
+
+static ProtoStr watchdogTaskName(uint8_t task) {
+    switch (task) {
+        case WDT_TASK_COMMANDS:   return VAL_TASK_COMMANDS;
+        case WDT_TASK_SENSORS:    return VAL_TASK_SENSORS;
+        case WDT_TASK_AUTOMATION: return VAL_TASK_AUTOMATION;
+        case WDT_TASK_ACTUATORS:  return VAL_TASK_ACTUATORS;
+        default:                  return VAL_NONE;
+    }
+}
+
+// Una vez por arranque: causa del reinicio y, si fue el perro, qué tarea
+// estaba corriendo cuando venció
+void CommandProcessor::sendBootReport() {
+    JsonWriter json(BusLink::out());
+    json.begin()
+        .field(KEY_EVENT, VAL_BOOT)
+        .field(KEY_RESET_CAUSE, resetCauseName(Watchdog::getResetCause()));
+    WatchdogRecord rec;
+    if (Watchdog::getBootRecord(rec)) {
+        json.field(KEY_WDT_TASK, watchdogTaskName(rec.task))
+            .field(KEY_WDT_TASK_MS, (unsigned long)rec.taskMs)
+            .field(KEY_WDT_LOOP_MS, (unsigned long)rec.loopMs)
+            .field(KEY_WDT_LOOPS, (unsigned long)rec.loops)
+            .field(KEY_WDT_UPTIME_MS, (unsigned long)rec.uptimeMs);
+    }
+    json.end();
+}
+
+void CommandProcessor::sendWatchdogStats() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_WATCHDOG)
+        .field(KEY_ENABLED, Watchdog::isEnabled())
+        .field(KEY_RESET_CAUSE, resetCauseName(Watchdog::getResetCause()))
+        .field(KEY_LOOPS, (unsigned long)Watchdog::getLoops())
+        .field(KEY_LOOP_MAX_US, (unsigned long)Watchdog::getLoopMaxUs())
+        .field(KEY_STALLS, (unsigned long)Watchdog::getStalls())
+        .beginObject(KEY_TASKS);
+    for (uint8_t t = 0; t < WDT_TASK_COUNT; ++t) {
+        json.beginObject(watchdogTaskName(t))
+            .field(KEY_MAX_US, (unsigned long)Watchdog::getTaskMaxUs(t))
+            .field(KEY_BUDGET_US, (unsigned long)Watchdog::getTaskBudgetUs(t))
+            .field(KEY_OVERRUNS, (unsigned long)Watchdog::getTaskOverruns(t))
+            .endObject();
+    }
+    json.endObject().endObject().end();
+}
+
+// ===== PERFILADO DEL LOOP (PROF) =====
+// Sin CATHUB_PROFILING sólo responde enabled:false
+void CommandProcessor::sendProfile() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_PROF);
+#if defined(CATHUB_PROFILING)
+    json.field(KEY_ENABLED, true)
+        .field(KEY_HIST_BASE_US, (unsigned long)LoopProfiler::HIST_BASE_US);
+    uint8_t slotCount = sensorManager ? (uint8_t)PROF_SLOT_COUNT : (uint8_t)PROF_SENSOR_BASE;
+    for (uint8_t slot = 0; slot < slotCount; ++slot) {
+        switch (slot) {
+            case PROF_LOOP:         json.beginObject(VAL_PROF_LOOP); break;
+            case PROF_COMMANDS:     json.beginObject(VAL_TASK_COMMANDS); break;
+            case PROF_SENSORS:      json.beginObject(VAL_TASK_SENSORS); break;
+            case PROF_AUTOMATION:   json.beginObject(VAL_TASK_AUTOMATION); break;
+            case PROF_FEEDER_MOTOR: json.beginObject(VAL_PROF_FEEDER_MOTOR); break;
+            case PROF_WATER_PUMP:   json.beginObject(VAL_PROF_WATER_PUMP); break;
+            default:                json.beginObject(sensorManager->getChannelSensorId(slot - PROF_SENSOR_BASE)); break;
+        }
+        json.field(KEY_COUNT, (unsigned long)LoopProfiler::getCount(slot))
+            .field(KEY_MEAN_US, (unsigned long)LoopProfiler::getMeanUs(slot))
+            .field(KEY_MAX_US, (unsigned long)LoopProfiler::getMaxUs(slot))
+            .beginArray(KEY_HIST);
+        for (uint8_t b = 0; b < LoopProfiler::HIST_BUCKETS; ++b) {
+            json.item((unsigned long)LoopProfiler::getBucket(slot, b));
+        }
+        json.endArray().endObject();
+    }
+#else
+    json.field(KEY_ENABLED, false);
+#endif
+    json.endObject().end();
+}
+
+void CommandProcessor::resetProfile() {
+#if defined(CATHUB_PROFILING)
+    LoopProfiler::reset();
+#endif
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_ACTION, CMD_PROF_RESET)
+        .field(KEY_SUCCESS, true)
+        .end();
+}
+
+// ===== TRAZA DE EVENTOS (TRACE) =====
+// Cabecera JSON y, en la misma respuesta, los registros en binario; la
+// convierte scripts/trace-to-perfetto.py. Sin CATHUB_TRACE: enabled:false
+void CommandProcessor::sendTrace() {
+    // Los registros van en binario detrás del JSON: no caben en la cola de
+    // un nodo del bus, sólo salen por el enlace punto a punto
+    if (BusLink::getInstance().isNode()) {
+        JsonWriter(BusLink::out()).begin().field(KEY_ERROR, VAL_NOT_ON_BUS).field(KEY_RECEIVED, CMD_TRACE).end();
+        return;
+    }
+
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_TRACE);
+#if defined(CATHUB_TRACE)
+    TraceBuffer::freeze();
+    json.field(KEY_ENABLED, true)
+        .field(KEY_CAPACITY, (unsigned long)TraceBuffer::CAPACITY)
+        .field(KEY_RECORD_BYTES, (unsigned long)sizeof(TraceRecord))
+        .field(KEY_TOTAL, (unsigned long)TraceBuffer::getTotal())
+        .field(KEY_DISCARDED, (unsigned long)TraceBuffer::getDiscarded())
+        .field(KEY_NOW_US, (unsigned long)micros())
+        .field(KEY_RECORDS, (unsigned long)TraceBuffer::getCount())
+        .endObject().end();
+    TraceBuffer::writeRecords(Serial);
+    TraceBuffer::thaw();
+#else
+    json.field(KEY_ENABLED, false).endObject().end();
+#endif
+}
+
+void CommandProcessor::resetTrace() {
+#if defined(CATHUB_TRACE)
+    TraceBuffer::reset();
+#endif
+    JsonWriter(BusLink::out()).begin()
+        .field(KEY_ACTION, CMD_TRACE_RESET)
+        .field(KEY_SUCCESS, true)
+        .end();
+}
+
+// ===== BANCO DE FORMATOS DE TELEMETRÍA (BENCH) =====
+// Los formatos actuales (getAllReadings, getSensorStatus, texto plano de "C")
+// contra los de TelemetryEncoder, todos hacia un Print que sólo cuenta
+#if defined(CATHUB_BENCH)
+static const char BENCH_ALL_READINGS[] PROGMEM = "ALL_READINGS";
+static const char BENCH_SENSOR_STATUS[] PROGMEM = "SENSOR_STATUS";
+static const char BENCH_PLAIN[] PROGMEM = "PLAIN";
+static const char BENCH_JSON_STREAM[] PROGMEM = "JSON_STREAM";
+static const char BENCH_BINARY[] PROGMEM = "BINARY";
+#endif
+
+void CommandProcessor::sendBench() {
+#if defined(CATHUB_BENCH)
+    struct Format {
+        const char* nameP;
+        TelemetryBench::Encoder encoder;
+    };
+    const Format formats[] = {
+        { BENCH_ALL_READINGS, [](void* cp, Print& out) {
+            out.println(static_cast<CommandProcessor*>(cp)->sensorManager->getAllReadings()); } },
+        { BENCH_SENSOR_STATUS, [](void* cp, Print& out) {
+            out.println(static_cast<CommandProcessor*>(cp)->sensorManager->getSensorStatus()); } },
+        { BENCH_PLAIN, [](void* cp, Print& out) {
+            static_cast<CommandProcessor*>(cp)->sendPlainTextSensors(out); } },
+        { BENCH_JSON_STREAM, [](void* cp, Print& out) {
+            TelemetrySnapshot snapshot;
+            TelemetryEncoder::capture(*static_cast<CommandProcessor*>(cp)->sensorManager, snapshot);
+            TelemetryEncoder::writeJson(snapshot, out); } },
+        { BENCH_BINARY, [](void* cp, Print& out) {
+            TelemetrySnapshot snapshot;
+            TelemetryEncoder::capture(*static_cast<CommandProcessor*>(cp)->sensorManager, snapshot);
+            TelemetryEncoder::writeBinary(snapshot, out); } },
+    };
+    const uint8_t formatCount = sensorManager ? (uint8_t)(sizeof(formats) / sizeof(formats[0])) : 0;
+
+    // Primero medir todo y después responder: la UART vaciándose por
+    // interrupción no se mezcla con los tiempos
+    BenchResult results[sizeof(formats) / sizeof(formats[0])];
+    for (uint8_t i = 0; i < formatCount; ++i) TelemetryBench::run(formats[i].encoder, this, results[i]);
+
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_BENCH)
+        .field(KEY_ENABLED, true)
+        .field(KEY_ITERATIONS, (unsigned long)TelemetryBench::ITERATIONS)
+        .field(KEY_UNIT, TelemetryBench::timeUnit());
+    for (uint8_t i = 0; i < formatCount; ++i) {
+        const BenchResult& r = results[i];
+        json.beginObject(FPSTR(formats[i].nameP))
+            .field(KEY_BYTES, (unsigned long)r.bytes)
+            .field(KEY_MEAN, (unsigned long)r.meanTime)
+            .field(KEY_MAX, (unsigned long)r.maxTime)
+            .field(KEY_ALLOCS, (unsigned long)r.allocs)
+            .field(KEY_ALLOC_BYTES, (unsigned long)r.allocBytes)
+            .field(KEY_STACK_BYTES, (unsigned long)r.stackBytes)
+            .endObject();
+    }
+    json.endObject().end();
+#else
+    JsonWriter(BusLink::out()).begin().beginObject(KEY_BENCH).field(KEY_ENABLED, false).endObject().end();
+#endif
+}
+
+// ===== RELLENADO DE AGUA (WTR1) =====
+// Se evalúa en cada ciclo para cortar apenas el nivel llega a water_flood.
+void CommandProcessor::updateWaterRefill(unsigned long now) {
+    bool catAtWater = presence.isOccupied(PRESENCE_WATER) ||
+                      SafetyInterlock::isLatched(safetyChannelFor(SAFETY_WATER, unit));
+    WaterRefillOutcome outcome = waterRefill.update(now, catAtWater);
+    if (outcome == REFILL_NONE) return;
+
+    JsonWriter json(BusLink::out());
+    json.begin();
+    tagDevice(json, waterId);
+    switch (outcome) {
+        case REFILL_STARTED:
+            json.field(KEY_AUTO_ACTION, VAL_WATER_PUMP_STARTED)
+                .field(KEY_LEVEL, sensorManager->getWaterLevel())
+                .field(KEY_REASON, VAL_REFILL_NEEDED)
+                .field(KEY_DURATION_MS, waterRefill.getPlannedMs());
+            break;
+        case REFILL_STOPPED_CAT:
+            json.field(KEY_AUTO_ACTION, VAL_WATER_PUMP_EMERGENCY_STOP)
+                .field(KEY_REASON, VAL_CAT_DETECTED);
+            break;
+        case REFILL_FAULT_DRY_RUN:
+        case REFILL_FAULT_STUCK:
+            json.field(KEY_AUTO_ACTION, VAL_WATER_PUMP_FAULT)
+                .field(KEY_REASON, outcome == REFILL_FAULT_STUCK ? VAL_SENSOR_STUCK : VAL_DRY_RUN)
+                .field(KEY_LEVEL, sensorManager->getWaterLevel());
+            break;
+        default:
+            json.field(KEY_AUTO_ACTION, VAL_WATER_PUMP_STOPPED)
+                .field(KEY_REASON, outcome == REFILL_STOPPED_FULL ? VAL_WATER_LEVEL_FULL : VAL_TIMEOUT)
+                .field(KEY_LEVEL, sensorManager->getWaterLevel())
+                .field(KEY_FILL_RATE, waterRefill.getLearnedRate());
+            break;
+    }
+    json.end();
+}
+
+// ===== EVENTOS DE PESO (FDR1) =====
+// Se reenvían en cuanto aparecen: el host guarda estos pocos registros por
+// comida en lugar de muestrear el peso crudo.
+void CommandProcessor::sendWeightEvents() {
+    if (!sensorManager) return;
+    WeightEvent ev;
+    while (sensorManager->pollFeederWeightEvent(ev)) {
+        JsonWriter json(BusLink::out());
+        json.begin().field(KEY_DEVICE_ID, feederId);
+        switch (ev.type) {
+            case WEIGHT_EVENT_EAT_START:
+                json.field(KEY_EVENT, VAL_EAT_START);
+                break;
+            case WEIGHT_EVENT_EAT_END:
+                json.field(KEY_EVENT, VAL_EAT_END)
+                    .field(KEY_GRAMS, ev.gramsDg / 10.0, 1)
+                    .field(KEY_DURATION_MS, (unsigned long)ev.durationMs);
+                break;
+            case WEIGHT_EVENT_STEP:
+                json.field(KEY_EVENT, VAL_WEIGHT_STEP)
+                    .field(KEY_GRAMS, ev.gramsDg / 10.0, 1);
+                break;
+        }
+        json.field(KEY_WEIGHT_GRAMS, ev.levelDg / 10.0, 1).end();
+    }
+}
+
 void CommandProcessor::update() {
-    static unsigned long lastUpdate = 0;
     unsigned long now = millis();
+    const ConfigData& cfg = ConfigStore::getInstance().get();
+
+    updateSafetyInterlock();
+    presence.update(now);
+    sendPresenceEvents();
+    updateSensorActivity();
+    updateDispense(now);
+    sendWeightEvents();
+    updateWaterRefill(now);
+    updateCleaning(now);
 
-    if (now - lastUpdate >= 500) {
+    if (now - lastUpdate >= cfg.automationPeriodMs) {
         // FEEDER: control persistente (manualFeederControl)
         if (manualFeederControl && sensorManager && feederMotor) {
             float storageDistance = sensorManager->getFeederFoodDistance();
@@ -312,50 +1182,44 @@ void CommandProcessor::update() {
                 if (!started) {
                     // Si no pudo arrancar por sensores, cancelamos la persistencia
                     manualFeederControl = false;
-                    String reason = "SENSOR_CHECK_FAILED";
-                    if (storageDistance <= 0 || storageDistance >= 13.0) {
-                        reason = "NO_FOOD_IN_STORAGE";
-                    } else if (plateDistance > 0 && plateDistance <= 2.0) {
-                        reason = "PLATE_FULL";
+                    ProtoStr reason = VAL_SENSOR_CHECK_FAILED;
+                    if (storageDistance <= 0 || storageDistance >= cfg.units[unit].storageEmptyCm) {
+                        reason = VAL_NO_FOOD_IN_STORAGE;
+                    } else if (plateDistance > 0 && plateDistance <= cfg.units[unit].plateFullCm) {
+                        reason = VAL_PLATE_FULL;
                     }
-                    Serial.println("{\"auto_action\":\"FEEDER_START_BLOCKED\",\"reason\":\"" + reason + "\",\"storage_distance\":" + String(storageDistance) + ",\"plate_distance\":" + String(plateDistance) + "}");
+                    JsonWriter json(BusLink::out());
+                    tagDevice(json.begin(), feederId);
+                    json.field(KEY_AUTO_ACTION, VAL_FEEDER_START_BLOCKED)
+                        .field(KEY_REASON, reason)
+                        .field(KEY_STORAGE_DISTANCE, storageDistance)
+                        .field(KEY_PLATE_DISTANCE, plateDistance)
+                        .end();
                 }
             } else {
                 // Si ya está corriendo, verificar que siga siendo seguro; si no, detener inmediatamente
                 if (feederMotor->monitorAndStop(storageDistance, plateDistance)) {
                     // monitorAndStop detuvo el motor por razones de seguridad -> cancelamos persistencia
                     manualFeederControl = false;
-                    Serial.println("{\"auto_action\":\"FEEDER_AUTO_STOPPED_BY_SENSORS\",\"storage_distance\":" + String(storageDistance) + ",\"plate_distance\":" + String(plateDistance) + "}");
+                    JsonWriter json(BusLink::out());
+                    tagDevice(json.begin(), feederId);
+                    json.field(KEY_AUTO_ACTION, VAL_FEEDER_AUTO_STOPPED)
+                        .field(KEY_STORAGE_DISTANCE, storageDistance)
+                        .field(KEY_PLATE_DISTANCE, plateDistance)
+                        .end();
                 }
             }
         }
 
-        // WATER: control automático
-        if (sensorManager && waterPump) {
-            String waterLevel = sensorManager->getWaterLevel();
-            bool catNearWater = sensorManager->isCatDrinking();
-
-            if (waterLevel != "FLOOD" && !catNearWater && !waterPump->isPumpRunning()) {
-                waterPump->turnOn(30000);
-                Serial.println("{\"auto_action\":\"WATER_PUMP_STARTED\",\"level\":\"" + waterLevel + "\",\"reason\":\"REFILL_NEEDED\"}");
-            }
-
-            if (catNearWater && waterPump->isPumpRunning()) {
-                waterPump->turnOff();
-                Serial.println("{\"auto_action\":\"WATER_PUMP_EMERGENCY_STOP\",\"reason\":\"CAT_DETECTED\"}");
-            }
-
-            if (waterLevel == "FLOOD" && waterPump->isPumpRunning()) {
-                waterPump->turnOff();
-                Serial.println("{\"auto_action\":\"WATER_PUMP_STOPPED\",\"reason\":\"WATER_LEVEL_FULL\",\"level\":\"FLOOD\"}");
-            }
-        }
-
         if (litterboxMotor && sensorManager) {
             int motorState = litterboxMotor->getState();
             // Solo monitoreo de seguridad, sin limpieza automática
             if (motorState == 2 && !isLitterboxSafeToOperate()) {
-                Serial.println("{\"safety_alert\":\"LITTERBOX_BLOCKED\",\"reason\":\"UNSAFE_CONDITIONS\"}");
+                JsonWriter json(BusLink::out());
+                tagDevice(json.begin(), litterboxId);
+                json.field(KEY_SAFETY_ALERT, VAL_LITTERBOX_BLOCKED)
+                    .field(KEY_REASON, VAL_UNSAFE_CONDITIONS)
+                    .end();
                 // No llamar a setBlocked() si no existe
             }
         }
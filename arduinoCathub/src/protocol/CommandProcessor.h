@@ -6,6 +6,15 @@
 #include "../Devices/litterbox/actuators/LitterboxStepperMotor.h"
 #include "../Devices/feeder/actuators/FeederStepperMotor.h"
 #include "../Devices/waterdispenser/actuators/WaterDispenserPump.h"
+#include "ProtocolStrings.h"
+#include "JsonWriter.h"
+#include "BusLink.h"
+#include "../automation/DispenseController.h"
+#include "../automation/PresenceEngine.h"
+#include "../automation/WaterRefillController.h"
+#include "../automation/LitterboxCleaningSequence.h"
+#include "../system/SafetyInterlock.h"
+#include "../system/Watchdog.h"
 
 class CommandProcessor {
 private:
@@ -15,8 +24,20 @@ private:
     WaterDispenserPump*      waterPump;
     bool                     initialized;
 
+    // Estación que atiende (0 = la primera) y sus IDs de dispositivo
+    uint8_t                    unit;
+    const __FlashStringHelper* litterboxId;
+    const __FlashStringHelper* feederId;
+    const __FlashStringHelper* waterId;
+    unsigned long              lastUpdate;
+
     bool manualFeederControl;
-    int  litterboxState; // 1 = INACTIVE, 2 = ACTIVE
+    int  litterboxState; // 1 = INACTIVE, 2 = ACTIVE, 21/22 = limpiando
+
+    DispenseController dispenser;
+    PresenceEngine presence;
+    WaterRefillController waterRefill;
+    LitterboxCleaningSequence cleaning;
 
     void processDeviceIDCommand(String command);
 
@@ -25,29 +46,78 @@ private:
     void setLitterboxReady();
     void startNormalCleaning();
     void startDeepCleaning();
+    void startCleaning(CleaningMode mode);
+    void updateCleaning(unsigned long now);
+    void sendLitterboxActionFailure(ProtoStr action, ProtoStr reason);
 
     // feeder / water (sin cambios)
     void sendFeederStatus();
     void controlFeederMotor(bool on);
+    void processFeederCommand(const String& action);
+    void sendWeightEvents();
+    void sendPresenceEvents();
+    void updateWaterRefill(unsigned long now);
+    void startDispense(const String& gramsText);
+    void sendDispenseEvent(ProtoStr event);
+    void updateDispense(unsigned long now);
+
+    // configuración persistente (EEPROM)
+    void sendConfig(uint8_t station);
+    void resetConfig();
+    void calibrateLitterboxMQ2();
+
+    // parámetros ajustables (GET/SET/LIST); "@N" elige la estación
+    void sendParamList(uint8_t station);
+    void sendParam(const String& name);
+    void setParam(const String& assignment);
+
+    // enclavamiento de seguridad (ISR)
+    void updateSafetyInterlock();
+
+    // muestreo adaptativo
+    void updateSensorActivity();
+    void sendSensorRates();
+    void sendSensorHealth();
+
+    // watchdog / vueltas del loop
+    void sendWatchdogStats();
+    void sendProfile();
+    void resetProfile();
+    void sendTrace();
+    void resetTrace();
+    void sendBench();
 
     void sendAllDevicesStatus();
-    void sendPlainTextSensors();
+
+    // con varias estaciones, device_id en los mensajes que no lo llevaban
+    void tagDevice(JsonWriter& json, const __FlashStringHelper* deviceId);
 
     // seguridad
     bool isCatPresent();
+    bool isLitterboxRangeBlocked();
     bool isLitterboxSafeToClean();
-    bool isLitterboxSafeToOperate();
     bool isFeederSafeToOperate();
     bool hasSufficientFood();
 
 public:
     CommandProcessor(SensorManager* sensors, LitterboxStepperMotor* litter,
-                     FeederStepperMotor* feeder, WaterDispenserPump* water);
+                     FeederStepperMotor* feeder, WaterDispenserPump* water, uint8_t unit = 0);
 
     bool initialize();
+    void sendBootReport();
     void processCommand(String command);
     void update();
-    
+
+    // Para DeviceRouter: dueño de un ID de 4 caracteres y las partes de las
+    // respuestas que abarcan a todas las estaciones (ALL, C, RATES, DIAG)
+    bool ownsDevice(const String& deviceId) const;
+    bool isLitterboxSafeToOperate();    // imprime su propia línea safety_check
+    void writeDeviceStatus(JsonWriter& json, bool litterboxSafe);
+    void sendPlainTextSensors(Print& out = BusLink::out());
+    void writeSensorRates(JsonWriter& json);
+    void writeSensorHealth(JsonWriter& json);
+    void resetSensorHealth();
+
 
     int getLitterboxState() const { return litterboxState; }
 };
@@ -0,0 +1,75 @@
+// DeviceRouter.cpp
+#include "DeviceRouter.h"
+#include "JsonWriter.h"
+#include "../system/TraceBuffer.h"
+
+DeviceRouter::DeviceRouter() : count(0) {
+    for (uint8_t i = 0; i < CATHUB_UNITS; ++i) processors[i] = nullptr;
+}
+
+bool DeviceRouter::addUnit(CommandProcessor* processor) {
+    if (!processor || count >= CATHUB_UNITS) return false;
+    processors[count++] = processor;
+    return true;
+}
+
+CommandProcessor* DeviceRouter::ownerOf(const String& command) {
+    if (command.length() >= 5 && command.charAt(4) == ':') {
+        String deviceId = command.substring(0, 4);
+        for (uint8_t i = 0; i < count; ++i) {
+            if (processors[i]->ownsDevice(deviceId)) return processors[i];
+        }
+    }
+    // Comandos de placa e IDs desconocidos (responde UNKNOWN_COMMAND)
+    return processors[0];
+}
+
+void DeviceRouter::processCommand(String command) {
+    command.trim();
+    if (command.length() == 0 || count == 0) return;
+    TRACE_EVENT(TRC_COMMAND, ((uint16_t)(uint8_t)command[0] << 8) | (uint8_t)command[command.length() - 1]);
+
+    if (count > 1) {
+        if (protoEquals(command, CMD_ALL))           { sendAllDevicesStatus(); return; }
+        if (protoEquals(command, CMD_PLAIN_SENSORS)) { sendPlainTextSensors(); return; }
+        if (protoEquals(command, CMD_RATES))         { sendSensorRates(); return; }
+        if (protoEquals(command, CMD_DIAG))          { sendSensorHealth(); return; }
+        if (protoEquals(command, CMD_DIAG_RESET)) {
+            for (uint8_t i = 0; i < count; ++i) processors[i]->resetSensorHealth();
+            sendSensorHealth();
+            return;
+        }
+    }
+
+    ownerOf(command)->processCommand(command);
+}
+
+// ===== RESPUESTAS DE TODAS LAS ESTACIONES =====
+void DeviceRouter::sendAllDevicesStatus() {
+    // Cada estación imprime su safety_check antes de abrir la respuesta
+    bool safe[CATHUB_UNITS];
+    for (uint8_t i = 0; i < count; ++i) safe[i] = processors[i]->isLitterboxSafeToOperate();
+
+    JsonWriter json(BusLink::out());
+    json.begin().field(KEY_COMMAND, CMD_ALL).beginObject(KEY_DEVICES);
+    for (uint8_t i = 0; i < count; ++i) processors[i]->writeDeviceStatus(json, safe[i]);
+    json.endObject().end();
+}
+
+void DeviceRouter::sendPlainTextSensors() {
+    for (uint8_t i = 0; i < count; ++i) processors[i]->sendPlainTextSensors(BusLink::out());
+}
+
+void DeviceRouter::sendSensorRates() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_RATES);
+    for (uint8_t i = 0; i < count; ++i) processors[i]->writeSensorRates(json);
+    json.endObject().end();
+}
+
+void DeviceRouter::sendSensorHealth() {
+    JsonWriter json(BusLink::out());
+    json.begin().beginObject(KEY_DIAG);
+    for (uint8_t i = 0; i < count; ++i) processors[i]->writeSensorHealth(json);
+    json.endObject().end();
+}
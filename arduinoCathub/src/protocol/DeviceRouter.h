@@ -0,0 +1,35 @@
+// DeviceRouter.h
+#ifndef DEVICE_ROUTER_H
+#define DEVICE_ROUTER_H
+
+#include <Arduino.h>
+#include "CommandProcessor.h"
+#include "../config/StationLayout.h"
+
+// Reparte los comandos del puerto serie entre los CommandProcessor de cada
+// estación. "XXXX:..." va al dueño del ID de 4 caracteres; ALL, C, RATES y
+// DIAG arman una sola respuesta con todas las estaciones; lo demás (PING,
+// CFG, GET/SET, WDT, PROF, ...) es de la placa y lo atiende la primera.
+// Con una sola estación todo pasa directo, sin cambiar las respuestas.
+class DeviceRouter {
+private:
+    CommandProcessor* processors[CATHUB_UNITS];
+    uint8_t count;
+
+    CommandProcessor* ownerOf(const String& command);
+
+    void sendAllDevicesStatus();
+    void sendPlainTextSensors();
+    void sendSensorRates();
+    void sendSensorHealth();
+
+public:
+    DeviceRouter();
+
+    bool addUnit(CommandProcessor* processor);
+    uint8_t getUnitCount() const { return count; }
+
+    void processCommand(String command);
+};
+
+#endif
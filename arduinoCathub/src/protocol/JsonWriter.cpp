@@ -0,0 +1,150 @@
+// JsonWriter.cpp
+#include "JsonWriter.h"
+
+JsonWriter::JsonWriter(Print& output) : out(output), depth(0) {
+    for (uint8_t i = 0; i < MAX_DEPTH; ++i) needComma[i] = false;
+}
+
+void JsonWriter::separator() {
+    if (depth == 0) return;
+    if (needComma[depth - 1]) out.print(',');
+    needComma[depth - 1] = true;
+}
+
+void JsonWriter::key(ProtoStr k) {
+    separator();
+    quoted(protoStr(k));
+    out.print(':');
+}
+
+void JsonWriter::quoted(const __FlashStringHelper* text) {
+    out.print('"');
+    out.print(text);
+    out.print('"');
+}
+
+JsonWriter& JsonWriter::begin() {
+    out.print('{');
+    if (depth < MAX_DEPTH) needComma[depth++] = false;
+    return *this;
+}
+
+void JsonWriter::end() {
+    out.println('}');
+    if (depth > 0) depth--;
+}
+
+JsonWriter& JsonWriter::beginObject(ProtoStr k) {
+    key(k);
+    return begin();
+}
+
+JsonWriter& JsonWriter::beginObject(const __FlashStringHelper* k) {
+    separator();
+    quoted(k);
+    out.print(':');
+    return begin();
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out.print('}');
+    if (depth > 0) depth--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(ProtoStr k) {
+    key(k);
+    out.print('[');
+    if (depth < MAX_DEPTH) needComma[depth++] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const __FlashStringHelper* k) {
+    separator();
+    quoted(k);
+    out.print(F(":["));
+    if (depth < MAX_DEPTH) needComma[depth++] = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out.print(']');
+    if (depth > 0) depth--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::item(unsigned long value) {
+    separator();
+    out.print(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::itemNull() {
+    separator();
+    out.print(F("null"));
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, ProtoStr value) {
+    key(k);
+    quoted(protoStr(value));
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, const __FlashStringHelper* value) {
+    key(k);
+    quoted(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, const String& value) {
+    key(k);
+    out.print('"');
+    out.print(value);
+    out.print('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, const char* value) {
+    key(k);
+    out.print('"');
+    out.print(value);
+    out.print('"');
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, bool value) {
+    key(k);
+    out.print(value ? F("true") : F("false"));
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, int value) {
+    key(k);
+    out.print(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, long value) {
+    key(k);
+    out.print(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, unsigned long value) {
+    key(k);
+    out.print(value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::field(ProtoStr k, double value, uint8_t decimals) {
+    key(k);
+    out.print(value, decimals);
+    return *this;
+}
+
+JsonWriter& JsonWriter::fieldNull(ProtoStr k) {
+    key(k);
+    out.print(F("null"));
+    return *this;
+}
@@ -0,0 +1,48 @@
+// JsonWriter.h
+// Emisor JSON en streaming: escribe directo al Print (Serial) usando las
+// claves de ProtocolStrings, sin construir Strings intermedios en SRAM.
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+#include "ProtocolStrings.h"
+
+class JsonWriter {
+private:
+    static const uint8_t MAX_DEPTH = 4;
+
+    Print& out;
+    uint8_t depth;
+    bool needComma[MAX_DEPTH];
+
+    void separator();
+    void key(ProtoStr k);
+    void quoted(const __FlashStringHelper* text);
+
+public:
+    explicit JsonWriter(Print& output);
+
+    JsonWriter& begin();                     // {
+    void end();                              // } + salto de línea
+    JsonWriter& beginObject(ProtoStr k);     // "k":{
+    JsonWriter& beginObject(const __FlashStringHelper* k);
+    JsonWriter& endObject();                 // }
+    JsonWriter& beginArray(ProtoStr k);      // "k":[
+    JsonWriter& beginArray(const __FlashStringHelper* k);
+    JsonWriter& endArray();                  // ]
+    JsonWriter& item(unsigned long value);   // elemento de un arreglo
+    JsonWriter& itemNull();
+
+    JsonWriter& field(ProtoStr k, ProtoStr value);
+    JsonWriter& field(ProtoStr k, const __FlashStringHelper* value);
+    JsonWriter& field(ProtoStr k, const String& value);
+    JsonWriter& field(ProtoStr k, const char* value);
+    JsonWriter& field(ProtoStr k, bool value);
+    JsonWriter& field(ProtoStr k, int value);
+    JsonWriter& field(ProtoStr k, long value);
+    JsonWriter& field(ProtoStr k, unsigned long value);
+    JsonWriter& field(ProtoStr k, double value, uint8_t decimals = 2);
+    JsonWriter& fieldNull(ProtoStr k);
+};
+
+#endif // JSON_WRITER_H
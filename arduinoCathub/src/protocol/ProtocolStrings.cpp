@@ -0,0 +1,33 @@
+// ProtocolStrings.cpp
+#include "ProtocolStrings.h"
+
+// Un arreglo PROGMEM por texto y una tabla de punteros (también en flash)
+#define PROTO_STR_DEFINE(name, text) static const char PSTR_##name[] PROGMEM = text;
+PROTOCOL_STRINGS(PROTO_STR_DEFINE)
+#undef PROTO_STR_DEFINE
+
+static const char* const PROTO_TABLE[PROTO_STR_COUNT] PROGMEM = {
+#define PROTO_STR_ENTRY(name, text) PSTR_##name,
+    PROTOCOL_STRINGS(PROTO_STR_ENTRY)
+#undef PROTO_STR_ENTRY
+};
+
+const __FlashStringHelper* protoStr(ProtoStr id) {
+    if (id >= PROTO_STR_COUNT) return nullptr;
+    return FPSTR(pgm_read_ptr(&PROTO_TABLE[id]));
+}
+
+bool protoEquals(const String& text, ProtoStr id) {
+    return protoEquals(text, protoStr(id));
+}
+
+bool protoEquals(const String& text, const __FlashStringHelper* flashText) {
+    if (!flashText) return false;
+    return strcmp_P(text.c_str(), reinterpret_cast<PGM_P>(flashText)) == 0;
+}
+
+bool protoStartsWith(const String& text, ProtoStr prefix) {
+    PGM_P p = reinterpret_cast<PGM_P>(protoStr(prefix));
+    if (!p) return false;
+    return strncmp_P(text.c_str(), p, strlen_P(p)) == 0;
+}
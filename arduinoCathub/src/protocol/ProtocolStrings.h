@@ -0,0 +1,281 @@
+// ProtocolStrings.h
+// Vocabulario del protocolo serie (claves JSON, valores y comandos) residente
+// en flash. Cada texto se indexa por enum y se emite con las rutinas _P, así
+// no ocupa SRAM del Mega.
+#ifndef PROTOCOL_STRINGS_H
+#define PROTOCOL_STRINGS_H
+
+#include <Arduino.h>
+#include "../Devices/config/DeviceIDs.h"
+
+// X(nombre, texto): KEY_ = clave JSON, VAL_ = valor, CMD_ = comando/acción recibida
+#define PROTOCOL_STRINGS(X) \
+    /* ===== CLAVES ===== */ \
+    X(KEY_RESPONSE,          "response") \
+    X(KEY_ERROR,             "error") \
+    X(KEY_RECEIVED,          "received") \
+    X(KEY_DEVICE_ID,         "device_id") \
+    X(KEY_ACTION,            "action") \
+    X(KEY_SUCCESS,           "success") \
+    X(KEY_REASON,            "reason") \
+    X(KEY_STATE,             "state") \
+    X(KEY_FINAL_STATE,       "final_state") \
+    X(KEY_STATUS,            "status") \
+    X(KEY_DISTANCE_CM,       "distance_cm") \
+    X(KEY_TEMPERATURE_C,     "temperature_c") \
+    X(KEY_HUMIDITY_PERCENT,  "humidity_percent") \
+    X(KEY_GAS_PPM,           "gas_ppm") \
+    X(KEY_MOTOR_READY,       "motor_ready") \
+    X(KEY_SAFE_TO_OPERATE,   "safe_to_operate") \
+    X(KEY_MANUAL_CONTROL,    "manual_control") \
+    X(KEY_MOTOR_RUNNING,     "motor_running") \
+    X(KEY_WEIGHT_GRAMS,      "weight_grams") \
+    X(KEY_CAT_DISTANCE_CM,   "cat_distance_cm") \
+    X(KEY_FOOD_DISTANCE_CM,  "food_distance_cm") \
+    X(KEY_STORAGE_STATUS,    "storage_status") \
+    X(KEY_PLATE_STATUS,      "plate_status") \
+    X(KEY_STORAGE_DISTANCE,  "storage_distance") \
+    X(KEY_PLATE_DISTANCE,    "plate_distance") \
+    X(KEY_MOTOR,             "motor") \
+    X(KEY_DIRECTION,         "direction") \
+    X(KEY_SPEED,             "speed") \
+    X(KEY_AUTO_ACTION,       "auto_action") \
+    X(KEY_LEVEL,             "level") \
+    X(KEY_SAFETY_CHECK,      "safety_check") \
+    X(KEY_SAFETY_ALERT,      "safety_alert") \
+    X(KEY_COMMAND,           "command") \
+    X(KEY_DEVICES,           "devices") \
+    X(KEY_SAFE,              "safe") \
+    X(KEY_CONFIG,            "config") \
+    X(KEY_HX711_FACTOR,      "hx711_factor") \
+    X(KEY_HX711_OFFSET,      "hx711_offset") \
+    X(KEY_MQ2_RO,            "mq2_ro") \
+    X(KEY_CAT_PRESENT_CM,    "cat_present_cm") \
+    X(KEY_STORAGE_EMPTY_CM,  "storage_empty_cm") \
+    X(KEY_PLATE_FULL_CM,     "plate_full_cm") \
+    X(KEY_PUMP_REFILL_MS,    "pump_refill_ms") \
+    X(KEY_PUMP_MAX_MS,       "pump_max_ms") \
+    X(KEY_FLAGS,             "flags") \
+    X(KEY_SEQUENCE,          "seq") \
+    X(KEY_SLOT,              "slot") \
+    X(KEY_WATER_DRY,         "water_dry") \
+    X(KEY_WATER_WET,         "water_wet") \
+    X(KEY_WATER_FLOOD,       "water_flood") \
+    X(KEY_AUTO_PERIOD_MS,    "auto_period_ms") \
+    X(KEY_PARAM,             "param") \
+    X(KEY_PARAMS,            "params") \
+    X(KEY_VALUE,             "value") \
+    X(KEY_MIN,               "min") \
+    X(KEY_MAX,               "max") \
+    X(KEY_PENDING,           "pending") \
+    X(KEY_MQ2_GAS,           "mq2_gas") \
+    X(KEY_GAS_ANALOG,        "gas_analog") \
+    X(KEY_WEIGHT_STEP_G,     "weight_step_g") \
+    X(KEY_WEIGHT_SETTLE_MS,  "weight_settle_ms") \
+    X(KEY_WEIGHT_GAP_MS,     "weight_session_gap_ms") \
+    X(KEY_EVENT,             "event") \
+    X(KEY_GRAMS,             "grams") \
+    X(KEY_DURATION_MS,       "duration_ms") \
+    X(KEY_TARGET_GRAMS,      "target_grams") \
+    X(KEY_STEPS,             "steps") \
+    X(KEY_STEPS_PER_GRAM,    "steps_per_gram") \
+    X(KEY_CONFIDENCE,        "confidence") \
+    X(KEY_FILL_RATE,         "fill_rate") \
+    X(KEY_MQ2_AUTOCAL,       "mq2_autocal") \
+    X(KEY_NODE_ADDR,         "node_addr") \
+    X(KEY_BUS_DE_PIN,        "bus_de_pin") \
+    X(KEY_MQ2_BASELINE,      "mq2_baseline_rs") \
+    X(KEY_RATES,             "rates") \
+    X(KEY_INTERVAL_MS,       "interval_ms") \
+    X(KEY_BURST,             "burst") \
+    X(KEY_LATENCY_US,        "latency_us") \
+    X(KEY_WORST_CASE_US,     "worst_case_us") \
+    X(KEY_POSITION,          "position") \
+    X(KEY_TARGET,            "target") \
+    X(KEY_CHECKPOINT,        "checkpoint") \
+    X(KEY_RESET_CAUSE,       "reset_cause") \
+    X(KEY_WATCHDOG,          "watchdog") \
+    X(KEY_WDT_TASK,          "wdt_task") \
+    X(KEY_WDT_TASK_MS,       "wdt_task_ms") \
+    X(KEY_WDT_LOOP_MS,       "wdt_loop_ms") \
+    X(KEY_WDT_LOOPS,         "wdt_loops") \
+    X(KEY_WDT_UPTIME_MS,     "wdt_uptime_ms") \
+    X(KEY_ENABLED,           "enabled") \
+    X(KEY_LOOPS,             "loops") \
+    X(KEY_LOOP_MAX_US,       "loop_max_us") \
+    X(KEY_STALLS,            "stalls") \
+    X(KEY_TASKS,             "tasks") \
+    X(KEY_MAX_US,            "max_us") \
+    X(KEY_BUDGET_US,         "budget_us") \
+    X(KEY_OVERRUNS,          "overruns") \
+    X(KEY_PROF,              "prof") \
+    X(KEY_HIST_BASE_US,      "hist_base_us") \
+    X(KEY_COUNT,             "n") \
+    X(KEY_MEAN_US,           "mean_us") \
+    X(KEY_HIST,              "hist") \
+    X(KEY_TRACE,             "trace") \
+    X(KEY_CAPACITY,          "capacity") \
+    X(KEY_RECORD_BYTES,      "record_bytes") \
+    X(KEY_TOTAL,             "total") \
+    X(KEY_DISCARDED,         "discarded") \
+    X(KEY_NOW_US,            "now_us") \
+    X(KEY_RECORDS,           "records") \
+    X(KEY_READINGS,          "readings") \
+    X(KEY_LITTERBOX,         "litterbox") \
+    X(KEY_DISTANCE,          "distance") \
+    X(KEY_TEMPERATURE,       "temperature") \
+    X(KEY_HUMIDITY,          "humidity") \
+    X(KEY_FEEDER,            "feeder") \
+    X(KEY_WEIGHT,            "weight") \
+    X(KEY_CAT_DISTANCE,      "cat_distance") \
+    X(KEY_FOOD_DISTANCE,     "food_distance") \
+    X(KEY_WATERDISPENSER,    "waterdispenser") \
+    X(KEY_WATER_LEVEL,       "water_level") \
+    X(KEY_CAT_DRINKING,      "cat_drinking") \
+    X(KEY_TIMESTAMP,         "timestamp") \
+    X(KEY_BENCH,             "bench") \
+    X(KEY_ITERATIONS,        "iterations") \
+    X(KEY_UNIT,              "unit") \
+    X(KEY_BYTES,             "bytes") \
+    X(KEY_MEAN,              "mean") \
+    X(KEY_ALLOCS,            "allocs") \
+    X(KEY_ALLOC_BYTES,       "alloc_bytes") \
+    X(KEY_STACK_BYTES,       "stack_bytes") \
+    X(KEY_DIAG,              "diag") \
+    X(KEY_BUS,               "bus") \
+    X(KEY_STATION,           "station") \
+    /* ===== VALORES ===== */ \
+    X(VAL_PONG,                       "PONG") \
+    X(VAL_UNKNOWN_COMMAND,            "UNKNOWN_COMMAND") \
+    X(VAL_UNKNOWN_DEVICE,             "UNKNOWN_DEVICE") \
+    X(VAL_UNKNOWN_ACTION,             "UNKNOWN_ACTION") \
+    X(VAL_ACTIVE,                     "ACTIVE") \
+    X(VAL_INACTIVE,                   "INACTIVE") \
+    X(VAL_UNKNOWN,                    "UNKNOWN") \
+    X(VAL_NOT_READY,                  "NOT_READY") \
+    X(VAL_SET_READY,                  "SET_READY") \
+    X(VAL_CLEAN_NORMAL,               "CLEAN_NORMAL") \
+    X(VAL_CLEAN_DEEP,                 "CLEAN_DEEP") \
+    X(VAL_CLEAN_PROGRESS,             "CLEAN_PROGRESS") \
+    X(VAL_CLEAN_PAUSED,               "CLEAN_PAUSED") \
+    X(VAL_CLEAN_RESUMED,              "CLEAN_RESUMED") \
+    X(VAL_CLEAN_TIMEOUT,              "CLEAN_TIMEOUT") \
+    X(VAL_CLEAN_ROLLBACK,             "CLEAN_ROLLBACK") \
+    X(VAL_CLEAN_DONE,                 "CLEAN_DONE") \
+    X(VAL_CLEAN_ABORTED,              "CLEAN_ABORTED") \
+    X(VAL_NO_SENSOR_MANAGER,          "NO_SENSOR_MANAGER") \
+    X(VAL_NOT_SAFE,                   "NOT_SAFE") \
+    X(VAL_NO_MOTOR,                   "NO_MOTOR") \
+    X(VAL_MOTOR_FAILED,               "MOTOR_FAILED") \
+    X(VAL_MISSING_DEPENDENCY,         "MISSING_DEPENDENCY") \
+    X(VAL_SENSOR_CHECK_FAILED,        "SENSOR_CHECK_FAILED") \
+    X(VAL_NO_FOOD_IN_STORAGE,         "NO_FOOD_IN_STORAGE") \
+    X(VAL_PLATE_ALREADY_FULL,         "PLATE_ALREADY_FULL") \
+    X(VAL_PLATE_FULL,                 "PLATE_FULL") \
+    X(VAL_ON,                         "ON") \
+    X(VAL_OFF,                        "OFF") \
+    X(VAL_LEFT,                       "LEFT") \
+    X(VAL_FLOOD,                      "FLOOD") \
+    X(VAL_FEEDER_START_BLOCKED,       "FEEDER_START_BLOCKED") \
+    X(VAL_FEEDER_AUTO_STOPPED,        "FEEDER_AUTO_STOPPED_BY_SENSORS") \
+    X(VAL_WATER_PUMP_STARTED,         "WATER_PUMP_STARTED") \
+    X(VAL_WATER_PUMP_EMERGENCY_STOP,  "WATER_PUMP_EMERGENCY_STOP") \
+    X(VAL_WATER_PUMP_STOPPED,         "WATER_PUMP_STOPPED") \
+    X(VAL_REFILL_NEEDED,              "REFILL_NEEDED") \
+    X(VAL_CAT_DETECTED,               "CAT_DETECTED") \
+    X(VAL_SAFETY_INTERLOCK,           "SAFETY_INTERLOCK") \
+    X(VAL_NO_CAT_DETECTED,            "NO_CAT_DETECTED") \
+    X(VAL_WATER_LEVEL_FULL,           "WATER_LEVEL_FULL") \
+    X(VAL_LITTERBOX_BLOCKED,          "LITTERBOX_BLOCKED") \
+    X(VAL_UNSAFE_CONDITIONS,          "UNSAFE_CONDITIONS") \
+    X(VAL_ERROR_NO_SENSOR_MANAGER,    "ERROR:NO_SENSOR_MANAGER") \
+    X(VAL_TARE,                       "TARE") \
+    X(VAL_CALIBRATE,                  "CALIBRATE") \
+    X(VAL_CAL_MQ2,                    "CAL_MQ2") \
+    X(VAL_RESET,                      "RESET") \
+    X(VAL_SENSOR_NOT_READY,           "SENSOR_NOT_READY") \
+    X(VAL_INVALID_VALUE,              "INVALID_VALUE") \
+    X(VAL_CALIBRATION_FAILED,         "CALIBRATION_FAILED") \
+    X(VAL_UNKNOWN_PARAM,              "UNKNOWN_PARAM") \
+    X(VAL_OUT_OF_RANGE,               "OUT_OF_RANGE") \
+    X(VAL_PIN_IN_USE,                 "PIN_IN_USE") \
+    X(VAL_EAT_START,                  "EAT_START") \
+    X(VAL_EAT_END,                    "EAT_END") \
+    X(VAL_WEIGHT_STEP,                "WEIGHT_STEP") \
+    X(VAL_BUSY,                       "BUSY") \
+    X(VAL_DISPENSE,                   "DISPENSE") \
+    X(VAL_DISPENSE_PROGRESS,          "DISPENSE_PROGRESS") \
+    X(VAL_DISPENSE_DONE,              "DISPENSE_DONE") \
+    X(VAL_DISPENSE_STALLED,           "DISPENSE_STALLED") \
+    X(VAL_DISPENSE_NO_FOOD,           "DISPENSE_NO_FOOD") \
+    X(VAL_DISPENSE_ABORTED,           "DISPENSE_ABORTED") \
+    X(VAL_CAT_ENTER,                  "CAT_ENTER") \
+    X(VAL_CAT_EXIT,                   "CAT_EXIT") \
+    X(VAL_WATER_PUMP_FAULT,           "WATER_PUMP_FAULT") \
+    X(VAL_TIMEOUT,                    "TIMEOUT") \
+    X(VAL_DRY_RUN,                    "DRY_RUN") \
+    X(VAL_SENSOR_STUCK,               "SENSOR_STUCK") \
+    X(VAL_BOOT,                       "BOOT") \
+    X(VAL_POWER_ON,                   "POWER_ON") \
+    X(VAL_EXTERNAL,                   "EXTERNAL") \
+    X(VAL_BROWN_OUT,                  "BROWN_OUT") \
+    X(VAL_WATCHDOG,                   "WATCHDOG") \
+    X(VAL_JTAG,                       "JTAG") \
+    X(VAL_TASK_COMMANDS,              "COMMANDS") \
+    X(VAL_TASK_SENSORS,               "SENSORS") \
+    X(VAL_TASK_AUTOMATION,            "AUTOMATION") \
+    X(VAL_TASK_ACTUATORS,             "ACTUATORS") \
+    X(VAL_NONE,                       "NONE") \
+    X(VAL_PROF_LOOP,                  "LOOP") \
+    X(VAL_PROF_FEEDER_MOTOR,          "FEEDER_MOTOR") \
+    X(VAL_PROF_WATER_PUMP,            "WATER_PUMP") \
+    X(VAL_NOT_ON_BUS,                 "NOT_ON_BUS") \
+    X(VAL_UNKNOWN_STATION,            "UNKNOWN_STATION") \
+    X(VAL_BOARD_PARAM,                "BOARD_PARAM") \
+    /* ===== COMANDOS ===== */ \
+    X(CMD_PING,          "PING") \
+    X(CMD_ALL,           "ALL") \
+    X(CMD_PLAIN_SENSORS, "C") \
+    X(CMD_STATUS,        "STATUS") \
+    X(CMD_READY,         "READY") \
+    X(CMD_STATE_READY,   "2") \
+    X(CMD_STATE_NORMAL,  "2.1") \
+    X(CMD_STATE_DEEP,    "2.2") \
+    X(CMD_ON,            "1") \
+    X(CMD_OFF,           "0") \
+    X(CMD_TARE,          "TARE") \
+    X(CMD_CAL_PREFIX,    "CAL:") \
+    X(CMD_CAL_MQ2,       "CAL_MQ2") \
+    X(CMD_CFG,           "CFG") \
+    X(CMD_CFG_RESET,     "CFG:RESET") \
+    X(CMD_GET_PREFIX,    "GET:") \
+    X(CMD_SET_PREFIX,    "SET:") \
+    X(CMD_LIST,          "LIST") \
+    X(CMD_RATES,         "RATES") \
+    X(CMD_WDT,           "WDT") \
+    X(CMD_WDT_RESET,     "WDT:RESET") \
+    X(CMD_PROF,          "PROF") \
+    X(CMD_PROF_RESET,    "PROF:RESET") \
+    X(CMD_TRACE,         "TRACE") \
+    X(CMD_TRACE_RESET,   "TRACE:RESET") \
+    X(CMD_BENCH,         "BENCH") \
+    X(CMD_DIAG,          "DIAG") \
+    X(CMD_DIAG_RESET,    "DIAG:RESET") \
+    X(CMD_DISPENSE_PREFIX, "DISPENSE:")
+
+enum ProtoStr : uint8_t {
+#define PROTO_STR_ENUM(name, text) name,
+    PROTOCOL_STRINGS(PROTO_STR_ENUM)
+#undef PROTO_STR_ENUM
+    PROTO_STR_COUNT
+};
+
+// Puntero a flash del texto (imprimible directamente con Print)
+const __FlashStringHelper* protoStr(ProtoStr id);
+
+// Comparaciones contra el vocabulario sin copiarlo a RAM
+bool protoEquals(const String& text, ProtoStr id);
+bool protoEquals(const String& text, const __FlashStringHelper* flashText);
+bool protoStartsWith(const String& text, ProtoStr prefix);
+
+#endif // PROTOCOL_STRINGS_H
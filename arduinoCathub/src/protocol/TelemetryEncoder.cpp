@@ -0,0 +1,133 @@
+// TelemetryEncoder.cpp
+#include "TelemetryEncoder.h"
+#include "JsonWriter.h"
+
+void TelemetryEncoder::capture(SensorManager& sensors, TelemetrySnapshot& out) {
+    out.litterDistanceCm = sensors.getLitterboxDistance();
+    out.temperatureC = sensors.getLitterboxTemperature();
+    out.humidityPct = sensors.getLitterboxHumidity();
+    out.gasPpm = sensors.getLitterboxGasPPM();
+    out.gasAnalog = sensors.getLitterboxGasAnalog();
+    out.feederWeightG = sensors.getFeederWeight();
+    out.catDistanceCm = sensors.getFeederCatDistance();
+    out.foodDistanceCm = sensors.getFeederFoodDistance();
+    out.waterLevel = sensors.getWaterLevelCode();
+    out.catDrinking = sensors.isCatDrinking();
+    out.timestampMs = millis();
+}
+
+// ===== JSON =====
+// Centinelas a null con las mismas reglas que getAllReadings()
+static bool isUnsetDht(float v) {
+    return isnan(v) || v <= -900.0f || v == -1.0f;
+}
+
+static void fieldOrNull(JsonWriter& json, ProtoStr k, float v, bool isNull, uint8_t decimals = 2) {
+    if (isNull) json.fieldNull(k);
+    else json.field(k, (double)v, decimals);
+}
+
+static const __FlashStringHelper* waterLevelText(uint8_t level) {
+    switch (level) {
+        case WATER_DRY:   return F("DRY");
+        case WATER_LOW:   return F("LOW");
+        case WATER_WET:   return F("WET");
+        case WATER_FLOOD: return F("FLOOD");
+        default:          return F("NOT_READY");
+    }
+}
+
+// Print que cuenta lo que pasa hacia el destino real
+class TallyPrint : public Print {
+public:
+    explicit TallyPrint(Print& target) : target(target), count(0) {}
+    size_t write(uint8_t c) override { size_t n = target.write(c); count += n; return n; }
+private:
+    Print& target;
+public:
+    size_t count;
+};
+
+size_t TelemetryEncoder::writeJson(const TelemetrySnapshot& s, Print& out) {
+    TallyPrint tally(out);
+    JsonWriter json(tally);
+    json.begin().beginObject(KEY_READINGS);
+
+    json.beginObject(KEY_LITTERBOX);
+    fieldOrNull(json, KEY_DISTANCE, s.litterDistanceCm, s.litterDistanceCm <= 0.0f);
+    fieldOrNull(json, KEY_TEMPERATURE, s.temperatureC, isUnsetDht(s.temperatureC));
+    fieldOrNull(json, KEY_HUMIDITY, s.humidityPct, isUnsetDht(s.humidityPct));
+    fieldOrNull(json, KEY_GAS_PPM, s.gasPpm, s.gasPpm < 0.0f);
+    fieldOrNull(json, KEY_GAS_ANALOG, s.gasAnalog, s.gasAnalog < 0.0f, 0);
+    json.endObject();
+
+    json.beginObject(KEY_FEEDER);
+    json.field(KEY_WEIGHT, (double)s.feederWeightG, 2);
+    fieldOrNull(json, KEY_CAT_DISTANCE, s.catDistanceCm, s.catDistanceCm < 0.0f);
+    fieldOrNull(json, KEY_FOOD_DISTANCE, s.foodDistanceCm, s.foodDistanceCm < 0.0f);
+    json.endObject();
+
+    json.beginObject(KEY_WATERDISPENSER)
+        .field(KEY_WATER_LEVEL, waterLevelText(s.waterLevel))
+        .field(KEY_CAT_DRINKING, s.catDrinking)
+        .endObject();
+
+    json.field(KEY_TIMESTAMP, s.timestampMs);
+    json.endObject().end();
+    return tally.count;
+}
+
+// ===== BINARIO =====
+static int16_t scaled(float v, float scale, bool isNull) {
+    if (isNull || isnan(v)) return TELEMETRY_NULL;
+    float x = v * scale;
+    if (x >= 32767.0f) return 32767;
+    if (x <= -32767.0f) return -32767;
+    return (int16_t)(x < 0 ? x - 0.5f : x + 0.5f);
+}
+
+static uint16_t scaledUnsigned(float v, float scale, bool isNull) {
+    if (isNull || isnan(v)) return (uint16_t)TELEMETRY_NULL;
+    float x = v * scale;
+    if (x >= 65534.0f) return 65534;
+    return (uint16_t)(x + 0.5f);
+}
+
+static void put16(uint8_t*& p, uint16_t v) {
+    *p++ = (uint8_t)v;
+    *p++ = (uint8_t)(v >> 8);
+}
+
+static uint8_t crc8(const uint8_t* data, uint8_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+size_t TelemetryEncoder::writeBinary(const TelemetrySnapshot& s, Print& out) {
+    uint8_t frame[TELEMETRY_FRAME_BYTES];
+    uint8_t* p = frame;
+    *p++ = TELEMETRY_SYNC;
+    *p++ = TELEMETRY_VERSION;
+    *p++ = TELEMETRY_BODY_BYTES;
+
+    uint32_t ts = s.timestampMs;
+    put16(p, (uint16_t)ts);
+    put16(p, (uint16_t)(ts >> 16));
+    put16(p, (uint16_t)scaled(s.litterDistanceCm, 100.0f, s.litterDistanceCm <= 0.0f));
+    put16(p, (uint16_t)scaled(s.temperatureC, 100.0f, isUnsetDht(s.temperatureC)));
+    put16(p, (uint16_t)scaled(s.humidityPct, 100.0f, isUnsetDht(s.humidityPct)));
+    put16(p, (uint16_t)scaled(s.catDistanceCm, 100.0f, s.catDistanceCm < 0.0f));
+    put16(p, (uint16_t)scaled(s.foodDistanceCm, 100.0f, s.foodDistanceCm < 0.0f));
+    put16(p, scaledUnsigned(s.gasPpm, 10.0f, s.gasPpm < 0.0f));
+    put16(p, scaledUnsigned(s.gasAnalog, 1.0f, s.gasAnalog < 0.0f));
+    put16(p, (uint16_t)scaled(s.feederWeightG, 10.0f, false));
+    *p++ = s.waterLevel;
+    *p++ = s.catDrinking ? 0x01 : 0x00;
+
+    *p = crc8(frame + 1, (uint8_t)(p - frame - 1));
+    return out.write(frame, sizeof(frame));
+}
@@ -0,0 +1,49 @@
+// TelemetryEncoder.h
+// Codificadores de telemetría alternativos a getAllReadings(): la misma foto
+// de sensores escrita directo a un Print, sin Strings intermedios. Candidatos
+// para el reporte periódico; el comando BENCH (-DCATHUB_BENCH) los compara con
+// los formatos actuales.
+#ifndef TELEMETRY_ENCODER_H
+#define TELEMETRY_ENCODER_H
+
+#include <Arduino.h>
+#include "../Devices/SensorManager.h"
+
+// Lecturas tal como las da SensorManager (con sus centinelas: -1, NAN)
+struct TelemetrySnapshot {
+    float litterDistanceCm;
+    float temperatureC;
+    float humidityPct;
+    float gasPpm;
+    float gasAnalog;
+    float feederWeightG;
+    float catDistanceCm;
+    float foodDistanceCm;
+    uint8_t waterLevel;       // WaterLevelCode
+    bool catDrinking;
+    unsigned long timestampMs;
+};
+
+// Trama binaria: TELEMETRY_SYNC, versión, longitud del cuerpo, cuerpo
+// little-endian y CRC-8 (polinomio 0x07) de todo lo anterior salvo el sync.
+// Cuerpo: timestamp u32 ms; distancia arenero, temperatura, humedad,
+// distancias al gato y a la comida en centésimas (i16); gas en décimas de
+// ppm (u16); gas en cuentas ADC (u16); peso en décimas de gramo (i16);
+// nivel de agua (u8, WaterLevelCode); banderas (u8, bit 0 = gato bebiendo).
+// Un valor sin lectura va como TELEMETRY_NULL.
+static const uint8_t TELEMETRY_SYNC = 0xA5;
+static const uint8_t TELEMETRY_VERSION = 1;
+static const int16_t TELEMETRY_NULL = INT16_MIN;
+static const uint8_t TELEMETRY_BODY_BYTES = 22;
+static const uint8_t TELEMETRY_FRAME_BYTES = TELEMETRY_BODY_BYTES + 4;
+
+class TelemetryEncoder {
+public:
+    static void capture(SensorManager& sensors, TelemetrySnapshot& out);
+
+    // Mismo JSON que SensorManager::getAllReadings(), en streaming
+    static size_t writeJson(const TelemetrySnapshot& s, Print& out);
+    static size_t writeBinary(const TelemetrySnapshot& s, Print& out);
+};
+
+#endif
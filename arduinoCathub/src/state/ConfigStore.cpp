@@ -0,0 +1,196 @@
+// ConfigStore.cpp
+#include "ConfigStore.h"
+#include <EEPROM.h>
+#include "../config/MotorConfigs.h"
+
+ConfigStore::ConfigStore() : sequence_(0), currentSlot_(-1), loaded_(false) {
+    applyDefaults(data_);
+}
+
+// Dirección de fábrica en el bus (-DCATHUB_NODE_ADDR=N); después se cambia
+// con SET:node_addr=N y queda en EEPROM
+#ifndef CATHUB_NODE_ADDR
+#define CATHUB_NODE_ADDR 0
+#endif
+
+// Pin DE/RE de fábrica del transceptor RS-485 (-DCATHUB_BUS_DE_PIN=N, o
+// SET:bus_de_pin=N); 0 = adaptador que conmuta solo o punto a punto
+#ifndef CATHUB_BUS_DE_PIN
+#define CATHUB_BUS_DE_PIN 0
+#endif
+
+void ConfigStore::applyDefaults(ConfigData& d) {
+    // Los huecos de alineación también van a la EEPROM y al memcmp de save()
+    memset(&d, 0, sizeof(d));
+    for (uint8_t i = 0; i < CATHUB_MAX_UNITS; ++i) {
+        UnitSettings& u = d.units[i];
+        u.hx711Factor        = 422.0f;   // factor calibrado del FeederWeightSensor
+        u.hx711Offset        = 0;
+        u.mq2Ro              = 0.0f;     // 0 = sin calibrar
+        u.catPresentCm       = 8.0f;
+        u.storageEmptyCm     = 13.0f;
+        u.plateFullCm        = 2.0f;
+        u.pumpRefillMs       = 30000UL;
+        u.pumpMaxMs          = 10000UL;
+        u.waterDryLevel      = 100;      // sin agua (bomba se ACTIVA)
+        u.waterWetLevel      = 250;      // medio lleno (bomba se ACTIVA aún)
+        u.waterFloodLevel    = 450;      // lleno al máximo (bomba se DETIENE)
+        u.weightStepG        = 5;        // weight_threshold del host
+        u.weightSettleMs     = 2000;
+        u.weightSessionGapMs = 10000;    // stability_timeout del host
+        u.dispenseStepsPerGramX100 = FeederMotorConfig::STEPS_PER_GRAM * 100;
+        u.waterFillRateX100  = 0;
+        u.flags              = 0;
+    }
+    d.automationPeriodMs = 500;
+    d.mq2Gas             = 0;        // MQ2_GAS_NH3
+    d.mq2AutoCal         = 2;        // MQ2_AUTOCAL_PERSIST
+    d.nodeAddress        = CATHUB_NODE_ADDR;
+    d.busDePin           = CATHUB_BUS_DE_PIN;
+}
+
+// CRC-16/CCITT (poly 0x1021)
+uint16_t ConfigStore::crc16(uint16_t crc, const uint8_t* buf, uint8_t len) {
+    for (uint8_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)buf[i] << 8;
+        for (uint8_t b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Valida encabezado y CRC leyendo directo de la EEPROM, sin copia en la pila
+bool ConfigStore::checkSlot(uint8_t slot, RecordHeader& header) const {
+    static_assert(sizeof(ConfigData) <= 255, "RecordHeader::dataSize es de 8 bits");
+    static_assert(sizeof(RecordHeader) + sizeof(ConfigData) + sizeof(uint16_t) <= SLOT_SIZE,
+                  "ConfigData no cabe en un slot de EEPROM");
+
+    int addr = slotAddress(slot);
+    EEPROM.get(addr, header);
+    if (header.magic != MAGIC || header.version != VERSION) return false;
+    if (header.dataSize == 0 || header.dataSize > sizeof(ConfigData)) return false;
+
+    uint16_t crc = crc16(0xFFFF, reinterpret_cast<const uint8_t*>(&header), sizeof(RecordHeader));
+    for (uint8_t i = 0; i < header.dataSize; ++i) {
+        uint8_t b = EEPROM.read(addr + (int)sizeof(RecordHeader) + i);
+        crc = crc16(crc, &b, 1);
+    }
+    uint16_t stored;
+    EEPROM.get(addr + (int)sizeof(RecordHeader) + header.dataSize, stored);
+    return crc == stored;
+}
+
+bool ConfigStore::readSlot(uint8_t slot, RecordHeader& header, ConfigData& out) const {
+    if (!checkSlot(slot, header)) return false;
+
+    // Un registro más corto (versión anterior) conserva los defaults de los campos nuevos
+    applyDefaults(out);
+    uint8_t* raw = reinterpret_cast<uint8_t*>(&out);
+    int addr = slotAddress(slot) + (int)sizeof(RecordHeader);
+    for (uint8_t i = 0; i < header.dataSize; ++i) {
+        raw[i] = EEPROM.read(addr + i);
+    }
+    return true;
+}
+
+// ¿El slot guarda exactamente `in`? Reemplaza a una segunda copia de ConfigData en SRAM
+bool ConfigStore::slotMatches(uint8_t slot, const ConfigData& in) const {
+    RecordHeader header;
+    int addr = slotAddress(slot);
+    EEPROM.get(addr, header);
+    if (header.dataSize != sizeof(ConfigData)) return false;
+
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(&in);
+    addr += (int)sizeof(RecordHeader);
+    for (uint8_t i = 0; i < sizeof(ConfigData); ++i) {
+        if (EEPROM.read(addr + i) != raw[i]) return false;
+    }
+    return true;
+}
+
+bool ConfigStore::writeSlot(uint8_t slot, uint32_t sequence, const ConfigData& in) {
+    RecordHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.dataSize = sizeof(ConfigData);
+    header.sequence = sequence;
+
+    uint16_t crc = crc16(0xFFFF, reinterpret_cast<const uint8_t*>(&header), sizeof(RecordHeader));
+    crc = crc16(crc, reinterpret_cast<const uint8_t*>(&in), sizeof(ConfigData));
+
+    // EEPROM.put usa update(): sólo reescribe los bytes que cambian
+    int addr = slotAddress(slot);
+    EEPROM.put(addr, header);
+    EEPROM.put(addr + (int)sizeof(RecordHeader), in);
+    EEPROM.put(addr + (int)sizeof(RecordHeader) + (int)sizeof(ConfigData), crc);
+
+    // Verificación de lectura
+    RecordHeader check;
+    return checkSlot(slot, check) && check.sequence == sequence && slotMatches(slot, in);
+}
+
+bool ConfigStore::initialize() {
+    return load();
+}
+
+bool ConfigStore::load() {
+    RecordHeader header;
+    bool found = false;
+
+    // Primero se elige el slot válido más nuevo y recién después se copia
+    for (uint8_t slot = 0; slot < SLOT_COUNT; ++slot) {
+        if (!checkSlot(slot, header)) continue;
+        // Diferencia con signo: sigue eligiendo el más nuevo si la secuencia da la vuelta
+        if (!found || (int32_t)(header.sequence - sequence_) > 0) {
+            sequence_ = header.sequence;
+            currentSlot_ = (int8_t)slot;
+            found = true;
+        }
+    }
+
+    if (!found || !readSlot((uint8_t)currentSlot_, header, data_)) {
+        applyDefaults(data_);
+        sequence_ = 0;
+        currentSlot_ = -1;
+        found = false;
+    }
+    loaded_ = true;
+    return found;
+}
+
+bool ConfigStore::save() {
+    if (currentSlot_ >= 0 && slotMatches((uint8_t)currentSlot_, data_)) {
+        return true; // sin cambios: no gastar ciclos de escritura
+    }
+
+    uint8_t slot = (currentSlot_ < 0) ? 0 : (uint8_t)((currentSlot_ + 1) % SLOT_COUNT);
+    uint32_t sequence = sequence_ + 1;
+    if (!writeSlot(slot, sequence, data_)) {
+        return false;
+    }
+    sequence_ = sequence;
+    currentSlot_ = (int8_t)slot;
+    return true;
+}
+
+void ConfigStore::resetToDefaults() {
+    applyDefaults(data_);
+}
+
+void ConfigStore::setCalibrationFactor(float factor, uint8_t unit) {
+    data_.units[unit].hx711Factor = factor;
+    data_.units[unit].flags |= CONFIG_FLAG_HX711_FACTOR;
+}
+
+void ConfigStore::setHx711Offset(long offset, uint8_t unit) {
+    data_.units[unit].hx711Offset = offset;
+    data_.units[unit].flags |= CONFIG_FLAG_HX711_TARE;
+}
+
+void ConfigStore::setMq2Ro(float ro, uint8_t unit) {
+    UnitSettings& u = data_.units[unit];
+    u.mq2Ro = ro;
+    if (ro > 0.0f) u.flags |= CONFIG_FLAG_MQ2_RO;
+    else u.flags &= (uint8_t)~CONFIG_FLAG_MQ2_RO;
+}
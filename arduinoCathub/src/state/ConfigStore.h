@@ -2,39 +2,135 @@
 #define CONFIG_STORE_H
 
 #include <Arduino.h>
+#include "../config/StationLayout.h"
+
+// Ajustes de una estación: calibración de sus sensores, umbrales, tiempos y
+// modelos aprendidos. Cada estación tiene los suyos aunque compartan placa.
+struct UnitSettings {
+    // Calibración HX711 (comedero)
+    float    hx711Factor;       // cuentas por gramo
+    int32_t  hx711Offset;       // tara en cuentas crudas
+    // Calibración MQ2 (arenero)
+    float    mq2Ro;             // kΩ en aire limpio
+    // Umbrales ultrasónicos (cm)
+    float    catPresentCm;      // arenero: gato presente si distancia <= valor
+    float    storageEmptyCm;    // comedero: depósito vacío si distancia >= valor
+    float    plateFullCm;       // comedero: plato lleno si distancia <= valor
+    // Tiempos de bomba (ms)
+    uint32_t pumpRefillMs;      // duración pedida por ciclo de rellenado
+    uint32_t pumpMaxMs;         // tope duro por encendido
+    // Sensor de nivel de agua (lectura analógica 0..1023)
+    uint16_t waterDryLevel;     // < valor: DRY
+    uint16_t waterWetLevel;     // < valor: LOW
+    uint16_t waterFloodLevel;   // < valor: WET, si no FLOOD
+    // Detector de eventos de peso (comedero)
+    uint16_t weightStepG;        // cambio mínimo que cuenta como escalón (g)
+    uint16_t weightSettleMs;     // tiempo estable para dar una meseta por buena
+    uint16_t weightSessionGapMs; // quietud que cierra una sesión de comida
+    // Dispensado por gramos: pasos del tornillo por gramo * 100 (aprendido)
+    uint16_t dispenseStepsPerGramX100;
+    // Rellenado de agua: caudal aprendido en cuentas ADC/s * 100 (0 = sin modelo)
+    uint16_t waterFillRateX100;
+    // Bits de validez (CONFIG_FLAG_*)
+    uint8_t  flags;
+};
+
+// Datos persistentes del controlador: un bloque por estación (se guardan los
+// CATHUB_MAX_UNITS aunque la placa atienda menos) y los ajustes de la placa.
+// Los campos de la placa nuevos se agregan SIEMPRE al final: un registro viejo
+// (más corto) se carga sobre los valores por defecto. Cambiar UnitSettings
+// mueve todo lo que sigue y obliga a subir ConfigStore::VERSION.
+struct ConfigData {
+    UnitSettings units[CATHUB_MAX_UNITS];
+    // Periodo del control automático (ms)
+    uint16_t automationPeriodMs;
+    // Curva del MQ2 para el canal de PPM (MQ2Gas, ver MQ2CurveTable.h)
+    uint16_t mq2Gas;
+    // Seguimiento de la línea base del MQ2 (MQ2AutoCalMode: 0 no, 1 en RAM, 2 y guardar Ro)
+    uint16_t mq2AutoCal;
+    // Dirección en el bus de controladores (BusLink): 0 = punto a punto
+    uint16_t nodeAddress;
+    // Pin DE/RE del transceptor RS-485 en el bus (0 = sin transceptor)
+    uint16_t busDePin;
+};
 
 class ConfigStore {
+public:
+    static const uint8_t CONFIG_FLAG_HX711_FACTOR = 0x01;
+    static const uint8_t CONFIG_FLAG_HX711_TARE   = 0x02;
+    static const uint8_t CONFIG_FLAG_MQ2_RO       = 0x04;
+
+    // Anillo de registros en EEPROM: cada save() escribe el slot siguiente
+    // con una secuencia mayor, repartiendo el desgaste entre SLOT_COUNT slots.
+    // Registro: RecordHeader + ConfigData + CRC-16/CCITT de ambos. El formato
+    // es público para las pruebas nativas (test/test_config_store).
+    // Los registros de otra VERSION se ignoran (la 1 no tenía bloques por
+    // estación y usaba slots de 128 bytes).
+    static const uint16_t MAGIC = 0xCA7B;
+    static const uint8_t  VERSION = 2;
+    static const int      BASE_ADDRESS = 0;
+    static const uint16_t SLOT_SIZE = 256;
+    static const uint8_t  SLOT_COUNT = 8;    // 2 KB de los 4 KB del Mega
+
+    struct RecordHeader {
+        uint16_t magic;
+        uint8_t  version;
+        uint8_t  dataSize;
+        uint32_t sequence;
+    };
+
+    static int slotAddress(uint8_t slot) { return BASE_ADDRESS + (int)slot * SLOT_SIZE; }
+
 private:
-    float calibrationFactor_;
-    static ConfigStore* instance_;
+    ConfigData data_;
+    uint32_t sequence_;
+    int8_t currentSlot_;      // -1 = no hay registro válido en EEPROM
+    bool loaded_;
+
+    static void applyDefaults(ConfigData& d);
+    static uint16_t crc16(uint16_t crc, const uint8_t* buf, uint8_t len);
+    bool checkSlot(uint8_t slot, RecordHeader& header) const;
+    bool readSlot(uint8_t slot, RecordHeader& header, ConfigData& out) const;
+    bool slotMatches(uint8_t slot, const ConfigData& in) const;
+    bool writeSlot(uint8_t slot, uint32_t sequence, const ConfigData& in);
 
 public:
-    ConfigStore() : calibrationFactor_(-7050.0) {}
-    
+    ConfigStore();
+
     static ConfigStore& getInstance() {
         static ConfigStore instance;
         return instance;
     }
-    
-    bool initialize() { 
-        return true; 
-    }
-    
-    float getCalibrationFactor() const { 
-        return calibrationFactor_; 
-    }
-    
-    void setCalibrationFactor(float factor) { 
-        calibrationFactor_ = factor; 
-    }
-    
-    void save() {
-        // Implementación básica - no hace nada por ahora
-    }
-    
-    void load() {
-        // Implementación básica - no hace nada por ahora
-    }
+
+    bool initialize();          // carga desde EEPROM (true si había registro válido)
+    bool load();
+    bool save();                // escribe sólo si cambió algo
+    void resetToDefaults();     // vuelve a valores por defecto (no guarda)
+
+    const ConfigData& get() const { return data_; }
+    void set(const ConfigData& d) { data_ = d; }
+    // Sin copia de ConfigData en la pila; los cambios se persisten con save()
+    ConfigData& edit() { return data_; }
+    uint32_t getSequence() const { return sequence_; }
+    int8_t getCurrentSlot() const { return currentSlot_; }
+
+    // Ajustes de la estación `unit` (0 = la primera)
+    const UnitSettings& getUnit(uint8_t unit = 0) const { return data_.units[unit]; }
+    bool hasFlag(uint8_t flag, uint8_t unit = 0) const { return (data_.units[unit].flags & flag) != 0; }
+
+    // HX711
+    float getCalibrationFactor(uint8_t unit = 0) const { return data_.units[unit].hx711Factor; }
+    void setCalibrationFactor(float factor, uint8_t unit = 0);
+    long getHx711Offset(uint8_t unit = 0) const { return data_.units[unit].hx711Offset; }
+    void setHx711Offset(long offset, uint8_t unit = 0);
+
+    // MQ2
+    float getMq2Ro(uint8_t unit = 0) const { return data_.units[unit].mq2Ro; }
+    void setMq2Ro(float ro, uint8_t unit = 0);
+
+    // Modelos aprendidos (no guardan: el llamador decide cuándo persistir)
+    void setStepsPerGramX100(uint16_t x100, uint8_t unit = 0) { data_.units[unit].dispenseStepsPerGramX100 = x100; }
+    void setWaterFillRateX100(uint16_t x100, uint8_t unit = 0) { data_.units[unit].waterFillRateX100 = x100; }
 };
 
-#endif
\ No newline at end of file
+#endif
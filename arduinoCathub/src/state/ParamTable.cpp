@@ -0,0 +1,155 @@
+// ParamTable.cpp
+#include "ParamTable.h"
+#include <stddef.h>
+#include "../protocol/BusLink.h"
+
+// Tabla en flash: nombre (clave del protocolo), tipo, alcance, campo y rango válido
+static const ParamDef PARAM_DEFS[] PROGMEM = {
+    { KEY_CAT_PRESENT_CM,   PARAM_FLOAT, PARAM_STATION, offsetof(UnitSettings, catPresentCm),       1.0f,   50.0f },
+    { KEY_STORAGE_EMPTY_CM, PARAM_FLOAT, PARAM_STATION, offsetof(UnitSettings, storageEmptyCm),     2.0f,   40.0f },
+    { KEY_PLATE_FULL_CM,    PARAM_FLOAT, PARAM_STATION, offsetof(UnitSettings, plateFullCm),        0.5f,   20.0f },
+    { KEY_WATER_DRY,        PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, waterDryLevel),      0.0f,   1023.0f },
+    { KEY_WATER_WET,        PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, waterWetLevel),      0.0f,   1023.0f },
+    { KEY_WATER_FLOOD,      PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, waterFloodLevel),    0.0f,   1023.0f },
+    { KEY_PUMP_REFILL_MS,   PARAM_U32,   PARAM_STATION, offsetof(UnitSettings, pumpRefillMs),       500.0f, 120000.0f },
+    { KEY_PUMP_MAX_MS,      PARAM_U32,   PARAM_STATION, offsetof(UnitSettings, pumpMaxMs),          500.0f, 60000.0f },
+    { KEY_AUTO_PERIOD_MS,   PARAM_U16,   PARAM_BOARD,   offsetof(ConfigData, automationPeriodMs),   100.0f, 5000.0f },
+    { KEY_MQ2_GAS,          PARAM_U16,   PARAM_BOARD,   offsetof(ConfigData, mq2Gas),               0.0f,   3.0f },  // MQ2_GAS_COUNT - 1
+    { KEY_WEIGHT_STEP_G,    PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, weightStepG),        1.0f,   100.0f },
+    { KEY_WEIGHT_SETTLE_MS, PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, weightSettleMs),     500.0f, 10000.0f },
+    { KEY_WEIGHT_GAP_MS,    PARAM_U16,   PARAM_STATION, offsetof(UnitSettings, weightSessionGapMs), 1000.0f, 60000.0f },
+    { KEY_MQ2_AUTOCAL,      PARAM_U16,   PARAM_BOARD,   offsetof(ConfigData, mq2AutoCal),           0.0f,   2.0f },  // MQ2AutoCalMode
+    { KEY_NODE_ADDR,        PARAM_U16,   PARAM_BOARD,   offsetof(ConfigData, nodeAddress),          0.0f,   BUS_MAX_ADDRESS },
+    { KEY_BUS_DE_PIN,       PARAM_U16,   PARAM_BOARD,   offsetof(ConfigData, busDePin),             0.0f,   69.0f },  // 0 = sin pin; ver set()
+};
+
+static const uint8_t PARAM_COUNT = sizeof(PARAM_DEFS) / sizeof(PARAM_DEFS[0]);
+static_assert(PARAM_COUNT <= 16, "dirtyMask_ tiene un bit por parámetro: ampliarlo antes de pasar de 16");
+static_assert(sizeof(ConfigData) <= 255, "ParamDef::offset es de 8 bits");
+
+ParamTable::ParamTable() {
+    memset(dirtyMask_, 0, sizeof(dirtyMask_));
+    pending_ = ConfigStore::getInstance().get();
+}
+
+void ParamTable::readDef(uint8_t index, ParamDef& def) {
+    memcpy_P(&def, &PARAM_DEFS[index], sizeof(ParamDef));
+}
+
+uint8_t ParamTable::fieldOffset(const ParamDef& def, uint8_t unit) {
+    if (def.scope == PARAM_BOARD) return def.offset;
+    return (uint8_t)(offsetof(ConfigData, units) + unit * sizeof(UnitSettings) + def.offset);
+}
+
+float ParamTable::readField(const ConfigData& data, const ParamDef& def, uint8_t unit) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&data) + fieldOffset(def, unit);
+    switch (def.type) {
+        case PARAM_U16: { uint16_t v; memcpy(&v, base, sizeof(v)); return (float)v; }
+        case PARAM_U32: { uint32_t v; memcpy(&v, base, sizeof(v)); return (float)v; }
+        default:        { float v;    memcpy(&v, base, sizeof(v)); return v; }
+    }
+}
+
+void ParamTable::writeField(ConfigData& data, const ParamDef& def, uint8_t unit, float value) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(&data) + fieldOffset(def, unit);
+    switch (def.type) {
+        case PARAM_U16: { uint16_t v = (uint16_t)(value + 0.5f); memcpy(base, &v, sizeof(v)); break; }
+        case PARAM_U32: { uint32_t v = (uint32_t)(value + 0.5f); memcpy(base, &v, sizeof(v)); break; }
+        default:        { memcpy(base, &value, sizeof(value)); break; }
+    }
+}
+
+uint8_t ParamTable::count() const {
+    return PARAM_COUNT;
+}
+
+int8_t ParamTable::find(const String& name) const {
+    for (uint8_t i = 0; i < PARAM_COUNT; ++i) {
+        if (protoEquals(name, nameOf(i))) return (int8_t)i;
+    }
+    return -1;
+}
+
+ProtoStr ParamTable::nameOf(uint8_t index) const {
+    ParamDef def;
+    readDef(index, def);
+    return def.name;
+}
+
+bool ParamTable::isInteger(uint8_t index) const {
+    ParamDef def;
+    readDef(index, def);
+    return def.type != PARAM_FLOAT;
+}
+
+bool ParamTable::isPerStation(uint8_t index) const {
+    ParamDef def;
+    readDef(index, def);
+    return def.scope == PARAM_STATION;
+}
+
+float ParamTable::minOf(uint8_t index) const {
+    ParamDef def;
+    readDef(index, def);
+    return def.minValue;
+}
+
+float ParamTable::maxOf(uint8_t index) const {
+    ParamDef def;
+    readDef(index, def);
+    return def.maxValue;
+}
+
+float ParamTable::get(uint8_t index, uint8_t unit) const {
+    if (index >= PARAM_COUNT || unit >= CATHUB_MAX_UNITS) return 0.0f;
+    ParamDef def;
+    readDef(index, def);
+    return readField(ConfigStore::getInstance().get(), def, unit);
+}
+
+ParamResult ParamTable::set(uint8_t index, float value, uint8_t unit) {
+    if (index >= PARAM_COUNT || unit >= CATHUB_MAX_UNITS) return PARAM_UNKNOWN;
+    ParamDef def;
+    readDef(index, def);
+    if (isnan(value) || value < def.minValue || value > def.maxValue) return PARAM_OUT_OF_RANGE;
+    if (def.scope == PARAM_BOARD && def.offset == offsetof(ConfigData, busDePin) && value >= 0.5f) {
+        // D0/D1 son la UART del bus; los pines de las estaciones ya tienen dueño
+        uint8_t pin = (uint8_t)(value + 0.5f);
+        if (pin <= 1 || stationUsesPin(pin)) return PARAM_PIN_IN_USE;
+    }
+    if (def.scope == PARAM_BOARD) unit = 0;
+
+    writeField(pending_, def, unit, value);
+    dirtyMask_[unit] |= (uint16_t)(1u << index);
+    return PARAM_OK;
+}
+
+bool ParamTable::hasPending() const {
+    for (uint8_t u = 0; u < CATHUB_MAX_UNITS; ++u) {
+        if (dirtyMask_[u] != 0) return true;
+    }
+    return false;
+}
+
+bool ParamTable::applyPending() {
+    if (!hasPending()) return false;
+
+    // Sólo se copian los campos marcados: las calibraciones (tara, Ro) que se
+    // guardaron mientras tanto no se pisan con la copia pendiente. Se escribe
+    // directo sobre la configuración vigente, sin otra ConfigData en la pila.
+    ConfigStore& store = ConfigStore::getInstance();
+    ConfigData& live = store.edit();
+    for (uint8_t u = 0; u < CATHUB_MAX_UNITS; ++u) {
+        for (uint8_t i = 0; i < PARAM_COUNT; ++i) {
+            if (!(dirtyMask_[u] & (1u << i))) continue;
+            ParamDef def;
+            readDef(i, def);
+            writeField(live, def, u, readField(pending_, def, u));
+        }
+        dirtyMask_[u] = 0;
+    }
+    store.save();
+
+    pending_ = live;
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef PARAM_TABLE_H
+#define PARAM_TABLE_H
+
+#include <Arduino.h>
+#include "ConfigStore.h"
+#include "../protocol/ProtocolStrings.h"
+
+// Parámetros ajustables en caliente (GET/SET/LIST por serie). Cada entrada
+// apunta a un campo de ConfigData o, si es de estación, al mismo campo de
+// UnitSettings en el bloque de cada estación; los SET quedan pendientes y se
+// aplican todos juntos en applyPending() al inicio del siguiente loop(), de
+// modo que ningún ciclo de control vea una mezcla de valores viejos y nuevos.
+enum ParamType : uint8_t {
+    PARAM_FLOAT,
+    PARAM_U16,
+    PARAM_U32
+};
+
+enum ParamResult : uint8_t {
+    PARAM_OK,
+    PARAM_UNKNOWN,
+    PARAM_OUT_OF_RANGE,
+    PARAM_PIN_IN_USE        // bus_de_pin: D0/D1 (el Serial del bus) o un pin de estación
+};
+
+enum ParamScope : uint8_t {
+    PARAM_BOARD,           // uno por placa
+    PARAM_STATION          // uno por estación
+};
+
+struct ParamDef {
+    ProtoStr  name;
+    ParamType type;
+    ParamScope scope;
+    uint8_t   offset;      // offsetof(ConfigData, campo) u offsetof(UnitSettings, campo)
+    float     minValue;
+    float     maxValue;
+};
+
+class ParamTable {
+private:
+    ConfigData pending_;
+    uint16_t dirtyMask_[CATHUB_MAX_UNITS];   // bit i = parámetro i modificado en esa estación
+                                             // (los de placa van en el de la primera)
+
+    ParamTable();
+    static void readDef(uint8_t index, ParamDef& def);
+    static uint8_t fieldOffset(const ParamDef& def, uint8_t unit);
+    static float readField(const ConfigData& data, const ParamDef& def, uint8_t unit);
+    static void writeField(ConfigData& data, const ParamDef& def, uint8_t unit, float value);
+
+public:
+    static ParamTable& getInstance() {
+        static ParamTable instance;
+        return instance;
+    }
+
+    uint8_t count() const;
+    int8_t find(const String& name) const;         // -1 si no existe
+    ProtoStr nameOf(uint8_t index) const;
+    bool isInteger(uint8_t index) const;
+    bool isPerStation(uint8_t index) const;
+    float minOf(uint8_t index) const;
+    float maxOf(uint8_t index) const;
+
+    // `unit` = estación (0 = la primera); los de placa la ignoran
+    float get(uint8_t index, uint8_t unit = 0) const;                // valor vigente
+    ParamResult set(uint8_t index, float value, uint8_t unit = 0);   // queda pendiente
+    bool hasPending() const;
+    bool applyPending();                           // aplica y persiste (true si hubo cambios)
+};
+
+#endif
@@ -0,0 +1,33 @@
+// LoopProfiler.cpp
+#include "LoopProfiler.h"
+
+#if defined(CATHUB_PROFILING)
+
+LoopProfiler::Slot LoopProfiler::slots[PROF_SLOT_COUNT] = {};
+
+void LoopProfiler::end(uint8_t slot) {
+    Slot& s = slots[slot];
+    uint32_t elapsed = micros() - s.startUs;
+
+    // Balde = posición del bit más alto por encima de HIST_BASE_US
+    uint8_t bucket = 0;
+    for (uint32_t limit = HIST_BASE_US; elapsed >= limit && bucket < HIST_BUCKETS - 1; limit <<= 1) {
+        bucket++;
+    }
+
+    if (s.hist[bucket] < 0xFFFF) s.hist[bucket]++;
+    if (s.count < 0xFFFFFFFFUL) s.count++;
+    s.sumUs += elapsed;
+    if (elapsed > s.maxUs) s.maxUs = elapsed;
+}
+
+uint32_t LoopProfiler::getMeanUs(uint8_t slot) {
+    const Slot& s = slots[slot];
+    return s.count ? (uint32_t)(s.sumUs / s.count) : 0;
+}
+
+void LoopProfiler::reset() {
+    for (uint8_t i = 0; i < PROF_SLOT_COUNT; ++i) slots[i] = Slot();
+}
+
+#endif // CATHUB_PROFILING
@@ -0,0 +1,66 @@
+// LoopProfiler.h
+#ifndef LOOP_PROFILER_H
+#define LOOP_PROFILER_H
+
+#include <Arduino.h>
+#include "../Devices/SensorManager.h"
+
+// Puntos medidos: el loop completo, cada tarea del loop y cada canal de
+// sensor que agenda SensorManager (PROF_SENSOR_BASE + SensorChannel).
+enum ProfileSlot : uint8_t {
+    PROF_LOOP,
+    PROF_COMMANDS,
+    PROF_SENSORS,
+    PROF_AUTOMATION,
+    PROF_FEEDER_MOTOR,
+    PROF_WATER_PUMP,
+    PROF_SENSOR_BASE,
+    PROF_SLOT_COUNT = PROF_SENSOR_BASE + SENSOR_CH_COUNT
+};
+
+// Perfilador del loop con micros(). Por punto guarda cantidad, suma, máximo
+// e histograma log2 de duraciones: el balde 0 cuenta lo menor a
+// HIST_BASE_US, el balde b lo que cae en [HIST_BASE_US << (b-1),
+// HIST_BASE_US << b) y el último además todo lo que lo supera.
+// Sólo existe con -DCATHUB_PROFILING (env megaatmega2560_prof); sin la
+// bandera las macros no generan código ni ocupan SRAM.
+#if defined(CATHUB_PROFILING)
+
+class LoopProfiler {
+public:
+    static const uint8_t HIST_BUCKETS = 14;          // hasta >= 65 ms
+    static const uint16_t HIST_BASE_US = 16;
+
+private:
+    struct Slot {
+        unsigned long startUs;
+        uint32_t count;
+        uint64_t sumUs;
+        uint32_t maxUs;
+        uint16_t hist[HIST_BUCKETS];
+    };
+
+    static Slot slots[PROF_SLOT_COUNT];
+
+public:
+    static void begin(uint8_t slot) { slots[slot].startUs = micros(); }
+    static void end(uint8_t slot);
+    static void reset();
+
+    static uint32_t getCount(uint8_t slot) { return slots[slot].count; }
+    static uint32_t getMaxUs(uint8_t slot) { return slots[slot].maxUs; }
+    static uint32_t getMeanUs(uint8_t slot);
+    static uint16_t getBucket(uint8_t slot, uint8_t bucket) { return slots[slot].hist[bucket]; }
+};
+
+#define PROFILE_BEGIN(slot) LoopProfiler::begin(slot)
+#define PROFILE_END(slot)   LoopProfiler::end(slot)
+
+#else
+
+#define PROFILE_BEGIN(slot) ((void)0)
+#define PROFILE_END(slot)   ((void)0)
+
+#endif // CATHUB_PROFILING
+
+#endif
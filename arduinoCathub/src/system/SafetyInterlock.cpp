@@ -0,0 +1,266 @@
+// SafetyInterlock.cpp
+#include "SafetyInterlock.h"
+#include "../Devices/common/UltrasonicRanging.h"
+#include "TraceBuffer.h"
+
+SafetyInterlock::Channel SafetyInterlock::channels[SafetyInterlock::CHANNEL_COUNT] = {};
+volatile uint8_t SafetyInterlock::armedMask = 0;
+volatile uint8_t SafetyInterlock::latchedMask = 0;
+volatile uint8_t SafetyInterlock::pendingMask = 0;
+volatile uint16_t SafetyInterlock::lastLatencyUs[SafetyInterlock::CHANNEL_COUNT] = {};
+volatile uint16_t SafetyInterlock::maxLatencyUs = 0;
+unsigned long SafetyInterlock::tripMillis[SafetyInterlock::CHANNEL_COUNT] = {};
+
+SafetyInterlock::Ranger SafetyInterlock::rangers[CATHUB_UNITS] = {};
+volatile uint8_t SafetyInterlock::pingCountdown = 0;
+volatile uint8_t SafetyInterlock::irConfirm[CATHUB_UNITS] = {};
+bool SafetyInterlock::started = false;
+
+// ===== REGISTRO DE PINES =====
+// En el AVR se precalculan puerto y máscara: el ISR escribe el registro en
+// un par de ciclos en lugar de pasar por digitalWrite().
+void SafetyInterlock::attachOutput(uint8_t channel, uint8_t pin, bool offHigh) {
+    Channel& c = channels[indexOf(channel)];
+    c.outPin = pin;
+    c.outOffHigh = offHigh;
+#if defined(__AVR__)
+    c.outPort = portOutputRegister(digitalPinToPort(pin));
+    c.outMask = digitalPinToBitMask(pin);
+#endif
+    c.hasOutput = true;
+}
+
+void SafetyInterlock::attachInput(uint8_t channel, uint8_t pin, bool activeLow) {
+    Channel& c = channels[indexOf(channel)];
+    c.inPin = pin;
+    c.inActiveLow = activeLow;
+#if defined(__AVR__)
+    c.inPort = portInputRegister(digitalPinToPort(pin));
+    c.inMask = digitalPinToBitMask(pin);
+#endif
+    c.hasInput = true;
+}
+
+void SafetyInterlock::attachRanger(uint8_t channel, uint8_t trig, uint8_t echo) {
+#if defined(__AVR__)
+    // Sólo hay vector para el grupo PCINT0 (D10-D13, D50-D53 en el Mega)
+    if (digitalPinToPCICR(echo) == nullptr || digitalPinToPCICRbit(echo) != 0) return;
+    Ranger& r = rangers[indexOf(channel) / 2];
+    r.trigPort = portOutputRegister(digitalPinToPort(trig));
+    r.trigMask = digitalPinToBitMask(trig);
+    r.echoPort = portInputRegister(digitalPinToPort(echo));
+    r.echoMask = digitalPinToBitMask(echo);
+    r.echoPin = echo;
+    r.echoHigh = (*r.echoPort & r.echoMask) != 0;
+    r.attached = true;
+#else
+    (void)channel;
+    (void)trig;
+    (void)echo;   // HAL nativo: sin PCINT, el arenero queda sin ranger de seguridad
+#endif
+}
+
+void SafetyInterlock::begin() {
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) setLitterboxBlockCm(8.0f, u);
+#if defined(__AVR__)
+    noInterrupts();
+    // Timer0 ya corre a 976 Hz para millis(): COMPA a mitad de cuenta da un
+    // tick propio sin reconfigurarlo (OC0A es el pin 13, DIR del comedero, sin PWM)
+    OCR0A = 0x80;
+    TIMSK0 |= _BV(OCIE0A);
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        if (!rangers[u].attached) continue;
+        uint8_t pin = rangers[u].echoPin;
+        *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+        PCICR |= _BV(digitalPinToPCICRbit(pin));
+    }
+    interrupts();
+#endif
+    started = true;
+}
+
+// ===== ARMADO =====
+bool SafetyInterlock::arm(uint8_t channel) {
+    noInterrupts();
+    bool latched = (latchedMask & channel) != 0;
+    if (!latched) armedMask |= channel;
+    if (channel & WATER_CHANNELS) irConfirm[indexOf(channel) / 2] = 0;
+    else pingCountdown = 0;
+    interrupts();
+    return !latched;
+}
+
+void SafetyInterlock::disarm(uint8_t channel) {
+    noInterrupts();
+    armedMask &= (uint8_t)~channel;
+    interrupts();
+}
+
+void SafetyInterlock::setLitterboxBlockCm(float cm, uint8_t unit) {
+    if (unit >= CATHUB_UNITS) return;
+    q16_t scale = UltrasonicRanging::getScaleQ16();
+    if (scale <= 0) scale = q16FromFloat(343.4f / 20000.0f);   // 20 °C
+    int32_t us = q16ToInt(q16Div(q16FromFloat(cm), scale));
+    if (us < 0) us = 0;
+    if (us > 65535) us = 65535;
+    noInterrupts();
+    rangers[unit].blockEchoUs = (uint16_t)us;
+    interrupts();
+}
+
+// ===== CONTEXTO DE INTERRUPCIÓN =====
+bool SafetyInterlock::inputAsserted(const Channel& c) {
+#if defined(__AVR__)
+    bool high = (*c.inPort & c.inMask) != 0;
+#else
+    bool high = digitalRead(c.inPin) == HIGH;
+#endif
+    return c.inActiveLow ? !high : high;
+}
+
+void SafetyInterlock::trip(uint8_t channel, unsigned long detectUs) {
+    uint8_t i = indexOf(channel);
+    const Channel& c = channels[i];
+#if defined(__AVR__)
+    if (c.outOffHigh) *c.outPort |= c.outMask;
+    else *c.outPort &= (uint8_t)~c.outMask;
+#else
+    digitalWrite(c.outPin, c.outOffHigh ? HIGH : LOW);
+#endif
+    unsigned long latency = micros() - detectUs;
+
+    armedMask &= (uint8_t)~channel;
+    latchedMask |= channel;
+    pendingMask |= channel;
+    lastLatencyUs[i] = (latency > 65535UL) ? 65535U : (uint16_t)latency;
+    if (lastLatencyUs[i] > maxLatencyUs) maxLatencyUs = lastLatencyUs[i];
+    tripMillis[i] = millis();
+    TRACE_EVENT(TRC_SAFETY_TRIP, channel);
+}
+
+void SafetyInterlock::onTick() {
+    unsigned long nowUs = micros();
+
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        uint8_t channel = safetyChannelFor(SAFETY_WATER, u);
+        const Channel& water = channels[2 * u];
+        if ((armedMask & channel) && water.hasInput && water.hasOutput && inputAsserted(water)) {
+            if (++irConfirm[u] >= IR_CONFIRM_TICKS) {
+                irConfirm[u] = 0;
+                trip(channel, nowUs);
+            }
+        } else {
+            irConfirm[u] = 0;
+        }
+    }
+
+#if defined(__AVR__)
+    // Ping propio mientras el motor se mueve; el eco lo mide onEchoChange().
+    // Los areneros armados disparan juntos: un solo pulso de 10 µs por tick
+    bool anyArmed = false;
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        if (rangers[u].attached && (armedMask & safetyChannelFor(SAFETY_LITTERBOX, u))) anyArmed = true;
+    }
+    if (anyArmed) {
+        if (pingCountdown == 0) {
+            pingCountdown = PING_TICKS;
+            for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+                const Ranger& r = rangers[u];
+                if (r.attached && (armedMask & safetyChannelFor(SAFETY_LITTERBOX, u))) *r.trigPort |= r.trigMask;
+            }
+            delayMicroseconds(10);
+            for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+                if (rangers[u].attached) *rangers[u].trigPort &= (uint8_t)~rangers[u].trigMask;
+            }
+        } else {
+            pingCountdown--;
+        }
+    }
+#endif
+}
+
+void SafetyInterlock::onEchoChange() {
+    unsigned long nowUs = micros();
+    for (uint8_t u = 0; u < CATHUB_UNITS; ++u) {
+        Ranger& r = rangers[u];
+        if (!r.attached) continue;
+        bool high = (*r.echoPort & r.echoMask) != 0;
+        if (high == r.echoHigh) continue;   // cambió otro pin del grupo
+        r.echoHigh = high;
+        if (high) {
+            r.echoStartUs = nowUs;
+            continue;
+        }
+        if (r.echoStartUs == 0) continue;
+        unsigned long width = nowUs - r.echoStartUs;
+        r.echoStartUs = 0;
+
+        uint8_t channel = safetyChannelFor(SAFETY_LITTERBOX, u);
+        const Channel& litter = channels[2 * u + 1];
+        if ((armedMask & channel) && litter.hasOutput &&
+            width >= MIN_ECHO_US && width < r.blockEchoUs) {
+            trip(channel, nowUs);
+        }
+    }
+}
+
+#if defined(__AVR__)
+ISR(TIMER0_COMPA_vect) {
+    SafetyInterlock::onTick();
+}
+
+ISR(PCINT0_vect) {
+    SafetyInterlock::onEchoChange();
+}
+#endif
+
+// ===== CONTEXTO DEL LOOP =====
+void SafetyInterlock::service() {
+#if !defined(__AVR__)
+    if (started) onTick();   // sin interrupciones: se muestrea en cada loop
+#endif
+}
+
+bool SafetyInterlock::pollTrip(SafetyTrip& out, uint8_t mask) {
+    noInterrupts();
+    uint8_t pending = pendingMask & mask;
+    if (pending == 0) {
+        interrupts();
+        return false;
+    }
+    uint8_t channel = pending & (uint8_t)(-pending);   // el de bit más bajo
+    pendingMask &= (uint8_t)~channel;
+    uint16_t latency = lastLatencyUs[indexOf(channel)];
+    uint16_t maxLatency = maxLatencyUs;
+    uint16_t blockUs = rangers[indexOf(channel) / 2].blockEchoUs;
+    interrupts();
+
+    // Cota del peor caso: lo que tarda en verse el peligro + la latencia
+    // máxima medida del ISR hasta la salida apagada
+    uint32_t window = (channel & WATER_CHANNELS)
+        ? (uint32_t)IR_CONFIRM_TICKS * TICK_US
+        : (uint32_t)PING_TICKS * TICK_US + blockUs;
+    out.channel = channel;
+    out.latencyUs = latency;
+    out.worstCaseUs = window + maxLatency;
+    return true;
+}
+
+bool SafetyInterlock::release(uint8_t channel) {
+    if (!isLatched(channel)) return true;
+    noInterrupts();
+    unsigned long trippedAt = tripMillis[indexOf(channel)];
+    interrupts();
+    if (millis() - trippedAt < RELEASE_MIN_MS) return false;
+    noInterrupts();
+    latchedMask &= (uint8_t)~channel;
+    interrupts();
+    return true;
+}
+
+uint16_t SafetyInterlock::getMaxLatencyUs() {
+    noInterrupts();
+    uint16_t v = maxLatencyUs;
+    interrupts();
+    return v;
+}
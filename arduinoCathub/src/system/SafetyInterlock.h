@@ -0,0 +1,128 @@
+// SafetyInterlock.h
+#ifndef SAFETY_INTERLOCK_H
+#define SAFETY_INTERLOCK_H
+
+#include <Arduino.h>
+#include "../config/StationLayout.h"
+
+// Enclavamiento de seguridad a nivel de interrupción. Cada canal une una
+// entrada de seguridad con la salida del actuador que protege:
+//   - WATER: IR del bebedero -> bomba. El pin 9 del Mega no tiene PCINT, así
+//     que se muestrea en la interrupción COMPA del Timer0 (~1 kHz, sin tocar
+//     millis()) y se confirma con IR_CONFIRM_TICKS lecturas seguidas.
+//   - LITTERBOX: ultrasónico del arenero -> EN del motor. Mientras el motor
+//     se mueve, el tick dispara el ping y la PCINT del eco (pin 11) mide el
+//     ancho: un eco más corto que la distancia de bloqueo corta el motor.
+// Sólo dispara si el canal está armado (actuador en marcha). El ISR apaga la
+// salida escribiendo el puerto, enclava la falla y mide la latencia; el loop
+// la reporta después (pollTrip) y la libera cuando la estación queda libre.
+// Los dispositivos registran sus propios pines al inicializarse.
+// Con varias estaciones (CATHUB_UNITS) cada una tiene su par de canales; los
+// rangers de los areneros comparten el vector PCINT0 y el mismo tick de ping.
+enum SafetyChannel : uint8_t {
+    SAFETY_WATER       = 0x01,
+    SAFETY_LITTERBOX   = 0x02,
+    SAFETY_WATER_2     = 0x04,
+    SAFETY_LITTERBOX_2 = 0x08,
+    SAFETY_WATER_3     = 0x10,
+    SAFETY_LITTERBOX_3 = 0x20
+};
+
+// Canal de la estación `unit` (0 = la primera) a partir del de la primera
+inline uint8_t safetyChannelFor(uint8_t channel, uint8_t unit) {
+    return (uint8_t)(channel << (2 * unit));
+}
+
+struct SafetyTrip {
+    uint8_t  channel;       // SafetyChannel
+    uint16_t latencyUs;     // medido: detección -> salida apagada
+    uint32_t worstCaseUs;   // cota: ventana de detección + latencia máxima medida
+};
+
+class SafetyInterlock {
+private:
+    static const uint8_t  CHANNEL_COUNT = 2 * CATHUB_UNITS;
+    static const uint8_t  WATER_CHANNELS = SAFETY_WATER | SAFETY_WATER_2 | SAFETY_WATER_3;
+    static const uint16_t TICK_US = 1024;             // Timer0 a 16 MHz / 64 / 256
+    static const uint8_t  IR_CONFIRM_TICKS = 2;       // ~2 ms de IR estable
+    static const uint8_t  PING_TICKS = 60;            // un ping cada ~61 ms
+    static const uint16_t MIN_ECHO_US = 60;           // ~1 cm: más corto es ruido
+    static const unsigned long RELEASE_MIN_MS = 2000; // enclavado al menos esto
+
+    struct Channel {
+        volatile uint8_t* outPort;
+        volatile uint8_t* inPort;
+        uint8_t outMask;
+        uint8_t inMask;
+        uint8_t outPin;
+        uint8_t inPin;
+        bool outOffHigh;       // nivel que apaga el actuador
+        bool inActiveLow;      // nivel que indica peligro
+        bool hasOutput;
+        bool hasInput;
+    };
+
+    static Channel channels[CHANNEL_COUNT];
+    static volatile uint8_t armedMask;
+    static volatile uint8_t latchedMask;
+    static volatile uint8_t pendingMask;
+    static volatile uint16_t lastLatencyUs[CHANNEL_COUNT];
+    static volatile uint16_t maxLatencyUs;
+    static unsigned long tripMillis[CHANNEL_COUNT];
+
+    // Ranger de cada arenero (ping desde el tick, eco por PCINT)
+    struct Ranger {
+        volatile uint8_t* trigPort;
+        volatile uint8_t* echoPort;
+        uint8_t trigMask;
+        uint8_t echoMask;
+        uint8_t echoPin;
+        bool attached;
+        volatile bool echoHigh;              // último nivel visto: el grupo PCINT0 es compartido
+        volatile unsigned long echoStartUs;
+        volatile uint16_t blockEchoUs;       // cat_present_cm de su estación, en µs de eco
+    };
+
+    static Ranger rangers[CATHUB_UNITS];
+    static volatile uint8_t pingCountdown;
+    static volatile uint8_t irConfirm[CATHUB_UNITS];
+    static bool started;
+
+    // Posición del bit del canal: 2 * estación (+1 si es el arenero)
+    static uint8_t indexOf(uint8_t channel) {
+        uint8_t i = 0;
+        while (channel > 1) { channel >>= 1; ++i; }
+        return i;
+    }
+    static bool inputAsserted(const Channel& c);
+    static void trip(uint8_t channel, unsigned long detectUs);
+
+public:
+    // Registro de pines (desde initialize() de cada dispositivo)
+    static void attachOutput(uint8_t channel, uint8_t pin, bool offHigh);
+    static void attachInput(uint8_t channel, uint8_t pin, bool activeLow);
+    static void attachRanger(uint8_t channel, uint8_t trigPin, uint8_t echoPin);
+
+    static void begin();     // habilita el tick y la PCINT (tras inicializar dispositivos)
+
+    // Actuador en marcha / detenido (arm() falla si el canal está enclavado)
+    static bool arm(uint8_t channel);
+    static void disarm(uint8_t channel);
+    static bool isArmed(uint8_t channel) { return (armedMask & channel) != 0; }
+    static bool isLatched(uint8_t channel) { return (latchedMask & channel) != 0; }
+    static bool ownsRanger(uint8_t channel) { return rangers[indexOf(channel) / 2].attached && isArmed(channel); }
+
+    static void setLitterboxBlockCm(float cm, uint8_t unit = 0);
+
+    // Desde loop(): sin AVR muestrea las entradas aquí (HAL nativo)
+    static void service();
+    static bool pollTrip(SafetyTrip& out, uint8_t mask = 0xFF);   // sólo los canales de `mask`
+    static bool release(uint8_t channel);   // false si aún no pasó RELEASE_MIN_MS
+    static uint16_t getMaxLatencyUs();
+
+    // Sólo para los vectores de interrupción
+    static void onTick();
+    static void onEchoChange();
+};
+
+#endif
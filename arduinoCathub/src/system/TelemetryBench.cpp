@@ -0,0 +1,127 @@
+// TelemetryBench.cpp
+#include "TelemetryBench.h"
+
+#if defined(CATHUB_BENCH)
+
+#if !defined(__AVR__)
+#include <chrono>
+#include <new>
+#include <stdlib.h>
+#endif
+
+volatile uint16_t TelemetryBench::allocCount = 0;
+volatile uint32_t TelemetryBench::allocBytes = 0;
+
+// ===== CONTEO DE RESERVAS =====
+#if defined(__AVR__)
+// realloc de avr-libc llama a malloc cuando tiene que mover el bloque: esa
+// reserva interna no se cuenta dos veces
+static volatile bool insideRealloc = false;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    if (!insideRealloc) {
+        TelemetryBench::allocCount++;
+        TelemetryBench::allocBytes += size;
+    }
+    return __real_malloc(size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    TelemetryBench::allocCount++;
+    TelemetryBench::allocBytes += size;
+    insideRealloc = true;
+    void* p = __real_realloc(ptr, size);
+    insideRealloc = false;
+    return p;
+}
+}
+#else
+void* operator new(size_t size) {
+    TelemetryBench::allocCount++;
+    TelemetryBench::allocBytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#endif
+
+// ===== RELOJ =====
+static uint32_t benchNow() {
+#if defined(__AVR__)
+    return micros();
+#else
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+const __FlashStringHelper* TelemetryBench::timeUnit() {
+#if defined(__AVR__)
+    return F("us");
+#else
+    return F("ns");
+#endif
+}
+
+// ===== PILA =====
+// Las dos funciones se llaman desde el mismo marco que el codificador, así
+// su arreglo ocupa justo la pila que él va a usar. measureStack() lee a
+// propósito un arreglo sin inicializar: lo que dejó la llamada anterior.
+static const uint8_t STACK_PAINT = 0xA5;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+
+__attribute__((noinline)) static void paintStack() {
+    volatile uint8_t area[TelemetryBench::STACK_PROBE_BYTES];
+    for (uint16_t i = 0; i < TelemetryBench::STACK_PROBE_BYTES; ++i) area[i] = STACK_PAINT;
+}
+
+__attribute__((noinline)) static uint16_t measureStack() {
+    volatile uint8_t area[TelemetryBench::STACK_PROBE_BYTES];
+    // area[0] es la dirección más baja: la más profunda
+    uint16_t untouched = 0;
+    while (untouched < TelemetryBench::STACK_PROBE_BYTES && area[untouched] == STACK_PAINT) untouched++;
+    return TelemetryBench::STACK_PROBE_BYTES - untouched;
+}
+
+#pragma GCC diagnostic pop
+
+// ===== MEDICIÓN =====
+void TelemetryBench::run(Encoder encoder, void* context, BenchResult& out) {
+    out = BenchResult();
+
+    // Primera llamada: pila y bytes (fuera del promedio de tiempo)
+    CountingPrint sink;
+    paintStack();
+    encoder(context, sink);
+    out.stackBytes = measureStack();
+    out.bytes = sink.bytes;
+
+    uint32_t total = 0;
+    uint16_t allocsBefore = allocCount;
+    uint32_t bytesBefore = allocBytes;
+    for (uint8_t i = 0; i < ITERATIONS; ++i) {
+        CountingPrint discard;
+        uint32_t start = benchNow();
+        encoder(context, discard);
+        uint32_t elapsed = benchNow() - start;
+        total += elapsed;
+        if (elapsed > out.maxTime) out.maxTime = elapsed;
+    }
+    out.meanTime = total / ITERATIONS;
+    // Totales: dividir por ITERATIONS escondería una reserva cada pocas llamadas
+    out.allocs = (uint16_t)(allocCount - allocsBefore);
+    out.allocBytes = allocBytes - bytesBefore;
+}
+
+#endif // CATHUB_BENCH
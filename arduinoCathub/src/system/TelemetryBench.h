@@ -0,0 +1,58 @@
+// TelemetryBench.h
+#ifndef TELEMETRY_BENCH_H
+#define TELEMETRY_BENCH_H
+
+#include <Arduino.h>
+
+// Banco de los formatos de telemetría (comando BENCH). Por formato mide bytes
+// emitidos, tiempo por llamada, reservas de heap (totales de las ITERATIONS
+// llamadas; la respuesta incluye iterations) y pico de pila.
+//   - Tiempo: en la placa micros() (resolución de 4 µs, por eso se promedian
+//     ITERATIONS llamadas); en el build nativo un reloj de la PC en ns, que
+//     sólo sirve para comparar formatos entre sí.
+//   - Heap: en el AVR se envuelven malloc/realloc con -Wl,--wrap (lo pone el
+//     env megaatmega2560_bench); en la PC se reemplaza operator new.
+//   - Pila: antes de la primera llamada se pinta una zona debajo del marco
+//     actual y al volver se busca el byte más profundo que cambió.
+// Sólo existe con -DCATHUB_BENCH; sin la bandera BENCH responde enabled:false.
+#if defined(CATHUB_BENCH)
+
+struct BenchResult {
+    uint32_t bytes;          // por llamada
+    uint32_t meanTime;       // en timeUnit()
+    uint32_t maxTime;
+    uint16_t allocs;         // total en las ITERATIONS llamadas
+    uint32_t allocBytes;     // pedidos en total en las ITERATIONS llamadas
+    uint16_t stackBytes;     // pico estimado
+};
+
+// Destino que sólo cuenta: mide el formato, no la UART
+class CountingPrint : public Print {
+public:
+    CountingPrint() : bytes(0) {}
+    size_t write(uint8_t) override { bytes++; return 1; }
+    uint32_t bytes;
+};
+
+class TelemetryBench {
+public:
+    static const uint8_t ITERATIONS = 16;
+#if defined(__AVR__)
+    static const uint16_t STACK_PROBE_BYTES = 512;
+#else
+    static const uint16_t STACK_PROBE_BYTES = 16384;
+#endif
+
+    typedef void (*Encoder)(void* context, Print& out);
+
+    static void run(Encoder encoder, void* context, BenchResult& out);
+    static const __FlashStringHelper* timeUnit();
+
+    // Los actualizan los envoltorios de malloc / operator new
+    static volatile uint16_t allocCount;
+    static volatile uint32_t allocBytes;
+};
+
+#endif // CATHUB_BENCH
+
+#endif
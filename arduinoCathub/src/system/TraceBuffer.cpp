@@ -0,0 +1,80 @@
+// TraceBuffer.cpp
+#include "TraceBuffer.h"
+
+#if defined(CATHUB_TRACE)
+
+static_assert((CATHUB_TRACE_RECORDS & (CATHUB_TRACE_RECORDS - 1)) == 0 && CATHUB_TRACE_RECORDS <= 1024,
+              "CATHUB_TRACE_RECORDS debe ser potencia de 2 (máximo 1024)");
+static_assert(sizeof(TraceRecord) == 8, "TraceRecord debe ocupar 8 bytes");
+
+TraceRecord TraceBuffer::ring[TraceBuffer::CAPACITY];
+volatile uint32_t TraceBuffer::total = 0;
+volatile uint16_t TraceBuffer::discarded = 0;
+volatile bool TraceBuffer::frozen = false;
+
+// ===== CONTEXTO DEL LOOP O DE INTERRUPCIÓN =====
+void TraceBuffer::record(uint8_t event, uint16_t arg) {
+    uint32_t tick = micros();
+
+    // Reserva: el único tramo compartido. En un ISR las interrupciones ya
+    // están cortadas; en el loop se cortan y se devuelve SREG tal cual
+    // (nunca interrupts(), que dentro de un ISR habilitaría anidamiento)
+#if defined(__AVR__)
+    uint8_t sreg = SREG;
+    cli();
+#endif
+    bool skip = frozen;
+    uint32_t n = total;
+    if (skip) {
+        if (discarded < 0xFFFF) discarded++;
+    } else {
+        total = n + 1;
+    }
+#if defined(__AVR__)
+    SREG = sreg;
+#endif
+    if (skip) return;
+
+    TraceRecord& r = ring[n & (CAPACITY - 1)];
+    r.tick = tick;
+    r.event = event;
+    r.seq = (uint8_t)n;
+    r.arg = arg;
+}
+
+// ===== CONTEXTO DEL LOOP =====
+void TraceBuffer::reset() {
+    noInterrupts();
+    total = 0;
+    discarded = 0;
+    interrupts();
+}
+
+uint32_t TraceBuffer::getTotal() {
+    noInterrupts();
+    uint32_t n = total;
+    interrupts();
+    return n;
+}
+
+uint16_t TraceBuffer::getCount() {
+    uint32_t n = getTotal();
+    return (n < CAPACITY) ? (uint16_t)n : CAPACITY;
+}
+
+uint16_t TraceBuffer::getDiscarded() {
+    noInterrupts();
+    uint16_t n = discarded;
+    interrupts();
+    return n;
+}
+
+void TraceBuffer::writeRecords(Print& out) {
+    uint32_t n = getTotal();
+    uint16_t count = getCount();
+    for (uint32_t i = n - count; i != n; ++i) {
+        out.write((const uint8_t*)&ring[i & (CAPACITY - 1)], sizeof(TraceRecord));
+    }
+}
+
+#endif // CATHUB_TRACE
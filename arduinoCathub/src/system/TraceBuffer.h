@@ -0,0 +1,108 @@
+// TraceBuffer.h
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <Arduino.h>
+
+// Eventos de la traza. X(id, fase, pista, arg):
+//   fase  B/E = comienzo/fin de un tramo, I = instantáneo, C = contador
+//   pista línea de tiempo en la que se dibuja
+//   arg   cómo leer el argumento: task (WatchdogTask), sensor (SensorChannel),
+//         reason (TraceReason), channel (SafetyChannel), cmd (primer y
+//         último carácter del comando) o value (número tal cual)
+// El id es la posición en la lista: sólo se agregan al final.
+// scripts/trace-to-perfetto.py (raspberryCathub) lee esta lista del fuente.
+#define TRACE_EVENT_LIST(X) \
+    X(TRC_TASK_BEGIN,      'B', "loop",     "task") \
+    X(TRC_TASK_END,        'E', "loop",     "task") \
+    X(TRC_SENSOR_BEGIN,    'B', "sensors",  "sensor") \
+    X(TRC_SENSOR_END,      'E', "sensors",  "sensor") \
+    X(TRC_COMMAND,         'I', "commands", "cmd") \
+    X(TRC_PUMP_ON,         'B', "pump",     "value") \
+    X(TRC_PUMP_OFF,        'E', "pump",     "reason") \
+    X(TRC_WATER_LEVEL,     'C', "pump",     "value") \
+    X(TRC_FEEDER_START,    'B', "feeder",   "value") \
+    X(TRC_FEEDER_STOP,     'E', "feeder",   "reason") \
+    X(TRC_FEEDER_BLOCKED,  'I', "feeder",   "reason") \
+    X(TRC_LITTER_MOVE,     'B', "litter",   "value") \
+    X(TRC_LITTER_STOP,     'E', "litter",   "reason") \
+    X(TRC_SAFETY_TRIP,     'I', "isr",      "channel") \
+    X(TRC_WDT_TIMEOUT,     'I', "isr",      "task") \
+    X(TRC_SENSOR_DEGRADED, 'I', "sensors",  "sensor") \
+    X(TRC_SENSOR_RECOVERED,'I', "sensors",  "sensor")
+
+#define TRACE_EVENT_ID(id, phase, track, arg) id,
+enum TraceEventId : uint8_t {
+    TRACE_EVENT_LIST(TRACE_EVENT_ID)
+    TRC_EVENT_COUNT
+};
+#undef TRACE_EVENT_ID
+
+// Por qué terminó un tramo (arg de *_STOP, *_OFF y *_BLOCKED)
+enum TraceReason : uint8_t {
+    TRC_REASON_DONE,        // llegó al final previsto (objetivo, duración)
+    TRC_REASON_COMMAND,     // lo pidió un comando o el controlador
+    TRC_REASON_SENSORS,     // monitorAndStop / canStart: plato lleno o depósito vacío
+    TRC_REASON_NOT_READY,
+    TRC_REASON_INTERLOCK,   // el enclavamiento cortó la salida
+    TRC_REASON_EMERGENCY,
+    TRC_REASON_STALLED      // el sinfín avanza y el peso no sube (atasco)
+};
+
+// Registro de 8 bytes, little-endian tanto en el AVR como en la PC
+struct TraceRecord {
+    uint32_t tick;      // micros()
+    uint8_t  event;     // TraceEventId
+    uint8_t  seq;       // byte bajo del contador total: orden y huecos
+    uint16_t arg;
+};
+
+// Grabador de eventos en un anillo fijo de CATHUB_TRACE_RECORDS registros
+// (potencia de 2, por defecto 128 = 1 KB). record() sirve tanto en el loop
+// como dentro de un ISR: sólo la reserva del lugar (incrementar el contador)
+// va con interrupciones cortadas unos ciclos y restaurando SREG; el llenado
+// del registro queda afuera porque cada escritor tiene su propio lugar. Al
+// llenarse pisa lo más viejo. Para volcarlo (comando TRACE) se congela,
+// se manda y se descongela.
+// Sólo existe con -DCATHUB_TRACE (env megaatmega2560_trace); sin la bandera
+// TRACE_EVENT no genera código ni ocupa SRAM.
+#if defined(CATHUB_TRACE)
+
+#ifndef CATHUB_TRACE_RECORDS
+#define CATHUB_TRACE_RECORDS 128
+#endif
+
+class TraceBuffer {
+public:
+    static const uint16_t CAPACITY = CATHUB_TRACE_RECORDS;
+
+    static void record(uint8_t event, uint16_t arg);
+
+    // Mientras está congelado record() descarta (y cuenta) lo que llega
+    static void freeze() { frozen = true; }
+    static void thaw() { frozen = false; }
+    static void reset();
+
+    static uint32_t getTotal();                  // reservados desde reset()
+    static uint16_t getCount();                  // presentes en el anillo
+    static uint16_t getDiscarded();              // llegados con el anillo congelado
+
+    // getCount() registros crudos, del más viejo al más nuevo
+    static void writeRecords(Print& out);
+
+private:
+    static TraceRecord ring[CAPACITY];
+    static volatile uint32_t total;
+    static volatile uint16_t discarded;
+    static volatile bool frozen;
+};
+
+#define TRACE_EVENT(event, arg) TraceBuffer::record((event), (uint16_t)(arg))
+
+#else
+
+#define TRACE_EVENT(event, arg) ((void)(event), (void)(arg))
+
+#endif // CATHUB_TRACE
+
+#endif
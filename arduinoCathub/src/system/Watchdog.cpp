@@ -0,0 +1,194 @@
+// Watchdog.cpp
+#include "Watchdog.h"
+#include "TraceBuffer.h"
+#if defined(__AVR__)
+#include <avr/wdt.h>
+#endif
+
+// Presupuesto por tarea: lo que se considera una vuelta sana. Pasarse no
+// reinicia (para eso está el perro), sólo suma al contador de la tarea.
+static const uint32_t TASK_BUDGET_US[WDT_TASK_COUNT] PROGMEM = {
+    100000UL,   // COMMANDS (LTR1:2 y CAL_MQ2 bloquean a propósito)
+    100000UL,   // SENSORS (DHT + ultrasónicos en la misma vuelta)
+    50000UL,    // AUTOMATION
+    20000UL     // ACTUATORS
+};
+
+static const uint8_t CRITICAL_MASK = (1u << WDT_TASK_COUNT) - 1;
+
+Watchdog::TaskStats Watchdog::stats[WDT_TASK_COUNT] = {};
+volatile uint8_t Watchdog::currentTask = WDT_TASK_NONE;
+volatile unsigned long Watchdog::taskStartMs = 0;
+volatile unsigned long Watchdog::loopStartMs = 0;
+volatile uint32_t Watchdog::loops = 0;
+volatile uint16_t Watchdog::stalls = 0;
+unsigned long Watchdog::taskStartUs = 0;
+uint32_t Watchdog::loopMaxUs = 0;
+unsigned long Watchdog::loopStartUs = 0;
+uint8_t Watchdog::progressMask = 0;
+uint8_t Watchdog::resetCause = RESET_UNKNOWN;
+bool Watchdog::enabled = false;
+bool Watchdog::bootRecordValid = false;
+WatchdogRecord Watchdog::bootRecord = {};
+
+#if defined(__AVR__)
+// Sin inicializar: conserva el contenido a través del reset del watchdog
+static WatchdogRecord noinitRecord __attribute__((section(".noinit")));
+static uint8_t mcusrMirror __attribute__((section(".noinit")));
+
+// Antes de main(): guardar MCUSR y apagar el perro. Tras un reset por
+// watchdog éste sigue activo con el prescaler mínimo y reiniciaría el chip
+// en bucle durante la inicialización de C++. Si el bootloader ya borró
+// MCUSR la causa queda UNKNOWN.
+void watchdogEarlyInit() __attribute__((naked, used, section(".init3")));
+void watchdogEarlyInit() {
+    mcusrMirror = MCUSR;
+    MCUSR = 0;
+    wdt_disable();
+}
+#else
+static WatchdogRecord noinitRecord;
+static uint8_t mcusrMirror = 0;
+#endif
+
+void Watchdog::captureResetCause() {
+    uint8_t flags = mcusrMirror;
+#if defined(__AVR__)
+    // Prioridad: el watchdog y el brown-out explican un reinicio inesperado
+    if (flags & _BV(WDRF)) resetCause = RESET_WATCHDOG;
+    else if (flags & _BV(BORF)) resetCause = RESET_BROWN_OUT;
+    else if (flags & _BV(EXTRF)) resetCause = RESET_EXTERNAL;
+    else if (flags & _BV(PORF)) resetCause = RESET_POWER_ON;
+#if defined(JTRF)
+    else if (flags & _BV(JTRF)) resetCause = RESET_JTAG;
+#endif
+#else
+    (void)flags;
+    resetCause = RESET_POWER_ON;   // HAL nativo: siempre arranque en frío
+#endif
+
+    bootRecordValid = (resetCause == RESET_WATCHDOG && noinitRecord.magic == RECORD_MAGIC);
+    if (bootRecordValid) bootRecord = noinitRecord;
+    noinitRecord.magic = 0;
+}
+
+void Watchdog::enable() {
+    loopStartMs = millis();
+    loopStartUs = micros();
+#if defined(__AVR__)
+    // Interrupción a los ~4 s y reinicio en el siguiente vencimiento (~8 s):
+    // holgura para LTR1:2 (~2 s bloqueante) y la calibración del MQ2 (~2.5 s)
+    noInterrupts();
+    wdt_reset();
+    wdt_enable(WDTO_4S);
+    WDTCSR |= _BV(WDIE);
+    interrupts();
+#endif
+    enabled = true;
+}
+
+// ===== MARCAS DEL LOOP =====
+void Watchdog::beginLoop() {
+    loopStartUs = micros();
+    loopStartMs = millis();
+}
+
+void Watchdog::beginTask(uint8_t task) {
+    taskStartUs = micros();
+    taskStartMs = millis();
+    currentTask = task;
+    TRACE_EVENT(TRC_TASK_BEGIN, task);
+}
+
+void Watchdog::endTask(uint8_t task) {
+    if (task >= WDT_TASK_COUNT) return;
+    uint32_t elapsed = micros() - taskStartUs;
+    currentTask = WDT_TASK_NONE;
+    TRACE_EVENT(TRC_TASK_END, task);
+
+    TaskStats& s = stats[task];
+    if (elapsed > s.maxUs) s.maxUs = elapsed;
+    if (elapsed > pgm_read_dword(&TASK_BUDGET_US[task]) && s.overruns < 0xFFFF) s.overruns++;
+    progressMask |= (uint8_t)(1u << task);
+}
+
+void Watchdog::endLoop() {
+    uint32_t elapsed = micros() - loopStartUs;
+    if (elapsed > loopMaxUs) loopMaxUs = elapsed;
+
+    // Una tarea que no volvió (o que el loop salteó) deja al perro sin comer
+    if (progressMask != CRITICAL_MASK) return;
+    progressMask = 0;
+
+    noInterrupts();
+    loops++;
+    interrupts();
+#if defined(__AVR__)
+    if (enabled) {
+        wdt_reset();
+        // El hardware apaga WDIE al atender la interrupción: rearmarla
+        // para que el próximo vencimiento vuelva a avisar antes de reiniciar
+        WDTCSR |= _BV(WDIE);
+    }
+#endif
+}
+
+// ===== CONTEXTO DE INTERRUPCIÓN =====
+void Watchdog::onTimeout() {
+    unsigned long now = millis();
+    noinitRecord.magic = RECORD_MAGIC;
+    noinitRecord.task = currentTask;
+    noinitRecord.taskMs = (currentTask != WDT_TASK_NONE) ? now - taskStartMs : 0;
+    noinitRecord.loopMs = now - loopStartMs;
+    noinitRecord.loops = loops;
+    noinitRecord.uptimeMs = now;
+    if (stalls < 0xFFFF) stalls++;
+    TRACE_EVENT(TRC_WDT_TIMEOUT, currentTask);
+}
+
+#if defined(__AVR__)
+ISR(WDT_vect) {
+    Watchdog::onTimeout();
+}
+#endif
+
+// ===== LECTURA =====
+bool Watchdog::getBootRecord(WatchdogRecord& out) {
+    if (!bootRecordValid) return false;
+    out = bootRecord;
+    return true;
+}
+
+uint32_t Watchdog::getTaskMaxUs(uint8_t task) {
+    return (task < WDT_TASK_COUNT) ? stats[task].maxUs : 0;
+}
+
+uint16_t Watchdog::getTaskOverruns(uint8_t task) {
+    return (task < WDT_TASK_COUNT) ? stats[task].overruns : 0;
+}
+
+uint32_t Watchdog::getTaskBudgetUs(uint8_t task) {
+    return (task < WDT_TASK_COUNT) ? pgm_read_dword(&TASK_BUDGET_US[task]) : 0;
+}
+
+uint32_t Watchdog::getLoops() {
+    noInterrupts();
+    uint32_t n = loops;
+    interrupts();
+    return n;
+}
+
+uint16_t Watchdog::getStalls() {
+    noInterrupts();
+    uint16_t n = stalls;
+    interrupts();
+    return n;
+}
+
+void Watchdog::resetStats() {
+    for (uint8_t i = 0; i < WDT_TASK_COUNT; ++i) stats[i] = TaskStats();
+    loopMaxUs = 0;
+    noInterrupts();
+    stalls = 0;
+    interrupts();
+}
@@ -0,0 +1,95 @@
+// Watchdog.h
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <Arduino.h>
+
+// Tareas del loop principal. Todas son críticas: el perro sólo se alimenta
+// cuando cada una terminó al menos una vez desde la última alimentación.
+enum WatchdogTask : uint8_t {
+    WDT_TASK_COMMANDS,     // lectura y ejecución de comandos serie
+    WDT_TASK_SENSORS,      // SensorManager::poll()
+    WDT_TASK_AUTOMATION,   // CommandProcessor::update()
+    WDT_TASK_ACTUATORS,    // motores y bomba
+    WDT_TASK_COUNT,
+    WDT_TASK_NONE = 0xFF   // entre tareas
+};
+
+// Causa del último reinicio (MCUSR, leído antes de que lo borre nadie)
+enum ResetCause : uint8_t {
+    RESET_UNKNOWN,
+    RESET_POWER_ON,
+    RESET_EXTERNAL,        // pin RESET (incluye el DTR al abrir el puerto serie)
+    RESET_BROWN_OUT,
+    RESET_WATCHDOG,
+    RESET_JTAG
+};
+
+// Registro que escribe la interrupción previa al reinicio. Vive en .noinit:
+// sobrevive al reset del watchdog (no al corte de energía, de ahí la firma).
+struct WatchdogRecord {
+    uint16_t magic;
+    uint8_t  task;          // WatchdogTask en curso al vencer
+    uint32_t taskMs;        // cuánto llevaba esa tarea
+    uint32_t loopMs;        // cuánto llevaba la vuelta del loop
+    uint32_t loops;         // vueltas completas desde el arranque
+    uint32_t uptimeMs;
+};
+
+// Perro guardián del AVR en modo interrupción + reinicio. Al vencer por
+// primera vez salta WDT_vect, que anota qué tarea estaba corriendo; si el
+// loop no se recupera antes del segundo vencimiento, el chip se reinicia y
+// el registro se informa en el arranque. Además mide cada tarea y cuenta
+// las que superan su presupuesto, para encontrar bloqueos en campo.
+class Watchdog {
+private:
+    static const uint16_t RECORD_MAGIC = 0xCA7D;
+
+    struct TaskStats {
+        uint32_t maxUs;
+        uint16_t overruns;
+    };
+
+    static TaskStats stats[WDT_TASK_COUNT];
+    static volatile uint8_t currentTask;
+    static volatile unsigned long taskStartMs;
+    static volatile unsigned long loopStartMs;
+    static volatile uint32_t loops;
+    static volatile uint16_t stalls;          // vencimientos de los que el loop se recuperó
+    static unsigned long taskStartUs;
+    static uint32_t loopMaxUs;
+    static unsigned long loopStartUs;
+    static uint8_t progressMask;
+    static uint8_t resetCause;
+    static bool enabled;
+    static bool bootRecordValid;
+    static WatchdogRecord bootRecord;         // copia del registro del reinicio anterior
+
+public:
+    // Lee la causa del reinicio y el registro .noinit (antes de todo lo demás)
+    static void captureResetCause();
+    static void enable();
+
+    // Marcas del loop principal
+    static void beginLoop();
+    static void beginTask(uint8_t task);
+    static void endTask(uint8_t task);
+    static void endLoop();                    // alimenta sólo si todas progresaron
+
+    // Lectura para el reporte de arranque y el comando WDT
+    static uint8_t getResetCause() { return resetCause; }
+    static bool getBootRecord(WatchdogRecord& out);   // false si no hubo vencimiento
+    static uint32_t getTaskMaxUs(uint8_t task);
+    static uint16_t getTaskOverruns(uint8_t task);
+    static uint32_t getTaskBudgetUs(uint8_t task);
+    static uint32_t getLoopMaxUs() { return loopMaxUs; }
+    static uint32_t getLoops();
+    static uint16_t getStalls();
+    static bool isEnabled() { return enabled; }
+    static void resetStats();
+
+    // Sólo para el vector de interrupción
+    static void onTimeout();
+};
+
+#endif
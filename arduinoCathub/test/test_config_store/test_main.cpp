@@ -0,0 +1,208 @@
+// test_main.cpp - anillo de registros de ConfigStore sobre la EEPROM simulada
+// pio test -e native -f test_config_store
+//
+// Cada prueba arranca con la EEPROM en blanco (0xFF, como sale de fábrica) y
+// lee con una instancia nueva de ConfigStore, como en un arranque. Los
+// registros armados a mano siguen el formato público de ConfigStore.h.
+#include <unity.h>
+#include <EEPROM.h>
+#include "../../src/state/ConfigStore.cpp"
+
+void setUp() { EEPROM.clear(); }
+void tearDown() {}
+
+// CRC-16/CCITT (0x1021, inicio 0xFFFF), el mismo que guarda ConfigStore
+static uint16_t crc16(uint16_t crc, const uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= (uint16_t)buf[i] << 8;
+        for (uint8_t b = 0; b < 8; ++b) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Registro completo (o sólo los primeros `size` bytes de data) en `slot`
+static void writeRecord(uint8_t slot, uint32_t sequence, const ConfigData& data,
+                        uint8_t size = sizeof(ConfigData), uint8_t version = ConfigStore::VERSION) {
+    ConfigStore::RecordHeader header = { ConfigStore::MAGIC, version, size, sequence };
+    const uint8_t* raw = reinterpret_cast<const uint8_t*>(&data);
+    int addr = ConfigStore::slotAddress(slot);
+    EEPROM.put(addr, header);
+    for (uint8_t i = 0; i < size; ++i) EEPROM.write(addr + (int)sizeof(header) + i, raw[i]);
+    uint16_t crc = crc16(crc16(0xFFFF, reinterpret_cast<const uint8_t*>(&header), sizeof(header)), raw, size);
+    EEPROM.put(addr + (int)sizeof(header) + size, crc);
+}
+
+static ConfigData withFactor(float factor) {
+    ConfigStore store;
+    store.setCalibrationFactor(factor);
+    return store.get();
+}
+
+static void flipByte(int addr) {
+    EEPROM.write(addr, (uint8_t)(EEPROM.read(addr) ^ 0x5A));
+}
+
+void test_crc_check_value() {
+    const uint8_t check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    TEST_ASSERT_EQUAL_UINT16(0x29B1, crc16(0xFFFF, check, sizeof(check)));
+}
+
+void test_blank_eeprom_loads_defaults() {
+    ConfigStore defaults;
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.load());
+    TEST_ASSERT_EQUAL(-1, store.getCurrentSlot());
+    TEST_ASSERT_EQUAL_UINT32(0, store.getSequence());
+    TEST_ASSERT_EQUAL_MEMORY(&defaults.get(), &store.get(), sizeof(ConfigData));
+
+    // El primer guardado va al slot 0 con secuencia 1
+    store.setCalibrationFactor(500.0f);
+    TEST_ASSERT_TRUE(store.save());
+    TEST_ASSERT_EQUAL(0, store.getCurrentSlot());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getSequence());
+
+    ConfigStore reboot;
+    TEST_ASSERT_TRUE(reboot.load());
+    TEST_ASSERT_EQUAL_FLOAT(500.0f, reboot.getCalibrationFactor());
+}
+
+// Tres vueltas al anillo: la secuencia sigue subiendo y siempre gana la última
+void test_ring_wraps_and_newest_wins() {
+    ConfigStore store;
+    store.load();
+    for (uint32_t i = 1; i <= 3u * ConfigStore::SLOT_COUNT; ++i) {
+        store.setCalibrationFactor(100.0f + i);
+        TEST_ASSERT_TRUE(store.save());
+
+        ConfigStore reboot;
+        TEST_ASSERT_TRUE(reboot.load());
+        TEST_ASSERT_EQUAL_UINT32(i, reboot.getSequence());
+        TEST_ASSERT_EQUAL((int)((i - 1) % ConfigStore::SLOT_COUNT), reboot.getCurrentSlot());
+        TEST_ASSERT_EQUAL_FLOAT(100.0f + i, reboot.getCalibrationFactor());
+    }
+}
+
+void test_save_without_changes_does_not_write() {
+    ConfigStore store;
+    store.load();
+    store.setCalibrationFactor(321.0f);
+    TEST_ASSERT_TRUE(store.save());
+    uint32_t writes = EEPROM.writeCount();
+    TEST_ASSERT_TRUE(store.save());
+    TEST_ASSERT_EQUAL_UINT32(writes, EEPROM.writeCount());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getSequence());
+}
+
+// Corte de luz a mitad de una escritura: el registro más nuevo no pasa el
+// CRC y se carga el anterior; el siguiente guardado lo pisa
+void test_corrupted_newest_falls_back() {
+    ConfigStore store;
+    store.load();
+    for (int i = 1; i <= 3; ++i) {
+        store.setCalibrationFactor(10.0f * i);
+        TEST_ASSERT_TRUE(store.save());
+    }
+    int newest = ConfigStore::slotAddress((uint8_t)store.getCurrentSlot());
+    flipByte(newest + (int)sizeof(ConfigStore::RecordHeader) + 1);   // un byte de datos
+
+    ConfigStore reboot;
+    TEST_ASSERT_TRUE(reboot.load());
+    TEST_ASSERT_EQUAL_UINT32(2, reboot.getSequence());
+    TEST_ASSERT_EQUAL(1, reboot.getCurrentSlot());
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, reboot.getCalibrationFactor());
+
+    // También el encabezado: sin magic válido el slot no cuenta
+    flipByte(ConfigStore::slotAddress(1));
+    ConfigStore second;
+    TEST_ASSERT_TRUE(second.load());
+    TEST_ASSERT_EQUAL_UINT32(1, second.getSequence());
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, second.getCalibrationFactor());
+
+    second.setCalibrationFactor(40.0f);
+    TEST_ASSERT_TRUE(second.save());
+    TEST_ASSERT_EQUAL(1, second.getCurrentSlot());
+    TEST_ASSERT_EQUAL_UINT32(2, second.getSequence());
+    ConfigStore third;
+    TEST_ASSERT_TRUE(third.load());
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, third.getCalibrationFactor());
+}
+
+// La secuencia de 32 bits no se agota en la vida de la EEPROM, pero si da la
+// vuelta el 0 sigue siendo más nuevo que 0xFFFFFFFF
+void test_sequence_rollover() {
+    writeRecord(0, 0xFFFFFFFEu, withFactor(1.0f));
+    writeRecord(1, 0xFFFFFFFFu, withFactor(2.0f));
+    writeRecord(2, 0, withFactor(3.0f));
+
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.load());
+    TEST_ASSERT_EQUAL(2, store.getCurrentSlot());
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, store.getCalibrationFactor());
+
+    store.setCalibrationFactor(4.0f);
+    TEST_ASSERT_TRUE(store.save());
+    TEST_ASSERT_EQUAL(3, store.getCurrentSlot());
+    TEST_ASSERT_EQUAL_UINT32(1, store.getSequence());
+}
+
+// Registro de una versión anterior (más corto): los campos que no trae
+// quedan con su valor por defecto
+void test_shorter_record_keeps_defaults() {
+    ConfigData data = withFactor(77.0f);
+    writeRecord(0, 5, data, sizeof(float));
+
+    ConfigStore defaults;
+    ConfigStore store;
+    TEST_ASSERT_TRUE(store.load());
+    TEST_ASSERT_EQUAL_FLOAT(77.0f, store.getCalibrationFactor());
+    const uint8_t* loaded = reinterpret_cast<const uint8_t*>(&store.get());
+    const uint8_t* expected = reinterpret_cast<const uint8_t*>(&defaults.get());
+    TEST_ASSERT_EQUAL_MEMORY(expected + sizeof(float), loaded + sizeof(float),
+                             sizeof(ConfigData) - sizeof(float));
+}
+
+// Cada estación guarda sus propios ajustes: tocar la segunda no cambia la primera
+void test_stations_are_independent() {
+    ConfigStore store;
+    store.load();
+    store.setCalibrationFactor(111.0f, 1);
+    store.setStepsPerGramX100(1234, 2);
+    store.edit().units[2].catPresentCm = 15.0f;
+    TEST_ASSERT_TRUE(store.save());
+
+    ConfigStore defaults;
+    ConfigStore reboot;
+    TEST_ASSERT_TRUE(reboot.load());
+    TEST_ASSERT_EQUAL_MEMORY(&defaults.getUnit(0), &reboot.getUnit(0), sizeof(UnitSettings));
+    TEST_ASSERT_EQUAL_FLOAT(111.0f, reboot.getCalibrationFactor(1));
+    TEST_ASSERT_TRUE(reboot.hasFlag(ConfigStore::CONFIG_FLAG_HX711_FACTOR, 1));
+    TEST_ASSERT_FALSE(reboot.hasFlag(ConfigStore::CONFIG_FLAG_HX711_FACTOR, 2));
+    TEST_ASSERT_EQUAL_UINT16(1234, reboot.getUnit(2).dispenseStepsPerGramX100);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, reboot.getUnit(2).catPresentCm);
+}
+
+// Un registro de otra versión del formato no se interpreta aunque su CRC sea válido
+void test_other_version_is_ignored() {
+    writeRecord(0, 9, withFactor(55.0f), sizeof(ConfigData), ConfigStore::VERSION - 1);
+
+    ConfigStore store;
+    TEST_ASSERT_FALSE(store.load());
+    TEST_ASSERT_EQUAL(-1, store.getCurrentSlot());
+    TEST_ASSERT_EQUAL_FLOAT(422.0f, store.getCalibrationFactor());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_check_value);
+    RUN_TEST(test_blank_eeprom_loads_defaults);
+    RUN_TEST(test_ring_wraps_and_newest_wins);
+    RUN_TEST(test_save_without_changes_does_not_write);
+    RUN_TEST(test_corrupted_newest_falls_back);
+    RUN_TEST(test_sequence_rollover);
+    RUN_TEST(test_shorter_record_keeps_defaults);
+    RUN_TEST(test_stations_are_independent);
+    RUN_TEST(test_other_version_is_ignored);
+    return UNITY_END();
+}
@@ -0,0 +1,289 @@
+// test_main.cpp - filtros de punto fijo contra su referencia en float
+// pio test -e native -f test_fixed_point
+//
+// Cotas. Las fórmulas se comparan con el float de siempre; los filtros, con
+// los mismos coeficientes ya cuantizados a Q16.16 (así se mide sólo el error
+// que acumula la aritmética):
+//   q16Mul                    < 1 LSB (2^-16): trunca hacia abajo
+//   q16Div                    <= 3 LSB
+//   Rs = RL*(1023-adc)/adc    error relativo < 1e-3 en 1..1023 cuentas
+//   eco * cm/µs               < µs * 0.5 LSB (la constante cuantizada): 0.23 cm a 30 ms
+//   EmaFilter (alfa 0.2/0.05) < 1/alfa LSB, que es < 0.001 cuentas
+//   AlphaBetaFilter           posición < 0.01 y velocidad < 0.001 (unidades de la muestra)
+//   MovingAverage             <= 0.5 (redondeo al entero)
+//   MedianFilter              exacta
+//   HysteresisComparator      exacta con umbrales y valores representables en Q16.16
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include "../../src/filters/SignalFilters.h"
+
+static const double LSB = 1.0 / 65536.0;
+
+// Generador fijo: las corridas son reproducibles en cualquier PC
+static uint32_t lcgState = 12345;
+static uint32_t nextRandom() {
+    lcgState = lcgState * 1664525u + 1013904223u;
+    return lcgState;
+}
+static int32_t randomRange(int32_t lo, int32_t hi) {
+    return lo + (int32_t)(nextRandom() % (uint32_t)(hi - lo + 1));
+}
+
+static double toDouble(q16_t v) { return (double)v * LSB; }
+
+void setUp() { lcgState = 12345; }
+void tearDown() {}
+
+// ===== ARITMÉTICA =====
+void test_q16_mul_matches_real_product() {
+    double worst = 0.0;
+    for (int i = 0; i < 100000; ++i) {
+        q16_t a = (q16_t)nextRandom() >> randomRange(0, 24);
+        q16_t b = (q16_t)nextRandom() >> randomRange(0, 24);
+        double exact = toDouble(a) * toDouble(b);
+        if (fabs(exact) >= 32767.0) continue;          // fuera de rango de Q16.16
+        double err = exact - toDouble(q16Mul(a, b));
+        TEST_ASSERT_TRUE(err >= 0.0);                   // piso, como el corrimiento
+        if (err > worst) worst = err;
+    }
+    TEST_ASSERT_TRUE(worst < LSB);
+}
+
+void test_q16_div_matches_real_quotient() {
+    double worst = 0.0;
+    for (int i = 0; i < 100000; ++i) {
+        q16_t a = (q16_t)nextRandom() >> randomRange(0, 24);
+        q16_t b = (q16_t)nextRandom() >> randomRange(0, 28);
+        if (b == 0) continue;
+        double exact = toDouble(a) / toDouble(b);
+        if (fabs(exact) >= 32767.0) continue;
+        double err = fabs(exact - toDouble(q16Div(a, b)));
+        if (err > worst) worst = err;
+    }
+    TEST_ASSERT_TRUE(worst <= 3.0 * LSB);
+}
+
+void test_q16_div_saturates() {
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Div(q16FromInt(1000), 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, q16Div(q16FromInt(-1000), 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, q16Div(Q16_ONE, 0));
+}
+
+// Mismo cálculo que LitterboxMQ2Sensor::rsFromAdcQ16 (RL = 10 kΩ)
+void test_mq2_rs_formula() {
+    const float rLoad = 10.0f;
+    q16_t rLoadQ16 = q16FromFloat(rLoad);
+    for (int32_t adc = 1; adc <= 1023; ++adc) {
+        q16_t adcQ16 = q16FromInt(adc);
+        double fixed = toDouble(q16Div(q16Mul(rLoadQ16, q16FromInt(1023) - adcQ16), adcQ16));
+        double exact = rLoad * (1023.0 - adc) / adc;
+        if (exact == 0.0) {
+            TEST_ASSERT_TRUE(fabs(fixed) < 1e-3);
+        } else {
+            TEST_ASSERT_TRUE(fabs(fixed - exact) / exact < 1e-3);
+        }
+    }
+}
+
+// Mismo cálculo que UltrasonicRanging::echoToCm, de -10 a 45 °C
+void test_echo_to_cm() {
+    for (int t = -10; t <= 45; ++t) {
+        const float cmPerUs = (331.3f + 0.606f * t) / 20000.0f;
+        q16_t scale = q16FromFloat(cmPerUs);
+        for (int32_t us = 0; us <= 30000; us += 7) {
+            double fixed = toDouble(q16MulInt(us, scale));
+            TEST_ASSERT_TRUE(fabs(fixed - us * (double)cmPerUs) <= us * 0.5 * LSB + 1e-6);
+        }
+    }
+}
+
+// ===== FILTROS =====
+static void checkEma(float alpha) {
+    EmaFilter ema(q16FromFloat(alpha));
+    double a = toDouble(q16FromFloat(alpha));
+    double ref = 0.0;
+    double worst = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        // ADC del MQ2: nivel que cambia de a escalones, con ruido
+        int32_t sample = ((i / 500) % 2 ? 700 : 150) + randomRange(-20, 20);
+        double fixed = toDouble(ema.update(sample));
+        ref = (i == 0) ? sample : ref + a * (sample - ref);
+        double err = fabs(fixed - ref);
+        if (err > worst) worst = err;
+    }
+    TEST_ASSERT_TRUE(worst < LSB / a);
+    TEST_ASSERT_TRUE(worst < 0.001);
+}
+
+void test_ema_alpha_020() { checkEma(0.2f); }
+void test_ema_alpha_005() { checkEma(0.05f); }
+
+void test_alpha_beta_tracks_float() {
+    const float alpha = 0.5f, beta = 0.1f;
+    AlphaBetaFilter filter(q16FromFloat(alpha), q16FromFloat(beta));
+    double a = toDouble(q16FromFloat(alpha)), b = toDouble(q16FromFloat(beta));
+    double x = 0.0, v = 0.0;
+    double worstX = 0.0, worstV = 0.0;
+    for (int i = 0; i < 5000; ++i) {
+        // Peso en cuentas: rampa (el gato come) y después quieto, con ruido
+        int32_t sample = (i < 2500 ? 20000 - i * 3 : 12500) + randomRange(-40, 40);
+        double fx = toDouble(filter.update(sample));
+        if (i == 0) {
+            x = sample;
+            v = 0.0;
+        } else {
+            double predicted = x + v;
+            double residual = sample - predicted;
+            x = predicted + a * residual;
+            v = v + b * residual;
+        }
+        if (fabs(fx - x) > worstX) worstX = fabs(fx - x);
+        double fv = toDouble(filter.velocityQ16());
+        if (fabs(fv - v) > worstV) worstV = fabs(fv - v);
+    }
+    TEST_ASSERT_TRUE(worstX < 0.01);
+    TEST_ASSERT_TRUE(worstV < 0.001);
+}
+
+void test_moving_average_rounds() {
+    MovingAverage<10> avg;
+    int32_t window[10];
+    for (int i = 0; i < 1000; ++i) {
+        int32_t sample = randomRange(-500000, 500000);   // cuentas crudas del HX711
+        window[i % 10] = sample;
+        int32_t n = (i < 10) ? i + 1 : 10;
+        double sum = 0.0;
+        for (int32_t k = 0; k < n; ++k) sum += window[k];
+        TEST_ASSERT_TRUE(fabs(avg.update(sample) - sum / n) <= 0.5);
+    }
+}
+
+static int compareInt32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a, y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+void test_median_is_exact() {
+    MedianFilter<5> median;
+    int32_t window[5], sorted[5];
+    for (int i = 0; i < 1000; ++i) {
+        int32_t sample = randomRange(0, 30000);          // µs de eco
+        window[i % 5] = sample;
+        int n = (i < 5) ? i + 1 : 5;
+        for (int k = 0; k < n; ++k) sorted[k] = window[k];
+        qsort(sorted, (size_t)n, sizeof(int32_t), compareInt32);
+        TEST_ASSERT_EQUAL_INT32(sorted[n / 2], median.update(sample));
+    }
+    TEST_ASSERT_EQUAL_INT32(median3(9, 1, 5), 5);
+}
+
+// Referencia en float del comparador (misma regla que HysteresisComparator)
+struct FloatHysteresis {
+    float on, off;
+    bool rising, active;
+    bool update(float value) {
+        if (rising) {
+            if (!active && value >= on) active = true;
+            else if (active && value < off) active = false;
+        } else {
+            if (!active && value <= on) active = true;
+            else if (active && value > off) active = false;
+        }
+        return active;
+    }
+};
+
+// Recorre values[] con los dos comparadores y con lo esperado
+static void checkHysteresis(float on, float off, bool rising,
+                            const float* values, const bool* expected, int count) {
+    HysteresisComparator fixed(q16FromFloat(on), q16FromFloat(off), rising);
+    FloatHysteresis ref = { on, off, rising, false };
+    for (int i = 0; i < count; ++i) {
+        bool f = fixed.update(q16FromFloat(values[i]));
+        TEST_ASSERT_EQUAL(ref.update(values[i]), f);
+        TEST_ASSERT_EQUAL(expected[i], f);
+    }
+}
+
+// Nivel de gas: se activa en on exacto y se suelta recién por debajo de off
+void test_hysteresis_rising_edges() {
+    const float lsb = (float)LSB;
+    const float on = 100.5f, off = 80.25f;
+    const float values[] = {
+        0.0f, on - lsb, on, on + lsb,      // sube: activo desde on
+        on - lsb, off + lsb, off,          // baja hasta off: sigue activo
+        off - lsb, off, on - lsb,          // por debajo de off se suelta; on-1 no reactiva
+        on, off - lsb,
+    };
+    const bool expected[] = {
+        false, false, true, true,
+        true, true, true,
+        false, false, false,
+        true, false,
+    };
+    checkHysteresis(on, off, true, values, expected, (int)(sizeof(values) / sizeof(values[0])));
+}
+
+// Presencia por distancia: activo al acercarse a on, se suelta pasando off
+void test_hysteresis_falling_edges() {
+    const float lsb = (float)LSB;
+    const float on = 8.0f, off = 10.0f;
+    const float values[] = {
+        40.0f, on + lsb, on, on - lsb,     // se acerca: activo desde on
+        on + lsb, off - lsb, off,          // se aleja hasta off: sigue activo
+        off + lsb, off, on + lsb,          // pasando off se suelta
+        on, off + lsb,
+    };
+    const bool expected[] = {
+        false, false, true, true,
+        true, true, true,
+        false, false, false,
+        true, false,
+    };
+    checkHysteresis(on, off, false, values, expected, (int)(sizeof(values) / sizeof(values[0])));
+}
+
+// Subidas y bajadas (onda triangular que cruza los dos umbrales) con ruido,
+// en pasos de 1/256: exactos en float y en Q16.16
+void test_hysteresis_matches_float() {
+    for (int rising = 0; rising <= 1; ++rising) {
+        const float on = rising ? 100.5f : 8.0f;
+        const float off = rising ? 80.25f : 10.0f;
+        HysteresisComparator fixed(q16FromFloat(on), q16FromFloat(off), rising != 0);
+        FloatHysteresis ref = { on, off, rising != 0, false };
+        const int32_t mid = (int32_t)((on + off) * 128.0f);            // en 1/256
+        const int32_t span = (int32_t)(fabs(on - off) * 512.0f);        // 2 * |on - off|
+        int transitions = 0;
+        bool last = false;
+        for (int i = 0; i < 20000; ++i) {
+            int32_t phase = i % 1000;
+            int32_t tri = (phase < 500) ? phase : 1000 - phase;         // 0..500..0
+            int32_t level = mid - span + 2 * span * tri / 500 + randomRange(-span / 8, span / 8);
+            float value = (float)level / 256.0f;
+            bool f = fixed.update(q16FromFloat(value));
+            TEST_ASSERT_EQUAL(ref.update(value), f);
+            if (f != last) transitions++;
+            last = f;
+        }
+        TEST_ASSERT_TRUE(transitions >= 20);    // la corrida cruzó los umbrales
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_q16_mul_matches_real_product);
+    RUN_TEST(test_q16_div_matches_real_quotient);
+    RUN_TEST(test_q16_div_saturates);
+    RUN_TEST(test_mq2_rs_formula);
+    RUN_TEST(test_echo_to_cm);
+    RUN_TEST(test_ema_alpha_020);
+    RUN_TEST(test_ema_alpha_005);
+    RUN_TEST(test_alpha_beta_tracks_float);
+    RUN_TEST(test_moving_average_rounds);
+    RUN_TEST(test_median_is_exact);
+    RUN_TEST(test_hysteresis_rising_edges);
+    RUN_TEST(test_hysteresis_falling_edges);
+    RUN_TEST(test_hysteresis_matches_float);
+    return UNITY_END();
+}
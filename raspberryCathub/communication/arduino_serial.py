@@ -13,7 +13,7 @@ logging.basicConfig(
     )
     
 import threading
-from typing import Dict, Any, Optional, Union
+from typing import Callable, Dict, Any, Optional, Union
 from queue import Queue, Empty
 
 class ArduinoSerial:
@@ -45,6 +45,10 @@ class ArduinoSerial:
         # ✅ THREAD SAFETY
         self.serial_lock = threading.Lock()
         self.command_queue = Queue()
+        self.event_queue = Queue()   # eventos espontáneos del firmware ({"event":...})
+        # Colas por device_id (subscribe_events): con varias estaciones en la
+        # misma placa cada DeviceManager lee sólo las suyas
+        self.device_event_queues: Dict[str, Queue] = {}
         
         # ✅ ESTADÍSTICAS
         self.stats = {
@@ -83,9 +87,9 @@ class ArduinoSerial:
             self.serial_connection.flushInput()
             self.serial_connection.flushOutput()
             
-            # Verificar comunicación con ping
+            # Verificar comunicación con ping (_send_command_raw exige connected)
+            self.connected = True
             if self._test_connection():
-                self.connected = True
                 self.last_connection_attempt = time.time()
                 self.logger.info("✅ Arduino conectado exitosamente")
                 return True
@@ -217,13 +221,16 @@ class ArduinoSerial:
             self.logger.error(f"❌ Error enviando comando actuador: {e}")
             return False
 
-    def _send_and_wait(self, command: Dict[str, Any], timeout: int = 5) -> Optional[Dict[str, Any]]:
+    def _send_and_wait(self, command: Dict[str, Any], timeout: int = 5,
+                       match: Optional[Callable[[Dict[str, Any]], bool]] = None) -> Optional[Dict[str, Any]]:
         """
         Envía comando y espera respuesta específica
         
         Args:
             command: Comando a enviar
             timeout: Timeout para respuesta
+            match: Si se da, las líneas que no cumplen (safety_check, auto_action...)
+                   se descartan y se sigue esperando la respuesta del comando
             
         Returns:
             Respuesta parseada o None
@@ -239,7 +246,10 @@ class ArduinoSerial:
                 while (time.time() - start_time) < timeout:
                     response = self._read_response()
                     if response:
-                        return response
+                        if match is None or match(response):
+                            return response
+                        self.logger.debug(f"📭 Línea ajena a {command} descartada: {response}")
+                        continue
                     
                     time.sleep(0.1)  # Pequeña pausa para no saturar CPU
                 
@@ -254,12 +264,12 @@ class ArduinoSerial:
         with self.serial_lock:
             return self._send_command_raw(command)
 
-    def _send_command_raw(self, command: Dict[str, Any]) -> bool:
+    def _send_command_raw(self, command: Union[str, Dict[str, Any]]) -> bool:
         """
         Envía comando raw (sin lock, para uso interno)
         
         Args:
-            command: Diccionario comando
+            command: Línea de texto del protocolo (ej: "PING", "SET:x=1") o diccionario comando
             
         Returns:
             True si envío exitoso
@@ -268,8 +278,11 @@ class ArduinoSerial:
             if not self.serial_connection or not self.connected:
                 return False
             
-            # Convertir a JSON y agregar terminador
-            command_json = json.dumps(command)
+            # Texto del protocolo tal cual; diccionarios como JSON
+            if isinstance(command, str):
+                command_json = command.rstrip('\r\n')
+            else:
+                command_json = json.dumps(command)
             command_bytes = (command_json + '\n').encode('utf-8')
             
             # Enviar comando
@@ -315,6 +328,8 @@ class ArduinoSerial:
             response = json.loads(line)
             
             self.logger.debug(f"📥 Respuesta recibida: {line}")
+            if self._route_event(response):
+                return None
             return response
             
         except json.JSONDecodeError as e:
@@ -330,6 +345,158 @@ class ArduinoSerial:
             self.logger.error(f"❌ Error leyendo respuesta: {e}")
             return None
 
+    def send_command(self, command: str) -> bool:
+        """
+        Envía una línea de texto del protocolo serie (ej: "ALL", "FDR1:1")
+        
+        Returns:
+            True si comando enviado
+        """
+        if not self.is_connected():
+            if not self._attempt_reconnect():
+                return False
+        return self._send_command(command)
+
+    def read_response(self) -> Optional[str]:
+        """
+        Lee una línea cruda del Arduino (sin parsear)
+        
+        Returns:
+            Línea recibida o None
+        """
+        try:
+            with self.serial_lock:
+                if not self.serial_connection or not self.connected:
+                    return None
+                # Los eventos que llegan intercalados se encolan y se sigue leyendo
+                while True:
+                    line = self.serial_connection.readline().decode('utf-8', errors='replace').strip()
+                    if not line:
+                        return None
+                    try:
+                        if self._route_event(json.loads(line)):
+                            continue
+                    except json.JSONDecodeError:
+                        pass
+                    return line
+        except serial.SerialException as e:
+            self.logger.error(f"❌ Error serial leyendo: {e}")
+            self.connected = False
+            return None
+
+    def _route_event(self, message: Any) -> bool:
+        """Encola los eventos espontáneos del firmware; True si lo era"""
+        if isinstance(message, dict) and "event" in message:
+            message["received_at"] = time.time()
+            device_id = message.get("device_id")
+            if not self.device_event_queues:
+                self.event_queue.put(message)
+            elif device_id in self.device_event_queues:
+                self.device_event_queues[device_id].put(message)
+            elif device_id is None:
+                # Eventos de la placa (BOOT): una copia para cada suscriptor
+                for queue in self.device_event_queues.values():
+                    queue.put(dict(message))
+            else:
+                # Con suscripciones nadie vaciaría la cola general
+                self.logger.debug(f"📭 Evento sin suscriptor ({device_id}): {message}")
+                return True
+            self.logger.debug(f"📨 Evento del Arduino: {message}")
+            return True
+        return False
+
+    def subscribe_events(self, device_id: str):
+        """Separa en su propia cola los eventos de un device_id del firmware (LTR2, FDR1...)"""
+        self.device_event_queues.setdefault(device_id, Queue())
+
+    def get_events(self, device_id: Optional[str] = None) -> list:
+        """
+        Devuelve (y vacía) los eventos recibidos del Arduino: los de device_id
+        si se suscribió con subscribe_events, o todos si no hay suscripciones
+        
+        Ej: {"device_id":"FDR1","event":"EAT_END","grams":18.0,"duration_ms":62000,"weight_grams":111.9}
+        """
+        queue = self.device_event_queues.get(device_id, self.event_queue) if device_id else self.event_queue
+        events = []
+        while True:
+            try:
+                events.append(queue.get_nowait())
+            except Empty:
+                return events
+
+    def set_param(self, name: str, value: Union[int, float], timeout: int = 2,
+                  station: Optional[int] = None) -> bool:
+        """
+        Ajusta un parámetro del firmware con SET:<nombre>[@<station>]=<valor>
+        
+        El Arduino responde {"param":...,"station":...,"success":...}; las
+        demás líneas (eventos automáticos) se descartan mientras se espera.
+        
+        Args:
+            station: Estación (1 = LTR1/FDR1/WTR1) para los parámetros que
+                tiene cada una; None para los de la placa
+        
+        Returns:
+            True si el Arduino aceptó el valor
+        """
+        if not self.is_connected():
+            if not self._attempt_reconnect():
+                return False
+
+        target = name if station is None else f"{name}@{station}"
+        with self.serial_lock:
+            if not self._send_command_raw(f"SET:{target}={value}"):
+                return False
+
+            start_time = time.time()
+            while (time.time() - start_time) < timeout:
+                response = self._read_response()
+                if not response:
+                    continue
+                # Los errores de nombre o estación devuelven el texto tal cual
+                # se envió; las respuestas normales, el nombre y la estación
+                if response.get("param") == target and "error" in response:
+                    self.logger.warning(f"⚠️ Parámetro {target} rechazado: {response.get('error')}")
+                    return False
+                if response.get("param") == name and response.get("station") == station:
+                    if response.get("success"):
+                        self.logger.info(f"✅ Parámetro {target}={value}")
+                        return True
+                    self.logger.warning(f"⚠️ Parámetro {target} rechazado: {response.get('reason', response.get('error'))}")
+                    return False
+
+        self.stats["timeouts"] += 1
+        self.logger.warning(f"⏰ Sin respuesta a SET {target}")
+        return False
+
+    def get_sensor_health(self, timeout: int = 2) -> Optional[Dict[str, list]]:
+        """
+        Pide los contadores de salud de los sensores (comando DIAG)
+        
+        Ej: {"UTS_001":[120,118,2,0,350,2410,6020,0], ...}; el orden de cada
+        arreglo está en DeviceManager.DIAG_FIELDS
+        
+        Returns:
+            sensor_id del firmware -> contadores, o None si no respondió
+        """
+        if not self.is_connected():
+            if not self._attempt_reconnect():
+                return None
+
+        with self.serial_lock:
+            if not self._send_command_raw("DIAG"):
+                return None
+
+            start_time = time.time()
+            while (time.time() - start_time) < timeout:
+                response = self._read_response()
+                if response and "diag" in response:
+                    return response["diag"]
+
+        self.stats["timeouts"] += 1
+        self.logger.warning("⏰ Sin respuesta a DIAG")
+        return None
+
     def _attempt_reconnect(self) -> bool:
         """
         Intenta reconectar al Arduino
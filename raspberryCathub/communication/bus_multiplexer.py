@@ -0,0 +1,392 @@
+"""
+Bus Multiplexer - Varias placas CatHub en un mismo bus serie semidúplex
+
+Cada placa tiene su dirección (parámetro node_addr, SET:node_addr=N por su
+propio USB antes de colgarla del bus) y sólo transmite cuando el host le da
+el turno, así nunca hablan dos a la vez (ver arduinoCathub/src/protocol/BusLink.h).
+Con un transceptor RS-485 va también SET:bus_de_pin=N (el pin de DE/RE), y
+antes que node_addr: después la placa sólo atiende tramas @NN:.
+
+    host -> placa   @NN:<comando>   se encola en la placa, no da turno
+                    @00:<comando>   para todas
+                    @NN:?           turno: la placa vuelca lo que tenga
+    placa -> host   #NN:<línea>     una línea de respuesta o evento
+                    #NN:.           fin del turno
+
+Un solo proceso (BusMultiplexer) es dueño del puerto. En cada ciclo da el
+turno a cada placa por orden, y en la misma escritura que el turno van los
+comandos pendientes de esa placa: el firmware atiende lo que llegó en orden
+y en la misma vuelta de loop, así que la respuesta sale en ese turno y no en
+el del ciclo siguiente. Los turnos de varias placas no pueden ir juntos (la
+segunda hablaría encima de la primera), de modo que lo que cuesta en el host
+es cada turno: escribir, esperar, leer. Por eso el camino del turno no hace
+tcdrain (flush) y lee por bloques, no de a un byte como readline() de
+pyserial, y entre ciclos se espera a que encolen las placas que acaban de
+recibir respuesta (ver _wait_for_commands).
+
+Para el resto del código cada placa es un BusNode: un ArduinoSerial con
+todas sus llamadas (send_command, read_response, set_param, get_events...)
+que en lugar del puerto usa la cola de su dirección, así que DeviceManager
+lo recibe igual que a una placa punto a punto.
+"""
+
+import json
+import logging
+import threading
+import time
+from queue import Queue, Empty
+from typing import Any, Dict, List, Optional
+
+import serial
+
+from communication.arduino_serial import ArduinoSerial
+
+BROADCAST = 0
+MAX_ADDRESS = 99          # BUS_MAX_ADDRESS del firmware
+END_OF_TURN = "."
+
+
+class NodePort:
+    """
+    Lo que ArduinoSerial espera de serial.Serial, atado a una dirección
+
+    write() encola líneas para el próximo ciclo del multiplexor y readline()
+    espera (hasta `timeout`) las que la placa mandó en sus turnos.
+    """
+
+    def __init__(self, mux: "BusMultiplexer", address: int, timeout: float):
+        self.mux = mux
+        self.address = address
+        self.timeout = timeout
+        self.rx: Queue = Queue()
+        self.pending = b""
+
+    def write(self, data: bytes) -> int:
+        if not self.mux.is_open():
+            raise serial.SerialException(f"Bus {self.mux.port} cerrado")
+        self.pending += data
+        lines = self.pending.split(b"\n")
+        self.pending = lines.pop()
+        for raw in lines:
+            line = raw.decode("utf-8", errors="replace").strip()
+            if line:
+                self.mux.enqueue(self.address, line)
+        return len(data)
+
+    def flush(self):
+        pass
+
+    def readline(self) -> bytes:
+        try:
+            return self.rx.get(timeout=self.timeout)
+        except Empty:
+            return b""
+
+    def flushInput(self):
+        while True:
+            try:
+                self.rx.get_nowait()
+            except Empty:
+                return
+
+    def flushOutput(self):
+        self.pending = b""
+        self.mux.drop_outgoing(self.address)
+
+    def close(self):
+        self.flushOutput()
+
+
+class BusNode(ArduinoSerial):
+    """Una placa del bus vista como un ArduinoSerial"""
+
+    def __init__(self, mux: "BusMultiplexer", address: int):
+        super().__init__(port=f"{mux.port}@{address:02d}", baudrate=mux.baudrate)
+        self.mux = mux
+        self.address = address
+        self.port_queue: Optional[NodePort] = None
+
+    def connect(self) -> bool:
+        """Se engancha a la cola de su dirección y prueba con PING (el puerto lo abre el multiplexor)"""
+        if self.connected:
+            return True
+        if not self.mux.is_open() and not self.mux.open():
+            return False
+
+        self.logger.info(f"🔗 Conectando a la placa {self.address:02d} del bus {self.mux.port}...")
+        self.port_queue = self.mux.attach(self.address, self.timeout)
+        self.serial_connection = self.port_queue
+        self.connected = True
+        if self._test_connection():
+            self.last_connection_attempt = time.time()
+            self.logger.info(f"✅ Placa {self.address:02d} conectada")
+            return True
+        self.logger.error(f"❌ La placa {self.address:02d} no responde al ping")
+        self._disconnect()
+        return False
+
+
+class BusMultiplexer:
+    """
+    Dueño del puerto del bus: reparte comandos y turnos entre las placas
+
+    Una placa que no cierra su turno en `turn_timeout` se salta una cantidad
+    creciente de ciclos (hasta MAX_BACKOFF_CYCLES) para no frenar a las
+    demás; vuelve al ritmo normal en cuanto contesta. Si estaba bloqueada, el
+    "@NN:?" vencido le queda en el buffer: BusLink no lo contesta cuando
+    detrás pasó otra trama o pudo tener más de BUS_POLL_MAX_AGE_MS (150 ms),
+    así que `turn_timeout` tiene que ser mayor que eso. Una línea de otra
+    placa dentro de un turno (late_lines) es una colisión en el cable.
+    """
+
+    MAX_BACKOFF_CYCLES = 32
+
+    def __init__(self, port: str = '/dev/ttyUSB0', baudrate: int = 115200,
+                 turn_timeout: float = 0.25, idle_s: float = 0.01):
+        self.logger = logging.getLogger(__name__)
+
+        # ✅ CONFIGURACIÓN DEL BUS
+        self.port = port
+        self.baudrate = baudrate
+        self.turn_timeout = turn_timeout
+        self.idle_s = idle_s            # espera entre ciclos si nadie encola un comando
+
+        # ✅ ESTADO
+        self.serial_connection: Optional[serial.Serial] = None
+        self.running = False
+        self.thread: Optional[threading.Thread] = None
+        self.lock = threading.Lock()
+        self.nodes: Dict[int, BusNode] = {}
+        self.ports: Dict[int, NodePort] = {}
+        self.outbox: Dict[int, List[str]] = {}
+        self.missed: Dict[int, int] = {}
+        self.skip_until: Dict[int, int] = {}
+        self.cycle = 0
+        self.rx_pending = b""           # bytes leídos del puerto que todavía no son línea
+        self.wake = threading.Event()   # enqueue() avisa que hay un comando para el próximo ciclo
+        self.answered = set()           # placas que recibieron líneas en este ciclo
+
+        # ✅ ESTADÍSTICAS
+        self.stats = {
+            "cycles": 0,
+            "polls": 0,
+            "turns_closed": 0,
+            "turn_timeouts": 0,
+            "frames_sent": 0,
+            "lines_received": 0,
+            "late_lines": 0,       # de otra placa dentro del turno (habló fuera de turno)
+            "stray_lines": 0,      # sin prefijo #NN: (una placa con node_addr=0 en el bus)
+            "discarded_by_nodes": 0,
+        }
+
+    # ===== PLACAS =====
+    def node(self, address: int) -> BusNode:
+        """El BusNode de una dirección (1..99), creado la primera vez"""
+        if not 1 <= address <= MAX_ADDRESS:
+            raise ValueError(f"Dirección de bus fuera de rango: {address}")
+        with self.lock:
+            if address not in self.nodes:
+                self.nodes[address] = BusNode(self, address)
+                self.outbox.setdefault(address, [])
+                self.missed[address] = 0
+                self.skip_until[address] = 0
+            return self.nodes[address]
+
+    def attach(self, address: int, timeout: float) -> NodePort:
+        with self.lock:
+            port = NodePort(self, address, timeout)
+            self.ports[address] = port
+            self.outbox.setdefault(address, [])
+            self.missed.setdefault(address, 0)
+            self.skip_until.setdefault(address, 0)
+            return port
+
+    def enqueue(self, address: int, line: str):
+        with self.lock:
+            self.outbox.setdefault(address, []).append(line)
+        self.wake.set()
+
+    def broadcast(self, line: str):
+        """Comando para todas las placas (@00:), sin respuesta esperada"""
+        self.enqueue(BROADCAST, line)
+
+    def drop_outgoing(self, address: int):
+        with self.lock:
+            self.outbox[address] = []
+
+    # ===== PUERTO =====
+    def open(self) -> bool:
+        if self.running:
+            return True
+        try:
+            self.logger.info(f"🔗 Abriendo bus en {self.port}...")
+            self.serial_connection = serial.Serial(port=self.port, baudrate=self.baudrate,
+                                                   timeout=self.turn_timeout, write_timeout=3)
+            # Las placas se reinician al abrir el USB del adaptador
+            time.sleep(2)
+            self.serial_connection.flushInput()
+            self.rx_pending = b""
+        except serial.SerialException as e:
+            self.logger.error(f"❌ Error abriendo el bus: {e}")
+            self.serial_connection = None
+            return False
+
+        self.running = True
+        self.thread = threading.Thread(target=self._run, name="bus-mux", daemon=True)
+        self.thread.start()
+        return True
+
+    def close(self):
+        self.running = False
+        if self.thread:
+            self.thread.join(timeout=2)
+            self.thread = None
+        for node in list(self.nodes.values()):
+            node.disconnect()
+        if self.serial_connection:
+            try:
+                self.serial_connection.close()
+            except Exception:
+                pass
+            self.serial_connection = None
+        self.logger.info("👋 Bus cerrado")
+
+    def is_open(self) -> bool:
+        return self.running and self.serial_connection is not None
+
+    # ===== CICLO =====
+    def _run(self):
+        while self.running:
+            try:
+                self._cycle()
+            except serial.SerialException as e:
+                self.logger.error(f"❌ Error serial en el bus: {e}")
+                self.running = False
+                for node in self.nodes.values():
+                    node.connected = False
+                return
+            self._wait_for_commands()
+
+    def _wait_for_commands(self):
+        """
+        Hasta idle_s, que encolen su próximo comando las placas que acaban de
+        recibir respuesta (quien la esperaba suele mandar otro enseguida). Sin
+        esto el ciclo siguiente sale apenas encola la primera y las demás
+        pierden una vuelta entera: un turno vacío ocupa el cable igual que uno
+        con datos.
+        """
+        deadline = time.perf_counter() + self.idle_s
+        while True:
+            with self.lock:
+                queued = any(self.outbox.values())
+                waiting = any(not self.outbox.get(a) for a in self.answered)
+            remaining = deadline - time.perf_counter()
+            if (queued and not waiting) or remaining <= 0:
+                break
+            self.wake.wait(remaining)
+            self.wake.clear()
+        self.answered.clear()
+
+    def _cycle(self):
+        """Un ciclo: un turno por placa, cada uno con los comandos pendientes de esa placa"""
+        self.cycle += 1
+        self.stats["cycles"] += 1
+
+        with self.lock:
+            outgoing: Dict[int, List[str]] = {}
+            for address, lines in self.outbox.items():
+                if lines:
+                    outgoing[address] = [f"@{address:02d}:{line}" for line in lines]
+                    lines.clear()
+            addresses = sorted(a for a in self.ports if self.skip_until.get(a, 0) <= self.cycle)
+
+        # Los de @00 y los de placas que en este ciclo no tienen turno salen con el primero
+        shared = [f for a in sorted(outgoing) if a not in addresses for f in outgoing[a]]
+        self.stats["frames_sent"] += sum(len(f) for f in outgoing.values())
+        for k, address in enumerate(addresses):
+            self._poll(address, (shared if k == 0 else []) + outgoing.get(address, []))
+        if shared and not addresses:
+            self.serial_connection.write(("\n".join(shared) + "\n").encode("utf-8"))
+
+    def _read_line(self, deadline: float) -> bytes:
+        """Una línea del puerto (sin esperar más allá de `deadline`); b"" si no llegó"""
+        conn = self.serial_connection
+        while b"\n" not in self.rx_pending:
+            if time.perf_counter() >= deadline:
+                return b""
+            chunk = conn.read(conn.in_waiting or 1)
+            if chunk:
+                self.rx_pending += chunk
+        line, self.rx_pending = self.rx_pending.split(b"\n", 1)
+        return line
+
+    def _poll(self, address: int, frames: List[str]) -> int:
+        """Manda `frames` y el turno de `address` juntos y reparte lo que llegue; devuelve las líneas recibidas"""
+        conn = self.serial_connection
+        conn.write("".join(f + "\n" for f in frames + [f"@{address:02d}:?"]).encode("utf-8"))
+        self.stats["polls"] += 1
+
+        received = 0
+        deadline = time.perf_counter() + self.turn_timeout
+        while time.perf_counter() < deadline:
+            raw = self._read_line(deadline)
+            if not raw:
+                continue
+            line = raw.decode("utf-8", errors="replace").strip()
+            source, payload = self._split(line)
+            if source is None:
+                if line:
+                    self.stats["stray_lines"] += 1
+                    self.logger.debug(f"📭 Línea sin dirección en el bus: {line}")
+                continue
+            if source == address and payload == END_OF_TURN:
+                self.stats["turns_closed"] += 1
+                self.missed[address] = 0
+                self.skip_until[address] = 0
+                return received
+            if source != address:
+                self.stats["late_lines"] += 1
+            else:
+                # Cada línea que llega estira la espera: una respuesta larga no es un turno perdido
+                deadline = time.perf_counter() + self.turn_timeout
+            self._deliver(source, payload)
+            received += 1
+
+        self.stats["turn_timeouts"] += 1
+        self.missed[address] = self.missed.get(address, 0) + 1
+        backoff = min(2 ** (self.missed[address] - 1), self.MAX_BACKOFF_CYCLES)
+        self.skip_until[address] = self.cycle + backoff
+        self.logger.debug(f"⏰ La placa {address:02d} no cerró su turno (salta {backoff} ciclos)")
+        return received
+
+    @staticmethod
+    def _split(line: str):
+        """'#NN:payload' -> (NN, payload); (None, None) si no es una trama de placa"""
+        if len(line) < 4 or line[0] != "#" or line[3] != ":" or not line[1:3].isdigit():
+            return None, None
+        return int(line[1:3]), line[4:]
+
+    def _deliver(self, address: int, payload: str):
+        self.stats["lines_received"] += 1
+        if payload.startswith('{"bus":'):
+            try:
+                report = json.loads(payload)["bus"]
+                self.stats["discarded_by_nodes"] += int(report.get("discarded", 0))
+                self.logger.warning(f"⚠️ La placa {address:02d} descartó {report.get('discarded')} líneas "
+                                    f"(cola de salida llena entre turnos)")
+                return
+            except (ValueError, KeyError, TypeError):
+                pass
+        port = self.ports.get(address)
+        if port is not None:
+            self.answered.add(address)
+            port.rx.put((payload + "\n").encode("utf-8"))
+
+    def get_status(self) -> Dict[str, Any]:
+        return {
+            "port": self.port,
+            "open": self.is_open(),
+            "nodes": {a: {"connected": n.connected, "missed_turns": self.missed.get(a, 0)}
+                      for a, n in self.nodes.items()},
+            "stats": self.stats.copy(),
+        }
@@ -1,4 +1,5 @@
 import time
+import json
 import logging
 import threading
 from database.postgres_handler import PostgresHandler
@@ -11,12 +12,75 @@ from typing import Optional, Dict, Any, List
 from datetime import datetime
 
 class DeviceManager:
-    def __init__(self, device_code: str, serial_port: str = "/dev/ttyACM0"):
+    # Parámetros ajustables del firmware (ver ParamTable). Los de estación
+    # van con SET:<nombre>@<unit>=<valor>; los de placa son uno para todas
+    # las estaciones y sólo los envía la estación 1.
+    ARDUINO_STATION_PARAMS = (
+        "cat_present_cm", "storage_empty_cm", "plate_full_cm",
+        "water_dry", "water_wet", "water_flood",
+        "pump_refill_ms", "pump_max_ms",
+        "weight_step_g", "weight_settle_ms", "weight_session_gap_ms",
+    )
+    ARDUINO_BOARD_PARAMS = ("auto_period_ms", "mq2_autocal")
+    ARDUINO_PARAMS = ARDUINO_STATION_PARAMS + ARDUINO_BOARD_PARAMS
+
+    # Lecturas que el firmware reporta como eventos (no se muestrean a Mongo)
+    EVENT_DRIVEN_READINGS = {
+        "feeder": ("weight",),
+    }
+
+    # Eventos que sólo se transmiten en vivo (MQTT), sin guardarse en Mongo
+    STREAM_ONLY_EVENTS = ("DISPENSE_PROGRESS",)
+
+    # Evento del firmware -> (sensor_type, unidad, campo que se guarda como value)
+    EVENT_TYPES = {
+        "EAT_START": ("feeding_event", "g", "weight_grams"),
+        "EAT_END": ("feeding_event", "g", "grams"),
+        "WEIGHT_STEP": ("feeding_event", "g", "grams"),
+        "DISPENSE_DONE": ("feeding_event", "g", "grams"),
+        "DISPENSE_STALLED": ("feeding_event", "g", "grams"),
+        "DISPENSE_NO_FOOD": ("feeding_event", "g", "grams"),
+        "DISPENSE_ABORTED": ("feeding_event", "g", "grams"),
+        "CAT_ENTER": ("presence", "%", "confidence"),
+        "CAT_EXIT": ("presence", "ms", "duration_ms"),
+        "SAFETY_INTERLOCK": ("safety", "us", "latency_us"),
+        "CLEAN_PROGRESS": ("litterbox_cleaning", "steps", "position"),
+        "BOOT": ("system", "", "reset_cause"),
+    }
+
+    # device_id que usa el firmware para cada tipo de dispositivo: prefijo +
+    # número de estación (LTR1, LTR2...; ver config/StationLayout.h)
+    FIRMWARE_DEVICE_PREFIXES = {
+        "litterbox": "LTR",
+        "feeder": "FDR",
+        "waterdispenser": "WTR",
+    }
+
+    # Sensores del firmware por tipo, en el orden de sensor_index de
+    # _get_sensor_mappings (el Arduino reporta los de todas sus estaciones).
+    # {n}: número de estación; el comedero tiene dos ultrasónicos por estación
+    FIRMWARE_SENSOR_IDS = {
+        "litterbox": ("LUT_{n:03d}", "DHT_{n:03d}", "MQ2_{n:03d}"),
+        "feeder": ("WIT_{n:03d}", "UTS_{a:03d}", "UTS_{b:03d}"),
+        "waterdispenser": ("WLV_{n:03d}", "WIR_{n:03d}"),
+    }
+
+    # Orden de los contadores de cada sensor en la respuesta a DIAG
+    # (CommandProcessor::sendSensorHealth). age_ms = None: nunca leyó bien;
+    # backoff > 0: el firmware lo degradó y lo sondea cada vez más espaciado
+    DIAG_FIELDS = ("attempts", "ok", "timeouts", "out_of_range", "age_ms", "avg_us", "max_us", "backoff")
+
+    def __init__(self, device_code: str, serial_port: str = "/dev/ttyACM0",
+                 unit: int = 1, arduino: Optional[ArduinoSerial] = None,
+                 device_type: Optional[str] = None):
         self.logger = logging.getLogger(__name__)
         
         # ✅ HANDLERS
+        # Varias estaciones en la misma placa comparten un ArduinoSerial: lo
+        # abre y lo cierra quien lo creó, no cada DeviceManager
         self.db = PostgresHandler()
-        self.arduino = ArduinoSerial(serial_port)
+        self.arduino = arduino or ArduinoSerial(serial_port)
+        self._owns_arduino = arduino is None
         self.socket_handler = SocketHandler()
         self.mqtt_handler = MQTTHandler()
         self.mongo_handler = MongoHandler()
@@ -27,6 +91,8 @@ class DeviceManager:
         
         # ✅ PROPIEDADES DEL DISPOSITIVO
         self.device_code = device_code
+        self.unit = unit              # estación del firmware (1 = LTR1/FDR1/WTR1)
+        self._device_type = device_type
         self.identifier: Optional[str] = None
         self.device_type: Optional[str] = None
         self.sensor_identifiers: List[str] = []
@@ -37,7 +103,14 @@ class DeviceManager:
         # ✅ INTERVALOS
         self.mqtt_interval = 5    # 5 segundos para MQTT
         self.mongo_interval = 60  # 60 segundos para MongoDB
+        self.health_interval = 60 # 60 segundos para la salud de sensores
+        self._last_health_at = 0.0
+        self._last_health: Dict[str, Dict[str, Any]] = {}
         
+        # ✅ EVENTOS DE ESTA ESTACIÓN (la placa compartida reporta las de todas)
+        if not self._owns_arduino and self.get_firmware_device_id():
+            self.arduino.subscribe_events(self.get_firmware_device_id())
+
         # ✅ CONFIGURAR CALLBACKS
         self._setup_socket_callbacks()
 
@@ -91,11 +164,21 @@ class DeviceManager:
                 setting = self.db.get_device_sensor_setting(sensor_id)
                 if setting and 'value' in setting:
                     self.food_amount = float(setting['value'])
-                    self.logger.info(f"✅ Nueva cantidad: {self.food_amount}g")
-                    self._send_food_to_arduino(self.food_amount)
+                    self.logger.info(f"✅ Nueva porción: {self.food_amount}g (se sirve en la próxima comida)")
+
+    def get_firmware_device_id(self) -> Optional[str]:
+        """device_id del firmware para este dispositivo (FDR2...), None si no se conoce el tipo"""
+        prefix = self.FIRMWARE_DEVICE_PREFIXES.get(self.get_device_type())
+        return f"{prefix}{self.unit}" if prefix else None
+
+    def get_firmware_sensor_ids(self) -> tuple:
+        templates = self.FIRMWARE_SENSOR_IDS.get(self.get_device_type(), ())
+        return tuple(t.format(n=self.unit, a=2 * self.unit - 1, b=2 * self.unit) for t in templates)
 
     def get_device_type(self) -> str:
         """Determina el tipo de dispositivo basado en el código"""
+        if self._device_type:
+            return self._device_type
         if self.device_code in ["A1B2C3D4"]:
             return "waterdispenser"
         elif self.device_code in ["E5F6G7H8"]:
@@ -153,10 +236,14 @@ class DeviceManager:
             for sensor_id in self.sensor_identifiers:
                 setting = self.db.get_device_sensor_setting(sensor_id)
                 if setting and 'value' in setting:
+                    # Sólo la porción: dispensar al configurar serviría comida en cada arranque
                     self.food_amount = float(setting['value'])
-                    self._send_food_to_arduino(self.food_amount)
+                    self.logger.info(f"🍽️ Porción configurada: {self.food_amount}g")
                     break
 
+        # ✅ UMBRALES Y TIEMPOS POR UNIDAD
+        self._push_arduino_params()
+
         # ✅ CONECTAR MQTT
         if self.mqtt_handler.connect():
             self.mqtt_handler.subscribe_to_commands(self.identifier, self._handle_mqtt_command)
@@ -177,6 +264,54 @@ class DeviceManager:
         self.is_configured = True
         return True
 
+    def _push_arduino_params(self) -> int:
+        """
+        Envía al Arduino los parámetros guardados en device_sensors_settings.
+
+        Un setting cuyo value es un objeto JSON con claves de ARDUINO_PARAMS
+        (ej: {"cat_present_cm": 6.5}) se aplica con SET; los valores simples
+        (cantidad de comida, etc.) se ignoran aquí.
+
+        Returns:
+            Cantidad de parámetros aceptados
+        """
+        applied = 0
+        for sensor_id in self.sensor_identifiers:
+            setting = self.db.get_device_sensor_setting(sensor_id)
+            if not setting or 'value' not in setting:
+                continue
+
+            value = setting['value']
+            if isinstance(value, str):
+                try:
+                    value = json.loads(value)
+                except ValueError:
+                    continue
+            if not isinstance(value, dict):
+                continue
+
+            for name, param_value in value.items():
+                if name in self.ARDUINO_STATION_PARAMS:
+                    station = self.unit
+                elif name in self.ARDUINO_BOARD_PARAMS:
+                    if self.unit != 1:
+                        # Con varias estaciones en la placa, la última en
+                        # conectarse pisaría el valor de las demás
+                        self.logger.info(f"ℹ️ {name} es de la placa: lo ajusta la estación 1, se ignora en la {self.unit}")
+                        continue
+                    station = None
+                else:
+                    continue
+                try:
+                    if self.arduino.set_param(name, float(param_value), station=station):
+                        applied += 1
+                except (TypeError, ValueError):
+                    self.logger.warning(f"⚠️ Valor inválido para {name}: {param_value}")
+
+        if applied:
+            self.logger.info(f"✅ {applied} parámetros enviados al Arduino")
+        return applied
+
     def _start_data_loops(self):
         """Iniciar loops de recolección de datos"""
         
@@ -202,6 +337,14 @@ class DeviceManager:
                     self.publish_sensor_readings(readings)
                     self.logger.debug(f"📡 Datos enviados por MQTT: {readings}")
                 
+                # ✅ EVENTOS DEL FIRMWARE (sesiones de comida, escalones de peso)
+                self._process_arduino_events()
+                
+                # ✅ SALUD DE SENSORES (cada health_interval)
+                if time.time() - self._last_health_at >= self.health_interval:
+                    self._last_health_at = time.time()
+                    self.publish_sensor_health()
+                
                 time.sleep(self.mqtt_interval)
                 
             except Exception as e:
@@ -270,6 +413,9 @@ class DeviceManager:
             device_id = self.mongo_handler.get_device_id(self.identifier)
             
             for reading_key, sensor_info in sensor_mappings.items():
+                # El peso del comedero se guarda por eventos, no muestreado
+                if reading_key in self.EVENT_DRIVEN_READINGS.get(self.get_device_type(), ()):
+                    continue
                 if reading_key in readings:
                     sensor_index = sensor_info.get('sensor_index', 0)
                     if sensor_index < len(self.sensor_identifiers):
@@ -298,25 +444,89 @@ class DeviceManager:
         except Exception as e:
             self.logger.error(f"❌ Error guardando en Mongo: {e}")
 
+    def _process_arduino_events(self):
+        """📨 Publicar y guardar los eventos que el Arduino generó por su cuenta"""
+        firmware_id = self.get_firmware_device_id()
+        events = self.arduino.get_events(firmware_id)
+        if not events:
+            return
+
+        device_id = self.mongo_handler.get_device_id(self.identifier)
+        # Los eventos pertenecen al sensor principal de la estación (índice 0)
+        sensor_id = self.sensor_identifiers[0] if self.sensor_identifiers else self.identifier
+
+        for event in events:
+            # Sin suscripción llegan los de todos los dispositivos de la placa
+            if firmware_id and event.get("device_id") not in (None, firmware_id):
+                continue
+
+            name = event.get("event")
+            sensor_type, unit, value_key = self.EVENT_TYPES.get(name, ("event", "", "value"))
+            value = event.get(value_key, event.get("weight_grams", 0))
+            extra = {k: v for k, v in event.items() if k not in ("event", "received_at")}
+
+            if self.mqtt_handler.connected:
+                self.mqtt_handler.publish_sensor_data(
+                    device_id=self.identifier,
+                    sensor_id=sensor_id,
+                    sensor_type=sensor_type,
+                    reading_value=name,
+                    additional_data=extra
+                )
+
+            if name in self.STREAM_ONLY_EVENTS:
+                continue
+
+            document = {
+                "sensor_name": f"{self.get_device_type()}_{sensor_type}",
+                "identifier": sensor_id,
+                "value": value,
+                "event": name,
+                "timestamp": datetime.fromtimestamp(event.get("received_at", time.time())),
+                "device_id": device_id,
+                "sensor_type": sensor_type,
+                "unit": unit,
+                "device_identifier": self.identifier,
+                **extra
+            }
+            if self.mongo_handler.save_sensor_reading(document):
+                self.logger.info(f"📨 Evento {name} guardado: {value}{unit}")
+
     def _send_status_to_arduino(self, status: bool, interval: int):
         """Enviar status e intervalo al Arduino (solo arenero)"""
         command = f"LITTERBOX:CONFIG:{int(status)},{interval}"
         if self.arduino.send_command(command):
             self.logger.info(f"✅ Status enviado: {status}, intervalo: {interval}")
 
-    def _send_food_to_arduino(self, amount: float):
-        """Enviar cantidad de comida al Arduino (solo feeder)"""
-        command = f"FEEDER:SET_FOOD:{amount}"
+    def dispense_food(self, amount: Optional[float] = None) -> bool:
+        """Servir una porción (solo feeder): comida pedida o programada, nunca al configurar"""
+        amount = self.food_amount if amount is None else amount
+        if self.get_device_type() != "feeder" or not amount or amount <= 0:
+            self.logger.warning("⚠️ Sin porción configurada: no se dispensa")
+            return False
+        # El firmware dosifica por gramos con la balanza (FDR1:DISPENSE:<g>)
+        command = f"{self.get_firmware_device_id() or 'FDR1'}:DISPENSE:{amount:.1f}"
         if self.arduino.send_command(command):
             self.logger.info(f"✅ Comida enviada: {amount}g")
+            return True
+        return False
 
     def _handle_mqtt_command(self, topic: str, payload: Dict):
         """Manejar comandos recibidos por MQTT"""
         parts = topic.split('/')
         if len(parts) >= 5:
             command = parts[4]
-            arduino_command = f"{command.upper()}:{payload.get('params', '')}"
-            success = self.arduino.send_command(arduino_command)
+            if command.lower() in ("feed", "dispense"):
+                # Comida a pedido: los gramos del payload o la porción configurada
+                try:
+                    params = payload.get('params')
+                    success = self.dispense_food(float(params) if params not in (None, '') else None)
+                except (TypeError, ValueError):
+                    self.logger.error(f"❌ Gramos inválidos en {topic}: {payload.get('params')}")
+                    success = False
+            else:
+                arduino_command = f"{command.upper()}:{payload.get('params', '')}"
+                success = self.arduino.send_command(arduino_command)
             
             self.mqtt_handler.publish_command_response(
                 self.identifier, command, success,
@@ -348,6 +558,50 @@ class DeviceManager:
                         }
                     )
 
+    def publish_sensor_health(self):
+        """🩺 Publicar por MQTT los contadores DIAG de los sensores de esta estación"""
+        if not self.is_configured or not self.mqtt_handler.connected:
+            return
+
+        diag = self.arduino.get_sensor_health()
+        if not diag:
+            return
+
+        firmware_ids = self.get_firmware_sensor_ids()
+        for sensor_index, firmware_id in enumerate(firmware_ids):
+            values = diag.get(firmware_id)
+            if not isinstance(values, list) or len(values) != len(self.DIAG_FIELDS):
+                continue
+            health = dict(zip(self.DIAG_FIELDS, values))
+
+            # Tasa de fallas del último intervalo: los contadores son acumulados
+            # desde el arranque (si bajan, el Arduino se reinició o hubo DIAG:RESET)
+            previous = self._last_health.get(firmware_id)
+            if previous and health["attempts"] >= previous["attempts"]:
+                attempts = health["attempts"] - previous["attempts"]
+                failures = (health["timeouts"] - previous["timeouts"]) + \
+                           (health["out_of_range"] - previous["out_of_range"])
+            else:
+                attempts = health["attempts"]
+                failures = health["timeouts"] + health["out_of_range"]
+            health["degraded"] = health["backoff"] > 0
+            health["interval_attempts"] = attempts
+            health["interval_error_rate"] = round(failures / attempts, 4) if attempts else None
+            self._last_health[firmware_id] = health
+
+            sensor_id = self.sensor_identifiers[sensor_index] \
+                if sensor_index < len(self.sensor_identifiers) else firmware_id
+            self.mqtt_handler.publish_sensor_health(
+                device_id=self.identifier,
+                sensor_id=sensor_id,
+                health={"firmware_sensor_id": firmware_id, **health}
+            )
+
+            if health["degraded"] and not (previous and previous.get("degraded")):
+                self.logger.warning(f"🩺 {firmware_id} degradado: el firmware espació sus lecturas")
+            elif health["interval_error_rate"] and health["interval_error_rate"] >= 0.2:
+                self.logger.warning(f"🩺 {firmware_id}: {failures} fallas en {attempts} lecturas")
+
     def _get_sensor_mappings(self) -> Dict[str, Dict]:
         """Mapeo de lecturas a sensores según tipo de dispositivo"""
         device_type = self.get_device_type()
@@ -377,8 +631,8 @@ class DeviceManager:
         """🚀 Iniciar dispositivo completo"""
         self.logger.info(f"🚀 Iniciando dispositivo: {self.device_code}")
         
-        # 1. Conectar Arduino
-        if not self.arduino.connect():
+        # 1. Conectar Arduino (el compartido ya lo conectó quien lo creó)
+        if self._owns_arduino and not self.arduino.connect():
             self.logger.error("❌ No se pudo conectar con Arduino")
             return False
 
@@ -421,6 +675,7 @@ class DeviceManager:
         self.socket_handler.disconnect()
         self.mqtt_handler.disconnect()
         self.mongo_handler.disconnect()
-        self.arduino.disconnect()
+        if self._owns_arduino:
+            self.arduino.disconnect()
         
         self.logger.info("🛑 Dispositivo detenido completamente")
\ No newline at end of file
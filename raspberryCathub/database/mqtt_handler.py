@@ -1,6 +1,7 @@
 import paho.mqtt.client as mqtt
 import json
 import logging
+import time
 from typing import Dict, Any, Optional
 
 class MQTTHandler:
@@ -98,6 +99,28 @@ class MQTTHandler:
             self.logger.error(f"❌ Excepción publicando datos: {e}")
             return False
 
+    def publish_sensor_health(self, device_id: str, sensor_id: str, health: Dict[str, Any]) -> bool:
+        """
+        Publica los contadores de salud de un sensor (fallas, antigüedad, duración)
+        
+        Topic: cathub/device/{device_id}/sensor/{sensor_id}/health
+        """
+        topic = f"cathub/device/{device_id}/sensor/{sensor_id}/health"
+        
+        payload = {
+            "device_id": device_id,
+            "sensor_id": sensor_id,
+            **health,
+            "timestamp": int(time.time() * 1000)
+        }
+        
+        try:
+            result = self.client.publish(topic, json.dumps(payload), qos=1)
+            return result.rc == mqtt.MQTT_ERR_SUCCESS
+        except Exception as e:
+            self.logger.error(f"❌ Error publicando salud del sensor: {e}")
+            return False
+
     def publish_device_status(self, device_id: str, status: str, device_type: str) -> bool:
         """
         Publica status del dispositivo
@@ -256,11 +256,10 @@ class PostgresHandler:
 
     def get_device_sensor_setting(self, sensor_id: str) -> Optional[Dict[str, Any]]:
         """
-        Obtiene la configuración de un sensor específico en un entorno dado.
+        Obtiene la configuración de un sensor específico.
 
         Args:
-            environment_id: ID del entorno
-            sensor_id: ID del sensor
+            sensor_id: ID del sensor (environment_sensors.id)
 
         Returns:
             Diccionario con la configuración del sensor o None si no se encuentra
@@ -287,10 +286,10 @@ class PostgresHandler:
             conn.close()
 
             if result:
-                self.logger.debug(f"✅ Configuración para sensor {sensor_id} en entorno {environment_id}: {result}")
+                self.logger.debug(f"✅ Configuración para sensor {sensor_id}: {result}")
                 return result
             else:
-                self.logger.warning(f"⚠️ No se encontró configuración para sensor {sensor_id} en entorno {environment_id}")
+                self.logger.warning(f"⚠️ No se encontró configuración para sensor {sensor_id}")
                 return None
 
         except Exception as e:
@@ -3,6 +3,8 @@ import time
 import signal
 import sys
 from core.DeviceManager import DeviceManager
+from communication.arduino_serial import ArduinoSerial
+from communication.bus_multiplexer import BusMultiplexer
 
 # Configurar logging
 logging.basicConfig(
@@ -10,41 +12,101 @@ logging.basicConfig(
     format='%(asctime)s - %(name)s - %(levelname)s - %(message)s'
 )
 
-# Variable global para el device manager
-device_manager = None
+SERIAL_PORT = "/dev/ttyACM0"
+
+# Dispositivos que atiende esta Raspberry: (código, estación del firmware,
+# tipo, placa). Con el firmware compilado para varias estaciones (CATHUB_UNITS) se
+# agregan acá los de la 2 y la 3; todos comparten el mismo puerto serie.
+# Placa: 0 = una sola placa punto a punto en SERIAL_PORT; 1..99 = dirección
+# (node_addr) de una de las placas colgadas del mismo bus RS-485 (SERIAL_PORT
+# es entonces el adaptador del bus). No se mezclan las dos formas.
+# (en producción podrías leerlo de un archivo o variable de entorno)
+STATIONS = [
+    ("I9J0K1L2", 1, None, 0),  # Ejemplo: arenero (tipo según el código)
+]
+
+# Variables globales para cerrar limpiamente
+device_managers = []
+arduino = None
+bus = None
+
+def stop_all():
+    for manager in device_managers:
+        manager.stop()
+    if arduino:
+        arduino.disconnect()
+    if bus:
+        bus.close()
+
+def connect_boards():
+    """Placa -> ArduinoSerial (o BusNode); None si no se pudo abrir el puerto"""
+    global arduino, bus
+
+    addresses = sorted({node for _, _, _, node in STATIONS})
+    if addresses == [0]:
+        # Un solo ArduinoSerial para todas las estaciones de la placa
+        arduino = ArduinoSerial(SERIAL_PORT)
+        if not arduino.connect():
+            print(f"❌ No se pudo conectar con Arduino en {SERIAL_PORT}")
+            return None
+        return {0: arduino}
+
+    if 0 in addresses:
+        print("❌ STATIONS mezcla placa 0 (punto a punto) con placas del bus")
+        return None
+    bus = BusMultiplexer(SERIAL_PORT)
+    if not bus.open():
+        print(f"❌ No se pudo abrir el bus en {SERIAL_PORT}")
+        return None
+    boards = {}
+    for address in addresses:
+        board = bus.node(address)
+        if board.connect():
+            boards[address] = board
+        else:
+            print(f"❌ La placa {address:02d} no responde en el bus")
+    return boards
 
 def signal_handler(sig, frame):
     """Manejador para cerrar limpiamente"""
     print('\n🛑 Cerrando aplicación...')
-    if device_manager:
-        device_manager.stop()
+    stop_all()
     sys.exit(0)
 
 def main():
-    global device_manager
-    
     # Configurar manejador de señales
     signal.signal(signal.SIGINT, signal_handler)
     
-    # Código del dispositivo (en producción podrías leerlo de un archivo o variable de entorno)
-    DEVICE_CODE = "I9J0K1L2"  # Ejemplo: arenero
+    boards = connect_boards()
+    if not boards:
+        stop_all()
+        return
+    
+    # Crear y iniciar un device manager por dispositivo
+    for device_code, unit, device_type, node in STATIONS:
+        if node not in boards:
+            continue
+        device_manager = DeviceManager(device_code, SERIAL_PORT, unit=unit,
+                                       arduino=boards[node], device_type=device_type)
+        if device_manager.start():
+            device_managers.append(device_manager)
+            print(f"✅ Dispositivo {device_code} (estación {unit}) iniciado correctamente")
+        else:
+            print(f"❌ No se pudo iniciar dispositivo {device_code}")
+    
+    if not device_managers:
+        stop_all()
+        return
     
-    # Crear y iniciar device manager
-    device_manager = DeviceManager(DEVICE_CODE, "/dev/ttyACM0")
+    print("⏳ Esperando identifier o eventos...")
     
-    if device_manager.start():
-        print(f"✅ Dispositivo {DEVICE_CODE} iniciado correctamente")
-        print("⏳ Esperando identifier o eventos...")
-        
-        # Mantener la aplicación corriendo
-        try:
-            while True:
-                time.sleep(1)
-        except KeyboardInterrupt:
-            print('\n� Cerrando aplicación...')
-            device_manager.stop()
-    else:
-        print(f"❌ No se pudo iniciar dispositivo {DEVICE_CODE}")
+    # Mantener la aplicación corriendo
+    try:
+        while True:
+            time.sleep(1)
+    except KeyboardInterrupt:
+        print('\n� Cerrando aplicación...')
+        stop_all()
 
 if __name__ == "__main__":
     main()
\ No newline at end of file
@@ -0,0 +1,292 @@
+"""
+Benchmark del bus de placas: comandos/s según cuántas placas comparten el cable
+
+Arma un bus simulado (PtyBus, ver pty_firmware.py) con 1, 2, 4... placas,
+el BusMultiplexer del host sobre él y un BusNode por placa. Un hilo por
+placa hace idas y vueltas de PING durante `--duration` segundos con el
+mismo _send_and_wait que usa el resto del código. Se mide:
+    - cmd/s total y por placa: cuánto escala el bus con la cantidad de placas
+    - p50/p99 de la ida y vuelta
+    - colisiones en el cable (dos que transmiten a la vez: tiene que ser 0)
+    - turnos vencidos del multiplexor y ciclos por segundo
+
+Y se comprueba que escale: con N placas se espera min(N x cmd/s de la
+primera fila por placa, lo que da el cable a esa velocidad), contando los
+bytes de una ida y vuelta de PING (comando, turno, PONG y fin de turno) a 10
+bits por byte. Si algún caso queda por debajo de --min-efficiency de lo
+esperado el script sale con 1: el cuello de botella es el host (el ciclo del
+BusMultiplexer), no el cable ni las placas.
+
+Con --slow-node la placa 1 recibe cada --slow-every segundos un
+LTR1:CAL_MQ2, que bloquea su loop ~2.5 s: su turno vence y el host sigue con
+las demás mientras su "@01:?" queda en el buffer. BusLink (y el emulador)
+descartan ese turno viejo; si lo contestaran hablarían encima de otra placa
+(colis, o líneas suyas en un turno ajeno: tarde). Cualquiera de las dos
+distinta de 0 hace salir con 1. --no-poll-guard apaga la regla en el
+emulador y reproduce el problema.
+
+Uso:
+    python scripts/benchmark-bus.py                                  # emulador Python
+    python scripts/benchmark-bus.py --nodes 1,2,4,8 --duration 10
+    python scripts/benchmark-bus.py --nodes 1,2,4,8 --baudrate 1000000   # cable RS-485 rápido
+    python scripts/benchmark-bus.py --native ../arduinoCathub/.pio/build/native/program --nodes 1,2,4
+    python scripts/benchmark-bus.py --nodes 2,4 --duration 10 --slow-node        # placa bloqueada
+Con --native cada placa es un proceso del firmware real: antes de colgarla
+del bus se le pone la dirección con SET:node_addr=N por su propio pty. Son
+procesos que compiten por la CPU: con menos núcleos que placas la
+eficiencia mide la máquina, no el bus (usar --min-efficiency más bajo).
+"""
+
+import argparse
+import json
+import logging
+import os
+import sys
+import threading
+import time
+from typing import Any, Dict, List, Optional
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from communication.bus_multiplexer import BusMultiplexer
+from pty_firmware import BusFirmwareEmulator, FirmwareEmulator, NativeFirmware, PtyBus, PtyLink
+
+
+def frame_bytes(address: int) -> int:
+    """Bytes en el cable de una ida y vuelta de PING con la placa `address`"""
+    prefix = f"{address:02d}:"
+    return len(f"@{prefix}PING\n") + len(f"@{prefix}?\n") + \
+        len(f'#{prefix}{{"response":"PONG"}}\r\n') + len(f"#{prefix}.\r\n")
+
+
+def wire_limit(baudrate: int) -> float:
+    """cmd/s que entran en el cable (8N1: 10 bits por byte)"""
+    return baudrate / 10.0 / frame_bytes(1)
+
+
+def check_scaling(results: List[Dict[str, Any]], baudrate: int):
+    """Agrega a cada caso lo esperado según la primera fila y el cable, y la eficiencia"""
+    base = results[0]["commands_per_s"] / results[0]["nodes"] if results else 0.0
+    for r in results:
+        r["expected_per_s"] = min(r["nodes"] * base, wire_limit(baudrate))
+        r["efficiency"] = r["commands_per_s"] / r["expected_per_s"] if r["expected_per_s"] else 0.0
+
+
+def percentile(values: List[float], q: float) -> Optional[float]:
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(round(q * (len(ordered) - 1))))]
+
+
+def commission(link: PtyLink, address: int, timeout: float) -> bool:
+    """Pone node_addr por el pty de la placa (todavía punto a punto) y espera el OK"""
+    deadline = time.perf_counter() + timeout
+    buf = b""
+    next_try = 0.0
+    while time.perf_counter() < deadline:
+        # Se reintenta: el firmware nativo no lee el Serial hasta terminar setup()
+        if time.perf_counter() >= next_try:
+            os.write(link.slave, f"SET:node_addr={address}\n".encode("utf-8"))
+            next_try = time.perf_counter() + 1.0
+        time.sleep(0.05)
+        try:
+            os.set_blocking(link.slave, False)
+            buf += os.read(link.slave, 4096)
+        except (BlockingIOError, OSError):
+            pass
+        finally:
+            os.set_blocking(link.slave, True)
+        if b'"param":"node_addr"' in buf and b'"success":true' in buf:
+            return True
+    return False
+
+
+def run_case(count: int, args) -> Dict[str, Any]:
+    links = [PtyLink() for _ in range(count)]
+    if args.native:
+        firmwares = [NativeFirmware(link, args.native) for link in links]
+    else:
+        firmwares = [BusFirmwareEmulator(link, address=k + 1, loop_ms=args.loop_ms, work_ms=args.work_ms,
+                                         baudrate=args.baudrate, boot_s=0.5, drop_stale_polls=not args.no_poll_guard)
+                     for k, link in enumerate(links)]
+    for fw in firmwares:
+        fw.start()
+
+    bus: Optional[PtyBus] = None
+    mux: Optional[BusMultiplexer] = None
+    try:
+        if args.native:
+            for k, link in enumerate(links):
+                if not commission(link, k + 1, timeout=15.0):
+                    raise RuntimeError(f"la placa {k + 1} no aceptó SET:node_addr")
+
+        bus = PtyBus(links, baudrate=args.baudrate)
+        bus.start()
+        mux = BusMultiplexer(bus.host.port, baudrate=args.baudrate, turn_timeout=args.turn_timeout,
+                             idle_s=args.idle_ms / 1000.0)
+        nodes = [mux.node(k + 1) for k in range(count)]
+        for node in nodes:
+            node.timeout = args.timeout
+            if not node.connect():
+                raise RuntimeError(f"la placa {node.address} no respondió por el bus")
+
+        # Medir desde cero: el PING de connect() y el arranque no cuentan
+        time.sleep(0.3)
+        for node in nodes:
+            node.flush_buffers()
+        collisions0 = bus.collisions
+        stats0 = dict(mux.stats)
+
+        samples: Dict[int, List[float]] = {node.address: [] for node in nodes}
+        failures = [0]
+        slow_commands = [0]
+        stop_at = time.perf_counter() + args.duration
+
+        def worker(node):
+            next_slow = time.perf_counter() + args.slow_every if args.slow_node and node.address == 1 else None
+            while time.perf_counter() < stop_at:
+                if next_slow is not None and time.perf_counter() >= next_slow:
+                    response = node._send_and_wait("LTR1:CAL_MQ2", args.timeout + FirmwareEmulator.CAL_MQ2_S,
+                                                   match=lambda r: r.get("action") == "CAL_MQ2")
+                    if response is None:
+                        failures[0] += 1
+                    slow_commands[0] += 1
+                    next_slow = time.perf_counter() + args.slow_every
+                    continue
+                t0 = time.perf_counter()
+                response = node._send_and_wait("PING", args.timeout)
+                if response and response.get("response") == "PONG":
+                    samples[node.address].append((time.perf_counter() - t0) * 1000.0)
+                else:
+                    # Sin respuesta, u otra línea de la placa (auto_action) tomada como respuesta
+                    failures[0] += 1
+
+        start = time.perf_counter()
+        workers = [threading.Thread(target=worker, args=(node,)) for node in nodes]
+        for w in workers:
+            w.start()
+        for w in workers:
+            w.join()
+        elapsed = time.perf_counter() - start
+
+        every = [v for values in samples.values() for v in values]
+        per_node = [len(values) / elapsed for values in samples.values()]
+        return {
+            "nodes": count,
+            "ok": len(every),
+            "failures": failures[0],
+            "commands_per_s": len(every) / elapsed,
+            "per_node_min": min(per_node),
+            "per_node_max": max(per_node),
+            "p50_ms": percentile(every, 0.50),
+            "p99_ms": percentile(every, 0.99),
+            "slow_commands": slow_commands[0],
+            "collisions": bus.collisions - collisions0,
+            "late_lines": mux.stats["late_lines"] - stats0["late_lines"],
+            "turn_timeouts": mux.stats["turn_timeouts"] - stats0["turn_timeouts"],
+            "cycles_per_s": (mux.stats["cycles"] - stats0["cycles"]) / elapsed,
+            "discarded_by_nodes": mux.stats["discarded_by_nodes"] - stats0["discarded_by_nodes"],
+        }
+    finally:
+        if mux:
+            mux.close()
+        if bus:
+            bus.stop()
+        for fw in firmwares:
+            fw.stop()
+        for link in links:
+            link.close()
+
+
+def fmt(value: Optional[float]) -> str:
+    return "-" if value is None else f"{value:.1f}"
+
+
+def print_table(results: List[Dict[str, Any]]):
+    header = f"{'placas':>6}{'ok':>7}{'fallo':>6}{'cmd/s':>9}{'x1':>6}{'esper':>8}{'efic':>6}" \
+             f"{'placa min':>11}{'placa max':>11}" \
+             f"{'p50':>8}{'p99':>8}{'colis':>7}{'tarde':>7}{'t/o turno':>11}{'ciclos/s':>10}"
+    print(header)
+    print("-" * len(header))
+    base = results[0]["commands_per_s"] if results and results[0]["commands_per_s"] else None
+    for r in results:
+        scale = r["commands_per_s"] / base if base else 0.0
+        print(f"{r['nodes']:>6}{r['ok']:>7}{r['failures']:>6}{r['commands_per_s']:>9.1f}{scale:>6.2f}"
+              f"{r['expected_per_s']:>8.1f}{r['efficiency']:>6.2f}"
+              f"{r['per_node_min']:>11.1f}{r['per_node_max']:>11.1f}{fmt(r['p50_ms']):>8}{fmt(r['p99_ms']):>8}"
+              f"{r['collisions']:>7}{r['late_lines']:>7}{r['turn_timeouts']:>11}{r['cycles_per_s']:>10.1f}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Comandos/s del bus de placas según la cantidad de placas")
+    parser.add_argument("--native", metavar="PROGRAM",
+                        help="binario de env:native (una instancia por placa); sin esto, emulador Python")
+    parser.add_argument("--nodes", default="1,2,4", help="cantidades de placas a medir (lista)")
+    parser.add_argument("--baudrate", type=int, default=115200,
+                        help="velocidad del cable simulado (RS-485 llega a 1000000 con el Mega)")
+    parser.add_argument("--duration", type=float, default=5.0, help="segundos de medición por caso")
+    parser.add_argument("--timeout", type=float, default=2.0, help="timeout por comando (s)")
+    parser.add_argument("--turn-timeout", type=float, default=0.25, help="espera del fin de turno (s)")
+    parser.add_argument("--idle-ms", type=float, default=2.0, help="espera del multiplexor entre ciclos a que encolen comandos")
+    parser.add_argument("--loop-ms", type=float, default=50.0, help="emulador: delay del loop")
+    parser.add_argument("--work-ms", type=float, default=6.0, help="emulador: trabajo por vuelta")
+    parser.add_argument("--min-efficiency", type=float, default=0.7,
+                        help="cmd/s mínimo respecto de lo esperado (N placas o el cable); debajo, sale con 1")
+    parser.add_argument("--slow-node", action="store_true",
+                        help="la placa 1 se bloquea en LTR1:CAL_MQ2 cada --slow-every s (turnos vencidos)")
+    parser.add_argument("--slow-every", type=float, default=3.0, help="segundos entre bloqueos de --slow-node")
+    parser.add_argument("--no-poll-guard", action="store_true",
+                        help="emulador: contestar también los turnos viejos (reproduce las colisiones)")
+    parser.add_argument("--json", metavar="PATH", help="guardar los resultados en JSON")
+    args = parser.parse_args()
+
+    logging.getLogger("communication.arduino_serial").setLevel(logging.WARNING)
+    logging.getLogger("communication.bus_multiplexer").setLevel(logging.WARNING)
+
+    print(f"🔌 Firmware: {'nativo ' + args.native if args.native else 'emulador Python'}, "
+          f"cable a {args.baudrate} baudios")
+    results = []
+    for count in [int(n) for n in args.nodes.split(",") if n]:
+        try:
+            results.append(run_case(count, args))
+        except RuntimeError as e:
+            print(f"❌ {count} placas: {e}")
+            sys.exit(1)
+        print(f"✅ {count} placas medidas")
+    print()
+
+    check_scaling(results, args.baudrate)
+    print_table(results)
+    print("\n(ms; fallo = sin PONG; x1 = cmd/s total respecto de una sola placa;")
+    print(f" esper = min(N x la primera fila, {wire_limit(args.baudrate):.0f} cmd/s del cable); efic = cmd/s / esper;")
+    print(" colis = transmisiones pisadas en el cable; tarde = líneas de una placa en el turno de otra)")
+    if args.slow_node:
+        print(f"🐢 Placa 1 bloqueada en CAL_MQ2: {sum(r['slow_commands'] for r in results)} veces "
+              f"(con una placa bloqueada no se mide la escala)")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"firmware": args.native or "emulator", "results": results}, f, indent=2)
+        print(f"💾 Resultados en {args.json}")
+
+    failed = False
+    for r in results:
+        if r["collisions"] or r["late_lines"]:
+            print(f"❌ {r['nodes']} placas: {r['collisions']} colisiones, {r['late_lines']} líneas fuera de turno")
+            failed = True
+    if not args.slow_node:
+        for r in results:
+            if r["efficiency"] < args.min_efficiency:
+                print(f"❌ {r['nodes']} placas: {r['commands_per_s']:.1f} cmd/s, {r['efficiency']:.0%} de lo "
+                      f"esperado ({r['expected_per_s']:.1f}); mínimo {args.min_efficiency:.0%}")
+                failed = True
+    if failed:
+        sys.exit(1)
+    if args.slow_node:
+        print("✅ Sin colisiones con una placa bloqueada")
+    else:
+        print(f"✅ Escala: todos los casos sobre {args.min_efficiency:.0%} de lo esperado, sin colisiones")
+
+
+if __name__ == "__main__":
+    main()
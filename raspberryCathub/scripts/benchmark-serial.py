@@ -0,0 +1,270 @@
+"""
+Benchmark de ida y vuelta de comandos serie (host <-> firmware)
+
+Conecta ArduinoSerial (el mismo código que usa main.py) a un firmware de
+mentira detrás de un pseudo-terminal (ver pty_firmware.py) y mide, por
+comando y por cantidad de hilos llamando a la vez, la latencia p50/p99 y
+los comandos/s. Cada ida y vuelta se desarma en:
+    - queue:    esperando el serial_lock (otros hilos con el puerto)
+    - write:    _send_command_raw (write + flush)
+    - wire:     del fin del write a que la línea llega completa al firmware
+    - firmware: de la línea recibida al primer byte de la respuesta
+    - read:     del primer byte de la respuesta a que la llamada devuelve
+                (aquí se ve el sondeo de _send_and_wait)
+
+Uso:
+    python scripts/benchmark-serial.py                       # emulador Python
+    python scripts/benchmark-serial.py --native ../arduinoCathub/.pio/build/native/program
+    python scripts/benchmark-serial.py --iterations 50 --threads 1,4 --json bench.json
+"""
+
+import argparse
+import json
+import logging
+import os
+import sys
+import threading
+import time
+from typing import Any, Callable, Dict, List, Optional
+
+sys.path.append(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+from communication.arduino_serial import ArduinoSerial
+from pty_firmware import FirmwareEmulator, NativeFirmware, PtyLink
+
+# ✅ COMANDOS MEDIDOS Y CÓMO RECONOCER SU RESPUESTA
+EXPECTED: Dict[str, Callable[[Dict[str, Any]], bool]] = {
+    "PING": lambda r: r.get("response") == "PONG",
+    "ALL": lambda r: r.get("command") == "ALL",
+    "LTR1:STATUS": lambda r: r.get("device_id") == "LTR1" and "status" in r,
+    "FDR1:1": lambda r: r.get("device_id") == "FDR1" and r.get("action") == "manual_control",
+    "FDR1:0": lambda r: r.get("device_id") == "FDR1" and r.get("action") == "manual_control",
+}
+# "C" responde texto plano (una línea por sensor): ArduinoSerial no tiene
+# una llamada de ida y vuelta para eso, se mide write + readline bajo el lock
+PLAIN_COMMAND = "C"
+PLAIN_LAST_PREFIX = "WIR_001:"
+DEFAULT_COMMANDS = ["PING", "C", "ALL", "LTR1:STATUS", "FDR1:1", "FDR1:0"]
+
+PHASES = ["queue", "write", "wire", "firmware", "read"]
+
+
+def percentile(values: List[float], q: float) -> Optional[float]:
+    if not values:
+        return None
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(round(q * (len(ordered) - 1))))]
+
+
+def parse_json(text: str) -> Optional[Dict[str, Any]]:
+    try:
+        value = json.loads(text)
+        return value if isinstance(value, dict) else None
+    except ValueError:
+        return None
+
+
+class RoundTripBench:
+    """Ejecuta y desarma idas y vueltas sobre un ArduinoSerial conectado al pty"""
+
+    def __init__(self, arduino: ArduinoSerial, link: PtyLink, timeout: float):
+        self.arduino = arduino
+        self.link = link
+        self.timeout = timeout
+        self.local = threading.local()
+
+        # Marcar el write real sin tocar ArduinoSerial
+        original = arduino._send_command_raw
+
+        def timed_send(command):
+            self.local.write_start = time.perf_counter()
+            ok = original(command)
+            self.local.write_end = time.perf_counter()
+            return ok
+
+        arduino._send_command_raw = timed_send
+
+    def _json_roundtrip(self, command: str) -> Dict[str, Any]:
+        expected = EXPECTED[command]
+        skipped = [0]
+
+        def match(response: Dict[str, Any]) -> bool:
+            # Las líneas que la placa manda sola (safety_check...) no son la respuesta
+            if expected(response):
+                return True
+            skipped[0] += 1
+            return False
+
+        t0 = time.perf_counter()
+        response = self.arduino._send_and_wait(command, self.timeout, match)
+        t_end = time.perf_counter()
+
+        if response is None:
+            return {"status": "timeout", "total": t_end - t0, "skipped": skipped[0]}
+        out = self.link.trace.first_output(lambda text: parse_json(text) == response,
+                                           self.local.write_start)
+        if out is None:
+            # La respuesta de una llamada anterior que quedó en el buffer
+            return {"status": "stale", "total": t_end - t0}
+        sample = self._split(command, t0, t_end, out[1])
+        sample["skipped"] = skipped[0]
+        return sample
+
+    def _plain_roundtrip(self, command: str) -> Dict[str, Any]:
+        t0 = time.perf_counter()
+        got_last = False
+        with self.arduino.serial_lock:
+            if self.arduino._send_command_raw(command):
+                conn = self.arduino.serial_connection
+                deadline = time.perf_counter() + self.timeout
+                while time.perf_counter() < deadline:
+                    line = conn.readline().decode("utf-8", errors="replace").strip()
+                    if line.startswith(PLAIN_LAST_PREFIX):
+                        got_last = True
+                        break
+        t_end = time.perf_counter()
+
+        if not got_last:
+            return {"status": "timeout", "total": t_end - t0}
+        out = self.link.trace.first_output(lambda text: text.startswith("LUT_001:"),
+                                           self.local.write_start)
+        return self._split(command, t0, t_end, out[1] if out else None)
+
+    def _split(self, command: str, t0: float, t_end: float, t_out: Optional[float]) -> Dict[str, Any]:
+        sample = {"status": "ok", "total": t_end - t0,
+                  "queue": self.local.write_start - t0,
+                  "write": self.local.write_end - self.local.write_start}
+        t_in = self.link.trace.last_command(command, self.local.write_start)
+        if t_in is not None and t_out is not None:
+            sample["wire"] = max(0.0, t_in - self.local.write_end)
+            sample["firmware"] = max(0.0, t_out - t_in)
+            sample["read"] = max(0.0, t_end - t_out)
+        return sample
+
+    def roundtrip(self, command: str) -> Dict[str, Any]:
+        if command == PLAIN_COMMAND:
+            return self._plain_roundtrip(command)
+        return self._json_roundtrip(command)
+
+    def run_case(self, command: str, threads: int, iterations: int) -> Dict[str, Any]:
+        samples: List[Dict[str, Any]] = []
+        samples_lock = threading.Lock()
+        remaining = [iterations]
+
+        # Cada caso arranca sin respuestas atrasadas del anterior
+        time.sleep(0.3)
+        self.arduino.flush_buffers()
+
+        def worker():
+            while True:
+                with samples_lock:
+                    if remaining[0] <= 0:
+                        return
+                    remaining[0] -= 1
+                sample = self.roundtrip(command)
+                with samples_lock:
+                    samples.append(sample)
+
+        start = time.perf_counter()
+        workers = [threading.Thread(target=worker) for _ in range(threads)]
+        for w in workers:
+            w.start()
+        for w in workers:
+            w.join()
+        elapsed = time.perf_counter() - start
+
+        ok = [s for s in samples if s["status"] == "ok"]
+        totals = [s["total"] * 1000.0 for s in ok]
+        result = {
+            "command": command,
+            "threads": threads,
+            "iterations": iterations,
+            "ok": len(ok),
+            "timeouts": sum(1 for s in samples if s["status"] == "timeout"),
+            "skipped_lines": sum(s.get("skipped", 0) for s in samples),
+            "stale": sum(1 for s in samples if s["status"] == "stale"),
+            "p50_ms": percentile(totals, 0.50),
+            "p99_ms": percentile(totals, 0.99),
+            "max_ms": max(totals) if totals else None,
+            "commands_per_s": len(ok) / elapsed if elapsed > 0 else 0.0,
+            "phases_p50_ms": {},
+        }
+        for phase in PHASES:
+            values = [s[phase] * 1000.0 for s in ok if phase in s]
+            result["phases_p50_ms"][phase] = percentile(values, 0.50)
+        return result
+
+
+def fmt(value: Optional[float]) -> str:
+    return "-" if value is None else f"{value:.1f}"
+
+
+def print_table(results: List[Dict[str, Any]]):
+    header = f"{'comando':<12}{'hilos':>6}{'ok':>5}{'t/o':>5}{'ajen':>5}{'viej':>5}{'p50':>8}{'p99':>8}{'cmd/s':>8}  " + \
+             "".join(f"{p:>9}" for p in PHASES)
+    print(header)
+    print("-" * len(header))
+    for r in results:
+        phases = "".join(f"{fmt(r['phases_p50_ms'][p]):>9}" for p in PHASES)
+        print(f"{r['command']:<12}{r['threads']:>6}{r['ok']:>5}{r['timeouts']:>5}{r['skipped_lines']:>5}{r['stale']:>5}"
+              f"{fmt(r['p50_ms']):>8}{fmt(r['p99_ms']):>8}{r['commands_per_s']:>8.2f}  {phases}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ida y vuelta de comandos serie sobre un pty")
+    parser.add_argument("--native", metavar="PROGRAM",
+                        help="binario de env:native (se lanza con --serial); sin esto, emulador Python")
+    parser.add_argument("--iterations", type=int, default=20, help="idas y vueltas por comando y caso")
+    parser.add_argument("--threads", default="1,4", help="hilos llamando a la vez (lista)")
+    parser.add_argument("--commands", default=",".join(DEFAULT_COMMANDS))
+    parser.add_argument("--timeout", type=float, default=2.0, help="timeout por comando (s)")
+    parser.add_argument("--loop-ms", type=float, default=50.0, help="emulador: delay del loop")
+    parser.add_argument("--work-ms", type=float, default=6.0, help="emulador: trabajo por vuelta")
+    parser.add_argument("--json", metavar="PATH", help="guardar los resultados en JSON")
+    args = parser.parse_args()
+
+    # Los DEBUG por línea de ArduinoSerial distorsionan la medición
+    logging.getLogger("communication.arduino_serial").setLevel(logging.WARNING)
+
+    link = PtyLink()
+    if args.native:
+        firmware = NativeFirmware(link, args.native)
+    else:
+        firmware = FirmwareEmulator(link, loop_ms=args.loop_ms, work_ms=args.work_ms)
+    firmware.start()
+
+    arduino = ArduinoSerial(port=link.port, baudrate=115200)
+    bench = RoundTripBench(arduino, link, args.timeout)
+
+    print(f"🔌 Firmware: {'nativo ' + args.native if args.native else 'emulador Python'} en {link.port}")
+    t0 = time.perf_counter()
+    if not arduino.connect():
+        print("❌ ArduinoSerial no pudo conectar")
+        firmware.stop()
+        link.close()
+        sys.exit(1)
+    connect_s = time.perf_counter() - t0
+    print(f"⏱️  connect(): {connect_s:.2f} s\n")
+
+    results = []
+    try:
+        for threads in [int(t) for t in args.threads.split(",") if t]:
+            for command in [c for c in args.commands.split(",") if c]:
+                results.append(bench.run_case(command, threads, args.iterations))
+    finally:
+        arduino.disconnect()
+        firmware.stop()
+        link.close()
+
+    print_table(results)
+    print("\n(ms; fases = p50 de cada tramo en las idas y vueltas correctas;")
+    print(" ajen = líneas sueltas de la placa salteadas, viej = respuesta de una llamada anterior)")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"firmware": args.native or "emulator", "connect_s": connect_s,
+                       "results": results}, f, indent=2)
+        print(f"💾 Resultados en {args.json}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,427 @@
+"""
+Firmware de mentira detrás de un pseudo-terminal
+
+Abre un par pty: ArduinoSerial se conecta al lado esclavo como si fuera
+/dev/ttyACM0 y del lado maestro responde uno de estos "firmwares":
+    - FirmwareEmulator: emulador en Python del protocolo serie (mismas
+      líneas que el firmware) con el loop de 50 ms y la velocidad del
+      puerto modelados
+    - NativeFirmware: el binario de `pio run -e native` en modo --serial
+      (el firmware real sobre el HAL nativo, al ritmo del reloj de pared)
+    - BusFirmwareEmulator: el emulador con dirección de bus (BusLink)
+
+PtyBus cuelga varios de esos pares de un mismo "cable" semidúplex: lo que
+escribe el host les llega a todas las placas y lo que escribe cada placa le
+llega al host, de a un byte por vez a la velocidad del puerto.
+
+Los dos anotan en una traza cuándo llega completa cada línea de comando y
+cuándo sale el primer byte de cada línea de respuesta, para separar el
+tiempo del firmware del tiempo del host.
+"""
+
+import os
+import pty
+import select
+import subprocess
+import threading
+import time
+import tty
+from collections import deque
+from typing import Deque, Dict, List, Optional, Tuple
+
+
+class LineTrace:
+    """Marcas de tiempo (time.perf_counter) de lo que cruza el cable"""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.rx: Deque[Tuple[str, float]] = deque(maxlen=10000)   # comandos recibidos
+        self.tx: Deque[Tuple[str, float]] = deque(maxlen=10000)   # respuestas (primer byte)
+
+    def command_in(self, line: str, t: float):
+        with self.lock:
+            self.rx.append((line, t))
+
+    def line_out(self, line: str, t: float):
+        with self.lock:
+            self.tx.append((line, t))
+
+    def last_command(self, line: str, since: float) -> Optional[float]:
+        """Llegada del comando `line` posterior a `since`"""
+        with self.lock:
+            for text, t in reversed(self.rx):
+                if t < since:
+                    break
+                if text == line:
+                    return t
+        return None
+
+    def first_output(self, predicate, since: float) -> Optional[Tuple[str, float]]:
+        """Primera línea de salida posterior a `since` que cumple `predicate`"""
+        with self.lock:
+            for text, t in self.tx:
+                if t >= since and predicate(text):
+                    return text, t
+        return None
+
+
+class PtyLink:
+    """Par pty en modo crudo: `port` para ArduinoSerial, `master` para el firmware"""
+
+    def __init__(self):
+        self.master, self.slave = pty.openpty()
+        # Sin eco ni traducción de fin de línea antes de que pyserial abra el puerto
+        tty.setraw(self.slave)
+        self.port = os.ttyname(self.slave)
+        self.trace = LineTrace()
+
+    def close(self):
+        for fd in (self.master, self.slave):
+            try:
+                os.close(fd)
+            except OSError:
+                pass
+
+
+class FirmwareEmulator(threading.Thread):
+    """
+    Emulador del protocolo serie del firmware
+
+    Modelo de tiempos: el firmware lee el Serial una vez por vuelta de loop
+    (trabajo `work_ms` + delay(50)), procesa como máximo un comando por
+    vuelta y la respuesta sale a `baudrate` (10 bits por byte).
+    """
+
+    def __init__(self, link: PtyLink, loop_ms: float = 50.0, work_ms: float = 6.0,
+                 baudrate: int = 115200, boot_s: float = 2.0):
+        super().__init__(daemon=True)
+        self.link = link
+        self.loop_s = (loop_ms + work_ms) / 1000.0
+        self.byte_s = 10.0 / baudrate
+        self.boot_s = boot_s
+        self.running = True
+        self.motor_on = False
+        self.pending: Deque[str] = deque()
+
+    # ✅ RESPUESTAS (mismos textos que ProtocolStrings.h)
+    # ALL y LTR1:STATUS pasan por isLitterboxSafeToOperate(), que imprime su
+    # propia línea safety_check antes de la respuesta: se reproduce igual
+    SAFETY_CHECK = '{"safety_check":"NO_CAT_DETECTED"}'
+    # calibrateRo() bloquea el loop: 50 muestras cada 50 ms
+    CAL_MQ2_S = 2.5
+
+    def respond(self, command: str) -> List[str]:
+        if command == "PING":
+            return ['{"response":"PONG"}']
+        if command == "ALL":
+            return [self.SAFETY_CHECK,
+                    '{"command":"ALL","devices":{"LTR1":{"state":1,"safe":true},'
+                    '"FDR1":{},"WTR1":{}}}']
+        if command == "C":
+            return ["LUT_001:0", "DHT_001:22.00", "DHT_001:45.00", "MQ2_001:0.14",
+                    "UTS_001:25.00", "UTS_002:8.00", "WIT_001:0.00", "WLV_001:360", "WIR_001:0"]
+        if command == "LTR1:STATUS":
+            return [self.SAFETY_CHECK,
+                    '{"device_id":"LTR1","status":"INACTIVE","state":1,"distance_cm":34.00,'
+                    '"temperature_c":22.00,"humidity_percent":45.00,"gas_ppm":0.14,'
+                    '"gas_analog":95,"mq2_ro":10.000,"mq2_baseline_rs":98.30,'
+                    '"motor_ready":false,"safe_to_operate":true}']
+        if command in ("FDR1:1", "FDR1:0"):
+            self.motor_on = command == "FDR1:1"
+            state = "ON" if self.motor_on else "OFF"
+            return ['{"device_id":"FDR1","action":"manual_control","success":true,"motor":"%s"}' % state]
+        if command == "LTR1:CAL_MQ2":
+            time.sleep(self.CAL_MQ2_S)
+            return ['{"device_id":"LTR1","action":"CAL_MQ2","success":true,"mq2_ro":10.000}']
+        return ['{"error":"UNKNOWN_COMMAND","received":"%s"}' % command]
+
+    def _write_line(self, line: str):
+        data = (line + "\n").encode("utf-8")
+        self.link.trace.line_out(line, time.perf_counter())
+        # La UART no va más rápido que el baudrate
+        time.sleep(len(data) * self.byte_s)
+        os.write(self.link.master, data)
+
+    def _reader(self):
+        buf = b""
+        while self.running:
+            try:
+                chunk = os.read(self.link.master, 256)
+            except OSError:
+                return
+            if not chunk:
+                return
+            buf += chunk
+            while b"\n" in buf:
+                raw, buf = buf.split(b"\n", 1)
+                line = raw.decode("utf-8", errors="replace").strip()
+                if line:
+                    self.link.trace.command_in(line, time.perf_counter())
+                    self.pending.append(line)
+
+    def run(self):
+        threading.Thread(target=self._reader, daemon=True).start()
+        time.sleep(self.boot_s)
+        self._write_line('{"event":"BOOT","reset_cause":"POWER_ON"}')
+        next_loop = time.perf_counter()
+        while self.running:
+            # Un comando por vuelta, leído al principio del loop
+            if self.pending:
+                command = self.pending.popleft()
+                try:
+                    for line in self.respond(command):
+                        self._write_line(line)
+                except OSError:
+                    return
+            next_loop += self.loop_s
+            delay = next_loop - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                next_loop = time.perf_counter()
+
+    def stop(self):
+        self.running = False
+
+
+class BusFirmwareEmulator(FirmwareEmulator):
+    """
+    El emulador con dirección de bus, con el modelo de main.cpp en modo nodo
+
+    Por vuelta: hasta BUS_LINES_PER_LOOP líneas (comandos a la cola de
+    salida, el turno la vuelca), el trabajo de la vuelta y la espera del
+    loop, que se corta apenas llega una trama para esta placa (BusLink::idle).
+    La salida no espera el baudrate: el tiempo de cable lo pone PtyBus.
+
+    Como BusLink, un turno que quedó viejo en el buffer (la placa estuvo
+    bloqueada) no se contesta si detrás llegó otra línea o si tiene más de
+    POLL_MAX_AGE_S. Con drop_stale_polls=False se contesta igual, como antes
+    de esa regla: sirve para reproducir las colisiones que evita.
+    """
+
+    BUS_LINES_PER_LOOP = 16
+    POLL_MAX_AGE_S = 0.150          # BUS_POLL_MAX_AGE_MS
+
+    def __init__(self, link: PtyLink, address: int, loop_ms: float = 50.0, work_ms: float = 6.0,
+                 baudrate: int = 115200, boot_s: float = 2.0, drop_stale_polls: bool = True):
+        super().__init__(link, loop_ms=loop_ms, work_ms=work_ms, baudrate=baudrate, boot_s=boot_s)
+        self.address = address
+        self.drop_stale_polls = drop_stale_polls
+        self.lines_heard = 0            # todas las líneas del bus, también las de otras placas
+        self.stale_polls = 0
+        self.work_s = work_ms / 1000.0
+        self.idle_s = loop_ms / 1000.0
+        self.wake = threading.Event()
+        self.queued: List[str] = []
+
+    def _accept(self, line: str) -> Optional[str]:
+        """Como BusLink::accept: el comando sin prefijo, "?" si es el turno, None si no es para esta placa"""
+        if len(line) < 4 or line[0] != "@" or line[3] != ":" or not line[1:3].isdigit():
+            return None
+        target = int(line[1:3])
+        if target not in (0, self.address):
+            return None
+        payload = line[4:]
+        if payload == "?":
+            return "?" if target == self.address else None
+        return payload
+
+    def _send_turn(self):
+        prefix = "#%02d:" % self.address
+        lines = [prefix + text for text in self.queued] + [prefix + "."]
+        self.queued = []
+        now = time.perf_counter()
+        for line in lines:
+            self.link.trace.line_out(line, now)
+        os.write(self.link.master, "".join(line + "\r\n" for line in lines).encode("utf-8"))
+
+    def _reader(self):
+        buf = b""
+        while self.running:
+            try:
+                chunk = os.read(self.link.master, 256)
+            except OSError:
+                return
+            if not chunk:
+                return
+            buf += chunk
+            while b"\n" in buf:
+                raw, buf = buf.split(b"\n", 1)
+                self.lines_heard += 1
+                command = self._accept(raw.decode("utf-8", errors="replace").strip())
+                # Las tramas de las otras placas no despiertan al loop
+                if command is not None:
+                    now = time.perf_counter()
+                    self.link.trace.command_in(command, now)
+                    self.pending.append((command, now, self.lines_heard))
+                    self.wake.set()
+
+    def run(self):
+        threading.Thread(target=self._reader, daemon=True).start()
+        time.sleep(self.boot_s)
+        self.queued.append('{"event":"BOOT","reset_cause":"POWER_ON"}')
+        while self.running:
+            for _ in range(self.BUS_LINES_PER_LOOP):
+                if not self.pending:
+                    break
+                command, arrived, heard = self.pending.popleft()
+                try:
+                    if command == "?":
+                        stale = self.lines_heard > heard or \
+                            time.perf_counter() - arrived > self.POLL_MAX_AGE_S
+                        if stale and self.drop_stale_polls:
+                            self.stale_polls += 1
+                        else:
+                            self._send_turn()
+                    elif command is not None:
+                        self.queued.extend(self.respond(command))
+                except OSError:
+                    return
+            time.sleep(self.work_s)
+            self.wake.clear()
+            if not self.pending:
+                self.wake.wait(self.idle_s)
+
+
+class PtyBus:
+    """
+    Cable semidúplex entre un host y varias placas, cada una en su PtyLink
+
+    El host abre `host.port`; las placas (emulador o NativeFirmware) usan el
+    lado maestro de su propio link y el bus habla con el lado esclavo. Un
+    solo hilo mueve los bytes de a uno: en el cable no puede haber dos a la
+    vez, y si dos placas tienen una línea a medio mandar al mismo tiempo, o
+    el host escribe mientras una placa está a mitad de línea, se cuenta una
+    colisión (en un RS-485 real esos bytes se pisarían).
+    """
+
+    def __init__(self, nodes: List[PtyLink], baudrate: int = 115200):
+        self.host = PtyLink()
+        self.nodes = nodes
+        self.byte_s = 10.0 / baudrate
+        self.running = False
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.collisions = 0
+        self.bytes_on_wire = 0
+
+    def start(self):
+        self.running = True
+        self.thread.start()
+
+    def _run(self):
+        sources = [self.host.master] + [link.slave for link in self.nodes]
+        pending: Dict[int, bytes] = {fd: b"" for fd in sources}
+        mid_line: Dict[int, bool] = {fd: False for fd in sources}
+        wire_free = time.perf_counter()
+
+        while self.running:
+            try:
+                ready, _, _ = select.select(sources, [], [], 0.05)
+            except (OSError, ValueError):
+                return
+            for fd in ready:
+                try:
+                    pending[fd] += os.read(fd, 256)
+                except OSError:
+                    pass
+
+            talking = [fd for fd in sources if pending[fd]]
+            node_mid = [fd for fd in sources[1:] if mid_line[fd]]
+            if len(set(talking + node_mid)) > 1:
+                self.collisions += 1
+
+            for fd in talking:
+                data, pending[fd] = pending[fd], b""
+                # El cable se ocupa byte por byte: el próximo envío espera al anterior
+                wire_free = max(wire_free, time.perf_counter()) + len(data) * self.byte_s
+                delay = wire_free - time.perf_counter()
+                if delay > 0:
+                    time.sleep(delay)
+                self.bytes_on_wire += len(data)
+                if fd != self.host.master:
+                    mid_line[fd] = not data.endswith(b"\n")
+                targets = [link.slave for link in self.nodes] if fd == self.host.master else [self.host.master]
+                for target in targets:
+                    try:
+                        os.write(target, data)
+                    except OSError:
+                        pass
+
+    def stop(self):
+        self.running = False
+        self.thread.join(timeout=1)
+        self.host.close()
+
+
+class NativeFirmware:
+    """
+    Firmware real compilado para la PC (env:native) en modo --serial
+
+    Un hilo pasa los bytes del pty al stdin del programa y otro los de su
+    stdout al pty, anotando las líneas en la traza.
+    """
+
+    def __init__(self, link: PtyLink, program: str):
+        self.link = link
+        self.proc = subprocess.Popen([program, "--serial"], stdin=subprocess.PIPE,
+                                     stdout=subprocess.PIPE, bufsize=0)
+        self.threads = [threading.Thread(target=self._host_to_fw, daemon=True),
+                        threading.Thread(target=self._fw_to_host, daemon=True)]
+
+    def start(self):
+        for t in self.threads:
+            t.start()
+
+    def _host_to_fw(self):
+        buf = b""
+        while self.proc.poll() is None:
+            try:
+                chunk = os.read(self.link.master, 256)
+            except OSError:
+                return
+            if not chunk:
+                return
+            buf += chunk
+            while b"\n" in buf:
+                raw, buf = buf.split(b"\n", 1)
+                line = raw.decode("utf-8", errors="replace").strip()
+                if line:
+                    self.link.trace.command_in(line, time.perf_counter())
+            try:
+                self.proc.stdin.write(chunk)
+            except (BrokenPipeError, ValueError):
+                return
+
+    def _fw_to_host(self):
+        line_start: Optional[float] = None
+        line = b""
+        while True:
+            chunk = self.proc.stdout.read1(256) if hasattr(self.proc.stdout, "read1") \
+                else os.read(self.proc.stdout.fileno(), 256)
+            if not chunk:
+                return
+            now = time.perf_counter()
+            for byte in chunk:
+                if line_start is None:
+                    line_start = now
+                if byte == 0x0A:
+                    text = line.decode("utf-8", errors="replace").strip()
+                    if text:
+                        self.link.trace.line_out(text, line_start)
+                    line, line_start = b"", None
+                else:
+                    line += bytes((byte,))
+            try:
+                os.write(self.link.master, chunk)
+            except OSError:
+                return
+
+    def stop(self):
+        try:
+            self.proc.stdin.close()
+        except Exception:
+            pass
+        try:
+            self.proc.wait(timeout=2)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
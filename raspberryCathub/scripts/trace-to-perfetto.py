@@ -0,0 +1,252 @@
+"""
+Volcado de la traza binaria del firmware -> Chrome trace / Perfetto JSON
+
+El firmware compilado con -DCATHUB_TRACE (pio run -e megaatmega2560_trace)
+graba eventos en un anillo de registros de 8 bytes. El comando TRACE
+responde una línea JSON {"trace":{...,"records":N}} seguida de N * 8 bytes
+(little-endian: tick micros() u32, evento u8, secuencia u8, argumento u16).
+
+La tabla de eventos (fase, pista y cómo leer el argumento) se lee de
+TRACE_EVENT_LIST en arduinoCathub/src/system/TraceBuffer.h, y los nombres de
+tareas, canales de sensor y motivos de las enumeraciones del mismo árbol:
+un evento nuevo en el firmware no necesita tocar este script.
+
+Uso:
+    # Directo de la placa (sin reiniciarla: el anillo se perdería)
+    python scripts/trace-to-perfetto.py --port /dev/ttyACM0 -o traza.json
+    # Desde una captura (cualquier salida que contenga la respuesta a TRACE)
+    # (firmware nativo con traza: PLATFORMIO_BUILD_FLAGS=-DCATHUB_TRACE pio run -e native)
+    CMDS=$'FDR1:1\\nFDR1:0\\nTRACE\\n' .pio/build/native/program 400 > volcado.bin
+    python scripts/trace-to-perfetto.py --input volcado.bin -o traza.json
+
+El JSON se abre en https://ui.perfetto.dev o en chrome://tracing.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+import time
+from typing import Any, Dict, List, Optional, Tuple
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__)))),
+                              "arduinoCathub", "src", "system", "TraceBuffer.h")
+RECORD = struct.Struct("<IBBH")
+HEADER_MARK = b'{"trace":'
+
+# ✅ DE DÓNDE SALEN LOS NOMBRES DE CADA TIPO DE ARGUMENTO
+# tipo -> (archivo relativo a src/, prefijo de la enumeración)
+ARG_ENUMS = {
+    "task": ("system/Watchdog.h", "WDT_TASK_"),
+    "sensor": ("Devices/SensorManager.h", "SENSOR_CH_"),
+    "reason": ("system/TraceBuffer.h", "TRC_REASON_"),
+    "channel": ("system/SafetyInterlock.h", "SAFETY_"),
+}
+
+
+# ===== TABLAS DESDE EL FUENTE DEL FIRMWARE =====
+def parse_event_list(header_path: str) -> List[Dict[str, str]]:
+    """TRACE_EVENT_LIST: el id de cada evento es su posición"""
+    with open(header_path, encoding="utf-8") as f:
+        text = f.read()
+    pattern = re.compile(r"X\(\s*(TRC_\w+)\s*,\s*'(\w)'\s*,\s*\"(\w+)\"\s*,\s*\"(\w+)\"\s*\)")
+    events = [{"name": m.group(1)[4:], "phase": m.group(2), "track": m.group(3), "arg": m.group(4)}
+              for m in pattern.finditer(text)]
+    if not events:
+        raise ValueError(f"No se encontró TRACE_EVENT_LIST en {header_path}")
+    return events
+
+
+def parse_enum(path: str, prefix: str) -> Dict[int, str]:
+    """Miembros PREFIX_* en orden, respetando los valores explícitos"""
+    with open(path, encoding="utf-8") as f:
+        text = re.sub(r"//[^\n]*", "", f.read())
+    names: Dict[int, str] = {}
+    value = 0
+    for m in re.finditer(r"\b" + prefix + r"(\w+)\s*(?:=\s*(0x[0-9A-Fa-f]+|\d+))?\s*[,}]", text):
+        if m.group(2):
+            value = int(m.group(2), 0)
+        if m.group(1) not in ("COUNT", "NONE"):
+            names[value] = m.group(1)
+        value += 1
+    return names
+
+
+def load_arg_names(header_path: str) -> Dict[str, Dict[int, str]]:
+    src = os.path.dirname(os.path.dirname(header_path))
+    tables = {}
+    for kind, (relative, prefix) in ARG_ENUMS.items():
+        path = os.path.join(src, relative)
+        tables[kind] = parse_enum(path, prefix) if os.path.exists(path) else {}
+    return tables
+
+
+# ===== LECTURA DEL VOLCADO =====
+def split_dump(data: bytes) -> Tuple[Dict[str, Any], bytes]:
+    """Busca la última respuesta a TRACE en `data`: (cabecera, registros crudos)"""
+    start = data.rfind(HEADER_MARK)
+    if start < 0:
+        raise ValueError("No hay respuesta a TRACE en la entrada")
+    end = data.index(b"\n", start)
+    header = json.loads(data[start:end].decode("utf-8").strip())["trace"]
+    if not header.get("enabled"):
+        raise ValueError("El firmware no tiene la traza (compilar con -DCATHUB_TRACE)")
+    size = header["records"] * header["record_bytes"]
+    raw = data[end + 1:end + 1 + size]
+    if len(raw) < size:
+        raise ValueError(f"Volcado incompleto: {len(raw)} de {size} bytes")
+    return header, raw
+
+
+def read_from_port(port: str, baudrate: int, timeout: float) -> bytes:
+    import serial
+
+    conn = serial.Serial()
+    conn.port = port
+    conn.baudrate = baudrate
+    conn.timeout = timeout
+    # Sin DTR al abrir: el Mega se reinicia con el flanco y el anillo está en SRAM
+    conn.dtr = False
+    conn.open()
+    try:
+        conn.reset_input_buffer()
+        conn.write(b"TRACE\n")
+        conn.flush()
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            line = conn.readline()
+            if line.startswith(HEADER_MARK):
+                header = json.loads(line.decode("utf-8"))["trace"]
+                size = header.get("records", 0) * header.get("record_bytes", 0)
+                return line + conn.read(size)
+        raise TimeoutError("El firmware no respondió a TRACE")
+    finally:
+        conn.close()
+
+
+# ===== CONVERSIÓN =====
+def decode_records(header: Dict[str, Any], raw: bytes) -> Tuple[List[Tuple[int, int, int]], int]:
+    """(ts_us, evento, arg) del más viejo al más nuevo, con micros() desenrollado"""
+    records = []
+    gaps = 0
+    ts = 0
+    prev_tick: Optional[int] = None
+    prev_seq: Optional[int] = None
+    for tick, event, seq, arg in RECORD.iter_unpack(raw):
+        if prev_tick is not None:
+            ts += (tick - prev_tick) & 0xFFFFFFFF   # micros() da la vuelta cada ~71 min
+            if seq != (prev_seq + 1) & 0xFF:
+                gaps += 1
+        prev_tick, prev_seq = tick, seq
+        records.append((ts, event, arg))
+    return records, gaps
+
+
+def format_arg(kind: str, arg: int, names: Dict[str, Dict[int, str]]) -> Any:
+    if kind == "cmd":
+        first, last = chr(arg >> 8), chr(arg & 0xFF)
+        return f"{first}…{last}"
+    if kind in names:
+        return names[kind].get(arg, arg)
+    return arg
+
+
+def to_chrome(records: List[Tuple[int, int, int]], events: List[Dict[str, str]],
+              names: Dict[str, Dict[int, str]]) -> Tuple[List[Dict[str, Any]], int]:
+    """Eventos Chrome trace; los fines sin comienzo (pisado o anterior a TRACE:RESET) se descartan"""
+    pid = 1
+    tracks: Dict[str, int] = {}
+    for e in events:
+        tracks.setdefault(e["track"], len(tracks) + 1)
+
+    out: List[Dict[str, Any]] = [{"ph": "M", "name": "process_name", "pid": pid, "args": {"name": "CatHub"}}]
+    for track, tid in tracks.items():
+        out.append({"ph": "M", "name": "thread_name", "pid": pid, "tid": tid, "args": {"name": track}})
+        out.append({"ph": "M", "name": "thread_sort_index", "pid": pid, "tid": tid, "args": {"sort_index": tid}})
+
+    open_slices = {tid: 0 for tid in tracks.values()}
+    orphans = 0
+    for ts, event_id, arg in records:
+        if event_id >= len(events):
+            out.append({"ph": "i", "s": "p", "name": f"UNKNOWN_{event_id}", "ts": ts, "pid": pid, "tid": 0,
+                        "args": {"arg": arg}})
+            continue
+        e = events[event_id]
+        tid = tracks[e["track"]]
+        value = format_arg(e["arg"], arg, names)
+        item: Dict[str, Any] = {"ts": ts, "pid": pid, "tid": tid}
+
+        if e["phase"] == "B":
+            # Tareas y canales llevan su propio nombre; el resto, el del evento
+            item.update(ph="B", name=value if e["arg"] in ("task", "sensor") else e["name"],
+                        args={e["arg"]: value})
+            open_slices[tid] += 1
+        elif e["phase"] == "E":
+            if open_slices[tid] == 0:
+                orphans += 1
+                continue
+            open_slices[tid] -= 1
+            item.update(ph="E", args={e["name"].lower(): value})
+        elif e["phase"] == "C":
+            item.update(ph="C", name=e["name"], args={e["arg"]: arg})
+        else:
+            item.update(ph="i", s="t", name=e["name"], args={e["arg"]: value})
+        out.append(item)
+    return out, orphans
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Traza binaria del firmware -> Chrome trace / Perfetto JSON")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="puerto serie de la placa (envía TRACE)")
+    source.add_argument("--input", metavar="PATH", help="captura que contiene la respuesta a TRACE")
+    parser.add_argument("--baudrate", type=int, default=115200)
+    parser.add_argument("--timeout", type=float, default=5.0, help="espera de la respuesta por el puerto (s)")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="TraceBuffer.h con TRACE_EVENT_LIST")
+    parser.add_argument("--save-raw", metavar="PATH", help="guardar también el volcado crudo")
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    events = parse_event_list(args.header)
+    names = load_arg_names(args.header)
+
+    if args.port:
+        data = read_from_port(args.port, args.baudrate, args.timeout)
+    else:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    if args.save_raw:
+        with open(args.save_raw, "wb") as f:
+            f.write(data)
+
+    try:
+        header, raw = split_dump(data)
+    except ValueError as e:
+        print(f"❌ {e}")
+        sys.exit(1)
+
+    records, gaps = decode_records(header, raw)
+    trace_events, orphans = to_chrome(records, events, names)
+
+    span_ms = records[-1][0] / 1000.0 if records else 0.0
+    with open(args.output, "w") as f:
+        json.dump({"traceEvents": trace_events, "displayTimeUnit": "ms",
+                   "otherData": {"firmware_trace": header}}, f)
+
+    print(f"📼 {len(records)} registros ({header['total']} grabados, capacidad {header['capacity']}) "
+          f"en {span_ms:.1f} ms")
+    if header["total"] > header["capacity"]:
+        print(f"⚠️  El anillo dio la vuelta: se perdieron los {header['total'] - header['capacity']} más viejos")
+    if header.get("discarded"):
+        print(f"⚠️  {header['discarded']} eventos llegaron con el anillo congelado (durante un volcado)")
+    if gaps:
+        print(f"⚠️  {gaps} saltos de secuencia")
+    if orphans:
+        print(f"ℹ️  {orphans} fines sin comienzo descartados (el comienzo quedó fuera del volcado)")
+    print(f"💾 {args.output}")
+
+
+if __name__ == "__main__":
+    main()